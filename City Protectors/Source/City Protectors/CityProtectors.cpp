@@ -1,4 +1,5 @@
 #include <EngineStd.h>
+#include <Events.h>
 
 #include "CityProtectors.h"
 #include "CityProtectorsLogic.h"
@@ -30,6 +31,8 @@ HICON CityProtectors::GetIcon()
 
 BaseGameLogic* CityProtectors::CreateGameAndView()
 {
+	SetGameEventLanes();
+
 	// create a new game logic and initialize it
 	m_pGame = CB_NEW CityProtectorsLogic();
 	m_pGame->Init();
@@ -41,12 +44,42 @@ BaseGameLogic* CityProtectors::CreateGameAndView()
 	return m_pGame;
 }
 
+BaseGameLogic* CityProtectors::CreateGameServer()
+{
+	SetGameEventLanes();
+
+	// create a new game logic and initialize it
+	m_pGame = CB_NEW CityProtectorsLogic();
+	m_pGame->Init();
+
+	// there is no main menu, start waiting for players right away
+	shared_ptr<Event_RequestStartGame> pRequestStartGameEvent(CB_NEW Event_RequestStartGame());
+	IEventManager::Get()->QueueEvent(pRequestStartGameEvent);
+
+	return m_pGame;
+}
+
+void CityProtectors::SetGameEventLanes()
+{
+	// player input is handled before anything else, ui updates can wait a frame if time runs out.
+	// a server never sends ui updates, so the cosmetic lane costs it nothing
+	m_pEventManager->SetEventLane(Event_StartThrust::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_EndThrust::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_StartSteer::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_EndSteer::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_FireWeapon::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_GameplayUIUpdate::sk_EventType, EventLane_Cosmetic);
+}
+
 void CityProtectors::RegisterGameEvents()
 {
 	REGISTER_EVENT(Event_StartThrust);
 	REGISTER_EVENT(Event_EndThrust);
 	REGISTER_EVENT(Event_StartSteer);
 	REGISTER_EVENT(Event_EndSteer);
+	REGISTER_EVENT(Event_FireWeapon);
+	REGISTER_EVENT(Event_GameplayUIUpdate);
+	REGISTER_EVENT(Event_SetControlledObject);
 }
 
 void CityProtectors::CreateNetworkEventForwarder()
@@ -25,7 +25,12 @@ public:
 
 protected:
 	virtual BaseGameLogic* CreateGameAndView();
+	virtual BaseGameLogic* CreateGameServer();
 	virtual void RegisterGameEvents();
 	virtual void CreateNetworkEventForwarder();
 	virtual void DestroyNetworkEventForwarder();
+
+private:
+	// put the game's events in their queue lanes, shared by the client and the server
+	void SetGameEventLanes();
 };
@@ -124,6 +124,9 @@ void CityProtectorsHumanView::RenderText()
 		D3DRenderer::g_pTextHelper->SetForegroundColor(D3DXCOLOR(1.0f, 1.0f, 0.0f, 1.0f));
 		D3DRenderer::g_pTextHelper->DrawTextLine(DXUTGetFrameStats());
 		D3DRenderer::g_pTextHelper->DrawTextLine(DXUTGetDeviceStats());
+		FramePacerStats frameStats = g_pApp->m_FramePacer.GetStats();
+		D3DRenderer::g_pTextHelper->DrawFormattedTextLine(L"Frame: avg %.2fms p99 %.2fms jitter %.2fms cpu %.0f%%",
+			frameStats.m_AvgFrameMS, frameStats.m_P99FrameMS, frameStats.m_JitterMS, frameStats.m_CpuUsage * 100.0f);
 		//...output statistics
 
 		D3DRenderer::g_pTextHelper->SetForegroundColor(D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.5f));
@@ -202,7 +205,7 @@ void CityProtectorsHumanView::OnUpdate(float deltaTime)
 	}
 
 	// set out a tick event to any listeners
-	shared_ptr<Event_UpdateTick> pEvent(CB_NEW Event_UpdateTick(deltaTime));
+	shared_ptr<Event_UpdateTick> pEvent = MakePooledEvent<Event_UpdateTick>(deltaTime);
 	IEventManager::Get()->TriggerEvent(pEvent);
 }
 
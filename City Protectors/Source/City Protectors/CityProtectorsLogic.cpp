@@ -43,11 +43,11 @@ void CityProtectorsLogic::MoveGameObject(const GameObjectId id, const Mat4x4& ma
 	StrongGameObjectPtr pObject = MakeStrongPtr(GetGameObject(id));
 	if (pObject)
 	{
-		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>(TransformComponent::g_Name));
+		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>());
 		if (pTransformComponent && pTransformComponent->GetPosition().y < -25)
 		{
-			shared_ptr<Event_DestroyGameObject> pDestroyObjectEvent(CB_NEW Event_DestroyGameObject(id));
-			IEventManager::Get()->QueueEvent(pDestroyObjectEvent);
+			// physics moves objects while it walks its bodies, so the object is removed at the end of the update
+			QueueDestroyGameObject(id);
 		}
 	}
 }
@@ -61,8 +61,8 @@ void CityProtectorsLogic::ChangeState(BaseGameState newState)
 	{
 	case BaseGameState::WaitingForPlayers:
 	{
-		// only one local player allowed
-		CB_ASSERT(m_ExpectedPlayers == 1);
+		// only one local player allowed, a headless server has none
+		CB_ASSERT(m_ExpectedPlayers <= 1);
 
 		// add each local human players view
 		for (int i = 0; i < m_ExpectedPlayers; i++)
@@ -238,7 +238,7 @@ void CityProtectorsLogic::StartThrustDelegate(IEventPtr pEvent)
 	if (pObject)
 	{
 		// apply acceleration to the physics component of the object
-		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>());
 		if (pPhysicsComponent)
 		{
 			pPhysicsComponent->ApplyAcceleration(pCastEvent->GetAcceleration());
@@ -254,7 +254,7 @@ void CityProtectorsLogic::EndThrustDelegate(IEventPtr pEvent)
 	if (pObject)
 	{
 		// set the object's acceleration to 0
-		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>());
 		if (pPhysicsComponent)
 		{
 			pPhysicsComponent->RemoveAcceleration();
@@ -269,7 +269,7 @@ void CityProtectorsLogic::StartSteerDelegate(IEventPtr pEvent)
 	StrongGameObjectPtr pObject = MakeStrongPtr(GetGameObject(pCastEvent->GetObjectId()));
 	if (pObject)
 	{
-		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>());
 		if (pPhysicsComponent)
 		{
 			pPhysicsComponent->ApplyAngularAcceleration(pCastEvent->GetAcceleration());
@@ -284,7 +284,7 @@ void CityProtectorsLogic::EndSteerDelegate(IEventPtr pEvent)
 	StrongGameObjectPtr pObject = MakeStrongPtr(GetGameObject(pCastEvent->GetObjectId()));
 	if (pObject)
 	{
-		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+		shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pObject->GetComponent<PhysicsComponent>());
 		if (pPhysicsComponent)
 		{
 			pPhysicsComponent->RemoveAngularAcceleration();
@@ -330,6 +330,7 @@ void CityProtectorsLogic::RemoveAllDelegates()
 	{
 		// this is only added for remote clients. its added in BaseGameLogic::SetProxy()
 		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(this, &CityProtectorsLogic::RequestNewGameObjectDelegate), Event_RequestNewGameObject::sk_EventType);
+		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(this, &CityProtectorsLogic::RequestNewGameObjectsDelegate), Event_RequestNewGameObjects::sk_EventType);
 	}
 	pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(this, &CityProtectorsLogic::StartThrustDelegate), Event_StartThrust::sk_EventType);
 	pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(this, &CityProtectorsLogic::EndThrustDelegate), Event_EndThrust::sk_EventType);
@@ -351,6 +352,7 @@ void CityProtectorsLogic::CreateNetworkEventForwarder(const int socketId)
 	pGlobalEventManager->AddListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_NewGameObject::sk_EventType);
 	pGlobalEventManager->AddListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_MoveGameObject::sk_EventType);
 	pGlobalEventManager->AddListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObject::sk_EventType);
+	pGlobalEventManager->AddListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObjects::sk_EventType);
 	pGlobalEventManager->AddListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_NetworkPlayerObjectAssignment::sk_EventType);
 
 	// add the forwarder to the list of forwarders
@@ -374,6 +376,7 @@ void CityProtectorsLogic::DestroyAllNetworkEventForwarders()
 		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_NewGameObject::sk_EventType);
 		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_MoveGameObject::sk_EventType);
 		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObject::sk_EventType);
+		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObjects::sk_EventType);
 		pGlobalEventManager->RemoveListener(fastdelegate::MakeDelegate(pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_NetworkPlayerObjectAssignment::sk_EventType);
 
 		CB_SAFE_DELETE(pNetworkEventForwarder);
@@ -44,6 +44,17 @@ public:
 		in >> m_Id;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_FireWeapon(m_Id));
@@ -124,6 +135,19 @@ public:
 		in >> m_Acceleration;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+		out.WriteFloat(m_Acceleration);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		m_Acceleration = in.ReadFloat();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_StartThrust(m_Id, m_Acceleration));
@@ -220,6 +244,17 @@ public:
 		in >> m_Id;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_EndThrust(m_Id));
@@ -307,6 +342,19 @@ public:
 		in >> m_Acceleration;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+		out.WriteFloat(m_Acceleration);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		m_Acceleration = in.ReadFloat();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_StartSteer(m_Id, m_Acceleration));
@@ -403,6 +451,17 @@ public:
 		in >> m_Id;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_EndSteer(m_Id));
@@ -484,6 +543,17 @@ public:
 		in >> m_GameplayUIString;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteString(m_GameplayUIString);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_GameplayUIString = in.ReadString();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_GameplayUIUpdate(m_GameplayUIString));
@@ -549,6 +619,17 @@ public:
 		in >> m_Id;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const override
+	{
+		out.WriteUInt32(m_Id);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in) override
+	{
+		m_Id = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const override
 	{
 		return IEventPtr(CB_NEW Event_SetControlledObject(m_Id));
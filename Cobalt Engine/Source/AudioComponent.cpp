@@ -17,6 +17,8 @@
 
 const char* AudioComponent::g_Name = "AudioComponent";
 
+const ComponentId AudioComponent::g_Id = Component::GetIdFromName(AudioComponent::g_Name);
+
 AudioComponent::AudioComponent()
 {
 	m_AudioResource = "";
@@ -59,6 +61,10 @@ bool AudioComponent::Init(TiXmlElement* pData)
 
 void AudioComponent::PostInit()
 {
+	// a headless server has nobody to play sounds to
+	if (g_pApp->IsHeadless())
+		return;
+
 	HumanView* humanView = g_pApp->GetHumanView();
 	if (!humanView)
 	{
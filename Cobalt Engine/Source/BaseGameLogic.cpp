@@ -10,12 +10,15 @@
 
 #include "BaseGameLogic.h"
 #include "BaseSocketManager.h"
+#include "BinaryPacket.h"
 #include "EngineStd.h"
 #include "Events.h"
 #include "GameObjectFactory.h"
 #include "GameServerListenSocket.h"
 #include "LevelManager.h"
 #include "Logger.h"
+#include "NetSocket.h"
+#include "NetworkEventForwarder.h"
 #include "NetworkEvents.h"
 #include "PathingGraph.h"
 #include "Physics.h"
@@ -24,13 +27,22 @@
 #include "ResourceCache.h"
 #include "StringUtil.h"
 #include "templates.h"
+#include "TransformComponent.h"
 #include "XmlResource.h"
 
 BaseGameLogic::BaseGameLogic()
 {
 	m_LastObjectId = 0;
 	m_LifeTime = 0.0f;
-	m_pProcessManager = CB_NEW ProcessManager;
+	m_pProcessManager = CB_NEW ProcessManager(g_pApp->m_pJobSystem, "Logic");
+	if (g_pApp->m_Options.m_ProcessProfile)
+	{
+		m_pProcessManager->EnableProfiling(true);
+		m_pProcessManager->SetProfileDumpInterval(g_pApp->m_Options.m_ProcessProfileDumpInterval);
+		m_pProcessManager->SetProfileFrameBudget(g_pApp->m_Options.m_ProcessProfileFrameBudget);
+		if (!g_pApp->m_Options.m_ProcessProfileTrace.empty())
+			m_pProcessManager->SetProfileTraceFile(g_pApp->m_Options.m_ProcessProfileTrace + "_Logic.json");
+	}
 	m_Random.Randomize();
 	m_State = BaseGameState::Initializing;
 	m_Proxy = false;
@@ -120,6 +132,32 @@ RandomGenerator& BaseGameLogic::GetRNG()
 	return m_Random;
 }
 
+unsigned int BaseGameLogic::GetTransformChecksum() const
+{
+	// the objects are hashed one at a time and summed so the map's order does not matter
+	unsigned int checksum = 0;
+	for (auto it = m_Objects.begin(); it != m_Objects.end(); ++it)
+	{
+		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(it->second->GetComponent<TransformComponent>());
+		if (!pTransformComponent)
+			continue;
+
+		// FNV-1a over the id and the bits of the matrix
+		Mat4x4 transform = pTransformComponent->GetTransform();
+		unsigned int hash = 2166136261U;
+		hash = (hash ^ it->first) * 16777619U;
+		const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(&transform.m[0][0]);
+		for (size_t i = 0; i < sizeof(transform.m); ++i)
+		{
+			hash = (hash ^ pBytes[i]) * 16777619U;
+		}
+
+		checksum += hash;
+	}
+
+	return checksum;
+}
+
 void BaseGameLogic::AddView(shared_ptr<IGameView> pView, GameObjectId id)
 {
 	// add the view to the game view list and initialize it
@@ -176,6 +214,116 @@ const Mat4x4* initialTransform , const GameObjectId serversObjectId)
 	}
 }
 
+unsigned int BaseGameLogic::CreateGameObjects(const std::string& objectResource, TiXmlElement* overrides, const std::vector<Vec3>& positions,
+	std::vector<StrongGameObjectPtr>* pCreatedObjects, const std::vector<GameObjectId>* pServersObjectIds)
+{
+	CB_ASSERT(m_pObjectFactory);
+
+	if (!m_Proxy && pServersObjectIds)
+		return 0;
+
+	if (m_Proxy && (!pServersObjectIds || pServersObjectIds->size() != positions.size()))
+		return 0;
+
+	// the resource is looked up and parsed once for the whole batch
+	TiXmlElement* pRoot = m_pObjectFactory->GetTemplate(objectResource.c_str());
+	if (!pRoot)
+	{
+		CB_ERROR("Failed to create objects from resource: " + objectResource);
+		return 0;
+	}
+
+	m_Objects.reserve(m_Objects.size() + positions.size());
+	if (pCreatedObjects)
+	{
+		pCreatedObjects->reserve(pCreatedObjects->size() + positions.size());
+	}
+
+	bool broadcast = !m_Proxy && (m_State == BaseGameState::SpawningPlayersObjects || m_State == BaseGameState::Running);
+	std::vector<GameObjectId> createdIds;
+	std::vector<Vec3> createdPositions;
+	if (broadcast)
+	{
+		createdIds.reserve(positions.size());
+		createdPositions.reserve(positions.size());
+	}
+
+	unsigned int numCreated = 0;
+	Mat4x4 initialTransform;
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		initialTransform.BuildTranslation(positions[i]);
+		GameObjectId serversObjectId = pServersObjectIds ? (*pServersObjectIds)[i] : INVALID_GAMEOBJECT_ID;
+
+		StrongGameObjectPtr pObject = m_pObjectFactory->CreateGameObjectFromTemplate(pRoot, objectResource.c_str(), overrides, &initialTransform, serversObjectId);
+		if (!pObject)
+			continue;
+
+		m_Objects.insert(std::make_pair(pObject->GetId(), pObject));
+		if (pCreatedObjects)
+		{
+			pCreatedObjects->push_back(pObject);
+		}
+
+		if (broadcast)
+		{
+			createdIds.push_back(pObject->GetId());
+			createdPositions.push_back(positions[i]);
+		}
+
+		++numCreated;
+	}
+
+	if (broadcast && !createdIds.empty())
+	{
+		BroadcastNewGameObjects(objectResource, createdIds, createdPositions);
+	}
+
+	return numCreated;
+}
+
+void BaseGameLogic::BroadcastNewGameObjects(const std::string& objectResource, const std::vector<GameObjectId>& ids, const std::vector<Vec3>& positions)
+{
+	// split the objects into as few events as fit in a network packet. each batch is measured by serializing it the way the
+	// forwarders will, a text event is a different size than a binary one and the numbers in it vary in length
+	size_t batchSize = MAX_PACKET_SIZE;
+	size_t first = 0;
+	while (first < ids.size())
+	{
+		size_t count = batchSize;
+		if (count > ids.size() - first)
+			count = ids.size() - first;
+
+		shared_ptr<Event_RequestNewGameObjects> pNewObjects;
+		for (;;)
+		{
+			std::vector<GameObjectId> batchIds(ids.begin() + first, ids.begin() + first + count);
+			std::vector<Vec3> batchPositions(positions.begin() + first, positions.begin() + first + count);
+			pNewObjects.reset(CB_NEW Event_RequestNewGameObjects(objectResource, batchIds, batchPositions));
+
+			unsigned long packetSize = NetworkEventForwarder::CreateEventPacket(pNewObjects)->GetSize();
+			if (packetSize <= MAX_PACKET_SIZE)
+				break;
+
+			if (count == 1)
+			{
+				CB_ERROR("Object resource name is too long to send to clients: " + objectResource);
+				return;
+			}
+
+			// the objects are close to the same size, so shrink in proportion to the overflow
+			size_t fitCount = count * MAX_PACKET_SIZE / packetSize;
+			count = (fitCount > 0 && fitCount < count) ? fitCount : count - 1;
+		}
+
+		IEventManager::Get()->TriggerEvent(pNewObjects);
+		first += count;
+
+		// start the next batch one larger, in case this one was shrunk too far
+		batchSize = count + 1;
+	}
+}
+
 void BaseGameLogic::DestroyGameObject(const GameObjectId id)
 {
 	// trigger an event so that any systems resonding to the event can still
@@ -191,6 +339,42 @@ void BaseGameLogic::DestroyGameObject(const GameObjectId id)
 	}
 }
 
+void BaseGameLogic::QueueDestroyGameObject(const GameObjectId id)
+{
+	m_DestroyQueue.push_back(id);
+}
+
+void BaseGameLogic::QueueDestroyGameObjects(const std::vector<GameObjectId>& ids)
+{
+	m_DestroyQueue.insert(m_DestroyQueue.end(), ids.begin(), ids.end());
+}
+
+void BaseGameLogic::DestroyQueuedGameObjects()
+{
+	// take the queue, destroy event listeners may queue more objects for the next update
+	std::vector<GameObjectId> destroyQueue;
+	destroyQueue.swap(m_DestroyQueue);
+
+	for (auto it = destroyQueue.begin(); it != destroyQueue.end(); ++it)
+	{
+		// an object can be queued more than once, only the first one destroys it
+		auto findIt = m_Objects.find(*it);
+		if (findIt == m_Objects.end())
+			continue;
+
+		shared_ptr<Event_DestroyGameObject> pEvent(CB_NEW Event_DestroyGameObject(*it));
+		IEventManager::Get()->TriggerEvent(pEvent);
+
+		// the listeners may have destroyed it already
+		findIt = m_Objects.find(*it);
+		if (findIt != m_Objects.end())
+		{
+			findIt->second->Destroy();
+			m_Objects.erase(findIt);
+		}
+	}
+}
+
 void BaseGameLogic::ModifyGameObject(const GameObjectId id, TiXmlElement* overrides)
 {
 	CB_ASSERT(m_pObjectFactory);
@@ -315,6 +499,7 @@ void BaseGameLogic::SetProxy()
 {
 	m_Proxy = true;
 	IEventManager::Get()->AddListener(fastdelegate::MakeDelegate(this, &BaseGameLogic::RequestNewGameObjectDelegate), Event_RequestNewGameObject::sk_EventType);
+	IEventManager::Get()->AddListener(fastdelegate::MakeDelegate(this, &BaseGameLogic::RequestNewGameObjectsDelegate), Event_RequestNewGameObjects::sk_EventType);
 
 	m_pPhysics.reset(CreateNullPhysics());
 }
@@ -381,6 +566,8 @@ void BaseGameLogic::OnUpdate(float time, float deltaTime)
 	{
 		it->second->Update(deltaTime);
 	}
+
+	DestroyQueuedGameObjects();
 }
 
 void BaseGameLogic::ChangeState(BaseGameState newState)
@@ -388,14 +575,23 @@ void BaseGameLogic::ChangeState(BaseGameState newState)
 	// if changing to waiting for players
 	if (newState == BaseGameState::WaitingForPlayers)
 	{
-		// get rid of the main menu
-		m_GameViews.pop_front();
+		if (g_pApp->IsHeadless())
+		{
+			// a dedicated server has no main menu and no local player, everyone connects remotely
+			m_ExpectedPlayers = 0;
+			m_ExpectedRemotePlayers = g_pApp->m_Options.m_ExpectedPlayers;
+		}
+		else
+		{
+			// get rid of the main menu
+			m_GameViews.pop_front();
 
-		m_ExpectedPlayers = 1;
-		m_ExpectedRemotePlayers = g_pApp->m_Options.m_ExpectedPlayers - 1;
+			m_ExpectedPlayers = 1;
+			m_ExpectedRemotePlayers = g_pApp->m_Options.m_ExpectedPlayers - 1;
+		}
 		m_ExpectedAI = g_pApp->m_Options.m_NumAIs;
 
-		if (!g_pApp->m_Options.m_GameHost.empty())
+		if (!g_pApp->IsHeadless() && !g_pApp->m_Options.m_GameHost.empty())
 		{
 			SetProxy();
 			m_ExpectedAI = 0;
@@ -412,6 +608,15 @@ void BaseGameLogic::ChangeState(BaseGameState newState)
 			BaseSocketManager* pServer = CB_NEW BaseSocketManager();
 			if (!pServer->Init())
 			{
+				CB_SAFE_DELETE(pServer);
+				if (g_pApp->IsHeadless())
+				{
+					// nothing else a dedicated server can do
+					CB_ERROR("Could not start the game server");
+					g_pApp->AbortGame();
+					return;
+				}
+
 				// throw up main menu if could not init server
 				ChangeState(BaseGameState::MainMenu);
 				return;
@@ -422,6 +627,12 @@ void BaseGameLogic::ChangeState(BaseGameState newState)
 	}
 	else if (newState == BaseGameState::LoadingGameEnvironment)
 	{
+		// the object templates held for batch spawns belong to the level being left
+		if (m_pObjectFactory)
+		{
+			m_pObjectFactory->ReleaseTemplates();
+		}
+
 		m_State = newState;
 		if (!g_pApp->LoadGame())
 		{
@@ -468,8 +679,9 @@ void BaseGameLogic::AttachProcess(StrongProcessPtr pProcess)
 
 void BaseGameLogic::RequestDestroyGameObjectDelegate(IEventPtr pEvent)
 {
+	// requests can come in the middle of an update, so they wait for the sweep at the end of it
 	shared_ptr<Event_RequestDestroyGameObject> pCastEvent = static_pointer_cast<Event_RequestDestroyGameObject>(pEvent);
-	DestroyGameObject(pCastEvent->GetId());
+	QueueDestroyGameObject(pCastEvent->GetId());
 }
 
 GameObjectFactory* BaseGameLogic::CreateObjectFactory()
@@ -504,3 +716,21 @@ void BaseGameLogic::RequestNewGameObjectDelegate(IEventPtr pEvent)
 		IEventManager::Get()->QueueEvent(pNewObjectEvent);
 	}
 }
+
+void BaseGameLogic::RequestNewGameObjectsDelegate(IEventPtr pEvent)
+{
+	CB_ASSERT(m_Proxy);
+	if (!m_Proxy)
+		return;
+
+	// create the whole batch, then let the game know about each object
+	shared_ptr<Event_RequestNewGameObjects> pCastEvent = static_pointer_cast<Event_RequestNewGameObjects>(pEvent);
+	std::vector<StrongGameObjectPtr> createdObjects;
+	CreateGameObjects(pCastEvent->GetObjectResource(), nullptr, pCastEvent->GetPositions(), &createdObjects, &pCastEvent->GetServerObjectIds());
+
+	for (auto it = createdObjects.begin(); it != createdObjects.end(); ++it)
+	{
+		shared_ptr<Event_NewGameObject> pNewObjectEvent(CB_NEW Event_NewGameObject((*it)->GetId()));
+		IEventManager::Get()->QueueEvent(pNewObjectEvent);
+	}
+}
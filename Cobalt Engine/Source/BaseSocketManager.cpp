@@ -73,7 +73,7 @@ void BaseSocketManager::DoSelect(int pauseMicroSecs, bool handleInput)
 
 	// select will poll the sockets for input and output
 	selRet = select(maxdesc + 1, &inp_set, &out_set, &exc_set, &tv);
-	if (selRet = SOCKET_ERROR)
+	if (selRet == SOCKET_ERROR)
 	{
 		PrintError();
 		return;
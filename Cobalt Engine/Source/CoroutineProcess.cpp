@@ -0,0 +1,163 @@
+/*
+	CoroutineProcess.cpp
+*/
+
+#include "CoroutineProcess.h"
+#include "Logger.h"
+
+CoroutineProcess::CoroutineProcess()
+{
+	m_ResumePoint = 0;
+	m_AwaitedState = UNINITIALIZED;
+}
+
+CoroutineProcess::~CoroutineProcess()
+{
+	// waiting here would be too late, the derived object the job may be using is already gone
+	CB_ASSERT(!m_pAwaitedJob || m_pAwaitedJob->IsFinished());
+}
+
+void CoroutineProcess::OnUpdate(float deltaTime)
+{
+	// nothing to do until the job is finished
+	if (m_pAwaitedJob)
+	{
+		if (!m_pAwaitedJob->IsFinished())
+			return;
+
+		m_pAwaitedJob.reset();
+	}
+
+	if (m_pAwaitedProcess && !UpdateAwaitedProcess(deltaTime))
+		return;
+
+	Run(deltaTime);
+}
+
+void CoroutineProcess::OnFail()
+{
+	WaitForAwaitedJob();
+}
+
+void CoroutineProcess::OnAbort()
+{
+	// abort whatever the body was waiting on the same way the process manager would
+	if (m_pAwaitedProcess && m_pAwaitedProcess->IsAlive())
+	{
+		m_pAwaitedProcess->SetState(ABORTED);
+		m_pAwaitedProcess->OnAbort();
+		m_AwaitedState = ABORTED;
+	}
+
+	// releasing the process aborts any children it still had waiting
+	if (m_pAwaitedProcess)
+	{
+		m_pAwaitedProcess->OnRemove();
+		m_pAwaitedProcess.reset();
+	}
+
+	WaitForAwaitedJob();
+}
+
+void CoroutineProcess::OnRemove()
+{
+	// an owner clearing its processes removes this without aborting it, so let go of the awaited
+	// process the way the owner lets go of its own
+	if (m_pAwaitedProcess)
+	{
+		m_pAwaitedProcess->OnRemove();
+		m_pAwaitedProcess.reset();
+	}
+
+	WaitForAwaitedJob();
+}
+
+void CoroutineProcess::AwaitProcess(const StrongProcessPtr& pProcess)
+{
+	CB_ASSERT(pProcess && pProcess.get() != this);
+	CB_ASSERT(!m_pAwaitedProcess && !m_pAwaitedJob);
+
+	m_pAwaitedProcess = pProcess;
+	m_AwaitedState = UNINITIALIZED;
+}
+
+void CoroutineProcess::AwaitJob(const JobPtr& pJob)
+{
+	CB_ASSERT(pJob);
+	CB_ASSERT(!m_pAwaitedProcess && !m_pAwaitedJob);
+
+	m_pAwaitedJob = pJob;
+	JobSystem::Get()->Run(pJob);
+}
+
+bool CoroutineProcess::UpdateAwaitedProcess(float deltaTime)
+{
+	Process* pProcess = m_pAwaitedProcess.get();
+
+	// this process only gets updated once it is awake again, so the awaited process is too
+	if (pProcess->m_State == SLEEPING)
+	{
+		pProcess->m_State = RUNNING;
+		pProcess->OnWake();
+	}
+
+	if (pProcess->m_State == UNINITIALIZED)
+	{
+		pProcess->OnInit();
+	}
+
+	if (pProcess->m_State == RUNNING)
+	{
+		pProcess->OnUpdate(deltaTime);
+	}
+
+	// sleep along with the awaited process so neither is updated until it wakes
+	if (pProcess->m_State == SLEEPING)
+	{
+		if (pProcess->m_SleepTime >= 0.0f)
+			Sleep(pProcess->m_SleepTime);
+		else
+			SleepUntilEvent(pProcess->m_WakeEventType);
+		return false;
+	}
+
+	if (!pProcess->IsDead())
+		return false;
+
+	// run the exit method, a child of a successful process is awaited next
+	switch (pProcess->m_State)
+	{
+	case SUCCEEDED:
+		{
+			pProcess->OnSuccess();
+			StrongProcessPtr pChild = pProcess->RemoveChild();
+			if (pChild)
+			{
+				pProcess->OnRemove();
+				m_pAwaitedProcess = pChild;
+				return false;
+			}
+			break;
+		}
+	case FAILED:
+		pProcess->OnFail();
+		break;
+	case ABORTED:
+		pProcess->OnAbort();
+		break;
+	}
+
+	m_AwaitedState = pProcess->m_State;
+	pProcess->OnRemove();
+	m_pAwaitedProcess.reset();
+	return true;
+}
+
+void CoroutineProcess::WaitForAwaitedJob()
+{
+	if (m_pAwaitedJob)
+	{
+		JobSystem::Get()->Wait(m_pAwaitedJob);
+		m_pAwaitedJob.reset();
+	}
+}
@@ -26,6 +26,9 @@ bool SdkMeshResourceLoader::LoadResource(char* rawBuffer, unsigned int rawSize,
 		// load the mesh
 		if (SUCCEEDED(extra->m_Mesh11.Create(DXUTGetD3D11Device(), (BYTE*)rawBuffer, (UINT)rawSize, true)))
 		{
+			// the mesh copies the static data and uploads the vertices and indices, the buffers are not
+			// exposed so count each as the size of the file
+			extra->m_MemorySize = rawSize * 2;
 			handle->SetExtra(shared_ptr<D3DSdkMeshResourceExtraData11>(extra));
 		}
 
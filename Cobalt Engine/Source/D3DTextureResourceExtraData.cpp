@@ -9,6 +9,18 @@
 
 #include "EngineStd.h"
 
+/// Return the bytes in one mip level, block compressed formats store 4x4 blocks
+static unsigned int GetMipLevelSize(unsigned int width, unsigned int height, unsigned int bitsPerPixel, bool blockCompressed)
+{
+	if (blockCompressed)
+	{
+		width = (width + 3) & ~3u;
+		height = (height + 3) & ~3u;
+	}
+
+	return (width * height * bitsPerPixel) / 8;
+}
+
 //====================================================
 //	D3D9 extra data
 //====================================================
@@ -27,6 +39,68 @@ std::string D3DTextureResourceExtraData9::ToStr()
 	return "D3DTextureResourceExtraData9";
 }
 
+unsigned int D3DTextureResourceExtraData9::GetMemorySize()
+{
+	if (!m_pTexture)
+		return 0;
+
+	unsigned int size = 0;
+	DWORD numLevels = m_pTexture->GetLevelCount();
+	for (DWORD level = 0; level < numLevels; ++level)
+	{
+		D3DSURFACE_DESC desc;
+		if (FAILED(m_pTexture->GetLevelDesc(level, &desc)))
+			continue;
+
+		unsigned int bitsPerPixel = 32;
+		bool blockCompressed = false;
+		switch (desc.Format)
+		{
+		case D3DFMT_DXT1:
+			bitsPerPixel = 4;
+			blockCompressed = true;
+			break;
+
+		case D3DFMT_DXT2:
+		case D3DFMT_DXT3:
+		case D3DFMT_DXT4:
+		case D3DFMT_DXT5:
+			bitsPerPixel = 8;
+			blockCompressed = true;
+			break;
+
+		case D3DFMT_R5G6B5:
+		case D3DFMT_A1R5G5B5:
+		case D3DFMT_X1R5G5B5:
+		case D3DFMT_A4R4G4B4:
+		case D3DFMT_L16:
+			bitsPerPixel = 16;
+			break;
+
+		case D3DFMT_A8:
+		case D3DFMT_L8:
+			bitsPerPixel = 8;
+			break;
+
+		case D3DFMT_A16B16G16R16:
+		case D3DFMT_A16B16G16R16F:
+			bitsPerPixel = 64;
+			break;
+
+		case D3DFMT_A32B32G32R32F:
+			bitsPerPixel = 128;
+			break;
+
+		default:
+			break;
+		}
+
+		size += GetMipLevelSize(desc.Width, desc.Height, bitsPerPixel, blockCompressed);
+	}
+
+	return size;
+}
+
 const LPDIRECT3DTEXTURE9 D3DTextureResourceExtraData9::GetTexture()
 {
 	return m_pTexture;
@@ -52,6 +126,100 @@ std::string D3DTextureResourceExtraData11::ToStr()
 	return "D3DTextureResourceExtraData11";
 }
 
+unsigned int D3DTextureResourceExtraData11::GetMemorySize()
+{
+	if (!m_pTexture)
+		return 0;
+
+	// the view only knows its resource, the size comes from the texture's description
+	ID3D11Resource* pResource = nullptr;
+	m_pTexture->GetResource(&pResource);
+	if (!pResource)
+		return 0;
+
+	ID3D11Texture2D* pTexture2D = nullptr;
+	HRESULT hr = pResource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&pTexture2D);
+	CB_COM_RELEASE(pResource);
+	if (FAILED(hr) || !pTexture2D)
+		return 0;
+
+	D3D11_TEXTURE2D_DESC desc;
+	pTexture2D->GetDesc(&desc);
+	CB_COM_RELEASE(pTexture2D);
+
+	unsigned int bitsPerPixel = 32;
+	bool blockCompressed = false;
+	switch (desc.Format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		bitsPerPixel = 4;
+		blockCompressed = true;
+		break;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		bitsPerPixel = 8;
+		blockCompressed = true;
+		break;
+
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_A8_UNORM:
+		bitsPerPixel = 8;
+		break;
+
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UNORM:
+		bitsPerPixel = 16;
+		break;
+
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R32G32_FLOAT:
+		bitsPerPixel = 64;
+		break;
+
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		bitsPerPixel = 128;
+		break;
+
+	default:
+		break;
+	}
+
+	unsigned int size = 0;
+	unsigned int width = desc.Width;
+	unsigned int height = desc.Height;
+	for (UINT level = 0; level < desc.MipLevels; ++level)
+	{
+		size += GetMipLevelSize(width, height, bitsPerPixel, blockCompressed);
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	return size * desc.ArraySize;
+}
+
 ID3D11ShaderResourceView** D3DTextureResourceExtraData11::GetTexture()
 {
 	return &m_pTexture;
@@ -0,0 +1,387 @@
+/*
+	EventJournal.cpp
+*/
+
+#include <fstream>
+#include <iterator>
+
+#include "BaseGameLogic.h"
+#include "EngineStd.h"
+#include "EventJournal.h"
+#include "EventManager.h"
+#include "Logger.h"
+#include "StringUtil.h"
+
+// identifies a journal file, "CBJ1" in little endian
+const unsigned long EVENTJOURNAL_MAGIC = 0x314a4243;
+
+// bumped whenever the record layout changes
+const unsigned short EVENTJOURNAL_VERSION = 1;
+
+// largest serialized event a record can hold
+const size_t EVENTJOURNAL_MAX_EVENT_SIZE = 0xffff;
+
+EventJournal::EventJournal() :
+	m_ReplayStream(nullptr, 0)
+{
+	m_FrameNumber = 0;
+	m_pFile = nullptr;
+	m_pRecordLogic = nullptr;
+	m_pReplayLogic = nullptr;
+	m_HasNextFrame = false;
+	m_NextFrameTime = 0.0f;
+	m_NextFrameDeltaTime = 0.0f;
+	m_Injecting = false;
+	m_NumChecksumMismatches = 0;
+}
+
+EventJournal::~EventJournal()
+{
+	// the logic may already be gone, so just make sure everything recorded makes it to disk
+	CloseFile();
+}
+
+bool EventJournal::StartRecording(const std::string& fileName, BaseGameLogic* pLogic)
+{
+	CB_ASSERT(pLogic);
+	if (IsRecording() || IsReplaying())
+	{
+		CB_ERROR("Event journal is already running");
+		return false;
+	}
+
+	fopen_s(&m_pFile, fileName.c_str(), "wb");
+	if (!m_pFile)
+	{
+		CB_ERROR("Failed to open event journal " + fileName);
+		return false;
+	}
+
+	// restart the random sequence from its seed so the replay can do the same
+	unsigned int seed = pLogic->GetRNG().GetRandomSeed();
+	pLogic->GetRNG().SetRandomSeed(seed);
+
+	m_pRecordLogic = pLogic;
+	m_FrameNumber = 0;
+	m_Buffer.Clear();
+	m_Buffer.WriteUInt32(EVENTJOURNAL_MAGIC);
+	m_Buffer.WriteUInt16(EVENTJOURNAL_VERSION);
+	m_Buffer.WriteUInt32(seed);
+
+	CB_LOG("Journal", "Recording events to " + fileName);
+	return true;
+}
+
+bool EventJournal::StartReplay(const std::string& fileName, BaseGameLogic* pLogic)
+{
+	CB_ASSERT(pLogic);
+	if (IsRecording() || IsReplaying())
+	{
+		CB_ERROR("Event journal is already running");
+		return false;
+	}
+
+	std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		CB_ERROR("Failed to open event journal " + fileName);
+		return false;
+	}
+	m_ReplayData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	m_ReplayStream = EventReadStream(m_ReplayData.empty() ? nullptr : &m_ReplayData[0], m_ReplayData.size());
+
+	unsigned long magic = m_ReplayStream.ReadUInt32();
+	unsigned short version = m_ReplayStream.ReadUInt16();
+	unsigned int seed = m_ReplayStream.ReadUInt32();
+	if (!m_ReplayStream.IsValid() || magic != EVENTJOURNAL_MAGIC || version != EVENTJOURNAL_VERSION)
+	{
+		CB_ERROR(fileName + " is not a supported event journal");
+		m_ReplayData.clear();
+		return false;
+	}
+
+	pLogic->GetRNG().SetRandomSeed(seed);
+
+	m_pReplayLogic = pLogic;
+	m_FrameNumber = 0;
+	m_NumChecksumMismatches = 0;
+	m_HasNextFrame = false;
+
+	// events recorded before the first frame are sent right away
+	if (!ReadRecords())
+	{
+		Stop();
+		return false;
+	}
+	InjectPendingEvents();
+
+	CB_LOG("Journal", "Replaying events from " + fileName);
+	return true;
+}
+
+void EventJournal::Stop()
+{
+	if (IsRecording())
+	{
+		WriteChecksum();
+		CloseFile();
+		m_pRecordLogic = nullptr;
+		CB_LOG("Journal", "Recorded " + ToStr(m_FrameNumber) + " frames");
+	}
+
+	if (IsReplaying())
+	{
+		m_pReplayLogic = nullptr;
+		m_ReplayStream = EventReadStream(nullptr, 0);
+		m_ReplayData.clear();
+		m_PendingEvents.clear();
+		m_PendingChecksums.clear();
+		m_HasNextFrame = false;
+
+		if (m_NumChecksumMismatches == 0)
+		{
+			CB_LOG("Journal", "Replay of " + ToStr(m_FrameNumber) + " frames finished, every checksum matched");
+		}
+		else
+		{
+			CB_WARNING("Replay finished with " + ToStr(m_NumChecksumMismatches) + " checksum mismatches");
+		}
+	}
+}
+
+bool EventJournal::ReplayAll(unsigned long maxMillis)
+{
+	CB_ASSERT(IsReplaying());
+
+	BaseGameLogic* pLogic = m_pReplayLogic;
+	float time = 0.0f;
+	float deltaTime = 0.0f;
+	while (BeginFrame(time, deltaTime))
+	{
+		IEventManager::Get()->Update(maxMillis);
+		pLogic->OnUpdate(time, deltaTime);
+		EndFrame();
+	}
+
+	return m_NumChecksumMismatches == 0;
+}
+
+bool EventJournal::BeginFrame(float& time, float& deltaTime)
+{
+	if (IsRecording())
+	{
+		++m_FrameNumber;
+		m_Buffer.WriteUInt8(JournalRecord_Frame);
+		m_Buffer.WriteFloat(time);
+		m_Buffer.WriteFloat(deltaTime);
+	}
+	else if (IsReplaying())
+	{
+		if (!m_HasNextFrame)
+		{
+			Stop();
+			return false;
+		}
+
+		++m_FrameNumber;
+		time = m_NextFrameTime;
+		deltaTime = m_NextFrameDeltaTime;
+		m_HasNextFrame = false;
+
+		if (!ReadRecords())
+		{
+			Stop();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void EventJournal::EndFrame()
+{
+	if (IsRecording())
+	{
+		if (m_FrameNumber % EVENTJOURNAL_CHECKSUM_INTERVAL == 0)
+		{
+			WriteChecksum();
+		}
+	}
+	else if (IsReplaying())
+	{
+		// triggered events have already been applied when the recorded checksum was taken
+		InjectPendingEvents();
+
+		for (auto it = m_PendingChecksums.begin(); it != m_PendingChecksums.end(); ++it)
+		{
+			VerifyChecksum(*it);
+		}
+		m_PendingChecksums.clear();
+	}
+}
+
+bool EventJournal::OnEvent(const IEventPtr& pEvent, EventJournalRecord record)
+{
+	if (m_pFile)
+	{
+		if (m_IgnoredTypes.find(pEvent->GetEventType()) == m_IgnoredTypes.end())
+		{
+			WriteEvent(pEvent, record);
+		}
+		return true;
+	}
+
+	if (m_pReplayLogic)
+	{
+		// live events are dropped in favor of the recorded copies
+		return m_Injecting || m_IgnoredTypes.find(pEvent->GetEventType()) != m_IgnoredTypes.end();
+	}
+
+	return true;
+}
+
+void EventJournal::WriteEvent(const IEventPtr& pEvent, EventJournalRecord record)
+{
+	m_EventData.Clear();
+	pEvent->SerializeBinary(m_EventData);
+	if (m_EventData.GetSize() > EVENTJOURNAL_MAX_EVENT_SIZE)
+	{
+		CB_WARNING(std::string(pEvent->GetName()) + " is too large to record in the event journal");
+		return;
+	}
+
+	m_Buffer.WriteUInt8((unsigned char)record);
+	m_Buffer.WriteUInt32(pEvent->GetEventType());
+	m_Buffer.WriteUInt16((unsigned short)m_EventData.GetSize());
+	m_Buffer.WriteBytes(m_EventData.GetData(), m_EventData.GetSize());
+
+	if (m_Buffer.GetSize() >= EVENTJOURNAL_FLUSH_SIZE)
+	{
+		Flush();
+	}
+}
+
+void EventJournal::WriteChecksum()
+{
+	m_Buffer.WriteUInt8(JournalRecord_Checksum);
+	m_Buffer.WriteUInt32(m_FrameNumber);
+	m_Buffer.WriteUInt32(m_pRecordLogic->GetTransformChecksum());
+}
+
+void EventJournal::Flush()
+{
+	if (m_pFile && m_Buffer.GetSize() > 0)
+	{
+		fwrite(m_Buffer.GetData(), 1, m_Buffer.GetSize(), m_pFile);
+	}
+	m_Buffer.Clear();
+}
+
+void EventJournal::CloseFile()
+{
+	if (m_pFile)
+	{
+		Flush();
+		fclose(m_pFile);
+		m_pFile = nullptr;
+	}
+}
+
+bool EventJournal::ReadRecords()
+{
+	while (m_ReplayStream.GetBytesRemaining() > 0)
+	{
+		unsigned char record = m_ReplayStream.ReadUInt8();
+		if (record == JournalRecord_Frame)
+		{
+			// this is the start of the next frame, stop here
+			m_NextFrameTime = m_ReplayStream.ReadFloat();
+			m_NextFrameDeltaTime = m_ReplayStream.ReadFloat();
+			m_HasNextFrame = m_ReplayStream.IsValid();
+			break;
+		}
+		else if (record == JournalRecord_Checksum)
+		{
+			JournalChecksum checksum;
+			checksum.m_Frame = m_ReplayStream.ReadUInt32();
+			checksum.m_Checksum = m_ReplayStream.ReadUInt32();
+			m_PendingChecksums.push_back(checksum);
+		}
+		else if (record == JournalRecord_QueueEvent || record == JournalRecord_TriggerEvent || record == JournalRecord_ThreadSafeEvent)
+		{
+			EventType eventType = m_ReplayStream.ReadUInt32();
+			unsigned short size = m_ReplayStream.ReadUInt16();
+			const char* pData = m_ReplayStream.ReadBytes(size);
+			if (!pData)
+				break;
+
+			IEventPtr pEvent(CREATE_EVENT(eventType));
+			if (!pEvent)
+			{
+				CB_WARNING("Skipping unregistered event type " + ToStr(eventType) + " in event journal");
+				continue;
+			}
+
+			EventReadStream eventData(pData, size);
+			if (!pEvent->DeserializeBinary(eventData))
+			{
+				CB_ERROR("Malformed " + std::string(pEvent->GetName()) + " in event journal");
+				return false;
+			}
+
+			// thread safe events were pulled in at the start of the event manager update, so they go in now
+			if (record == JournalRecord_ThreadSafeEvent)
+			{
+				m_Injecting = true;
+				IEventManager::Get()->QueueEvent(pEvent);
+				m_Injecting = false;
+			}
+			else
+			{
+				m_PendingEvents.push_back(std::make_pair((EventJournalRecord)record, pEvent));
+			}
+		}
+		else
+		{
+			CB_ERROR("Unknown record in event journal");
+			return false;
+		}
+	}
+
+	if (!m_ReplayStream.IsValid())
+	{
+		CB_ERROR("Event journal is truncated");
+		return false;
+	}
+
+	return true;
+}
+
+void EventJournal::InjectPendingEvents()
+{
+	m_Injecting = true;
+	for (auto it = m_PendingEvents.begin(); it != m_PendingEvents.end(); ++it)
+	{
+		if (it->first == JournalRecord_TriggerEvent)
+		{
+			IEventManager::Get()->TriggerEvent(it->second);
+		}
+		else
+		{
+			IEventManager::Get()->QueueEvent(it->second);
+		}
+	}
+	m_Injecting = false;
+	m_PendingEvents.clear();
+}
+
+void EventJournal::VerifyChecksum(const JournalChecksum& checksum)
+{
+	unsigned long currentChecksum = m_pReplayLogic->GetTransformChecksum();
+	if (currentChecksum != checksum.m_Checksum)
+	{
+		++m_NumChecksumMismatches;
+		CB_WARNING("Replay desync at frame " + ToStr(checksum.m_Frame) + ", transform checksum " +
+			ToStr(currentChecksum) + " expected " + ToStr(checksum.m_Checksum));
+	}
+}
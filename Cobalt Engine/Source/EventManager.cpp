@@ -5,9 +5,15 @@
 	by Mike McShaffry and David Graham
 */
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include "EventManager.h"
 
 #include "EngineStd.h"
+#include "EventJournal.h"
+#include "HighResClock.h"
 #include "Logger.h"
 #include "StringUtil.h"
 
@@ -48,20 +54,31 @@ IEventManager* IEventManager::Get()
 //	EventManager definitions
 //====================================================
 EventManager::EventManager(const char* pName, bool setAsGlobal) :
-IEventManager(pName, setAsGlobal)
+IEventManager(pName, setAsGlobal),
+m_RealTimeEventQueue(EVENTMANAGER_REALTIME_QUEUE_SIZE)
 {
 	m_ActiveQueue = 0;
+	m_LastRealTimeOverflowCount = 0;
+	m_DispatchDepth = 0;
+	m_NumCoalescedEvents = 0;
+	m_ConcurrentEventNS = 0;
+	m_pJobSystem = nullptr;
+	m_pJournal = nullptr;
+	m_StatsEnabled = false;
+	m_StatsDumpIntervalMillis = 0;
+	m_LastStatsDumpNS = 0;
 }
 
 EventManager::~EventManager()
 { }
 
-bool EventManager::AddListener(const EventListenerDelegate& eventDelegate, const EventType& type)
+bool EventManager::AddListener(const EventListenerDelegate& eventDelegate, const EventType& type, bool concurrentSafe)
 {
 	CB_LOG("Events", "Attempting to add delegate listener for event type: " + ToStr(type, 16));
 
 	// get the correct list from the map
-	EventListenerList& listeners = m_EventListeners[type];
+	EventListenerTable& table = m_EventListeners[type];
+	EventListenerList& listeners = table.m_Listeners;
 
 	// make sure the listener is not already registered
 	for (auto it = listeners.begin(); it != listeners.end(); ++it)
@@ -75,6 +92,9 @@ bool EventManager::AddListener(const EventListenerDelegate& eventDelegate, const
 
 	// add the listener to the list
 	listeners.push_back(eventDelegate);
+	table.m_ConcurrentSafe.push_back(concurrentSafe ? 1 : 0);
+	if (!concurrentSafe)
+		++table.m_NumSerialListeners;
 	CB_LOG("Events", "Successfully added delegate listener for event type: " + ToStr(type, 16));
 	
 	return true;
@@ -90,13 +110,27 @@ bool EventManager::RemoveListener(const EventListenerDelegate& eventDelegate, co
 	if (findIt != m_EventListeners.end())
 	{
 		// get the list of listeners for this event type
-		EventListenerList& listeners = findIt->second;
-		for (auto it = listeners.begin(); it != listeners.end(); ++it)
+		EventListenerTable& table = findIt->second;
+		EventListenerList& listeners = table.m_Listeners;
+		for (size_t i = 0; i < listeners.size(); ++i)
 		{
 			// if the delegate listener is found, remove it
-			if (eventDelegate == (*it))
+			if (eventDelegate == listeners[i])
 			{
-				listeners.erase(it);
+				if (!table.m_ConcurrentSafe[i])
+					--table.m_NumSerialListeners;
+
+				if (m_DispatchDepth == 0)
+				{
+					listeners.erase(listeners.begin() + i);
+					table.m_ConcurrentSafe.erase(table.m_ConcurrentSafe.begin() + i);
+				}
+				else
+				{
+					// an event is being dispatched to this array, clear the slot and compact it later
+					listeners[i].clear();
+					m_PendingCompaction.push_back(type);
+				}
 				CB_LOG("Events", "Successfully removed delegate listener from event type: " + ToStr(type, 16));
 				success = true;
 				// break because there cannot be duplicate delegates for an event type
@@ -113,19 +147,44 @@ bool EventManager::TriggerEvent(const IEventPtr& pEvent) const
 	CB_LOG("Events", "Attempting to trigger event " + std::string(pEvent->GetName()));
 	bool processed = false;
 
+	// the journal records the event, or drops it during a replay
+	if (m_pJournal && !m_pJournal->OnEvent(pEvent, JournalRecord_TriggerEvent))
+		return false;
+
+	EventTypeStats* pStats = nullptr;
+	unsigned long long dispatchStartNS = 0;
+	if (m_StatsEnabled)
+	{
+		pStats = &GetStatsForEvent(pEvent);
+		++pStats->m_NumTriggered;
+		dispatchStartNS = HighResClock::GetNanoseconds();
+	}
+
 	// iterate the map looking for this event type
 	auto findIt = m_EventListeners.find(pEvent->GetEventType());
 	if (findIt != m_EventListeners.end())
 	{
-		// iterate the listener list and send the event to each listener
-		const EventListenerList& listeners = findIt->second;
-		for (EventListenerList::const_iterator it = listeners.begin(); it != listeners.end(); ++it)
+		// iterate the listener array and send the event to each listener. index rather than
+		// iterate since a listener may add to this array and cause it to reallocate
+		const EventListenerList& listeners = findIt->second.m_Listeners;
+		const size_t numListeners = listeners.size();
+		++m_DispatchDepth;
+		for (size_t i = 0; i < numListeners; ++i)
 		{
-			EventListenerDelegate listener = (*it);
+			// skip listeners that were removed during this dispatch
+			if (listeners[i].empty())
+				continue;
+
 			CB_LOG("Events", "Sending event " + std::string(pEvent->GetName()) + " to delegate listener."); 
-			listener(pEvent);
+			listeners[i](pEvent);
 			processed = true;
 		}
+		--m_DispatchDepth;
+	}
+
+	if (pStats)
+	{
+		pStats->m_ListenerTimeNS += HighResClock::GetNanoseconds() - dispatchStartNS;
 	}
 
 	return processed;
@@ -133,26 +192,69 @@ bool EventManager::TriggerEvent(const IEventPtr& pEvent) const
 
 bool EventManager::QueueEvent(const IEventPtr& pEvent)
 {
-	CB_ASSERT(m_ActiveQueue >= 0);
-	CB_ASSERT(m_ActiveQueue < EVENTMANAGER_NUM_QUEUES);
-
 	if (!pEvent)
 	{
 		CB_ERROR("Invalid Event");
 		return false;
 	}
+
+	// the journal records the event, or drops it during a replay
+	if (m_pJournal && !m_pJournal->OnEvent(pEvent, JournalRecord_QueueEvent))
+		return false;
+
+	return EnqueueEvent(pEvent);
+}
+
+bool EventManager::EnqueueEvent(const IEventPtr& pEvent)
+{
+	CB_ASSERT(m_ActiveQueue >= 0);
+	CB_ASSERT(m_ActiveQueue < EVENTMANAGER_NUM_QUEUES);
+
 	CB_LOG("Events", "Attempting to queue event: " + std::string(pEvent->GetName()));
 
 	// make sure there are listeners for this event
 	auto findIt = m_EventListeners.find(pEvent->GetEventType());
 	if (findIt != m_EventListeners.end())
 	{
-		m_Queues[m_ActiveQueue].push_back(pEvent);
+		EventQueue& queue = m_Queues[m_ActiveQueue][GetEventLane(pEvent->GetEventType())];
+
+		if (m_StatsEnabled)
+		{
+			++GetStatsForEvent(pEvent).m_NumQueued;
+		}
+
+		// if this type coalesces, replace the event with the same key that is still waiting
+		auto policyIt = m_CoalescePolicies.find(pEvent->GetEventType());
+		if (policyIt != m_CoalescePolicies.end())
+		{
+			unsigned long long key = MakeCoalesceKey(pEvent->GetEventType(), policyIt->second(pEvent));
+			EventCoalesceIndex& index = m_CoalesceIndex[m_ActiveQueue];
+			auto indexIt = index.find(key);
+			if (indexIt != index.end())
+			{
+				*(indexIt->second) = pEvent;
+				++m_NumCoalescedEvents;
+				CB_LOG("Events", "Coalesced event: " + std::string(pEvent->GetName()));
+				return true;
+			}
+
+			queue.push_back(pEvent);
+			index[key] = std::prev(queue.end());
+			CB_LOG("Events", "Successfully queued event: " + std::string(pEvent->GetName()));
+			return true;
+		}
+
+		queue.push_back(pEvent);
 		CB_LOG("Events", "Successfully queued event: " + std::string(pEvent->GetName()));
 		return true;
 	}
 	else
 	{
+		if (m_StatsEnabled)
+		{
+			++GetStatsForEvent(pEvent).m_NumDropped;
+		}
+
 		CB_LOG("Events", "No listeners for event: " + std::string(pEvent->GetName()));
 		return false;
 	}
@@ -160,8 +262,11 @@ bool EventManager::QueueEvent(const IEventPtr& pEvent)
 
 bool EventManager::ThreadSafeQueueEvent(const IEventPtr& pEvent)
 {
-	m_RealTimeEventQueue.push(pEvent);
-	return true;
+	if (!pEvent)
+		return false;
+
+	// lock free push, this fails if the consumer has fallen a full ring behind
+	return m_RealTimeEventQueue.Push(pEvent);
 }
 
 bool EventManager::AbortEvent(const EventType& type, bool allOfType)
@@ -174,22 +279,35 @@ bool EventManager::AbortEvent(const EventType& type, bool allOfType)
 	EventListenerMap::iterator findIt = m_EventListeners.find(type);
 	if (findIt != m_EventListeners.end())
 	{
-		// get the active event queue
-		EventQueue& queue = m_Queues[m_ActiveQueue];
-		auto it = queue.begin();
-		while (it != queue.end())
+		// search each lane of the active event queue in priority order
+		for (int lane = 0; lane < EventLane_Count; ++lane)
 		{
-			auto thisIt = it;
-			++it;
-			// remove the first occurrence of this event type from the queue,
-			// if allOfType is true, remove all occurrences
-			if ((*thisIt)->GetEventType() == type)
+			EventQueue& queue = m_Queues[m_ActiveQueue][lane];
+			auto it = queue.begin();
+			while (it != queue.end())
 			{
-				queue.erase(thisIt);
-				success = true;
-
-				if (!allOfType)
-					break;
+				auto thisIt = it;
+				++it;
+				// remove the first occurrence of this event type from the queue,
+				// if allOfType is true, remove all occurrences
+				if ((*thisIt)->GetEventType() == type)
+				{
+					// drop the event from the coalesce index if it was the one indexed for its key
+					auto policyIt = m_CoalescePolicies.find(type);
+					if (policyIt != m_CoalescePolicies.end())
+					{
+						EventCoalesceIndex& index = m_CoalesceIndex[m_ActiveQueue];
+						auto indexIt = index.find(MakeCoalesceKey(type, policyIt->second(*thisIt)));
+						if (indexIt != index.end() && indexIt->second == thisIt)
+							index.erase(indexIt);
+					}
+
+					queue.erase(thisIt);
+					success = true;
+
+					if (!allOfType)
+						return success;
+				}
 			}
 		}
 	}
@@ -199,79 +317,363 @@ bool EventManager::AbortEvent(const EventType& type, bool allOfType)
 
 bool EventManager::Update(unsigned long maxMillis)
 {
-	unsigned long currMS = GetTickCount();
-	// set the max milliseconds to process events
-	unsigned long maxMS = (maxMillis == IEventManager::kINFINITE) ? IEventManager::kINFINITE : currMS + maxMillis;
+	// set the deadline to stop processing events
+	unsigned long long currNS = HighResClock::GetNanoseconds();
+	unsigned long long deadlineNS = (maxMillis == IEventManager::kINFINITE) ? 0 : currNS + maxMillis * NANOSECONDS_PER_MILLISECOND;
+
+	// dump the traffic counters if it is time
+	if (m_StatsEnabled && m_StatsDumpIntervalMillis != 0 && currNS - m_LastStatsDumpNS >= m_StatsDumpIntervalMillis * NANOSECONDS_PER_MILLISECOND)
+	{
+		DumpStats();
+		m_LastStatsDumpNS = currNS;
+	}
 
-	// handle events from other threads
-	IEventPtr pRealtimeEvent;
-	while (m_RealTimeEventQueue.try_pop(pRealtimeEvent))
+	// clean up listeners that were removed while events were being dispatched
+	CompactListeners();
+
+	// handle events from other threads, drain everything that has been published so far in one batch
+	m_RealTimeEventQueue.Drain([this](const IEventPtr& pRealtimeEvent)
 	{
-		QueueEvent(pRealtimeEvent);
-		currMS = GetTickCount();
+		if (!m_pJournal || m_pJournal->OnEvent(pRealtimeEvent, JournalRecord_ThreadSafeEvent))
+			EnqueueEvent(pRealtimeEvent);
+	});
 
-		if (maxMillis != IEventManager::kINFINITE)
+	if (maxMillis != IEventManager::kINFINITE)
+	{
+		if (HighResClock::GetNanoseconds() >= deadlineNS)
 		{
-			if (currMS >= maxMS)
-			{
-				CB_ERROR("Too many real time processes hitting the event manager");
-			}
+			CB_ERROR("Too many real time processes hitting the event manager");
 		}
 	}
 
+	// report any events that other threads dropped because the ring was full
+	unsigned long overflowCount = m_RealTimeEventQueue.GetOverflowCount();
+	if (overflowCount != m_LastRealTimeOverflowCount)
+	{
+		CB_WARNING("Real time event queue overflowed, dropped " + ToStr(overflowCount - m_LastRealTimeOverflowCount) + " events");
+		m_LastRealTimeOverflowCount = overflowCount;
+	}
+
 	// swap active queues and clear the new active after the swap
 	int queueToProcess = m_ActiveQueue;
 	m_ActiveQueue = (m_ActiveQueue + 1) % EVENTMANAGER_NUM_QUEUES;
-	m_Queues[m_ActiveQueue].clear();
+	for (int lane = 0; lane < EventLane_Count; ++lane)
+	{
+		m_Queues[m_ActiveQueue][lane].clear();
+	}
 
-	CB_LOG("EventLoop", "Processing Event Queue " + ToStr(queueToProcess) + "; " + ToStr((unsigned long)m_Queues[queueToProcess].size()) + " events to process");
+	// nothing else can be queued to the queue being processed so its coalesce index is no longer needed
+	m_CoalesceIndex[queueToProcess].clear();
+	m_CoalesceIndex[m_ActiveQueue].clear();
 
-	// process the queue of events
-	while (!m_Queues[queueToProcess].empty())
-	{
-		// process the first event and pop it
-		IEventPtr pEvent = m_Queues[queueToProcess].front();
-		m_Queues[queueToProcess].pop_front();
-		CB_LOG("EventLoop", "\t\tProcessing Event " + std::string(pEvent->GetName()));
+	memset(&m_LastUpdateReport, 0, sizeof(m_LastUpdateReport));
+	bool timeRanOut = false;
 
-		const EventType& eventType = pEvent->GetEventType();
+	// process each lane of the queue in priority order
+	for (int lane = 0; lane < EventLane_Count && !timeRanOut; ++lane)
+	{
+		EventQueue& queue = m_Queues[queueToProcess][lane];
+		CB_LOG("EventLoop", "Processing Event Queue " + ToStr(queueToProcess) + " lane " + ToStr(lane) + "; " + ToStr((unsigned long)queue.size()) + " events to process");
 
-		// find all the listeners registered for this event in the map
-		auto findIt = m_EventListeners.find(eventType);
-		if (findIt != m_EventListeners.end())
+		while (!queue.empty())
 		{
-			// get the list of listeners
-			const EventListenerList& listeners = findIt->second;
-			CB_LOG("Event Loop", "\t\tFound " + ToStr((unsigned long)listeners.size()) + " listeners");
+			// process the first event and pop it
+			IEventPtr pEvent = queue.front();
+			queue.pop_front();
+			CB_LOG("EventLoop", "\t\tProcessing Event " + std::string(pEvent->GetName()));
+
+			const EventType& eventType = pEvent->GetEventType();
+
+			// find all the listeners registered for this event in the map
+			auto findIt = m_EventListeners.find(eventType);
+			if (findIt != m_EventListeners.end())
+			{
+				// get the list of listeners
+				const EventListenerTable& table = findIt->second;
+				const EventListenerList& listeners = table.m_Listeners;
+				const size_t numListeners = listeners.size();
+				CB_LOG("Event Loop", "\t\tFound " + ToStr((unsigned long)numListeners) + " listeners");
+
+				// if every listener is concurrent safe, save the event for the concurrent batch
+				if (m_pJobSystem && table.m_NumSerialListeners == 0 && numListeners > 0)
+				{
+					ConcurrentDispatch dispatch;
+					dispatch.m_pEvent = pEvent;
+					dispatch.m_pListeners = &listeners;
+					dispatch.m_NumListeners = numListeners;
+					dispatch.m_ListenerTimeNS = 0;
+					m_ConcurrentBatch.push_back(dispatch);
+				}
+				else
+				{
+					// call each listener for this event type
+					unsigned long long dispatchStartNS = m_StatsEnabled ? HighResClock::GetNanoseconds() : 0;
+					++m_DispatchDepth;
+					for (size_t i = 0; i < numListeners; ++i)
+					{
+						if (listeners[i].empty())
+							continue;
+
+						CB_LOG("EventLoop", "\t\tSending event " + std::string(pEvent->GetName()) + " to listener");
+						listeners[i](pEvent);
+					}
+					--m_DispatchDepth;
+
+					if (m_StatsEnabled)
+					{
+						GetStatsForEvent(pEvent).m_ListenerTimeNS += HighResClock::GetNanoseconds() - dispatchStartNS;
+					}
+				}
+			}
+			++m_LastUpdateReport.m_NumProcessed[lane];
 
-			// call each listener for this event type
-			for (auto it = listeners.begin(); it != listeners.end(); ++it)
+			// check to see if time ran out, counting the time the concurrent batch is expected to take once it runs
+			if (maxMillis != IEventManager::kINFINITE &&
+				HighResClock::GetNanoseconds() + m_ConcurrentBatch.size() * m_ConcurrentEventNS >= deadlineNS)
 			{
-				EventListenerDelegate listener = *it;
-				CB_LOG("EventLoop", "\t\tSending event " + std::string(pEvent->GetName()) + " to listener");
-				listener(pEvent);
+				CB_LOG("EventLoop", "Aborting event processing, time ran out");
+				timeRanOut = true;
+				break;
 			}
 		}
+	}
+
+	// run the concurrent listeners, this is the barrier before the next queue swap
+	DispatchConcurrentBatch();
+
+	// if we couldn't process all events, splice the remaining events onto the front of the new active queue
+	bool queueFlushed = true;
+	for (int lane = 0; lane < EventLane_Count; ++lane)
+	{
+		EventQueue& queue = m_Queues[queueToProcess][lane];
+		if (!queue.empty())
+		{
+			m_LastUpdateReport.m_NumDeferred[lane] = (unsigned int)queue.size();
+			EventQueue& activeQueue = m_Queues[m_ActiveQueue][lane];
+			EventQueue::iterator firstQueuedIt = activeQueue.begin();
+			activeQueue.splice(activeQueue.begin(), queue);
+			IndexDeferredEvents(activeQueue, firstQueuedIt);
+			queueFlushed = false;
+		}
+	}
+
+	return queueFlushed;
+}
+
+void EventManager::SetEventLane(const EventType& type, EventLane lane)
+{
+	CB_ASSERT(lane >= 0 && lane < EventLane_Count);
+	m_EventLanes[type] = lane;
+}
+
+EventLane EventManager::GetEventLane(const EventType& type) const
+{
+	auto findIt = m_EventLanes.find(type);
+	if (findIt != m_EventLanes.end())
+		return findIt->second;
+
+	return EventLane_Normal;
+}
+
+void EventManager::SetCoalescePolicy(const EventType& type, EventCoalesceKeyFunction keyFunction)
+{
+	CB_ASSERT(keyFunction);
+	m_CoalescePolicies[type] = keyFunction;
+}
+
+void EventManager::RemoveCoalescePolicy(const EventType& type)
+{
+	m_CoalescePolicies.erase(type);
+
+	// forget indexed events of this type so they can't be replaced later
+	for (unsigned int i = 0; i < EVENTMANAGER_NUM_QUEUES; ++i)
+	{
+		EventCoalesceIndex& index = m_CoalesceIndex[i];
+		for (auto it = index.begin(); it != index.end();)
+		{
+			if ((*(it->second))->GetEventType() == type)
+				it = index.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+unsigned long long EventManager::MakeCoalesceKey(const EventType& type, unsigned int key)
+{
+	return ((unsigned long long)type << 32) | key;
+}
 
-		// check to see if time ran out
-		currMS = GetTickCount();
-		if (maxMillis != IEventManager::kINFINITE && currMS >= maxMS)
+void EventManager::IndexDeferredEvents(EventQueue& queue, EventQueue::iterator lastIt)
+{
+	if (m_CoalescePolicies.empty())
+		return;
+
+	// walk back from the newest deferred event, so an event already in the index is always the newer one for its key
+	EventCoalesceIndex& index = m_CoalesceIndex[m_ActiveQueue];
+	EventQueue::iterator it = lastIt;
+	while (it != queue.begin())
+	{
+		--it;
+		auto policyIt = m_CoalescePolicies.find((*it)->GetEventType());
+		if (policyIt == m_CoalescePolicies.end())
+			continue;
+
+		unsigned long long key = MakeCoalesceKey((*it)->GetEventType(), policyIt->second(*it));
+		auto indexIt = index.find(key);
+		if (indexIt != index.end())
+		{
+			// the newer event takes this older event's place in the queue
+			*it = *(indexIt->second);
+			queue.erase(indexIt->second);
+			indexIt->second = it;
+			++m_NumCoalescedEvents;
+		}
+		else
 		{
-			CB_LOG("EventLoop", "Aborting event processing, time ran out");
-			break;
+			index[key] = it;
 		}
 	}
-	bool queueFlushed = m_Queues[queueToProcess].empty();
-	// if we couldn't process all events, push remaining events on the new active queue
-	if (!queueFlushed)
+}
+
+void EventManager::CompactListeners()
+{
+	if (m_DispatchDepth != 0)
+		return;
+
+	for (auto typeIt = m_PendingCompaction.begin(); typeIt != m_PendingCompaction.end(); ++typeIt)
 	{
-		while (!m_Queues[queueToProcess].empty())
+		auto findIt = m_EventListeners.find(*typeIt);
+		if (findIt != m_EventListeners.end())
 		{
-			IEventPtr pEvent = m_Queues[queueToProcess].back();
-			m_Queues[queueToProcess].pop_back();
-			m_Queues[m_ActiveQueue].push_front(pEvent);
+			// shift the live listeners down over the cleared slots, preserving their order
+			EventListenerTable& table = findIt->second;
+			size_t numLive = 0;
+			for (size_t i = 0; i < table.m_Listeners.size(); ++i)
+			{
+				if (table.m_Listeners[i].empty())
+					continue;
+
+				table.m_Listeners[numLive] = table.m_Listeners[i];
+				table.m_ConcurrentSafe[numLive] = table.m_ConcurrentSafe[i];
+				++numLive;
+			}
+			table.m_Listeners.resize(numLive);
+			table.m_ConcurrentSafe.resize(numLive);
 		}
 	}
 
-	return queueFlushed;
+	m_PendingCompaction.clear();
+}
+
+void EventManager::DispatchConcurrentBatch()
+{
+	if (m_ConcurrentBatch.empty())
+		return;
+
+	CB_LOG("EventLoop", "Dispatching " + ToStr((unsigned long)m_ConcurrentBatch.size()) + " events to concurrent listeners");
+
+	// listeners can't be erased while the batch runs, removals are deferred to the next update. main thread
+	// jobs are left for the next RunMainThreadJobs(), their callbacks would re-enter game code partway through
+	++m_DispatchDepth;
+	const bool timeListeners = m_StatsEnabled;
+	unsigned long long batchStartNS = HighResClock::GetNanoseconds();
+	m_pJobSystem->ParallelFor((unsigned int)m_ConcurrentBatch.size(), [this, timeListeners](unsigned int index)
+	{
+		ConcurrentDispatch& dispatch = m_ConcurrentBatch[index];
+		unsigned long long dispatchStartNS = timeListeners ? HighResClock::GetNanoseconds() : 0;
+		const EventListenerList& listeners = *dispatch.m_pListeners;
+		for (size_t i = 0; i < dispatch.m_NumListeners; ++i)
+		{
+			if (!listeners[i].empty())
+				listeners[i](dispatch.m_pEvent);
+		}
+
+		// each item only writes its own slot, the counters are summed after the barrier
+		if (timeListeners)
+			dispatch.m_ListenerTimeNS = HighResClock::GetNanoseconds() - dispatchStartNS;
+	}, JobWait_SkipMainThread);
+	--m_DispatchDepth;
+
+	// the next update counts this much time against its deadline for every event it sets aside
+	m_ConcurrentEventNS = (HighResClock::GetNanoseconds() - batchStartNS) / m_ConcurrentBatch.size();
+
+	if (timeListeners)
+	{
+		for (auto it = m_ConcurrentBatch.begin(); it != m_ConcurrentBatch.end(); ++it)
+		{
+			GetStatsForEvent(it->m_pEvent).m_ListenerTimeNS += it->m_ListenerTimeNS;
+		}
+	}
+
+	m_ConcurrentBatch.clear();
+}
+
+bool EventManager::GetEventStats(const EventType& type, EventTypeStats& stats) const
+{
+	auto findIt = m_EventStats.find(type);
+	if (findIt == m_EventStats.end())
+		return false;
+
+	stats = findIt->second;
+	stats.m_NumListeners = CountLiveListeners(type);
+	return true;
+}
+
+void EventManager::GetAllEventStats(std::vector<EventTypeStats>& stats) const
+{
+	stats.clear();
+	stats.reserve(m_EventStats.size());
+	for (auto it = m_EventStats.begin(); it != m_EventStats.end(); ++it)
+	{
+		stats.push_back(it->second);
+		stats.back().m_NumListeners = CountLiveListeners(it->first);
+	}
+}
+
+void EventManager::DumpStats() const
+{
+	std::vector<EventTypeStats> stats;
+	GetAllEventStats(stats);
+	std::sort(stats.begin(), stats.end(), [](const EventTypeStats& a, const EventTypeStats& b) { return a.m_ListenerTimeNS > b.m_ListenerTimeNS; });
+
+	CB_LOG("EventStats", "Event traffic for " + ToStr((unsigned long)stats.size()) + " event types");
+	for (auto it = stats.begin(); it != stats.end(); ++it)
+	{
+		CB_LOG("EventStats", std::string(it->m_pName) + " (0x" + ToStr(it->m_Type, 16) + ")" +
+			" queued " + ToStr(it->m_NumQueued) +
+			" triggered " + ToStr(it->m_NumTriggered) +
+			" dropped " + ToStr(it->m_NumDropped) +
+			" listeners " + ToStr(it->m_NumListeners) +
+			" listener time " + ToStr((float)(it->m_ListenerTimeNS / 1000) / 1000.0f) + "ms");
+	}
+}
+
+EventTypeStats& EventManager::GetStatsForEvent(const IEventPtr& pEvent) const
+{
+	EventTypeStats& stats = m_EventStats[pEvent->GetEventType()];
+	if (!stats.m_pName)
+	{
+		stats.m_Type = pEvent->GetEventType();
+		stats.m_pName = pEvent->GetName();
+	}
+
+	return stats;
+}
+
+unsigned int EventManager::CountLiveListeners(const EventType& type) const
+{
+	auto findIt = m_EventListeners.find(type);
+	if (findIt == m_EventListeners.end())
+		return 0;
+
+	unsigned int numListeners = 0;
+	const EventListenerList& listeners = findIt->second.m_Listeners;
+	for (auto it = listeners.begin(); it != listeners.end(); ++it)
+	{
+		if (!it->empty())
+			++numListeners;
+	}
+
+	return numListeners;
 }
@@ -0,0 +1,47 @@
+/*
+	EventPool.cpp
+*/
+
+#include "EventPool.h"
+
+std::atomic<unsigned long> EventMemoryPool::s_TotalBlockAllocations(0);
+
+EventMemoryPool::EventMemoryPool(unsigned int chunkSize)
+{
+	m_ChunkSize = chunkSize;
+	m_NumActive = 0;
+}
+
+void* EventMemoryPool::Alloc()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// lazily create the first block so pools for unused events cost nothing
+	if (m_Pool.GetChunkSize() == 0)
+	{
+		if (!m_Pool.Init(m_ChunkSize, EVENTPOOL_CHUNKS_PER_BLOCK))
+			throw std::bad_alloc();
+		++s_TotalBlockAllocations;
+	}
+
+	unsigned int numBlocks = m_Pool.GetNumBlocks();
+	void* pMem = m_Pool.Alloc();
+	if (!pMem)
+		throw std::bad_alloc();
+
+	if (m_Pool.GetNumBlocks() != numBlocks)
+		++s_TotalBlockAllocations;
+
+	++m_NumActive;
+	return pMem;
+}
+
+void EventMemoryPool::Free(void* pMem)
+{
+	if (!pMem)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Pool.Free(pMem);
+	--m_NumActive;
+}
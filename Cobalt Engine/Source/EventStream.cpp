@@ -0,0 +1,215 @@
+/*
+	EventStream.cpp
+*/
+
+#include <cstring>
+
+#include "EventStream.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+// largest value a quantized float is stored as
+const unsigned short EVENTSTREAM_QUANTIZED_MAX = 0xffff;
+
+// longest string that can be written with a 16 bit length
+const size_t EVENTSTREAM_MAX_STRING_LENGTH = 0xffff;
+
+//====================================================
+//	EventWriteStream definitions
+//====================================================
+EventWriteStream::EventWriteStream(bool allowQuantization)
+{
+	m_AllowQuantization = allowQuantization;
+	m_Buffer.reserve(64);
+}
+
+void EventWriteStream::WriteUInt8(unsigned char value)
+{
+	m_Buffer.push_back((char)value);
+}
+
+void EventWriteStream::WriteUInt16(unsigned short value)
+{
+	m_Buffer.push_back((char)(value & 0xff));
+	m_Buffer.push_back((char)((value >> 8) & 0xff));
+}
+
+void EventWriteStream::WriteUInt32(unsigned long value)
+{
+	m_Buffer.push_back((char)(value & 0xff));
+	m_Buffer.push_back((char)((value >> 8) & 0xff));
+	m_Buffer.push_back((char)((value >> 16) & 0xff));
+	m_Buffer.push_back((char)((value >> 24) & 0xff));
+}
+
+void EventWriteStream::WriteInt32(long value)
+{
+	WriteUInt32((unsigned long)value);
+}
+
+void EventWriteStream::WriteBool(bool value)
+{
+	WriteUInt8(value ? 1 : 0);
+}
+
+void EventWriteStream::WriteFloat(float value)
+{
+	// copy the bits rather than casting so the value is not converted
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	WriteUInt32(bits);
+}
+
+void EventWriteStream::WriteQuantizedFloat(float value, float minValue, float maxValue)
+{
+	if (value < minValue)
+		value = minValue;
+	if (value > maxValue)
+		value = maxValue;
+
+	float normalized = (value - minValue) / (maxValue - minValue);
+	WriteUInt16((unsigned short)(normalized * EVENTSTREAM_QUANTIZED_MAX + 0.5f));
+}
+
+void EventWriteStream::WriteString(const std::string& value)
+{
+	size_t length = value.size();
+	if (length > EVENTSTREAM_MAX_STRING_LENGTH)
+		length = EVENTSTREAM_MAX_STRING_LENGTH;
+
+	WriteUInt16((unsigned short)length);
+	m_Buffer.insert(m_Buffer.end(), value.begin(), value.begin() + length);
+}
+
+void EventWriteStream::WriteVec3(const Vec3& value)
+{
+	WriteFloat(value.x);
+	WriteFloat(value.y);
+	WriteFloat(value.z);
+}
+
+void EventWriteStream::WriteMat4x4(const Mat4x4& value)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			WriteFloat(value.m[i][j]);
+		}
+	}
+}
+
+void EventWriteStream::WriteBytes(const char* pData, size_t size)
+{
+	m_Buffer.insert(m_Buffer.end(), pData, pData + size);
+}
+
+
+//====================================================
+//	EventReadStream definitions
+//====================================================
+EventReadStream::EventReadStream(const char* pData, size_t size)
+{
+	m_pData = pData;
+	m_Size = pData ? size : 0;
+	m_Position = 0;
+	m_Failed = false;
+}
+
+const unsigned char* EventReadStream::Consume(size_t numBytes)
+{
+	if (m_Failed || m_Size - m_Position < numBytes)
+	{
+		m_Failed = true;
+		return nullptr;
+	}
+
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(m_pData + m_Position);
+	m_Position += numBytes;
+	return pBytes;
+}
+
+unsigned char EventReadStream::ReadUInt8()
+{
+	const unsigned char* pBytes = Consume(1);
+	return pBytes ? pBytes[0] : 0;
+}
+
+unsigned short EventReadStream::ReadUInt16()
+{
+	const unsigned char* pBytes = Consume(2);
+	if (!pBytes)
+		return 0;
+
+	return (unsigned short)(pBytes[0] | (pBytes[1] << 8));
+}
+
+unsigned long EventReadStream::ReadUInt32()
+{
+	const unsigned char* pBytes = Consume(4);
+	if (!pBytes)
+		return 0;
+
+	return (unsigned long)pBytes[0] |
+		((unsigned long)pBytes[1] << 8) |
+		((unsigned long)pBytes[2] << 16) |
+		((unsigned long)pBytes[3] << 24);
+}
+
+long EventReadStream::ReadInt32()
+{
+	unsigned long value = ReadUInt32();
+	return (value & 0x80000000UL) ? -(long)(0xffffffffUL - value) - 1 : (long)value;
+}
+
+bool EventReadStream::ReadBool()
+{
+	return ReadUInt8() != 0;
+}
+
+float EventReadStream::ReadFloat()
+{
+	unsigned int bits = (unsigned int)ReadUInt32();
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+float EventReadStream::ReadQuantizedFloat(float minValue, float maxValue)
+{
+	float normalized = (float)ReadUInt16() / EVENTSTREAM_QUANTIZED_MAX;
+	return minValue + normalized * (maxValue - minValue);
+}
+
+std::string EventReadStream::ReadString()
+{
+	unsigned short length = ReadUInt16();
+	const unsigned char* pBytes = Consume(length);
+	if (!pBytes)
+		return std::string();
+
+	return std::string(reinterpret_cast<const char*>(pBytes), length);
+}
+
+void EventReadStream::ReadVec3(Vec3& value)
+{
+	value.x = ReadFloat();
+	value.y = ReadFloat();
+	value.z = ReadFloat();
+}
+
+void EventReadStream::ReadMat4x4(Mat4x4& value)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			value.m[i][j] = ReadFloat();
+		}
+	}
+}
+
+const char* EventReadStream::ReadBytes(size_t size)
+{
+	return reinterpret_cast<const char*>(Consume(size));
+}
@@ -8,9 +8,17 @@
 #include "Events.h"
 
 #include "EngineStd.h"
+#include "EventPool.h"
 #include "Logger.h"
 #include "PhysicsEvents.h"
 
+// layouts Event_MoveGameObject can be written in, recorded as the first byte after the id
+enum MoveLayout
+{
+	MoveLayout_Full,
+	MoveLayout_QuantizedRotation
+};
+
 //====================================================
 //	Static Event GUID's
 //====================================================
@@ -21,6 +29,7 @@ const EventType Event_MoveGameObject::sk_EventType(0x1a81ed5);
 const EventType Event_NewRenderComponent::sk_EventType(0xfb30a10c);
 const EventType Event_ModifiedRenderComponent::sk_EventType(0xf5ef297b);
 const EventType Event_RequestNewGameObject::sk_EventType(0xe32a1a9a);
+const EventType Event_RequestNewGameObjects::sk_EventType(0x7c4d2e91);
 const EventType Event_RequestDestroyGameObject::sk_EventType(0xdc8c485d);
 const EventType Event_EnvironmentLoaded::sk_EventType(0x8f28edab);
 const EventType Event_RequestStartGame::sk_EventType(0xc46b8535);
@@ -68,6 +77,19 @@ void Event_NewGameObject::Deserialize(std::istream& in)
 	in >> m_ViewId;
 }
 
+void Event_NewGameObject::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteUInt32(m_ObjectId);
+	out.WriteUInt32(m_ViewId);
+}
+
+bool Event_NewGameObject::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectId = in.ReadUInt32();
+	m_ViewId = in.ReadUInt32();
+	return in.IsValid();
+}
+
 IEventPtr Event_NewGameObject::Copy() const
 {
 	return IEventPtr(CB_NEW Event_NewGameObject(m_ObjectId, m_ViewId));
@@ -106,6 +128,17 @@ void Event_DestroyGameObject::Deserialize(std::istream& in)
 	in >> m_Id;
 }
 
+void Event_DestroyGameObject::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteUInt32(m_Id);
+}
+
+bool Event_DestroyGameObject::DeserializeBinary(EventReadStream& in)
+{
+	m_Id = in.ReadUInt32();
+	return in.IsValid();
+}
+
 IEventPtr Event_DestroyGameObject::Copy() const
 {
 	return IEventPtr(CB_NEW Event_DestroyGameObject(m_Id));
@@ -141,6 +174,11 @@ const Mat4x4& Event_MoveGameObject::GetMatrix() const
 	return m_Matrix;
 }
 
+unsigned int Event_MoveGameObject::GetCoalesceKey(const IEventPtr& pEvent)
+{
+	return static_pointer_cast<Event_MoveGameObject>(pEvent)->m_ObjectId;
+}
+
 const EventType& Event_MoveGameObject::GetEventType() const
 {
 	return sk_EventType;
@@ -170,9 +208,83 @@ void Event_MoveGameObject::Deserialize(std::istream& in)
 	}
 }
 
+void Event_MoveGameObject::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteUInt32(m_ObjectId);
+
+	// a rigid transform only needs its rotation and translation, and the rotation
+	// values always fall in [-1, 1] so they can be packed into 16 bits each
+	bool isRigid = m_Matrix.m[0][3] == 0.0f && m_Matrix.m[1][3] == 0.0f && m_Matrix.m[2][3] == 0.0f && m_Matrix.m[3][3] == 1.0f;
+	for (int i = 0; i < 3 && isRigid; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			if (m_Matrix.m[i][j] < -1.0f || m_Matrix.m[i][j] > 1.0f)
+			{
+				isRigid = false;
+				break;
+			}
+		}
+	}
+
+	if (out.AllowQuantization() && isRigid)
+	{
+		out.WriteUInt8(MoveLayout_QuantizedRotation);
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				out.WriteQuantizedFloat(m_Matrix.m[i][j], -1.0f, 1.0f);
+			}
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			out.WriteFloat(m_Matrix.m[3][j]);
+		}
+	}
+	else
+	{
+		out.WriteUInt8(MoveLayout_Full);
+		out.WriteMat4x4(m_Matrix);
+	}
+}
+
+bool Event_MoveGameObject::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectId = in.ReadUInt32();
+
+	unsigned char layout = in.ReadUInt8();
+	if (layout == MoveLayout_QuantizedRotation)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				m_Matrix.m[i][j] = in.ReadQuantizedFloat(-1.0f, 1.0f);
+			}
+			m_Matrix.m[i][3] = 0.0f;
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			m_Matrix.m[3][j] = in.ReadFloat();
+		}
+		m_Matrix.m[3][3] = 1.0f;
+	}
+	else if (layout == MoveLayout_Full)
+	{
+		in.ReadMat4x4(m_Matrix);
+	}
+	else
+	{
+		return false;
+	}
+
+	return in.IsValid();
+}
+
 IEventPtr Event_MoveGameObject::Copy() const
 {
-	return IEventPtr(CB_NEW Event_MoveGameObject(m_ObjectId, m_Matrix));
+	return MakePooledEvent<Event_MoveGameObject>(m_ObjectId, m_Matrix);
 }
 
 const char* Event_MoveGameObject::GetName() const
@@ -220,6 +332,17 @@ void Event_NewRenderComponent::Deserialize(std::istream& in)
 	CB_ERROR(GetName() + std::string(" should not be deserialized!"));
 }
 
+void Event_NewRenderComponent::SerializeBinary(EventWriteStream& out) const
+{
+	CB_ERROR(GetName() + std::string(" should not be serialized!"));
+}
+
+bool Event_NewRenderComponent::DeserializeBinary(EventReadStream& in)
+{
+	CB_ERROR(GetName() + std::string(" should not be deserialized!"));
+	return false;
+}
+
 IEventPtr Event_NewRenderComponent::Copy() const
 {
 	return IEventPtr(CB_NEW Event_NewRenderComponent(m_ObjectId, m_pSceneNode));
@@ -264,6 +387,17 @@ void Event_ModifiedRenderComponent::Deserialize(std::istream& in)
 	in >> m_ObjectId;
 }
 
+void Event_ModifiedRenderComponent::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteUInt32(m_ObjectId);
+}
+
+bool Event_ModifiedRenderComponent::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectId = in.ReadUInt32();
+	return in.IsValid();
+}
+
 IEventPtr Event_ModifiedRenderComponent::Copy() const
 {
 	return IEventPtr(CB_NEW Event_ModifiedRenderComponent(m_ObjectId));
@@ -365,6 +499,31 @@ void Event_RequestNewGameObject::Deserialize(std::istream& in)
 	in >> m_ViewId;
 }
 
+void Event_RequestNewGameObject::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteString(m_ObjectResource);
+	out.WriteBool(m_HasInitialTransform);
+	if (m_HasInitialTransform)
+	{
+		out.WriteMat4x4(m_InitialTransform);
+	}
+	out.WriteUInt32(m_ServerObjectId);
+	out.WriteUInt32(m_ViewId);
+}
+
+bool Event_RequestNewGameObject::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectResource = in.ReadString();
+	m_HasInitialTransform = in.ReadBool();
+	if (m_HasInitialTransform)
+	{
+		in.ReadMat4x4(m_InitialTransform);
+	}
+	m_ServerObjectId = in.ReadUInt32();
+	m_ViewId = in.ReadUInt32();
+	return in.IsValid();
+}
+
 IEventPtr Event_RequestNewGameObject::Copy() const
 {
 	return IEventPtr(CB_NEW Event_RequestNewGameObject(m_ObjectResource, (m_HasInitialTransform) ? &m_InitialTransform : nullptr, m_ServerObjectId, m_ViewId));
@@ -376,6 +535,107 @@ const char* Event_RequestNewGameObject::GetName() const
 }
 
 
+//====================================================
+//	Event_RequestNewGameObjects
+//====================================================
+Event_RequestNewGameObjects::Event_RequestNewGameObjects()
+{
+}
+
+Event_RequestNewGameObjects::Event_RequestNewGameObjects(const std::string& objectResource, const std::vector<GameObjectId>& serverObjectIds, const std::vector<Vec3>& positions)
+{
+	CB_ASSERT(serverObjectIds.size() == positions.size());
+
+	m_ObjectResource = objectResource;
+	m_ServerObjectIds = serverObjectIds;
+	m_Positions = positions;
+}
+
+const std::string& Event_RequestNewGameObjects::GetObjectResource() const
+{
+	return m_ObjectResource;
+}
+
+const std::vector<GameObjectId>& Event_RequestNewGameObjects::GetServerObjectIds() const
+{
+	return m_ServerObjectIds;
+}
+
+const std::vector<Vec3>& Event_RequestNewGameObjects::GetPositions() const
+{
+	return m_Positions;
+}
+
+const EventType& Event_RequestNewGameObjects::GetEventType() const
+{
+	return sk_EventType;
+}
+
+void Event_RequestNewGameObjects::Serialize(std::ostream& out) const
+{
+	out << m_ObjectResource << " ";
+	out << m_ServerObjectIds.size() << " ";
+	for (size_t i = 0; i < m_ServerObjectIds.size(); ++i)
+	{
+		out << m_ServerObjectIds[i] << " ";
+		out << m_Positions[i].x << " " << m_Positions[i].y << " " << m_Positions[i].z << " ";
+	}
+}
+
+void Event_RequestNewGameObjects::Deserialize(std::istream& in)
+{
+	size_t numObjects = 0;
+	in >> m_ObjectResource;
+	in >> numObjects;
+
+	m_ServerObjectIds.resize(numObjects);
+	m_Positions.resize(numObjects);
+	for (size_t i = 0; i < numObjects; ++i)
+	{
+		in >> m_ServerObjectIds[i];
+		in >> m_Positions[i].x >> m_Positions[i].y >> m_Positions[i].z;
+	}
+}
+
+void Event_RequestNewGameObjects::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteString(m_ObjectResource);
+	out.WriteUInt16((unsigned short)m_ServerObjectIds.size());
+	for (size_t i = 0; i < m_ServerObjectIds.size(); ++i)
+	{
+		out.WriteUInt32(m_ServerObjectIds[i]);
+		out.WriteVec3(m_Positions[i]);
+	}
+}
+
+bool Event_RequestNewGameObjects::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectResource = in.ReadString();
+	unsigned short numObjects = in.ReadUInt16();
+	if (!in.IsValid())
+		return false;
+
+	m_ServerObjectIds.resize(numObjects);
+	m_Positions.resize(numObjects);
+	for (unsigned short i = 0; i < numObjects; ++i)
+	{
+		m_ServerObjectIds[i] = in.ReadUInt32();
+		in.ReadVec3(m_Positions[i]);
+	}
+	return in.IsValid();
+}
+
+IEventPtr Event_RequestNewGameObjects::Copy() const
+{
+	return IEventPtr(CB_NEW Event_RequestNewGameObjects(m_ObjectResource, m_ServerObjectIds, m_Positions));
+}
+
+const char* Event_RequestNewGameObjects::GetName() const
+{
+	return "Event_RequestNewGameObjects";
+}
+
+
 //====================================================
 //	Event_RequestDestroyGameObject
 //====================================================
@@ -409,6 +669,17 @@ void Event_RequestDestroyGameObject::Deserialize(std::istream& in)
 	in >> m_ObjectId;
 }
 
+void Event_RequestDestroyGameObject::SerializeBinary(EventWriteStream& out) const
+{
+	out.WriteUInt32(m_ObjectId);
+}
+
+bool Event_RequestDestroyGameObject::DeserializeBinary(EventReadStream& in)
+{
+	m_ObjectId = in.ReadUInt32();
+	return in.IsValid();
+}
+
 IEventPtr Event_RequestDestroyGameObject::Copy() const
 {
 	return IEventPtr(CB_NEW Event_RequestDestroyGameObject(m_ObjectId));
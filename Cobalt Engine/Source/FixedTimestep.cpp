@@ -0,0 +1,89 @@
+/*
+	FixedTimestep.cpp
+*/
+
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(float ticksPerSecond, unsigned int maxTicksPerFrame)
+{
+	m_TickDelta = 0.0f;
+	m_MaxTicksPerFrame = 1;
+	m_Accumulator = 0.0;
+	m_Interpolation = 1.0f;
+	m_SimulationTime = 0.0;
+	m_NumTicks = 0;
+	m_NumDroppedTicks = 0;
+
+	SetTickRate(ticksPerSecond);
+	SetMaxTicksPerFrame(maxTicksPerFrame);
+}
+
+void FixedTimestep::SetTickRate(float ticksPerSecond)
+{
+	m_TickDelta = (ticksPerSecond > 0.0f) ? 1.0f / ticksPerSecond : 0.0f;
+	Reset();
+}
+
+void FixedTimestep::SetMaxTicksPerFrame(unsigned int maxTicksPerFrame)
+{
+	// always make some progress
+	m_MaxTicksPerFrame = (maxTicksPerFrame > 0) ? maxTicksPerFrame : 1;
+}
+
+unsigned int FixedTimestep::Step(float deltaTime, const TickFunction& tick)
+{
+	if (deltaTime < 0.0f)
+		deltaTime = 0.0f;
+
+	// variable step, the frame is the tick
+	if (m_TickDelta <= 0.0f)
+	{
+		RunTick(deltaTime, tick);
+		m_Interpolation = 1.0f;
+		return 1;
+	}
+
+	m_Accumulator += deltaTime;
+
+	unsigned int numTicks = 0;
+	while (m_Accumulator >= m_TickDelta)
+	{
+		// too far behind to catch up, drop the backlog so a slow frame does not lead to a slower one
+		if (numTicks == m_MaxTicksPerFrame)
+		{
+			unsigned long long numDropped = (unsigned long long)(m_Accumulator / m_TickDelta);
+			m_NumDroppedTicks += numDropped;
+			m_Accumulator -= numDropped * (double)m_TickDelta;
+			break;
+		}
+
+		m_Accumulator -= m_TickDelta;
+		RunTick(m_TickDelta, tick);
+		++numTicks;
+	}
+
+	m_Interpolation = (float)(m_Accumulator / m_TickDelta);
+	return numTicks;
+}
+
+void FixedTimestep::RunTicks(unsigned int numTicks, const TickFunction& tick)
+{
+	float deltaTime = (m_TickDelta > 0.0f) ? m_TickDelta : 1.0f / FIXEDTIMESTEP_DEFAULT_TICK_RATE;
+	for (unsigned int i = 0; i < numTicks; ++i)
+	{
+		RunTick(deltaTime, tick);
+	}
+}
+
+void FixedTimestep::Reset()
+{
+	m_Accumulator = 0.0;
+	m_Interpolation = (m_TickDelta > 0.0f) ? 0.0f : 1.0f;
+}
+
+void FixedTimestep::RunTick(float deltaTime, const TickFunction& tick)
+{
+	m_SimulationTime += deltaTime;
+	++m_NumTicks;
+	tick(m_SimulationTime, deltaTime);
+}
@@ -0,0 +1,261 @@
+/*
+	FramePacer.cpp
+*/
+
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+ #include <Windows.h>
+ #include <mmsystem.h>
+ #pragma comment(lib, "winmm.lib")
+#else
+ #include <chrono>
+ #include <ctime>
+ #include <thread>
+#endif
+
+#include "HighResClock.h"
+#include "Logger.h"
+#include "StringUtil.h"
+
+static float NanosecondsToMillis(unsigned long long nanoseconds)
+{
+	return (float)((double)nanoseconds / NANOSECONDS_PER_MILLISECOND);
+}
+
+FramePacer::FramePacer(float framesPerSecond)
+{
+	m_FramePeriodNS = 0;
+	m_SpinNS = 0;
+	m_NextFrameNS = 0;
+	m_LastFrameNS = 0;
+	m_HighResolutionTimer = false;
+	m_FrameSamples.resize(FRAMEPACER_STATS_SAMPLES, 0);
+	m_StatsDumpIntervalNS = 0;
+	m_LastStatsDumpNS = 0;
+
+	SetSpinTime(FRAMEPACER_DEFAULT_SPIN_MS);
+	SetTargetFrameRate(framesPerSecond);
+	ResetStats();
+}
+
+FramePacer::~FramePacer()
+{
+	SetHighResolutionTimer(false);
+}
+
+void FramePacer::SetTargetFrameRate(float framesPerSecond)
+{
+	m_FramePeriodNS = (framesPerSecond > 0.0f) ? (unsigned long long)(NANOSECONDS_PER_SECOND / framesPerSecond) : 0;
+	m_NextFrameNS = 0;
+
+	// the finer timer costs some power, so it is only on while there is something to sleep for
+	SetHighResolutionTimer(m_FramePeriodNS > 0);
+}
+
+float FramePacer::GetTargetFrameRate() const
+{
+	return (m_FramePeriodNS > 0) ? (float)((double)NANOSECONDS_PER_SECOND / m_FramePeriodNS) : 0.0f;
+}
+
+void FramePacer::SetSpinTime(float milliseconds)
+{
+	m_SpinNS = (milliseconds > 0.0f) ? (unsigned long long)(milliseconds * NANOSECONDS_PER_MILLISECOND) : 0;
+}
+
+float FramePacer::WaitForNextFrame()
+{
+	unsigned long long waitStartNS = HighResClock::GetNanoseconds();
+	if (m_FramePeriodNS > 0 && m_NextFrameNS > waitStartNS)
+	{
+		WaitUntil(m_NextFrameNS);
+	}
+
+	unsigned long long frameStartNS = HighResClock::GetNanoseconds();
+
+	// stay on the grid if this frame made up for a short overrun, otherwise start a new one
+	if (m_FramePeriodNS > 0)
+	{
+		m_NextFrameNS += m_FramePeriodNS;
+		if (m_NextFrameNS <= frameStartNS)
+		{
+			m_NextFrameNS = frameStartNS + m_FramePeriodNS;
+		}
+	}
+
+	float deltaTime = 0.0f;
+	if (m_LastFrameNS != 0)
+	{
+		unsigned long long frameNS = frameStartNS - m_LastFrameNS;
+		RecordFrame(frameNS, frameStartNS - waitStartNS);
+		deltaTime = (float)((double)frameNS / NANOSECONDS_PER_SECOND);
+	}
+	m_LastFrameNS = frameStartNS;
+
+	if (m_StatsDumpIntervalNS > 0 && frameStartNS - m_LastStatsDumpNS >= m_StatsDumpIntervalNS)
+	{
+		DumpStats();
+		m_LastStatsDumpNS = frameStartNS;
+	}
+
+	return deltaTime;
+}
+
+FramePacerStats FramePacer::GetStats() const
+{
+	FramePacerStats stats;
+	stats.m_NumFrames = m_NumFrames;
+	if (m_NumFrames == 0)
+		return stats;
+
+	stats.m_AvgFrameMS = NanosecondsToMillis(m_TotalFrameNS / m_NumFrames);
+	stats.m_MinFrameMS = NanosecondsToMillis(m_MinFrameNS);
+	stats.m_MaxFrameMS = NanosecondsToMillis(m_MaxFrameNS);
+	stats.m_AvgWaitMS = NanosecondsToMillis(m_TotalWaitNS / m_NumFrames);
+	stats.m_AvgWorkMS = NanosecondsToMillis((m_TotalFrameNS - m_TotalWaitNS) / m_NumFrames);
+
+	// the percentile and jitter only look at the recent frames so they follow changes in load
+	unsigned int numSamples = (m_NumFrames < FRAMEPACER_STATS_SAMPLES) ? (unsigned int)m_NumFrames : FRAMEPACER_STATS_SAMPLES;
+	std::vector<unsigned long long> samples(m_FrameSamples.begin(), m_FrameSamples.begin() + numSamples);
+
+	double mean = 0.0;
+	for (auto it = samples.begin(); it != samples.end(); ++it)
+	{
+		mean += (double)*it;
+	}
+	mean /= numSamples;
+
+	double variance = 0.0;
+	for (auto it = samples.begin(); it != samples.end(); ++it)
+	{
+		double difference = (double)*it - mean;
+		variance += difference * difference;
+	}
+	variance /= numSamples;
+	stats.m_JitterMS = (float)(sqrt(variance) / NANOSECONDS_PER_MILLISECOND);
+
+	auto p99 = samples.begin() + (numSamples * 99) / 100;
+	std::nth_element(samples.begin(), p99, samples.end());
+	stats.m_P99FrameMS = NanosecondsToMillis(*p99);
+
+	unsigned long long wallNS = HighResClock::GetNanoseconds() - m_StatsStartNS;
+	if (wallNS > 0)
+	{
+		stats.m_CpuUsage = (float)((double)(GetProcessCpuNanoseconds() - m_StatsStartCpuNS) / wallNS);
+	}
+
+	return stats;
+}
+
+void FramePacer::ResetStats()
+{
+	m_NextSample = 0;
+	m_NumFrames = 0;
+	m_TotalFrameNS = 0;
+	m_TotalWaitNS = 0;
+	m_MinFrameNS = 0;
+	m_MaxFrameNS = 0;
+	m_StatsStartNS = HighResClock::GetNanoseconds();
+	m_StatsStartCpuNS = GetProcessCpuNanoseconds();
+}
+
+void FramePacer::DumpStats() const
+{
+	FramePacerStats stats = GetStats();
+	float targetFrameRate = GetTargetFrameRate();
+	CB_LOG("FramePacer", ToStr(stats.m_NumFrames) + " frames at " + ((targetFrameRate > 0.0f) ? ToStr(targetFrameRate) + " fps" : std::string("full speed")) + ":" +
+		" avg " + ToStr(stats.m_AvgFrameMS) + "ms" +
+		" p99 " + ToStr(stats.m_P99FrameMS) + "ms" +
+		" min " + ToStr(stats.m_MinFrameMS) + "ms" +
+		" max " + ToStr(stats.m_MaxFrameMS) + "ms" +
+		" jitter " + ToStr(stats.m_JitterMS) + "ms" +
+		" work " + ToStr(stats.m_AvgWorkMS) + "ms" +
+		" wait " + ToStr(stats.m_AvgWaitMS) + "ms" +
+		" cpu " + ToStr(stats.m_CpuUsage * 100.0f) + "%");
+}
+
+void FramePacer::SetStatsDumpInterval(unsigned long milliseconds)
+{
+	m_StatsDumpIntervalNS = milliseconds * NANOSECONDS_PER_MILLISECOND;
+	m_LastStatsDumpNS = HighResClock::GetNanoseconds();
+}
+
+void FramePacer::SetHighResolutionTimer(bool enabled)
+{
+	if (enabled == m_HighResolutionTimer)
+		return;
+
+#ifdef _WIN32
+	if (enabled)
+		timeBeginPeriod(1);
+	else
+		timeEndPeriod(1);
+#endif
+	m_HighResolutionTimer = enabled;
+}
+
+void FramePacer::WaitUntil(unsigned long long targetNS)
+{
+	// sleep through most of the wait, a sleep can only be trusted to a millisecond or two
+	unsigned long long currNS = HighResClock::GetNanoseconds();
+	if (currNS + m_SpinNS < targetNS)
+	{
+		unsigned long long sleepNS = targetNS - currNS - m_SpinNS;
+#ifdef _WIN32
+		DWORD sleepMillis = (DWORD)(sleepNS / NANOSECONDS_PER_MILLISECOND);
+		if (sleepMillis > 0)
+		{
+			Sleep(sleepMillis);
+		}
+#else
+		std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNS));
+#endif
+	}
+
+	// spin through the rest so the frame starts on time
+	while (HighResClock::GetNanoseconds() < targetNS)
+	{
+#ifdef _WIN32
+		YieldProcessor();
+#else
+		std::this_thread::yield();
+#endif
+	}
+}
+
+void FramePacer::RecordFrame(unsigned long long frameNS, unsigned long long waitNS)
+{
+	m_FrameSamples[m_NextSample] = frameNS;
+	m_NextSample = (m_NextSample + 1) % FRAMEPACER_STATS_SAMPLES;
+
+	if (m_NumFrames == 0 || frameNS < m_MinFrameNS)
+		m_MinFrameNS = frameNS;
+	if (frameNS > m_MaxFrameNS)
+		m_MaxFrameNS = frameNS;
+
+	++m_NumFrames;
+	m_TotalFrameNS += frameNS;
+	m_TotalWaitNS += waitNS;
+}
+
+unsigned long long FramePacer::GetProcessCpuNanoseconds()
+{
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	// file times count 100 nanosecond intervals
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+	return (kernel.QuadPart + user.QuadPart) * 100ULL;
+#else
+	return (unsigned long long)((double)std::clock() / CLOCKS_PER_SEC * NANOSECONDS_PER_SECOND);
+#endif
+}
@@ -13,36 +13,97 @@
 #include "Logger.h"
 #include "PhysicsComponent.h"
 #include "RenderComponent.h"
+#include "ResourceHandle.h"
 #include "ScriptComponent.h"
 #include "TransformComponent.h"
 #include "XmlResource.h"
 
+/// Component ids worked out offline with HashedString::Hash_Name, one per registered component
+struct PrecomputedComponentId
+{
+	const char* m_pName;
+	ComponentId m_Id;
+};
+
+static const PrecomputedComponentId GAMEOBJECTFACTORY_COMPONENT_IDS[] =
+{
+	{ "TransformComponent", 0x490007af },
+	{ "AudioComponent", 0x2bb805e5 },
+	{ "MeshRenderComponent", 0x4f890800 },
+	{ "SphereRenderComponent", 0x611808da },
+	{ "TeapotRenderComponent", 0x614f08e0 },
+	{ "PhysicsComponent", 0x3a2806d6 },
+	{ "LuaScriptComponent", 0x489207aa },
+	{ "LightRenderComponent", 0x57d6086b },
+	{ "SkyRenderComponent", 0x48f607aa },
+	{ "GridRenderComponent", 0x4f1707f9 },
+};
+
+/// Check a component's startup-hashed id against the precomputed table, so a change to the hash or a renamed component is caught
+static void CheckPrecomputedComponentId(const char* name, ComponentId id)
+{
+	const int numIds = sizeof(GAMEOBJECTFACTORY_COMPONENT_IDS) / sizeof(GAMEOBJECTFACTORY_COMPONENT_IDS[0]);
+	for (int i = 0; i < numIds; ++i)
+	{
+		if (strcmp(GAMEOBJECTFACTORY_COMPONENT_IDS[i].m_pName, name) == 0)
+		{
+			CB_ASSERT(GAMEOBJECTFACTORY_COMPONENT_IDS[i].m_Id == id && "Component id differs from the precomputed table");
+			return;
+		}
+	}
+
+	CB_ASSERT(false && "Registered component is missing from the precomputed id table");
+}
+
 GameObjectFactory::GameObjectFactory()
 {
 	m_lastObjectId = INVALID_GAMEOBJECT_ID;
 
 	// Register all the component creation functions
-	m_ComponentFactory.Register<TransformComponent>(Component::GetIdFromName(TransformComponent::g_Name));
+	m_ComponentFactory.Register<TransformComponent>(TransformComponent::g_Id);
+
+	m_ComponentFactory.Register<AudioComponent>(AudioComponent::g_Id);
 
-	m_ComponentFactory.Register<AudioComponent>(Component::GetIdFromName(AudioComponent::g_Name));
+	m_ComponentFactory.Register<MeshRenderComponent>(MeshRenderComponent::g_Id);
+	m_ComponentFactory.Register<SphereRenderComponent>(SphereRenderComponent::g_Id);
+	m_ComponentFactory.Register<TeapotRenderComponent>(TeapotRenderComponent::g_Id);
 
-	m_ComponentFactory.Register<MeshRenderComponent>(Component::GetIdFromName(MeshRenderComponent::g_Name));
-	m_ComponentFactory.Register<SphereRenderComponent>(Component::GetIdFromName(SphereRenderComponent::g_Name));
-	m_ComponentFactory.Register<TeapotRenderComponent>(Component::GetIdFromName(TeapotRenderComponent::g_Name));
+	m_ComponentFactory.Register<PhysicsComponent>(PhysicsComponent::g_Id);
 
-	m_ComponentFactory.Register<PhysicsComponent>(Component::GetIdFromName(PhysicsComponent::g_Name));
+	m_ComponentFactory.Register<LuaScriptComponent>(LuaScriptComponent::g_Id);
 
-	m_ComponentFactory.Register<LuaScriptComponent>(Component::GetIdFromName(LuaScriptComponent::g_Name));
+	m_ComponentFactory.Register<LightRenderComponent>(LightRenderComponent::g_Id);
+	m_ComponentFactory.Register<SkyRenderComponent>(SkyRenderComponent::g_Id);
+	m_ComponentFactory.Register<GridRenderComponent>(GridRenderComponent::g_Id);
 
-	m_ComponentFactory.Register<LightRenderComponent>(Component::GetIdFromName(LightRenderComponent::g_Name));
-	m_ComponentFactory.Register<SkyRenderComponent>(Component::GetIdFromName(SkyRenderComponent::g_Name));
-	m_ComponentFactory.Register<GridRenderComponent>(Component::GetIdFromName(GridRenderComponent::g_Name));
+	// the ids only change if the hash or a name changes, so check them for the first factory only
+	static bool s_ComponentIdsChecked = false;
+	if (!s_ComponentIdsChecked)
+	{
+		CheckPrecomputedComponentId(TransformComponent::g_Name, TransformComponent::g_Id);
+		CheckPrecomputedComponentId(AudioComponent::g_Name, AudioComponent::g_Id);
+		CheckPrecomputedComponentId(MeshRenderComponent::g_Name, MeshRenderComponent::g_Id);
+		CheckPrecomputedComponentId(SphereRenderComponent::g_Name, SphereRenderComponent::g_Id);
+		CheckPrecomputedComponentId(TeapotRenderComponent::g_Name, TeapotRenderComponent::g_Id);
+		CheckPrecomputedComponentId(PhysicsComponent::g_Name, PhysicsComponent::g_Id);
+		CheckPrecomputedComponentId(LuaScriptComponent::g_Name, LuaScriptComponent::g_Id);
+		CheckPrecomputedComponentId(LightRenderComponent::g_Name, LightRenderComponent::g_Id);
+		CheckPrecomputedComponentId(SkyRenderComponent::g_Name, SkyRenderComponent::g_Id);
+		CheckPrecomputedComponentId(GridRenderComponent::g_Name, GridRenderComponent::g_Id);
+		s_ComponentIdsChecked = true;
+	}
 }
 
 StrongGameObjectPtr GameObjectFactory::CreateGameObject(const char* objectResource, TiXmlElement* overrides, const Mat4x4* pInitialTransform, const GameObjectId serversObjectId)
 {
 	// get the root xml node
 	TiXmlElement* pRoot = XmlResourceLoader::LoadAndReturnRootXmlElement(objectResource);
+
+	return CreateGameObjectFromTemplate(pRoot, objectResource, overrides, pInitialTransform, serversObjectId);
+}
+
+StrongGameObjectPtr GameObjectFactory::CreateGameObjectFromTemplate(TiXmlElement* pRoot, const char* objectResource, TiXmlElement* overrides, const Mat4x4* pInitialTransform, const GameObjectId serversObjectId)
+{
 	if (!pRoot)
 	{
 		CB_ERROR("Failed to create object from resource: " + std::string(objectResource));
@@ -88,7 +149,7 @@ StrongGameObjectPtr GameObjectFactory::CreateGameObject(const char* objectResour
 	}
 
 	// set the initial transform of the object
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>());
 	if (pInitialTransform && pTransformComponent)
 	{
 		pTransformComponent->SetPosition(pInitialTransform->GetPosition());
@@ -100,6 +161,29 @@ StrongGameObjectPtr GameObjectFactory::CreateGameObject(const char* objectResour
 	return pObject;
 }
 
+TiXmlElement* GameObjectFactory::GetTemplate(const char* objectResource)
+{
+	auto findIt = m_Templates.find(objectResource);
+	if (findIt == m_Templates.end())
+	{
+		// holding the handle keeps the parsed xml out of reach of the cache's eviction
+		Resource resource(objectResource);
+		shared_ptr<ResHandle> pResHandle = g_pApp->m_ResCache->GetHandle(&resource);
+		if (!pResHandle)
+			return nullptr;
+
+		findIt = m_Templates.insert(std::make_pair(std::string(objectResource), pResHandle)).first;
+	}
+
+	shared_ptr<XmlResourceExtraData> pExtraData = static_pointer_cast<XmlResourceExtraData>(findIt->second->GetExtra());
+	return pExtraData ? pExtraData->GetRoot() : nullptr;
+}
+
+void GameObjectFactory::ReleaseTemplates()
+{
+	m_Templates.clear();
+}
+
 void GameObjectFactory::ModifyGameObject(StrongGameObjectPtr pObject, TiXmlElement* overrides)
 {
 	// loop through each child xml element and load the component
@@ -128,12 +212,16 @@ void GameObjectFactory::ModifyGameObject(StrongGameObjectPtr pObject, TiXmlEleme
 StrongComponentPtr GameObjectFactory::CreateComponent(TiXmlElement* pData)
 {
 	const char* name = pData->Value();
+	ComponentId componentId = Component::GetIdFromName(name);
 
-	StrongComponentPtr pComponent(m_ComponentFactory.Create(Component::GetIdFromName(name)));
+	StrongComponentPtr pComponent(m_ComponentFactory.Create(componentId));
 
 	// If the component was successfully created, initialize it
 	if (pComponent)
 	{
+		// the id it was registered under has to match the one it reports, or typed lookups will miss it
+		CB_ASSERT(pComponent->GetId() == componentId && "Component name does not match its registered id");
+
 		if (!pComponent->Init(pData))
 		{
 			CB_ERROR("Component failed to initialize: " + std::string(name));
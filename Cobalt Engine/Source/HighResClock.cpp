@@ -0,0 +1,51 @@
+/*
+	HighResClock.cpp
+*/
+
+#include "HighResClock.h"
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN
+ #include <Windows.h>
+#else
+ #include <chrono>
+#endif
+
+#ifdef _WIN32
+// the performance counter frequency is fixed at boot so it only needs to be read once
+static unsigned long long s_PerformanceFrequency = 0;
+#endif
+
+unsigned long long HighResClock::GetNanoseconds()
+{
+#ifdef _WIN32
+	if (s_PerformanceFrequency == 0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		s_PerformanceFrequency = (unsigned long long)frequency.QuadPart;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	unsigned long long ticks = (unsigned long long)counter.QuadPart;
+
+	// split into whole seconds and the remainder so the multiply can't overflow
+	unsigned long long seconds = ticks / s_PerformanceFrequency;
+	unsigned long long remainder = ticks % s_PerformanceFrequency;
+	return seconds * NANOSECONDS_PER_SECOND + (remainder * NANOSECONDS_PER_SECOND) / s_PerformanceFrequency;
+#else
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+unsigned long long HighResClock::GetMicroseconds()
+{
+	return GetNanoseconds() / 1000ULL;
+}
+
+double HighResClock::GetSeconds()
+{
+	return (double)GetNanoseconds() / (double)NANOSECONDS_PER_SECOND;
+}
@@ -22,13 +22,19 @@
 
 const GameViewId CB_INVALID_GAMEVIEW_ID = 0xffffffff;
 
-const unsigned int SCREEN_REFRESH_RATE(1000 / 60);
-
 HumanView::HumanView(shared_ptr<IRenderer> renderer)
 {
 	InitAudio();
 
-	m_pProcessManager = CB_NEW ProcessManager;
+	m_pProcessManager = CB_NEW ProcessManager(g_pApp->m_pJobSystem, "View");
+	if (g_pApp->m_Options.m_ProcessProfile)
+	{
+		m_pProcessManager->EnableProfiling(true);
+		m_pProcessManager->SetProfileDumpInterval(g_pApp->m_Options.m_ProcessProfileDumpInterval);
+		m_pProcessManager->SetProfileFrameBudget(g_pApp->m_Options.m_ProcessProfileFrameBudget);
+		if (!g_pApp->m_Options.m_ProcessProfileTrace.empty())
+			m_pProcessManager->SetProfileTraceFile(g_pApp->m_Options.m_ProcessProfileTrace + "_View.json");
+	}
 
 	m_PointerRadius = 1;
 	m_ViewId = CB_INVALID_GAMEVIEW_ID;
@@ -49,8 +55,6 @@ HumanView::HumanView(shared_ptr<IRenderer> renderer)
 		m_pScene->AddChild(INVALID_GAMEOBJECT_ID, m_pCamera);
 		m_pScene->SetCamera(m_pCamera);
 	}
-
-	m_LastDraw = 0;
 }
 
 HumanView::~HumanView()
@@ -105,39 +109,34 @@ HRESULT HumanView::OnRestore()
 
 void HumanView::OnRender(float time, float deltaTime)
 {
-	m_CurrTick = timeGetTime();
-	if (m_CurrTick = m_LastDraw)
-		return;
+	// the application paces the frames, so draw every call with moving objects between the last two simulation ticks
+	if (m_pScene)
+	{
+		m_pScene->SetInterpolation(g_pApp->m_Timestep.GetInterpolation());
+	}
 
-	// Is it time to draw?
-	if (m_RunFullSpeed || (m_CurrTick - m_LastDraw) > SCREEN_REFRESH_RATE)
+	// pre-render the scene
+	if (g_pApp->m_Renderer->PreRender())
 	{
-		// pre-render the scene
-		if (g_pApp->m_Renderer->PreRender())
+		// sort UI screen elements 
+		m_ScreenElements.sort(SortBy_SharedPtr_Content<IScreenElement>());
+		
+		// render screen elements
+		for (ScreenElementList::iterator it = m_ScreenElements.begin(); it != m_ScreenElements.end(); ++it)
 		{
-			// sort UI screen elements 
-			m_ScreenElements.sort(SortBy_SharedPtr_Content<IScreenElement>());
-			
-			// render screen elements
-			for (ScreenElementList::iterator it = m_ScreenElements.begin(); it != m_ScreenElements.end(); ++it)
+			if ((*it)->IsVisible())
 			{
-				if ((*it)->IsVisible())
-				{
-					(*it)->OnRender(time, deltaTime);
-				}
+				(*it)->OnRender(time, deltaTime);
 			}
-
-			RenderText();
-
-			// render the console
-			m_Console.Render();
-
-			// record the last successful draw
-			m_LastDraw = m_CurrTick;
 		}
 
-		g_pApp->m_Renderer->PostRender();
+		RenderText();
+
+		// render the console
+		m_Console.Render();
 	}
+
+	g_pApp->m_Renderer->PostRender();
 }
 
 HRESULT HumanView::OnLostDevice()
@@ -28,6 +28,9 @@ public:
 	/// Name of the component
 	static const char* g_Name;
 
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
+
 private:
 	/// Name of the audio resource for this component
 	std::string m_AudioResource;
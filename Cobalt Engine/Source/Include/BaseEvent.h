@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "EventStream.h"
 #include "interfaces.h"
 
 /**
@@ -31,6 +32,12 @@ public:
 	/// Deserialize an event from an input stream
 	virtual void Deserialize(std::istream& in) { }
 
+	/// Serialize the event to a compact binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const { }
+
+	/// Deserialize an event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in) { return true; }
+
 private:
 	/// Time that the event occured
 	const float m_TimeStamp;
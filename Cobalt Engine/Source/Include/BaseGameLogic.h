@@ -8,6 +8,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include "GameObjectFactory.h"
 #include "interfaces.h"
@@ -32,6 +33,7 @@ enum BaseGameState
 class IGamePhysics;
 class PathingGraph;
 class LevelManager;
+class ProcessManager;
 
 /*
 	This is the base class for a game's logic layer. It inherits from the
@@ -70,6 +72,9 @@ public:
 	/// Return the random number generator
 	RandomGenerator& GetRNG();
 
+	/// Return a checksum of every game object's transform, used to detect replays that desync
+	unsigned int GetTransformChecksum() const;
+
 	/// Attach a view to the game logic
 	virtual void AddView(shared_ptr<IGameView> pView, GameObjectId id = INVALID_GAMEOBJECT_ID);
 
@@ -83,9 +88,19 @@ public:
 	virtual StrongGameObjectPtr CreateGameObject(const std::string& objectResource, TiXmlElement* overrides,
 		const Mat4x4* initialTransform = nullptr, const GameObjectId serversObjectId = INVALID_GAMEOBJECT_ID);
 
+	/// Create a batch of game objects from the same resource, one at each position -- returns how many were created
+	virtual unsigned int CreateGameObjects(const std::string& objectResource, TiXmlElement* overrides, const std::vector<Vec3>& positions,
+		std::vector<StrongGameObjectPtr>* pCreatedObjects = nullptr, const std::vector<GameObjectId>* pServersObjectIds = nullptr);
+
 	/// Destroy a game object
 	virtual void DestroyGameObject(const GameObjectId id);
 
+	/// Destroy a game object at the end of the current update
+	void QueueDestroyGameObject(const GameObjectId id);
+
+	/// Destroy a batch of game objects at the end of the current update
+	void QueueDestroyGameObjects(const std::vector<GameObjectId>& ids);
+
 	/// Modify a game object
 	virtual void ModifyGameObject(const GameObjectId id, TiXmlElement* overrides);
 
@@ -125,6 +140,9 @@ public:
 	/// Attach a process to the game logic
 	void AttachProcess(StrongProcessPtr pProcess);
 
+	/// Return the game logic's process manager
+	ProcessManager* GetProcessManager() { return m_pProcessManager; }
+
 	/// Event delegate for destroying a game object
 	void RequestDestroyGameObjectDelegate(IEventPtr pEvent);
 
@@ -135,12 +153,21 @@ protected:
 	/// Load game delegate, override this for game-specific loading
 	virtual bool LoadGameDelegate(TiXmlElement* pLevelDate);
 
+	/// Destroy every object queued for destruction, called at the end of OnUpdate()
+	void DestroyQueuedGameObjects();
+
+	/// Tell the clients about a batch of new objects, split into events that each fit in a network packet
+	void BroadcastNewGameObjects(const std::string& objectResource, const std::vector<GameObjectId>& ids, const std::vector<Vec3>& positions);
+
 	/// Event delegate for moving a game object
 	void MoveGameObjectDelegate(IEventPtr pEvent);
 
 	/// Event delegate for creating a new game object
 	void RequestNewGameObjectDelegate(IEventPtr pEvent);
 
+	/// Event delegate for creating a batch of new game objects
+	void RequestNewGameObjectsDelegate(IEventPtr pEvent);
+
 protected:
 	/// How long this game has been in session
 	float m_LifeTime;
@@ -154,6 +181,9 @@ protected:
 	/// Map of game objects in this logic
 	GameObjectMap m_Objects;
 
+	/// Objects to destroy at the end of the update, so nothing is removed while the objects are being iterated
+	std::vector<GameObjectId> m_DestroyQueue;
+
 	/// The id of the last game object created
 	GameObjectId m_LastObjectId;
 
@@ -0,0 +1,124 @@
+/*
+	CoroutineProcess.h
+
+	A process whose behavior is written as one sequential body that
+	can wait on delays, events, other processes and jobs.
+*/
+
+#pragma once
+
+#include "JobSystem.h"
+#include "Process.h"
+
+// Marks the start of a coroutine body inside Run()
+#define CB_CO_BEGIN switch (m_ResumePoint) { case 0:
+
+// Marks the end of a coroutine body, the process succeeds when it gets here
+#define CB_CO_END } if (GetState() == Process::RUNNING) Succeed();
+
+// Return from Run() and carry on from here. __COUNTER__ is used since __LINE__ is not a
+// constant with Edit and Continue, the argument is expanded once so both uses match
+#define CB_CO_SUSPEND_AT(resumePoint) m_ResumePoint = (resumePoint); return; case (resumePoint):;
+
+// Carry on from here next frame
+#define CB_CO_YIELD() do { CB_CO_SUSPEND_AT(__COUNTER__ + 1) } while (0)
+
+// Carry on from here once seconds have passed, the process sleeps and is not updated in between
+#define CB_CO_AWAIT_DELAY(seconds) do { Sleep(seconds); CB_CO_SUSPEND_AT(__COUNTER__ + 1) } while (0)
+
+// Carry on from here once an event of the given type is sent, the process sleeps until then
+#define CB_CO_AWAIT_EVENT(eventType) do { SleepUntilEvent(eventType); CB_CO_SUSPEND_AT(__COUNTER__ + 1) } while (0)
+
+// Run another process, and its children, inside this one and carry on from here once it is done
+#define CB_CO_AWAIT_PROCESS(pProcess) do { AwaitProcess(pProcess); CB_CO_SUSPEND_AT(__COUNTER__ + 1) } while (0)
+
+// Run a job on the global job system and carry on from here once it and its children have finished
+#define CB_CO_AWAIT_JOB(pJob) do { AwaitJob(pJob); CB_CO_SUSPEND_AT(__COUNTER__ + 1) } while (0)
+
+/**
+	Base class for processes written as coroutines. Instead of a state machine in OnUpdate(),
+	derived classes write their whole behavior in Run() between CB_CO_BEGIN and CB_CO_END and
+	wait with the CB_CO_AWAIT macros. Each await returns from Run() and the next call picks up
+	where it left off.
+
+	The coroutine is stackless, its frame is the process object itself. Waiting does not
+	allocate anything, but local variables do not survive an await, so anything the body
+	needs afterward has to be a member. Run() can not use a switch statement of its own
+	around an await.
+
+	Delays and events put the process to sleep in the process manager, so a waiting coroutine
+	costs nothing per frame. An awaited process is owned and updated by the coroutine, and
+	when the coroutine is aborted it aborts the awaited process the same way AbortAllProcesses()
+	does. An awaited job may use the process, so the coroutine waits for it when it fails, is
+	aborted or is removed by its owner. Derived classes that override OnFail(), OnAbort() or
+	OnRemove() must call this version.
+
+	Usage:
+	void OpenDoorProcess::Run(float deltaTime)
+	{
+		CB_CO_BEGIN
+		CB_CO_AWAIT_EVENT(Event_PlayerNearDoor::sk_EventType);
+		CB_CO_AWAIT_PROCESS(StrongProcessPtr(CB_NEW SlideDoorProcess(m_DoorId)));
+		CB_CO_AWAIT_DELAY(5.0f);
+		CB_CO_AWAIT_PROCESS(StrongProcessPtr(CB_NEW SlideDoorProcess(m_DoorId, true)));
+		CB_CO_END
+	}
+*/
+class CoroutineProcess : public Process
+{
+public:
+	/// Default constructor
+	CoroutineProcess();
+
+	/// Virtual destructor, an awaited job must have finished by now
+	virtual ~CoroutineProcess();
+
+	/// Return the final state of the last awaited process, ex. to check if it failed
+	State GetAwaitedState() const { return m_AwaitedState; }
+
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "CoroutineProcess"; }
+
+protected:
+	/// The body of the coroutine
+	virtual void Run(float deltaTime) = 0;
+
+	/// Update method resumes the body once whatever it awaits is done
+	virtual void OnUpdate(float deltaTime) override;
+
+	/// Fail method waits for an awaited job
+	virtual void OnFail() override;
+
+	/// Abort method aborts the awaited process and waits for an awaited job
+	virtual void OnAbort() override;
+
+	/// Remove method releases an awaited process and waits for an awaited job before the owner releases this one
+	virtual void OnRemove() override;
+
+	/// Start owning and updating a process until it and its children are done -- use CB_CO_AWAIT_PROCESS()
+	void AwaitProcess(const StrongProcessPtr& pProcess);
+
+	/// Start a job and wait for it -- use CB_CO_AWAIT_JOB()
+	void AwaitJob(const JobPtr& pJob);
+
+private:
+	/// Run the awaited process for a frame the way the process manager would -- returns true once it is done
+	bool UpdateAwaitedProcess(float deltaTime);
+
+	/// Block until an awaited job has finished, running other jobs meanwhile
+	void WaitForAwaitedJob();
+
+protected:
+	/// Where the body picks up on the next call to Run()
+	int m_ResumePoint;
+
+private:
+	/// Process the body is waiting on
+	StrongProcessPtr m_pAwaitedProcess;
+
+	/// Final state of the last awaited process
+	State m_AwaitedState;
+
+	/// Job the body is waiting on
+	JobPtr m_pAwaitedJob;
+};
@@ -21,7 +21,7 @@ class D3DSdkMeshResourceExtraData11 : public IResourceExtraData
 
 public:
 	/// Default constructor
-	D3DSdkMeshResourceExtraData11() { }
+	D3DSdkMeshResourceExtraData11() : m_MemorySize(0) { }
 
 	/// Virtual Destructor
 	~D3DSdkMeshResourceExtraData11() { }
@@ -29,8 +29,15 @@ public:
 	/// Returns a string describing the extra data
 	virtual std::string ToStr() { return "D3DSdkMeshResourceExtraData11"; }
 
+	/// Return an estimate of the bytes the mesh takes outside the raw buffer
+	virtual unsigned int GetMemorySize() { return m_MemorySize; }
+
 	/// The actual SDK mesh
 	CDXUTSDKMesh m_Mesh11;
+
+protected:
+	/// Estimate of the mesh's own copy of the data plus its vertex and index buffers
+	unsigned int m_MemorySize;
 };
 
 /**
@@ -31,6 +31,9 @@ public:
 	/// Returns a string describing the extra this extra data
 	virtual std::string ToStr();
 
+	/// Return the bytes the texture takes in video memory, all mip levels included
+	virtual unsigned int GetMemorySize();
+
 	/// Return a pointer to the texture object
 	const LPDIRECT3DTEXTURE9 GetTexture();
 
@@ -58,6 +61,9 @@ public:
 	/// Returns a string describing the extra this extra data
 	virtual std::string ToStr();
 
+	/// Return the bytes the texture takes in video memory, all mip levels and array slices included
+	virtual unsigned int GetMemorySize();
+
 	/// Return a pointer to the shader resource view that holds the texture
 	ID3D11ShaderResourceView** GetTexture();
 
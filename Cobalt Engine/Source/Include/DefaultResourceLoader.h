@@ -9,7 +9,7 @@
 
 #include <string>
 
-#include "interfaces.h"
+#include "ResourceInterfaces.h"
 
 /**
 	Used to load resources that need no additional processing on load. It will use the
@@ -28,6 +28,9 @@ public:
 	/// Return true and release the raw buffer 
 	virtual bool DiscardRawBufferAfterLoad() { return true; }
 
+	/// Return true, there is nothing to do that needs the main thread
+	virtual bool IsThreadSafe() { return true; }
+
 	/// Return the raw size
 	virtual unsigned int GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize) { return rawSize; }
 
@@ -25,6 +25,12 @@ public:
 		m_ElapsedTime(0)
 	{}
 
+	/// Counting down only touches the process itself
+	virtual bool IsParallelSafe() const override { return true; }
+
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "DelayedProcess"; }
+
 protected:
 	/// Update function will succeed after the delay timer
 	virtual void OnUpdate(const float deltaTime)
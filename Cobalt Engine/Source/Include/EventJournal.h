@@ -0,0 +1,178 @@
+/*
+	EventJournal.h
+
+	Records every event that passes through the event manager to
+	a compact binary file, and plays the file back so a session
+	can be reproduced offline.
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "EventStream.h"
+#include "interfaces.h"
+
+class BaseGameLogic;
+
+// number of bytes buffered in memory before they are written to the journal file
+const size_t EVENTJOURNAL_FLUSH_SIZE = 64 * 1024;
+
+// number of frames between transform checksums
+const unsigned int EVENTJOURNAL_CHECKSUM_INTERVAL = 30;
+
+/// The kinds of record stored in a journal file
+enum EventJournalRecord
+{
+	JournalRecord_Frame,			// start of a frame with its time and delta time
+	JournalRecord_QueueEvent,		// event passed to QueueEvent()
+	JournalRecord_TriggerEvent,		// event passed to TriggerEvent()
+	JournalRecord_ThreadSafeEvent,	// event from ThreadSafeQueueEvent(), recorded when the event manager pulls it in
+	JournalRecord_Checksum			// checksum of every object's transform at the end of a frame
+};
+
+/**
+	Journal of every event the event manager sees, with a marker at the start of each frame
+	and the random seed of the game logic in the header. Events are written with their binary
+	serialization into a memory buffer that is flushed to the file once it fills up.
+
+	During replay the journal is the only source of events. Live events from game code are
+	dropped, since the logic regenerates them, and the recorded copies are fed back at the same
+	point in the frame: thread safe events before the event manager update, queued and triggered
+	events at the end of the frame. Checksums of the object transforms are compared along the way
+	so a desync is reported on the frame it happens. Frames where the event manager ran out of
+	time may defer different events than the recorded run did.
+
+	Event types that only matter to the views and cannot be serialized, like render components,
+	can be ignored. They are not recorded and always pass straight through, even during replay.
+
+	Usage (once per frame):
+	pJournal->BeginFrame(time, deltaTime);	// recorded time is written back during replay
+	pEventManager->Update(maxMillis);
+	pLogic->OnUpdate(time, deltaTime);
+	pJournal->EndFrame();
+*/
+class EventJournal
+{
+	typedef std::vector<std::pair<EventJournalRecord, IEventPtr>> JournalEventList;
+
+	/// A checksum read from the journal
+	struct JournalChecksum
+	{
+		unsigned long m_Frame;
+		unsigned long m_Checksum;
+	};
+
+public:
+	/// Default constructor
+	EventJournal();
+
+	/// Destructor closes the journal file
+	~EventJournal();
+
+	/// Start recording to a file -- the logic's random generator is reseeded so replay can start from the same sequence
+	bool StartRecording(const std::string& fileName, BaseGameLogic* pLogic);
+
+	/// Load a journal and start replaying it into the logic -- the logic's random generator is seeded from the journal
+	bool StartReplay(const std::string& fileName, BaseGameLogic* pLogic);
+
+	/// Stop recording or replaying, writes the final checksum when recording
+	void Stop();
+
+	/// Replay every remaining frame without a window -- returns true if every checksum matched
+	bool ReplayAll(unsigned long maxMillis = IEventManager::kINFINITE);
+
+	/// Start a frame -- during replay time and deltaTime are replaced by the recorded values. Returns false when the replay runs out of frames
+	bool BeginFrame(float& time, float& deltaTime);
+
+	/// End a frame -- feeds the recorded events back during replay and writes or checks the transform checksum
+	void EndFrame();
+
+	/// Called by the event manager for every event. Records it, or returns false if the event should be dropped during replay
+	bool OnEvent(const IEventPtr& pEvent, EventJournalRecord record);
+
+	/// Never record this event type and always let it through
+	void IgnoreEventType(const EventType& type) { m_IgnoredTypes.insert(type); }
+
+	/// Return true if the journal is recording
+	bool IsRecording() const { return m_pFile != nullptr; }
+
+	/// Return true if the journal is replaying
+	bool IsReplaying() const { return m_pReplayLogic != nullptr; }
+
+	/// Return the number of checksums that did not match during replay
+	unsigned int GetNumChecksumMismatches() const { return m_NumChecksumMismatches; }
+
+private:
+	/// Write a record to the buffer
+	void WriteEvent(const IEventPtr& pEvent, EventJournalRecord record);
+
+	/// Write a checksum record for the current frame
+	void WriteChecksum();
+
+	/// Write the buffered bytes to the file
+	void Flush();
+
+	/// Flush and close the file
+	void CloseFile();
+
+	/// Read records up to the start of the next frame -- returns false if the data is malformed
+	bool ReadRecords();
+
+	/// Feed the recorded queued and triggered events back to the event manager
+	void InjectPendingEvents();
+
+	/// Compare a recorded checksum with the logic's current transforms
+	void VerifyChecksum(const JournalChecksum& checksum);
+
+private:
+	/// Event types that are never recorded
+	std::unordered_set<EventType> m_IgnoredTypes;
+
+	/// Number of the current frame
+	unsigned long m_FrameNumber;
+
+	/// File being recorded to
+	FILE* m_pFile;
+
+	/// Logic being recorded
+	BaseGameLogic* m_pRecordLogic;
+
+	/// Records waiting to be written to the file
+	EventWriteStream m_Buffer;
+
+	/// Scratch stream each event is serialized into before it is buffered
+	EventWriteStream m_EventData;
+
+	/// Logic being replayed into
+	BaseGameLogic* m_pReplayLogic;
+
+	/// Contents of the journal being replayed
+	std::vector<char> m_ReplayData;
+
+	/// Reads records out of m_ReplayData
+	EventReadStream m_ReplayStream;
+
+	/// True once the start of the next frame has been read
+	bool m_HasNextFrame;
+
+	/// Recorded time and delta time of the next frame
+	float m_NextFrameTime;
+	float m_NextFrameDeltaTime;
+
+	/// Recorded queued and triggered events for the current frame, fed back at the end of the frame
+	JournalEventList m_PendingEvents;
+
+	/// Recorded checksums for the current frame
+	std::vector<JournalChecksum> m_PendingChecksums;
+
+	/// Set while the journal feeds its own events to the event manager
+	bool m_Injecting;
+
+	/// Number of checksums that did not match
+	unsigned int m_NumChecksumMismatches;
+};
@@ -9,23 +9,113 @@
 
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 #include "interfaces.h"
 #include "templates.h"
+#include "EventPool.h"
+#include "JobSystem.h"
+
+class EventJournal;
 
 // Multiple Queues are used so that listener delegate functions can queue up more 
 // events in the event queue without causing an endless loop of queueing
 const unsigned int EVENTMANAGER_NUM_QUEUES = 2;
 
+// Max number of events other threads can have in flight between updates
+const unsigned int EVENTMANAGER_REALTIME_QUEUE_SIZE = 4096;
+
+/// Priority lanes for queued events. Every lane is processed in order each update, so when
+/// time runs out it is the lower priority lanes that get deferred to the next update.
+enum EventLane
+{
+	EventLane_Critical,		// input and network events that should never wait
+	EventLane_Normal,		// default lane for gameplay events
+	EventLane_Cosmetic,		// sound and visual events that can slip a frame
+	EventLane_Count			// not a lane - a counter for for-loops
+};
+
+/// Number of events each lane processed or deferred during an update
+struct EventLaneReport
+{
+	unsigned int m_NumProcessed[EventLane_Count];
+	unsigned int m_NumDeferred[EventLane_Count];
+};
+
+/// Traffic counters for one event type, collected while event stats are enabled
+struct EventTypeStats
+{
+	EventTypeStats() :
+		m_Type(0), m_pName(nullptr), m_NumQueued(0), m_NumTriggered(0), m_NumDropped(0), m_NumListeners(0), m_ListenerTimeNS(0)
+	{ }
+
+	EventType m_Type;
+	const char* m_pName;				// name of the event, set the first time one is seen
+	unsigned long m_NumQueued;			// events accepted by QueueEvent()
+	unsigned long m_NumTriggered;		// events sent through TriggerEvent()
+	unsigned long m_NumDropped;			// events QueueEvent() dropped because nothing was listening
+	unsigned int m_NumListeners;		// live listeners, filled in when the stats are queried
+	unsigned long long m_ListenerTimeNS;	// total time spent inside listeners for this type
+};
+
+// Returns the key that identifies which queued events of the same type an event replaces, ex. an object id
+typedef unsigned int (*EventCoalesceKeyFunction)(const IEventPtr& pEvent);
+
 /**
 	Manages events for the game. This class is a global singleton responsible for mapping
 	event types to listeners.
+
+	Listeners for each event type are stored in a contiguous array so dispatch is a linear
+	walk over memory. Listeners removed while an event is being dispatched are cleared in
+	place and compacted out at the start of the next Update(), so the arrays never shift
+	under a running dispatch. Listeners added during dispatch will receive the next event.
+
+	Queued events and the coalesce index are stored in containers whose nodes come from
+	event pools, so once the pools have warmed up queueing an event does not touch the heap.
+
+	Listeners can be flagged as concurrent safe when they are added. If every listener for a
+	queued event is flagged, Update() collects the event into a batch that is dispatched across
+	the job system once the serial events are done, and waits for the batch to finish before
+	returning. The wait never runs main thread jobs. Each event set aside counts the time an
+	event took in the last batch against the deadline. Serial listeners are always called on
+	the main thread in queue order. Concurrent listeners must not add or remove listeners and
+	should only use ThreadSafeQueueEvent().
 */
 class EventManager : public IEventManager
 {
-	typedef std::list<EventListenerDelegate> EventListenerList;
-	typedef std::unordered_map<EventType, EventListenerList> EventListenerMap;
-	typedef std::list<IEventPtr> EventQueue;
+	typedef std::vector<EventListenerDelegate> EventListenerList;
+
+	/// All of the listeners for one event type
+	struct EventListenerTable
+	{
+		EventListenerTable() : m_NumSerialListeners(0) { }
+
+		/// Listener delegates in the order they were added
+		EventListenerList m_Listeners;
+
+		/// Parallel to m_Listeners, 1 if the listener was flagged concurrent safe
+		std::vector<unsigned char> m_ConcurrentSafe;
+
+		/// Number of live listeners that are not concurrent safe
+		unsigned int m_NumSerialListeners;
+	};
+
+	/// An event waiting on the concurrent batch and the listeners it goes to
+	struct ConcurrentDispatch
+	{
+		IEventPtr m_pEvent;
+		const EventListenerList* m_pListeners;
+		size_t m_NumListeners;
+		unsigned long long m_ListenerTimeNS;
+	};
+
+	typedef std::unordered_map<EventType, EventListenerTable> EventListenerMap;
+	typedef std::list<IEventPtr, EventPoolAllocator<IEventPtr> > EventQueue;
+	typedef std::unordered_map<EventType, EventLane> EventLaneMap;
+	typedef std::unordered_map<EventType, EventCoalesceKeyFunction> EventCoalescePolicyMap;
+	typedef std::unordered_map<unsigned long long, EventQueue::iterator, std::hash<unsigned long long>, std::equal_to<unsigned long long>,
+		EventPoolAllocator<std::pair<const unsigned long long, EventQueue::iterator> > > EventCoalesceIndex;
+	typedef std::unordered_map<EventType, EventTypeStats> EventStatsMap;
 
 public:
 	/// Constructor to set the event manager global or not
@@ -35,7 +125,7 @@ public:
 	virtual ~EventManager();
 
 	/// Registers a delegate function that will get called when the event type is triggered -- returns true if successful
-	virtual bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type);
+	virtual bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type, bool concurrentSafe = false);
 
 	/// Remove a delegate/event type pairing -- returns false if the pairing is not found
 	virtual bool RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type);
@@ -55,18 +145,137 @@ public:
 	/// Process events from the queue and optionally limit the processing time
 	virtual bool Update(unsigned long maxMillis = kINFINITE);
 
+	/// Set which lane queued events of this type are processed in -- types default to EventLane_Normal
+	void SetEventLane(const EventType& type, EventLane lane);
+
+	/// Return the lane queued events of this type are processed in
+	EventLane GetEventLane(const EventType& type) const;
+
+	/// Return how many events each lane processed and deferred during the last update
+	const EventLaneReport& GetLastUpdateReport() const { return m_LastUpdateReport; }
+
+	/// Opt an event type in to coalescing -- a queued event replaces any event of the same type and key still waiting in the queue
+	void SetCoalescePolicy(const EventType& type, EventCoalesceKeyFunction keyFunction);
+
+	/// Stop coalescing an event type
+	void RemoveCoalescePolicy(const EventType& type);
+
+	/// Return the total number of queued events that were replaced by a newer event
+	unsigned long GetNumCoalescedEvents() const { return m_NumCoalescedEvents; }
+
+	/// Set the job system used to dispatch events to concurrent safe listeners -- without one they are called on the main thread
+	void SetJobSystem(JobSystem* pJobSystem) { m_pJobSystem = pJobSystem; }
+
+	/// Return the number of thread safe events that were dropped because the real time queue was full
+	unsigned long GetRealTimeOverflowCount() const { return m_RealTimeEventQueue.GetOverflowCount(); }
+
+	/// Set the journal that records events or replays them -- pass nullptr to detach it
+	void SetJournal(EventJournal* pJournal) { m_pJournal = pJournal; }
+
+	/// Turn per event type traffic counters on or off -- they cost a branch per event when off
+	void EnableStats(bool enable) { m_StatsEnabled = enable; }
+
+	/// Return true if per event type traffic counters are being collected
+	bool IsStatsEnabled() const { return m_StatsEnabled; }
+
+	/// Fill in the counters for an event type -- returns false if nothing has been recorded for it
+	bool GetEventStats(const EventType& type, EventTypeStats& stats) const;
+
+	/// Fill in the counters for every event type that has been recorded
+	void GetAllEventStats(std::vector<EventTypeStats>& stats) const;
+
+	/// Zero every counter
+	void ResetStats() { m_EventStats.clear(); }
+
+	/// Write the counters to the "EventStats" log, busiest listeners first
+	void DumpStats() const;
+
+	/// Dump the counters from Update() every intervalMillis while stats are enabled -- 0 turns it off
+	void SetStatsDumpInterval(unsigned long intervalMillis) { m_StatsDumpIntervalMillis = intervalMillis; }
+
+private:
+	/// Add an event to the active queue without passing it through the journal
+	bool EnqueueEvent(const IEventPtr& pEvent);
+
+	/// Combine an event type and coalesce key into a single key for the coalesce index
+	static unsigned long long MakeCoalesceKey(const EventType& type, unsigned int key);
+
+	/// Add the deferred events from the front of a lane up to lastIt to the active coalesce index,
+	/// merging any that share a key with an event queued since
+	void IndexDeferredEvents(EventQueue& queue, EventQueue::iterator lastIt);
+
+	/// Remove the cleared out listeners from any arrays that were modified during dispatch
+	void CompactListeners();
+
+	/// Send the events collected for concurrent safe listeners across the job system and wait for them
+	void DispatchConcurrentBatch();
+
+	/// Return the counters for an event's type, creating them the first time the type is seen
+	EventTypeStats& GetStatsForEvent(const IEventPtr& pEvent) const;
+
+	/// Return the number of listeners for a type that have not been removed
+	unsigned int CountLiveListeners(const EventType& type) const;
+
 private:
 	/// Map from event types to lists of listeners for that type
 	EventListenerMap m_EventListeners;
 
-	/// Event queues for processing queued events
-	EventQueue m_Queues[EVENTMANAGER_NUM_QUEUES];
+	/// Event types with listeners that were removed during dispatch and need compacting
+	std::vector<EventType> m_PendingCompaction;
+
+	/// How many dispatches are currently running -- listeners are only erased when this is 0
+	mutable unsigned int m_DispatchDepth;
+
+	/// Event queues for processing queued events, one per lane
+	EventQueue m_Queues[EVENTMANAGER_NUM_QUEUES][EventLane_Count];
 
 	/// Which queue being actively processed
 	int m_ActiveQueue;
 
+	/// Map from event types to the lane they are processed in
+	EventLaneMap m_EventLanes;
+
+	/// Processed and deferred counts from the last update
+	EventLaneReport m_LastUpdateReport;
+
+	/// Map from event types that coalesce to the function that returns their key
+	EventCoalescePolicyMap m_CoalescePolicies;
+
+	/// Position of the queued event for each coalescing type and key, one per queue
+	EventCoalesceIndex m_CoalesceIndex[EVENTMANAGER_NUM_QUEUES];
+
+	/// Total number of queued events replaced by a newer event
+	unsigned long m_NumCoalescedEvents;
+
+	/// Events from this update whose listeners are all concurrent safe
+	std::vector<ConcurrentDispatch> m_ConcurrentBatch;
+
+	/// Time per event the last concurrent batch took, the events waiting on the next one are counted against the deadline with it
+	unsigned long long m_ConcurrentEventNS;
+
+	/// Job system for concurrent dispatch, not owned by the event manager
+	JobSystem* m_pJobSystem;
+
 	/// Thread safe event queue
 	ThreadSafeEventQueue m_RealTimeEventQueue;
+
+	/// Overflow count at the last update, used to report new drops
+	unsigned long m_LastRealTimeOverflowCount;
+
+	/// Journal that records or replays events, not owned by the event manager
+	EventJournal* m_pJournal;
+
+	/// Whether traffic counters are collected
+	bool m_StatsEnabled;
+
+	/// Traffic counters for each event type, mutable so TriggerEvent() can count
+	mutable EventStatsMap m_EventStats;
+
+	/// How often Update() dumps the counters, 0 for never
+	unsigned long m_StatsDumpIntervalMillis;
+
+	/// Time of the last dump
+	unsigned long long m_LastStatsDumpNS;
 };
 
 
@@ -0,0 +1,153 @@
+/*
+	EventPool.h
+
+	Pooled allocation for high frequency events. Events made with
+	MakePooledEvent() are still handed around as a regular IEventPtr,
+	but the event and its reference count live together in a single
+	chunk from a per event type MemoryPool instead of on the heap.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "MemoryPool.h"
+
+// number of events each block in an event pool holds
+const unsigned int EVENTPOOL_CHUNKS_PER_BLOCK = 256;
+
+/**
+	A thread safe wrapper around a MemoryPool that hands out fixed size
+	chunks for one event type. The pool is initialized on the first
+	allocation and grows a block at a time, so once a game has warmed up
+	allocating and freeing events never touches the heap.
+*/
+class EventMemoryPool
+{
+public:
+	/// Constructor sets the size of the chunks this pool hands out
+	explicit EventMemoryPool(unsigned int chunkSize);
+
+	/// Allocate a chunk from the pool
+	void* Alloc();
+
+	/// Return a chunk to the pool
+	void Free(void* pMem);
+
+	/// Return the number of chunks currently handed out by this pool
+	unsigned long GetNumActive() const { return m_NumActive; }
+
+	/// Return the number of blocks all event pools have allocated from the heap
+	static unsigned long GetTotalBlockAllocations() { return s_TotalBlockAllocations.load(); }
+
+private:
+	/// The pool of chunks
+	MemoryPool m_Pool;
+
+	/// Guards the pool since events can be created on other threads
+	std::mutex m_Mutex;
+
+	/// Size of a single chunk
+	unsigned int m_ChunkSize;
+
+	/// Number of chunks currently handed out
+	unsigned long m_NumActive;
+
+	/// Number of blocks all event pools have allocated from the heap
+	static std::atomic<unsigned long> s_TotalBlockAllocations;
+};
+
+
+/**
+	Standard library allocator that pulls single objects from an EventMemoryPool.
+	Each rebound type gets its own pool sized for that type, which lets
+	std::allocate_shared place the event and its shared_ptr control block
+	in one pooled chunk.
+*/
+template<class T>
+class EventPoolAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<class U>
+	struct rebind
+	{
+		typedef EventPoolAllocator<U> other;
+	};
+
+	EventPoolAllocator() { }
+
+	template<class U>
+	EventPoolAllocator(const EventPoolAllocator<U>&) { }
+
+	/// Allocate room for n objects -- single objects come from the pool
+	pointer allocate(size_type n, const void* = nullptr)
+	{
+		if (n == 1)
+			return static_cast<pointer>(s_Pool.Alloc());
+
+		return static_cast<pointer>(::operator new(n * sizeof(T)));
+	}
+
+	/// Release memory returned by allocate()
+	void deallocate(pointer p, size_type n)
+	{
+		if (n == 1)
+			s_Pool.Free(p);
+		else
+			::operator delete(p);
+	}
+
+	template<class U, class... Args>
+	void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+
+	template<class U>
+	void destroy(U* p) { p->~U(); }
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+	size_type max_size() const { return ((size_t)-1) / sizeof(T); }
+
+	/// Return the pool that backs this type
+	static const EventMemoryPool& GetPool() { return s_Pool; }
+
+private:
+	/// The pool for this type
+	static EventMemoryPool s_Pool;
+};
+
+template<class T>
+EventMemoryPool EventPoolAllocator<T>::s_Pool(sizeof(T));
+
+template<class T, class U>
+bool operator==(const EventPoolAllocator<T>&, const EventPoolAllocator<U>&) { return true; }
+
+template<class T, class U>
+bool operator!=(const EventPoolAllocator<T>&, const EventPoolAllocator<U>&) { return false; }
+
+
+/**
+	Create an event from its pool. The returned pointer converts to an IEventPtr
+	and can be cast, queued and copied exactly like an event made with CB_NEW.
+
+	Usage:
+	shared_ptr<Event_MoveGameObject> pEvent = MakePooledEvent<Event_MoveGameObject>(id, matrix);
+	IEventManager::Get()->QueueEvent(pEvent);
+*/
+template<class EventClass, class... Args>
+std::shared_ptr<EventClass> MakePooledEvent(Args&&... args)
+{
+	return std::allocate_shared<EventClass>(EventPoolAllocator<EventClass>(), std::forward<Args>(args)...);
+}
@@ -0,0 +1,153 @@
+/*
+	EventStream.h
+
+	Compact binary streams used to serialize events. Every field
+	is written with a fixed width in little endian byte order, so
+	the bytes are the same on every machine and nothing depends on
+	the locale the way the iostream text format does.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Mat4x4;
+class Vec3;
+
+/**
+	Growable buffer that events write their binary data into.
+
+	Quantization is opt in. When it is enabled, events are free to write
+	values with a known range in fewer bits using WriteQuantizedFloat().
+	Readers do not need to know whether it was enabled since events record
+	which layout they wrote.
+*/
+class EventWriteStream
+{
+public:
+	/// Constructor reserves room for a typical event
+	explicit EventWriteStream(bool allowQuantization = false);
+
+	/// Write an unsigned 8 bit value
+	void WriteUInt8(unsigned char value);
+
+	/// Write an unsigned 16 bit value
+	void WriteUInt16(unsigned short value);
+
+	/// Write an unsigned 32 bit value
+	void WriteUInt32(unsigned long value);
+
+	/// Write a signed 32 bit value
+	void WriteInt32(long value);
+
+	/// Write a bool as a single byte
+	void WriteBool(bool value);
+
+	/// Write a 32 bit IEEE float
+	void WriteFloat(float value);
+
+	/// Write a float in the range [minValue, maxValue] as a 16 bit fixed point value
+	void WriteQuantizedFloat(float value, float minValue, float maxValue);
+
+	/// Write a string as a 16 bit length followed by the characters
+	void WriteString(const std::string& value);
+
+	/// Write a vector as 3 floats
+	void WriteVec3(const Vec3& value);
+
+	/// Write a matrix as 16 floats
+	void WriteMat4x4(const Mat4x4& value);
+
+	/// Write raw bytes with no length
+	void WriteBytes(const char* pData, size_t size);
+
+	/// Return true if events may write quantized values to this stream
+	bool AllowQuantization() const { return m_AllowQuantization; }
+
+	/// Return the bytes written so far
+	const char* GetData() const { return m_Buffer.empty() ? nullptr : &m_Buffer[0]; }
+
+	/// Return the number of bytes written so far
+	size_t GetSize() const { return m_Buffer.size(); }
+
+	/// Throw away everything written so far
+	void Clear() { m_Buffer.clear(); }
+
+private:
+	/// The written bytes
+	std::vector<char> m_Buffer;
+
+	/// Whether quantized writes are allowed
+	bool m_AllowQuantization;
+};
+
+
+/**
+	Reads back data written by an EventWriteStream. The stream does not own
+	the memory it reads from. Reading past the end of the data never touches
+	memory outside the buffer -- it returns 0 and marks the stream as failed,
+	so events can read every field and check IsValid() once at the end.
+*/
+class EventReadStream
+{
+public:
+	/// Constructor taking the buffer to read from
+	EventReadStream(const char* pData, size_t size);
+
+	/// Read an unsigned 8 bit value
+	unsigned char ReadUInt8();
+
+	/// Read an unsigned 16 bit value
+	unsigned short ReadUInt16();
+
+	/// Read an unsigned 32 bit value
+	unsigned long ReadUInt32();
+
+	/// Read a signed 32 bit value
+	long ReadInt32();
+
+	/// Read a bool
+	bool ReadBool();
+
+	/// Read a 32 bit IEEE float
+	float ReadFloat();
+
+	/// Read a float written by WriteQuantizedFloat() with the same range
+	float ReadQuantizedFloat(float minValue, float maxValue);
+
+	/// Read a string
+	std::string ReadString();
+
+	/// Read a vector
+	void ReadVec3(Vec3& value);
+
+	/// Read a matrix
+	void ReadMat4x4(Mat4x4& value);
+
+	/// Return a pointer to the next size raw bytes and skip over them -- nullptr if there are not enough left
+	const char* ReadBytes(size_t size);
+
+	/// Return false if a read ran past the end of the data
+	bool IsValid() const { return !m_Failed; }
+
+	/// Return the number of bytes that have not been read yet
+	size_t GetBytesRemaining() const { return m_Size - m_Position; }
+
+private:
+	/// Return a pointer to the next numBytes bytes or nullptr if there are not enough left
+	const unsigned char* Consume(size_t numBytes);
+
+private:
+	/// The data being read
+	const char* m_pData;
+
+	/// Size of the data
+	size_t m_Size;
+
+	/// Offset of the next byte to read
+	size_t m_Position;
+
+	/// Set when a read runs past the end of the data
+	bool m_Failed;
+};
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "BaseEvent.h"
+#include "EventPool.h"
 #include "GameObject.h"
 #include "HumanView.h"
 #include "Logger.h"
@@ -37,7 +38,7 @@ public:
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const
 	{
-		return IEventPtr(CB_NEW Event_UpdateTick(m_DeltaTime));
+		return MakePooledEvent<Event_UpdateTick>(m_DeltaTime);
 	}
 
 	/// Serialize the event
@@ -46,6 +47,12 @@ public:
 		CB_ERROR("Do not serialize update ticks");
 	}
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		CB_ERROR("Do not serialize update ticks");
+	}
+
 	/// Return the name of the event
 	virtual const char* GetName() const
 	{
@@ -90,6 +97,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -131,6 +144,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -165,6 +184,9 @@ public:
 	/// Return the tranformation
 	const Mat4x4& GetMatrix() const;
 
+	/// Coalesce key for the event manager -- only the latest move for each object needs to stay queued
+	static unsigned int GetCoalesceKey(const IEventPtr& pEvent);
+
 	// IEvent interface
 	/// Return the event type
 	virtual const EventType& GetEventType() const;
@@ -175,6 +197,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -222,6 +250,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -266,6 +300,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -318,6 +358,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -337,6 +383,63 @@ private:
 };
 
 
+/**
+	This event is sent by a server asking client proxy logics to create a batch of
+	objects from the same resource, ex. a wave of enemies. It carries the server id and
+	starting position of each object, which is all the object factory uses from a
+	transform, so a batch fits many objects in one network packet.
+*/
+class Event_RequestNewGameObjects : public BaseEvent
+{
+public:
+	/// Default constructor
+	Event_RequestNewGameObjects();
+
+	/// Constructor filling out the event
+	Event_RequestNewGameObjects(const std::string& objectResource, const std::vector<GameObjectId>& serverObjectIds, const std::vector<Vec3>& positions);
+
+	/// Return a string of the object resource
+	const std::string& GetObjectResource() const;
+
+	/// Return the server game object ids
+	const std::vector<GameObjectId>& GetServerObjectIds() const;
+
+	/// Return the starting positions, one for each id
+	const std::vector<Vec3>& GetPositions() const;
+
+	// IEvent interface
+	/// Return the event type
+	virtual const EventType& GetEventType() const;
+
+	/// Serialize the event to an output stream
+	virtual void Serialize(std::ostream& out) const;
+
+	/// Deserialize the event from an input stream
+	virtual void Deserialize(std::istream& in);
+
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
+	/// Return a copy of the event
+	virtual IEventPtr Copy() const;
+
+	/// Return the name of the event
+	virtual const char* GetName() const;
+
+public:
+	/// The event type
+	static const EventType sk_EventType;
+
+private:
+	std::string m_ObjectResource;
+	std::vector<GameObjectId> m_ServerObjectIds;
+	std::vector<Vec3> m_Positions;
+};
+
+
 /**
 	This event is sent by any system requesting that the game logic destroy a game object.
 */
@@ -362,6 +465,12 @@ public:
 	/// Deserialize the event from an input stream
 	virtual void Deserialize(std::istream& in);
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const;
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in);
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const;
 
@@ -491,6 +600,19 @@ public:
 		in >> m_SoundResource;
 	}
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteString(m_SoundResource);
+	}
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_SoundResource = in.ReadString();
+		return in.IsValid();
+	}
+
 	/// Return the sound resource
 	const std::string& GetResource() const
 	{
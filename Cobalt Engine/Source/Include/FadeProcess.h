@@ -23,6 +23,9 @@ public:
 	/// Update method called once per frame
 	virtual void OnUpdate(float deltaTime) override;
 
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "FadeProcess"; }
+
 protected:
 	/// The sound to be faded in or out
 	shared_ptr<SoundProcess> m_Sound;
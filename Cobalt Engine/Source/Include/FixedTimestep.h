@@ -0,0 +1,103 @@
+/*
+	FixedTimestep.h
+
+	Drives a simulation in ticks of a fixed length no matter how
+	long each frame takes.
+*/
+
+#pragma once
+
+#include <functional>
+
+// ticks per second used when no tick rate is given
+const float FIXEDTIMESTEP_DEFAULT_TICK_RATE = 60.0f;
+
+// most ticks run in one frame when catching up, the rest of the backlog is dropped
+const unsigned int FIXEDTIMESTEP_DEFAULT_MAX_TICKS = 5;
+
+/// Called once per tick with the simulation time at the end of the tick and the tick length in seconds
+typedef std::function<void(double time, float deltaTime)> TickFunction;
+
+/**
+	Accumulates real frame time and spends it in fixed ticks, so the cost and the result of
+	the simulation do not depend on the frame rate. A frame that is shorter than a tick runs
+	no ticks, and a long frame runs several up to a limit. Past the limit the backlog is
+	dropped and the simulation falls behind real time instead of spending ever longer frames
+	catching up.
+
+	The time left in the accumulator after a frame's ticks is how far real time has got
+	toward the next tick. GetInterpolation() returns it as a fraction, which the view uses to
+	blend between the last two ticks so motion stays smooth at any render rate.
+
+	A tick rate of 0 turns the fixed step off and runs exactly one tick per frame with the
+	frame's own length.
+
+	Nothing here depends on a window or a platform, so the same driver can run a simulation
+	headless, ex. RunTicks() to benchmark simulation throughput without real time.
+
+	Usage:
+	m_Timestep.Step(frameDeltaTime, [this](double time, float deltaTime) { m_pGame->OnUpdate((float)time, deltaTime); });
+	m_pScene->SetInterpolation(m_Timestep.GetInterpolation());
+*/
+class FixedTimestep
+{
+public:
+	/// Constructor taking the tick rate and the most ticks to run in one frame
+	explicit FixedTimestep(float ticksPerSecond = FIXEDTIMESTEP_DEFAULT_TICK_RATE, unsigned int maxTicksPerFrame = FIXEDTIMESTEP_DEFAULT_MAX_TICKS);
+
+	/// Set the number of ticks per second -- 0 runs one variable length tick per frame
+	void SetTickRate(float ticksPerSecond);
+
+	/// Set the most ticks to run in one frame
+	void SetMaxTicksPerFrame(unsigned int maxTicksPerFrame);
+
+	/// Add a frame's real time and run every tick that is due -- returns the number of ticks run
+	unsigned int Step(float deltaTime, const TickFunction& tick);
+
+	/// Run a number of ticks without waiting for real time, ex. for a headless benchmark
+	void RunTicks(unsigned int numTicks, const TickFunction& tick);
+
+	/// Throw away the time waiting in the accumulator, ex. after a load that took a long time
+	void Reset();
+
+	/// Return the length of a tick in seconds, or 0 if the step is variable
+	float GetTickDelta() const { return m_TickDelta; }
+
+	/// Return how far real time is between the last tick and the next one, from 0 to 1
+	float GetInterpolation() const { return m_Interpolation; }
+
+	/// Return the simulation time at the end of the last tick
+	double GetSimulationTime() const { return m_SimulationTime; }
+
+	/// Return the number of ticks run so far
+	unsigned long long GetNumTicks() const { return m_NumTicks; }
+
+	/// Return the number of ticks dropped because frames were too far behind
+	unsigned long long GetNumDroppedTicks() const { return m_NumDroppedTicks; }
+
+private:
+	/// Run a single tick
+	void RunTick(float deltaTime, const TickFunction& tick);
+
+private:
+	/// Length of a tick in seconds, 0 for a variable step
+	float m_TickDelta;
+
+	/// Most ticks to run in one frame
+	unsigned int m_MaxTicksPerFrame;
+
+	/// Real time that has not been spent on ticks yet
+	double m_Accumulator;
+
+	/// Fraction of a tick waiting in the accumulator
+	float m_Interpolation;
+
+	/// Simulation time at the end of the last tick
+	double m_SimulationTime;
+
+	/// Ticks run so far
+	unsigned long long m_NumTicks;
+
+	/// Ticks dropped so far
+	unsigned long long m_NumDroppedTicks;
+};
@@ -0,0 +1,139 @@
+/*
+	FramePacer.h
+
+	Limits the frame rate by sleeping off the spare time in each
+	frame instead of polling, and measures how even the frames are.
+*/
+
+#pragma once
+
+#include <vector>
+
+// frame rate used when no target is given
+const float FRAMEPACER_DEFAULT_FRAME_RATE = 60.0f;
+
+// time left before a frame is due that is spun instead of slept, sleeps can wake this late
+const float FRAMEPACER_DEFAULT_SPIN_MS = 2.0f;
+
+// number of recent frames the percentile and jitter are taken from
+const unsigned int FRAMEPACER_STATS_SAMPLES = 512;
+
+/// Frame times over the most recent frames, and the CPU the process used since the stats were reset
+struct FramePacerStats
+{
+	FramePacerStats() :
+		m_NumFrames(0), m_AvgFrameMS(0.0f), m_P99FrameMS(0.0f), m_MinFrameMS(0.0f), m_MaxFrameMS(0.0f),
+		m_JitterMS(0.0f), m_AvgWorkMS(0.0f), m_AvgWaitMS(0.0f), m_CpuUsage(0.0f)
+	{ }
+
+	unsigned long m_NumFrames;		// frames measured since the stats were reset
+	float m_AvgFrameMS;				// average frame time
+	float m_P99FrameMS;				// 99th percentile of the recent frames
+	float m_MinFrameMS;				// shortest frame
+	float m_MaxFrameMS;				// longest frame
+	float m_JitterMS;				// standard deviation of the recent frames
+	float m_AvgWorkMS;				// average time per frame spent outside WaitForNextFrame()
+	float m_AvgWaitMS;				// average time per frame spent waiting
+	float m_CpuUsage;				// process CPU time over wall time, 1 is one core fully busy
+};
+
+/**
+	Frame limiter for the main loop. WaitForNextFrame() is called once per frame and returns
+	once the next frame is due at the target rate. Frames are scheduled on a fixed grid so
+	the rate does not drift, but a frame that runs over starts a new grid instead of racing
+	to catch up.
+
+	The wait is a hybrid of sleeping and spinning. The thread sleeps for most of it, with the
+	system timer at 1 ms resolution, and only spins for the last couple of milliseconds
+	because a sleep can wake late. That keeps the frame times as even as a busy loop without
+	burning a core while the game is idle.
+
+	A target of 0 turns the limiter off so the loop runs as fast as it can, the stats are still
+	measured. GetStats() includes the process CPU usage, so comparing an idle menu with the
+	limiter on and off shows what it saves.
+
+	Usage:
+	m_FramePacer.SetTargetFrameRate(60.0f);
+	m_FramePacer.WaitForNextFrame();	// once per frame, before updating and rendering
+*/
+class FramePacer
+{
+public:
+	/// Constructor taking the target frames per second -- 0 runs unlimited
+	explicit FramePacer(float framesPerSecond = FRAMEPACER_DEFAULT_FRAME_RATE);
+
+	/// Destructor restores the system timer resolution
+	~FramePacer();
+
+	/// Set the target frames per second -- 0 runs unlimited
+	void SetTargetFrameRate(float framesPerSecond);
+
+	/// Return the target frames per second, 0 if unlimited
+	float GetTargetFrameRate() const;
+
+	/// Set how long before a frame is due to stop sleeping and start spinning
+	void SetSpinTime(float milliseconds);
+
+	/// Wait until the next frame is due -- returns the time since the last frame started in seconds
+	float WaitForNextFrame();
+
+	/// Compute the stats for the most recent frames
+	FramePacerStats GetStats() const;
+
+	/// Start measuring the stats over
+	void ResetStats();
+
+	/// Log the stats under the "FramePacer" tag
+	void DumpStats() const;
+
+	/// Log the stats every interval, 0 to turn off
+	void SetStatsDumpInterval(unsigned long milliseconds);
+
+private:
+	/// Turn the 1 ms system timer on or off
+	void SetHighResolutionTimer(bool enabled);
+
+	/// Sleep and then spin until a time
+	void WaitUntil(unsigned long long targetNS);
+
+	/// Add a frame to the stats
+	void RecordFrame(unsigned long long frameNS, unsigned long long waitNS);
+
+	/// Return the CPU time used by the process so far in nanoseconds
+	static unsigned long long GetProcessCpuNanoseconds();
+
+private:
+	/// Length of a frame in nanoseconds, 0 when unlimited
+	unsigned long long m_FramePeriodNS;
+
+	/// Time left before a frame is due that is spun instead of slept
+	unsigned long long m_SpinNS;
+
+	/// When the next frame is due
+	unsigned long long m_NextFrameNS;
+
+	/// When the last frame started, 0 before the first frame
+	unsigned long long m_LastFrameNS;
+
+	/// Is the system timer set to 1 ms resolution
+	bool m_HighResolutionTimer;
+
+	/// Ring of recent frame times in nanoseconds
+	std::vector<unsigned long long> m_FrameSamples;
+	unsigned int m_NextSample;
+
+	/// Totals since the stats were reset
+	unsigned long m_NumFrames;
+	unsigned long long m_TotalFrameNS;
+	unsigned long long m_TotalWaitNS;
+	unsigned long long m_MinFrameNS;
+	unsigned long long m_MaxFrameNS;
+
+	/// Wall clock and process CPU time when the stats were reset
+	unsigned long long m_StatsStartNS;
+	unsigned long long m_StatsStartCpuNS;
+
+	/// Periodic stats logging
+	unsigned long long m_StatsDumpIntervalNS;
+	unsigned long long m_LastStatsDumpNS;
+};
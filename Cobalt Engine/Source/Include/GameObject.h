@@ -75,25 +75,18 @@ public:
 		}
 	}
 	
-	/// Return a weak pointer to a particular component by name
+	/// Return a weak pointer to a particular component by name -- hashes the name on every call, prefer the typed overload in code
 	template <typename ComponentType>
 	weak_ptr<ComponentType> GetComponent(const char* name)
 	{
-		ComponentId id = Component::GetIdFromName(name);
-		Components::iterator it = m_Components.find(id);
-		if (it != m_Components.end())
-		{
-			// if it exists, get the component part
-			StrongComponentPtr pBase(it->second);
-			// cast it down to the derived class and return a weak ptr
-			shared_ptr<ComponentType> pDerived = static_pointer_cast<ComponentType>(pBase);
-			weak_ptr<ComponentType> pWeakDerived(pDerived);
-			return pWeakDerived;
-		}
-		else
-		{
-			return weak_ptr<ComponentType>();
-		}
+		return GetComponent<ComponentType>(Component::GetIdFromName(name));
+	}
+
+	/// Return a weak pointer to a particular component by type using the id the component hashed at startup
+	template <typename ComponentType>
+	weak_ptr<ComponentType> GetComponent()
+	{
+		return GetComponent<ComponentType>(ComponentType::g_Id);
 	}
 
 private:
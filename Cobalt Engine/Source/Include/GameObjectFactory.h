@@ -8,6 +8,7 @@
 #pragma once
 
 #include <functional>
+#include <string>
 #include <tinyxml.h>
 #include <unordered_map>
 
@@ -15,6 +16,8 @@
 #include "Matrix.h"
 #include "templates.h"
 
+class ResHandle;
+
 /**
 	This class is used to create game objects by using xml data to 
 	attach components to them.
@@ -28,6 +31,15 @@ public:
 	/// Create a game object from a resource
 	StrongGameObjectPtr CreateGameObject(const char* objectResource, TiXmlElement* overrides, const Mat4x4* pInitialTransform, const GameObjectId serversObjectId);
 
+	/// Create a game object from an already loaded resource root, see GetTemplate()
+	StrongGameObjectPtr CreateGameObjectFromTemplate(TiXmlElement* pRoot, const char* objectResource, TiXmlElement* overrides, const Mat4x4* pInitialTransform, const GameObjectId serversObjectId);
+
+	/// Return the root element of an object resource, kept loaded until ReleaseTemplates() -- nullptr if it does not load
+	TiXmlElement* GetTemplate(const char* objectResource);
+
+	/// Let the resource cache evict the templates again
+	void ReleaseTemplates();
+
 	/// Modify a game object's components
 	void ModifyGameObject(StrongGameObjectPtr pObject, TiXmlElement* overrides);
 
@@ -46,4 +58,7 @@ protected:
 private:
 	/// Id of the last object created
 	GameObjectId m_lastObjectId;
+
+	/// Object resources held by GetTemplate(), so a batch does not look them up and parse them per object
+	std::unordered_map<std::string, shared_ptr<ResHandle>> m_Templates;
 };
@@ -0,0 +1,25 @@
+/*
+	HighResClock.h
+
+	A monotonic, high resolution clock for timing code. Unlike
+	GetTickCount() and timeGetTime() this is accurate well below a
+	millisecond and never jumps backwards.
+*/
+
+#pragma once
+
+namespace HighResClock
+{
+	/// Return the current time in nanoseconds from an arbitrary starting point
+	unsigned long long GetNanoseconds();
+
+	/// Return the current time in microseconds from an arbitrary starting point
+	unsigned long long GetMicroseconds();
+
+	/// Return the current time in seconds from an arbitrary starting point
+	double GetSeconds();
+}
+
+// conversion helpers
+const unsigned long long NANOSECONDS_PER_MILLISECOND = 1000000ULL;
+const unsigned long long NANOSECONDS_PER_SECOND = 1000000000ULL;
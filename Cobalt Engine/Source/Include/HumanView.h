@@ -130,15 +130,6 @@ protected:
 	/// Process manager used for things like button animations -- anything that takes multiple frames to execute
 	ProcessManager* m_pProcessManager;
 
-	/// Current time
-	DWORD m_CurrTick;
-
-	/// Last time the game rendered
-	DWORD m_LastDraw;
-
-	/// Should the game run full speed or limit the framerate
-	bool m_RunFullSpeed;
-
 	/// Current state of the game
 	BaseGameState m_BaseGameState;
 
@@ -47,6 +47,11 @@ struct GameOptions
 	bool m_RunFullSpeed;
 	Point m_ScreenSize;
 
+	// frame pacing options
+	float m_FrameRate;
+	float m_FrameSpinTime;
+	unsigned long m_FrameStatsDumpInterval;
+
 	// sound options
 	float m_SoundEffectsVolume;
 	float m_MusicVolume;
@@ -59,9 +64,35 @@ struct GameOptions
 	int m_NumAIs;
 	int m_MaxAIs;
 	int m_MaxPlayers;
+	bool m_TextNetworkEvents;
 
 	// resource cache options
 	bool m_UseDevelopmentDirectories;
+	bool m_MemoryMapResources;
+	std::string m_ResCachePolicy;
+	std::string m_ResCacheTrace;
+
+	// dedicated server options
+	bool m_Headless;
+	float m_ServerTickRate;
+
+	// simulation options
+	float m_TickRate;
+	unsigned int m_MaxTicksPerFrame;
+
+	// event journal options
+	std::string m_JournalRecordFile;
+	std::string m_JournalReplayFile;
+
+	// event stats options
+	bool m_EventStats;
+	unsigned long m_EventStatsDumpInterval;
+
+	// process profiling options
+	bool m_ProcessProfile;
+	unsigned long m_ProcessProfileDumpInterval;
+	float m_ProcessProfileFrameBudget;
+	std::string m_ProcessProfileTrace;
 
 	// xml options document
 	TiXmlDocument* m_pDoc;
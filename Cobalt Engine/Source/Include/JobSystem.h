@@ -0,0 +1,192 @@
+/*
+	JobSystem.h
+
+	A work stealing job scheduler that spreads small pieces of work
+	across every core, with fork/join and parent/child dependencies.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Job;
+typedef std::shared_ptr<Job> JobPtr;
+
+/// Function run by a job
+typedef std::function<void()> JobFunction;
+
+/// Where a job is allowed to run
+enum JobAffinity
+{
+	JobAffinity_Any,			// any worker or the main thread
+	JobAffinity_MainThread		// only the thread that created the job system, ex. for D3D or Lua calls
+};
+
+/// What the main thread runs while it waits
+enum JobWaitMode
+{
+	JobWait_Any,				// any job, main thread jobs included
+	JobWait_SkipMainThread		// never main thread jobs, ex. partway through an update their callbacks would re-enter
+};
+
+/**
+	A piece of work for the job system. A job is not finished until its function
+	has returned and every child job created for it has finished, so waiting on a
+	parent joins a whole tree of work.
+*/
+class Job
+{
+	friend class JobSystem;
+
+public:
+	/// Return true once the job and all of its children have finished
+	bool IsFinished() const { return m_NumUnfinished.load() == 0; }
+
+	/// Return where the job is allowed to run
+	JobAffinity GetAffinity() const { return m_Affinity; }
+
+private:
+	/// Constructor is private, jobs are made by the job system
+	Job(const JobFunction& function, const JobPtr& pParent, JobAffinity affinity);
+
+private:
+	/// The work to do
+	JobFunction m_Function;
+
+	/// Job that waits on this one, if any
+	JobPtr m_pParent;
+
+	/// One for the job itself plus one for each child that has not finished
+	std::atomic<int> m_NumUnfinished;
+
+	/// Where the job is allowed to run
+	JobAffinity m_Affinity;
+};
+
+/**
+	Work stealing scheduler built on std::thread. Every worker owns a deque of jobs. A thread
+	runs the newest job from the back of its own deque, which keeps forked work hot in its
+	cache, and steals the oldest job from the front of another deque when it runs dry. Idle
+	workers sleep until a job is submitted.
+
+	The thread that creates the job system acts as the main thread. It has a deque of its own
+	that workers can steal from, and it is the only thread that runs main thread jobs. It runs
+	them whenever it waits on a job or calls RunMainThreadJobs(), unless it waits with
+	JobWait_SkipMainThread. A wait that skips them must not be on a job that needs one.
+
+	Usage:
+	JobPtr pParent = pJobSystem->CreateJob([]() { });
+	for (unsigned int i = 0; i < numChunks; ++i)
+		pJobSystem->Run(pJobSystem->CreateChildJob(pParent, [i]() { ProcessChunk(i); }));
+	pJobSystem->Run(pParent);
+	pJobSystem->Wait(pParent);	// this thread helps out until every chunk is done
+*/
+class JobSystem
+{
+	typedef std::function<void(unsigned int)> ParallelForFunction;
+
+	/// A worker's deque, the owner works from the back and thieves steal from the front
+	struct JobQueue
+	{
+		std::mutex m_Mutex;
+		std::deque<JobPtr> m_Jobs;
+	};
+
+public:
+	/// Constructor starts the workers -- 0 uses one less than the number of hardware threads
+	explicit JobSystem(unsigned int numWorkers = 0, bool setAsGlobal = false);
+
+	/// Destructor runs whatever is still queued and joins the workers
+	~JobSystem();
+
+	/// Create a job without starting it
+	JobPtr CreateJob(const JobFunction& function, JobAffinity affinity = JobAffinity_Any);
+
+	/// Create a job the parent waits on -- must be called before the parent finishes, ex. from the parent's own function
+	JobPtr CreateChildJob(const JobPtr& pParent, const JobFunction& function, JobAffinity affinity = JobAffinity_Any);
+
+	/// Queue a job to run -- each job can only be run once
+	void Run(const JobPtr& pJob);
+
+	/// Run other jobs on this thread until the job and all of its children have finished
+	void Wait(const JobPtr& pJob, JobWaitMode mode = JobWait_Any);
+
+	/// Call func once for every index in [0, count) across the workers and block until they all finish
+	void ParallelFor(unsigned int count, const ParallelForFunction& func, JobWaitMode mode = JobWait_Any);
+
+	/// Run every queued main thread job -- only call this from the main thread
+	void RunMainThreadJobs();
+
+	/// Return the number of worker threads, not counting the main thread
+	unsigned int GetNumWorkers() const { return (unsigned int)m_Workers.size(); }
+
+	/// Return true if called from the thread that created the job system
+	bool IsMainThread() const { return std::this_thread::get_id() == m_MainThreadId; }
+
+	/// Return the index of the calling thread -- workers are 0 to GetNumWorkers() - 1, the main thread is GetNumWorkers() and any other thread is -1
+	int GetThreadIndex() const { return GetQueueIndex(); }
+
+	/// Return the global job system
+	static JobSystem* Get();
+
+private:
+	/// Loop run by each worker thread
+	void WorkerThreadProc(unsigned int queueIndex);
+
+	/// Return the index of the calling thread's deque, or -1 if it is not a worker or the main thread
+	int GetQueueIndex() const;
+
+	/// Find a job for the thread that owns queueIndex -- its own deque first, then main thread jobs unless told to skip them, then steal
+	JobPtr FindJob(int queueIndex, JobWaitMode mode = JobWait_Any);
+
+	/// Steal the oldest job from another thread's deque
+	JobPtr StealJob(int thiefIndex);
+
+	/// Run a job and finish it
+	void Execute(const JobPtr& pJob);
+
+	/// Mark one unit of a job as done and pass completion up to its parent
+	void Finish(const JobPtr& pJob);
+
+	// no copying allowed!
+	JobSystem(const JobSystem&);
+	JobSystem& operator=(const JobSystem&);
+
+private:
+	/// The worker threads
+	std::vector<std::thread> m_Workers;
+
+	/// Ids of the worker threads, in the same order as their deques
+	std::vector<std::thread::id> m_WorkerIds;
+
+	/// One deque per thread, the main thread's is last
+	std::vector<JobQueue*> m_Queues;
+
+	/// Jobs that can only run on the main thread
+	JobQueue m_MainThreadJobs;
+
+	/// Id of the thread that created the job system
+	std::thread::id m_MainThreadId;
+
+	/// Number of jobs in the worker and main thread deques, used to let idle workers sleep
+	std::atomic<unsigned int> m_NumQueuedJobs;
+
+	/// Deque that jobs from threads outside the job system go to next
+	std::atomic<unsigned int> m_NextExternalQueue;
+
+	/// Guards sleeping and waking the workers
+	std::mutex m_SleepMutex;
+
+	/// Signaled when a job is queued or the job system is shutting down
+	std::condition_variable m_JobQueued;
+
+	/// Set when the job system is being destroyed
+	std::atomic<bool> m_ShuttingDown;
+};
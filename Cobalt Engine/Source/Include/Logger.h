@@ -70,6 +70,9 @@ namespace Logger
 	/// Shutdown the logger
 	void Destroy();
 
+	/// Return true if logs with this tag are displayed anywhere
+	bool IsTagEnabled(const std::string& tag);
+
 	/// Log a message
 	void Log(const std::string& tag, const std::string& message, const char* funcName, const char* sourceFile, unsigned int lineNum);
 
@@ -82,12 +85,15 @@ namespace Logger
 //	Debug Macros
 //====================================================
 
-// log a tag and message
+// log a tag and message, the message is only built if the tag is enabled
 #define CB_LOG(tag, str) \
 do \
 { \
-	std::string s((str)); \
-	Logger::Log(tag, s, nullptr, nullptr, 0); \
+	if (Logger::IsTagEnabled(tag)) \
+	{ \
+		std::string s((str)); \
+		Logger::Log(tag, s, nullptr, nullptr, 0); \
+	} \
 } \
 while (0) \
 
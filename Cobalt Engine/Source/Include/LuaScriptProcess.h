@@ -20,6 +20,9 @@ public:
 	/// Register the script class within lua to get access to these process methods -- call this in application initialization
 	static void RegisterScriptClass();
 
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "LuaScriptProcess"; }
+
 protected:
 	// Process interface
 	/// Initialize the process
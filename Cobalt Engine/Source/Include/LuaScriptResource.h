@@ -9,6 +9,27 @@
 
 #include "interfaces.h"
 
+/**
+	Remembers how much the Lua State grew when a script ran, ex. the tables and functions it
+	defined, so the resource cache can count it against its budget.
+*/
+class LuaScriptResourceExtraData : public IResourceExtraData
+{
+public:
+	/// Constructor taking the bytes the script added to the Lua State
+	explicit LuaScriptResourceExtraData(unsigned int memorySize) : m_MemorySize(memorySize) { }
+
+	/// Returns a string describing the extra data
+	virtual std::string ToStr() { return "LuaScriptResourceExtraData"; }
+
+	/// Return the bytes the script added to the Lua State
+	virtual unsigned int GetMemorySize() { return m_MemorySize; }
+
+private:
+	/// Bytes the Lua State grew by while the script ran
+	unsigned int m_MemorySize;
+};
+
 /**
 	Used to load lua scripts into the resource cache.
 */
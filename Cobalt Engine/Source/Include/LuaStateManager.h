@@ -48,6 +48,9 @@ public:
 	/// Return the Lua State object
 	LuaPlus::LuaState* GetLuaState() const;
 
+	/// Return the bytes the Lua State has allocated
+	unsigned int GetMemoryUsed() const;
+
 	/// Create a lua table path from a string
 	LuaPlus::LuaObject CreatePath(const char* pathString, bool toIgnoreLastElement = false);
 	
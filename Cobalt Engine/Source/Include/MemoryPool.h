@@ -51,6 +51,7 @@ public:
 	void* Alloc();
 	void Free(void* pMem);
 	unsigned int GetChunkSize() const;
+	unsigned int GetNumBlocks() const;
 
 	// enable/disable the pool to allocate more memory when full
 	void SetAllowResize(bool allowResize);
@@ -0,0 +1,174 @@
+/*
+	MpscRingBuffer.h
+
+	A bounded, lock-free queue that can be pushed to from any
+	number of threads and popped from by a single consumer thread.
+	Based on Dmitry Vyukov's bounded queue with per cell sequence
+	numbers, trimmed down for the single consumer case.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// used to pad the producer and consumer counters onto separate cache lines
+const size_t MPSC_CACHE_LINE_SIZE = 64;
+
+/**
+	Fixed capacity multi producer, single consumer ring buffer.
+
+	Each cell in the ring stores a sequence number. A producer claims a
+	slot by advancing the enqueue position with a compare and swap, writes
+	the data and then publishes it by bumping the cell's sequence number.
+	The consumer owns the dequeue position outright and only has to check
+	the sequence number of the next cell to know if the data is ready.
+
+	Push() never blocks or allocates. If the ring is full the data is
+	dropped, Push() returns false and the overflow counter is incremented.
+	Only one thread may call TryPop() or Drain() at a time.
+*/
+template<typename Data>
+class MpscRingBuffer
+{
+public:
+	/// Constructor allocates the ring. Capacity is rounded up to a power of 2
+	explicit MpscRingBuffer(size_t capacity = 1024)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+
+		m_pBuffer = new Cell[size];
+		m_Mask = size - 1;
+		for (size_t i = 0; i < size; ++i)
+			m_pBuffer[i].m_Sequence.store(i, std::memory_order_relaxed);
+
+		m_EnqueuePos.store(0, std::memory_order_relaxed);
+		m_DequeuePos = 0;
+		m_OverflowCount.store(0, std::memory_order_relaxed);
+	}
+
+	/// Destructor frees the ring and anything still left in it
+	~MpscRingBuffer()
+	{
+		delete[] m_pBuffer;
+	}
+
+	/// [thread safe] Add data to the ring -- returns false if the ring is full
+	bool Push(const Data& data)
+	{
+		Cell* pCell = nullptr;
+		size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			pCell = &m_pBuffer[pos & m_Mask];
+			size_t sequence = pCell->m_Sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)pos;
+
+			if (diff == 0)
+			{
+				// the cell is free, try to claim it
+				if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				// the consumer has not freed this cell yet, the ring is full
+				m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				// another producer claimed the cell first, reload and try again
+				pos = m_EnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		// write the data and publish it to the consumer
+		pCell->m_Data = data;
+		pCell->m_Sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// [consumer only] Pop the oldest data off the ring -- returns false if nothing is ready
+	bool TryPop(Data& poppedValue)
+	{
+		Cell* pCell = &m_pBuffer[m_DequeuePos & m_Mask];
+		size_t sequence = pCell->m_Sequence.load(std::memory_order_acquire);
+		if ((ptrdiff_t)sequence - (ptrdiff_t)(m_DequeuePos + 1) < 0)
+			return false;
+
+		poppedValue = std::move(pCell->m_Data);
+		pCell->m_Data = Data();
+
+		// hand the cell back to the producers one lap ahead
+		pCell->m_Sequence.store(m_DequeuePos + m_Mask + 1, std::memory_order_release);
+		++m_DequeuePos;
+		return true;
+	}
+
+	/// [consumer only] Pop up to maxCount items and pass each one to func -- returns the number popped
+	template<class Func>
+	size_t Drain(Func func, size_t maxCount = (size_t)-1)
+	{
+		size_t count = 0;
+		Data data;
+		while (count < maxCount && TryPop(data))
+		{
+			func(data);
+			++count;
+		}
+
+		return count;
+	}
+
+	/// Return true if there is nothing ready to be popped
+	bool Empty() const
+	{
+		const Cell* pCell = &m_pBuffer[m_DequeuePos & m_Mask];
+		size_t sequence = pCell->m_Sequence.load(std::memory_order_acquire);
+		return (ptrdiff_t)sequence - (ptrdiff_t)(m_DequeuePos + 1) < 0;
+	}
+
+	/// Return the max number of items that the ring can hold
+	size_t GetCapacity() const { return m_Mask + 1; }
+
+	/// Return the number of pushes that were dropped because the ring was full
+	unsigned long GetOverflowCount() const { return m_OverflowCount.load(std::memory_order_relaxed); }
+
+private:
+	/// A single slot in the ring
+	struct Cell
+	{
+		std::atomic<size_t> m_Sequence;
+		Data m_Data;
+	};
+
+	// no copying allowed!
+	MpscRingBuffer(const MpscRingBuffer&);
+	MpscRingBuffer& operator=(const MpscRingBuffer&);
+
+private:
+	/// Array of cells making up the ring
+	Cell* m_pBuffer;
+
+	/// Capacity - 1, used to wrap positions into the ring
+	size_t m_Mask;
+
+	char m_Pad0[MPSC_CACHE_LINE_SIZE];
+
+	/// Next position a producer will write to
+	std::atomic<size_t> m_EnqueuePos;
+
+	char m_Pad1[MPSC_CACHE_LINE_SIZE];
+
+	/// Next position the consumer will read from
+	size_t m_DequeuePos;
+
+	char m_Pad2[MPSC_CACHE_LINE_SIZE];
+
+	/// Number of pushes dropped because the ring was full
+	std::atomic<unsigned long> m_OverflowCount;
+};
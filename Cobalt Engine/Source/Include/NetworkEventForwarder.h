@@ -9,6 +9,8 @@
 
 #include "interfaces.h"
 
+class BinaryPacket;
+
 /**
 	This class is used to forward events down a network connection. It 
 	stores a socket id which will be used to determine which socket
@@ -23,6 +25,9 @@ public:
 	/// Forward an event down the socket over TCP/IP
 	void ForwardEvent(IEventPtr pEvent);
 
+	/// Serialize an event into the packet ForwardEvent() would send, text or binary depending on the options
+	static shared_ptr<BinaryPacket> CreateEventPacket(IEventPtr pEvent);
+
 protected:
 	/// Id of the socket connection
 	int m_SocketId;
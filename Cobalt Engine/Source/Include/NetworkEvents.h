@@ -65,6 +65,21 @@ public:
 		in >> m_SocketId;
 	}
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteUInt32(m_ObjectId);
+		out.WriteInt32(m_SocketId);
+	}
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_ObjectId = in.ReadUInt32();
+		m_SocketId = in.ReadInt32();
+		return in.IsValid();
+	}
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const
 	{
@@ -140,6 +155,21 @@ public:
 		in >> m_IpAddress;
 	}
 
+	/// Serialize the event to a binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteInt32(m_SocketId);
+		out.WriteInt32(m_IpAddress);
+	}
+
+	/// Deserialize the event from a binary stream
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_SocketId = in.ReadInt32();
+		m_IpAddress = in.ReadInt32();
+		return in.IsValid();
+	}
+
 	/// Return a copy of the event
 	virtual IEventPtr Copy() const
 	{
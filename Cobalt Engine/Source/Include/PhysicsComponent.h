@@ -85,6 +85,9 @@ public:
 	/// Name of the component
 	static const char* g_Name;
 
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
+
 protected:
 	float m_Acceleration;
 	float m_AngularAcceleration;
@@ -12,10 +12,14 @@
 
 #include "BaseEvent.h"
 #include "EngineStd.h"
+#include "EventPool.h"
 #include "LuaScriptEvent.h"
 #include "LuaStateManager.h"
 #include "Vector.h"
 
+// a bullet contact manifold holds at most 4 points, so collision events store them inline
+const unsigned int PHYSEVENT_MAX_COLLISION_POINTS = 4;
+
 /**
 	Event sent when a game physics trigger object is triggered
 	by another game object.
@@ -49,9 +53,22 @@ public:
 		return sk_EventType;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteInt32(m_TriggerId);
+		out.WriteUInt32(m_OtherId);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_TriggerId = in.ReadInt32();
+		m_OtherId = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const
 	{
-		return IEventPtr(CB_NEW Event_PhysTriggerEnter(m_TriggerId, m_OtherId));
+		return MakePooledEvent<Event_PhysTriggerEnter>(m_TriggerId, m_OtherId);
 	}
 
 	virtual const char* GetName() const
@@ -101,9 +118,22 @@ public:
 		return sk_EventType;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteInt32(m_TriggerId);
+		out.WriteUInt32(m_OtherId);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_TriggerId = in.ReadInt32();
+		m_OtherId = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const
 	{
-		return IEventPtr(CB_NEW Event_PhysTriggerLeave(m_TriggerId, m_OtherId));
+		return MakePooledEvent<Event_PhysTriggerLeave>(m_TriggerId, m_OtherId);
 	}
 
 	virtual const char* GetName() const
@@ -132,16 +162,23 @@ public:
 		m_ObjectB = INVALID_GAMEOBJECT_ID;
 		m_SumNormalForce = Vec3(0.0f, 0.0f, 0.0f);
 		m_SumFrictionForce = Vec3(0.0f, 0.0f, 0.0f);
+		m_NumCollisionPoints = 0;
 	}
 
+	/// Points past PHYSEVENT_MAX_COLLISION_POINTS are dropped
 	explicit Event_PhysCollision(GameObjectId objA, GameObjectId objB, const Vec3& sumNormalForce, 
-		const Vec3& sumFrictionForce, const Vec3List& collisionPoints) :
+		const Vec3& sumFrictionForce, const Vec3* pCollisionPoints, unsigned int numCollisionPoints) :
 		m_ObjectA(objA),
 		m_ObjectB(objB),
 		m_SumNormalForce(sumNormalForce),
-		m_SumFrictionForce(sumFrictionForce),
-		m_CollisionPoints(collisionPoints)
-	{ }
+		m_SumFrictionForce(sumFrictionForce)
+	{
+		m_NumCollisionPoints = (numCollisionPoints > PHYSEVENT_MAX_COLLISION_POINTS) ? PHYSEVENT_MAX_COLLISION_POINTS : numCollisionPoints;
+		for (unsigned int i = 0; i < m_NumCollisionPoints; ++i)
+		{
+			m_CollisionPoints[i] = pCollisionPoints[i];
+		}
+	}
 
 	GameObjectId GetObjectA() const
 	{
@@ -163,9 +200,14 @@ public:
 		return m_SumFrictionForce;
 	}
 
-	const Vec3List& GetCollisionPoints() const
+	unsigned int GetNumCollisionPoints() const
 	{
-		return m_CollisionPoints;
+		return m_NumCollisionPoints;
+	}
+
+	const Vec3& GetCollisionPoint(unsigned int index) const
+	{
+		return m_CollisionPoints[index];
 	}
 
 	virtual const EventType& GetEventType() const
@@ -173,9 +215,43 @@ public:
 		return sk_EventType;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteUInt32(m_ObjectA);
+		out.WriteUInt32(m_ObjectB);
+		out.WriteVec3(m_SumNormalForce);
+		out.WriteVec3(m_SumFrictionForce);
+		out.WriteUInt16((unsigned short)m_NumCollisionPoints);
+		for (unsigned int i = 0; i < m_NumCollisionPoints; ++i)
+		{
+			out.WriteVec3(m_CollisionPoints[i]);
+		}
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_ObjectA = in.ReadUInt32();
+		m_ObjectB = in.ReadUInt32();
+		in.ReadVec3(m_SumNormalForce);
+		in.ReadVec3(m_SumFrictionForce);
+
+		// read every point so the stream stays in step, but only keep what fits
+		m_NumCollisionPoints = 0;
+		unsigned short numPoints = in.ReadUInt16();
+		for (unsigned short i = 0; i < numPoints && in.IsValid(); ++i)
+		{
+			Vec3 point;
+			in.ReadVec3(point);
+			if (m_NumCollisionPoints < PHYSEVENT_MAX_COLLISION_POINTS)
+				m_CollisionPoints[m_NumCollisionPoints++] = point;
+		}
+
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const
 	{
-		return IEventPtr(CB_NEW Event_PhysCollision(m_ObjectA, m_ObjectB, m_SumNormalForce, m_SumFrictionForce, m_CollisionPoints));
+		return MakePooledEvent<Event_PhysCollision>(m_ObjectA, m_ObjectB, m_SumNormalForce, m_SumFrictionForce, m_CollisionPoints, m_NumCollisionPoints);
 	}
 
 	virtual const char* GetName() const
@@ -200,7 +276,8 @@ private:
 	GameObjectId m_ObjectB;
 	Vec3 m_SumNormalForce;
 	Vec3 m_SumFrictionForce;
-	Vec3List m_CollisionPoints;
+	Vec3 m_CollisionPoints[PHYSEVENT_MAX_COLLISION_POINTS];
+	unsigned int m_NumCollisionPoints;
 };
 
 
@@ -237,9 +314,22 @@ public:
 		return sk_EventType;
 	}
 
+	virtual void SerializeBinary(EventWriteStream& out) const
+	{
+		out.WriteUInt32(m_ObjectA);
+		out.WriteUInt32(m_ObjectB);
+	}
+
+	virtual bool DeserializeBinary(EventReadStream& in)
+	{
+		m_ObjectA = in.ReadUInt32();
+		m_ObjectB = in.ReadUInt32();
+		return in.IsValid();
+	}
+
 	virtual IEventPtr Copy() const
 	{
-		return IEventPtr(CB_NEW Event_PhysSeparation(m_ObjectA, m_ObjectB));
+		return MakePooledEvent<Event_PhysSeparation>(m_ObjectA, m_ObjectB);
 	}
 
 	virtual const char* GetName() const
@@ -9,6 +9,8 @@
 
 #include <memory>
 
+#include "interfaces.h"
+
 class Process;
 typedef std::shared_ptr<Process> StrongProcessPtr;
 typedef std::weak_ptr<Process> WeakProcessPtr;
@@ -20,10 +22,15 @@ typedef std::weak_ptr<Process> WeakProcessPtr;
 	In this case, the child process will be promoted by the Process Manager to a full process and 
 	execute its own behavior in the chain. If a child is added to a process that already has a 
 	child, the new child (grand child) will be added as a child to the processes child.
+
+	A running process that is only waiting can Sleep() or SleepUntilEvent(). The Process Manager
+	parks it where it costs nothing per frame until the time passes or the event is sent, and
+	then calls OnWake() and starts updating it again.
 */
 class Process
 {
 	friend class ProcessManager;
+	friend class CoroutineProcess;
 
 public:
 	/// Describes the state that a process can be in
@@ -34,6 +41,7 @@ public:
 		// running processes
 		RUNNING,
 		PAUSED,
+		SLEEPING,
 		// finished processes
 		SUCCEEDED,
 		FAILED,
@@ -58,6 +66,12 @@ public:
 	/// Resume a paused process
 	void UnPause();
 
+	/// Stop updating a running process until the given number of seconds have passed
+	void Sleep(float seconds);
+
+	/// Stop updating a running process until an event of the given type is sent
+	void SleepUntilEvent(const EventType& eventType);
+
 	/// Return the state of a process
 	State GetState() const;
 
@@ -73,6 +87,9 @@ public:
 	/// Return whether or not a process is paused
 	bool IsPaused() const;
 
+	/// Return whether or not a process is sleeping
+	bool IsSleeping() const;
+
 	/// Attach a child process to this process
 	void AttachChild(StrongProcessPtr pChild);
 
@@ -82,6 +99,13 @@ public:
 	/// Return a pointer to the child process
 	StrongProcessPtr PeekChild();
 
+	/// Return true if OnUpdate() only touches this process, so it can run on a worker thread alongside other
+	/// parallel safe processes. It may still change its own state and child
+	virtual bool IsParallelSafe() const { return false; }
+
+	/// Return the name of the process type, used to group processes when profiling -- must be a string literal
+	virtual const char* GetName() const { return "Process"; }
+
 protected:
 	/// Default Init method sets the state to RUNNING
 	virtual void OnInit()
@@ -92,6 +116,9 @@ protected:
 	/// Update method must be overriden in derived class and is called every frame
 	virtual void OnUpdate(float deltaTime) = 0;
 
+	/// Called when a sleeping process wakes up, before its next update
+	virtual void OnWake() { }
+
 	/// Called if a process ends with sucess
 	virtual void OnSuccess() { }
 
@@ -101,6 +128,9 @@ protected:
 	/// Called if a process ends with abort
 	virtual void OnAbort() { }
 
+	/// Called right before the owner lets go of the process, whatever state it ended in -- the last point a process can wait on work that uses it
+	virtual void OnRemove() { }
+
 private:
 	/// Sets the state of a process -- done by the manager
 	void SetState(State newState);
@@ -111,4 +141,10 @@ private:
 
 	/// Strong pointer to a child process, if one exists
 	StrongProcessPtr m_pChild;
+
+	/// Seconds to sleep for, or a negative value to sleep until m_WakeEventType
+	float m_SleepTime;
+
+	/// Event type that wakes the process when m_SleepTime is negative
+	EventType m_WakeEventType;
 };
@@ -7,39 +7,332 @@
 
 #pragma once
 
-#include <list>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Process.h"
 
+class JobSystem;
+
+/// Handle to a process attached to a process manager, the slot index in the low 32 bits and its generation in the high 32 bits
+typedef unsigned long long ProcessHandle;
+
+// handle that never refers to a process
+const ProcessHandle INVALID_PROCESS_HANDLE = 0;
+
+// smallest number of parallel safe processes that is worth handing to the job system
+const unsigned int PROCESSMANAGER_MIN_PARALLEL_BATCH = 8;
+
+// number of recent update times kept for each process type to find the 99th percentile
+const unsigned int PROCESSMANAGER_PROFILE_SAMPLES = 1024;
+
+// number of timed updates kept for the trace, older ones are overwritten
+const unsigned int PROCESSMANAGER_TRACE_CAPACITY = 65536;
+
+/// Update timings for one process type, collected while profiling is enabled
+struct ProcessTypeStats
+{
+	ProcessTypeStats() :
+		m_pName(nullptr), m_NumUpdates(0), m_TotalNS(0), m_MinNS(0), m_MaxNS(0), m_AverageNS(0), m_P99NS(0),
+		m_NumAttached(0), m_NumSucceeded(0), m_NumFailed(0), m_NumLive(0), m_PeakLive(0)
+	{ }
+
+	const char* m_pName;				// name returned by Process::GetName(), kept by the manager until the profile is reset
+	unsigned long m_NumUpdates;			// calls to OnUpdate()
+	unsigned long long m_TotalNS;		// total time spent in OnUpdate()
+	unsigned long long m_MinNS;			// quickest update
+	unsigned long long m_MaxNS;			// slowest update
+	unsigned long long m_AverageNS;		// filled in when the report is made
+	unsigned long long m_P99NS;			// 99th percentile of the recent updates, filled in when the report is made
+	unsigned long m_NumAttached;		// processes attached, including promoted children
+	unsigned long m_NumSucceeded;		// processes that succeeded
+	unsigned long m_NumFailed;			// processes that failed or were aborted
+	unsigned int m_NumLive;				// processes of this type attached right now
+	unsigned int m_PeakLive;			// most processes of this type attached at once
+};
+
+/// Frame totals and per type timings recorded since profiling was enabled or reset
+struct ProcessProfileReport
+{
+	ProcessProfileReport() :
+		m_NumFrames(0), m_TotalFrameNS(0), m_MaxFrameNS(0), m_NumOverBudgetFrames(0),
+		m_NumAttached(0), m_NumRemoved(0), m_PeakProcesses(0), m_PeakAwake(0)
+	{ }
+
+	unsigned long m_NumFrames;				// calls to UpdateProcesses()
+	unsigned long long m_TotalFrameNS;		// total time spent in UpdateProcesses()
+	unsigned long long m_MaxFrameNS;		// slowest UpdateProcesses()
+	unsigned long m_NumOverBudgetFrames;	// frames UpdateProcesses() went over the frame budget
+	unsigned long m_NumAttached;			// processes attached
+	unsigned long m_NumRemoved;				// processes removed
+	unsigned int m_PeakProcesses;			// most processes attached at once
+	unsigned int m_PeakAwake;				// most processes awake in one update
+	std::vector<ProcessTypeStats> m_Types;	// most total update time first
+};
+
 /**
 	Manages all the running processes in a game. This class will call OnUpdate on
 	each running process once per frame.
+
+	Processes are stored in a dense array so an update walks contiguous memory, and are
+	removed by moving the last process into the hole. Handles go through a slot table with
+	a generation count, so a handle to a process that has died or been removed is detected
+	instead of finding whichever process reused the slot. Attaching, looking up and removing
+	a process are all O(1), and the arrays are reused so steady state churn does not allocate.
+
+	Sleeping processes are moved out of the dense array into one of their own, so the per
+	frame cost scales with the number of awake processes. Timed sleepers wait in a min heap
+	ordered by wake time and only the ones that are due are looked at each update. Processes
+	sleeping until an event wait in a list for that event type, and the manager listens for
+	the type only while something waits on it: the listener is removed once the event wakes the
+	last waiter or the last waiter is aborted. Every sleep bumps a serial in the process's slot,
+	so a wake up left over from an earlier sleep is ignored.
+
+	Processes that declare themselves parallel safe are updated across the job system
+	after the other processes have been updated on the main thread. Initialization,
+	exit callbacks and child promotion always happen afterward on the main thread, in
+	array order, so the results do not depend on which thread ran a process.
+
+	Profiling is off by default and costs a branch per update when off. When it is on every
+	OnUpdate() is timed and grouped by Process::GetName(), along with process churn and peak
+	counts. Updates on worker threads write their timing to their own batch slot and are
+	folded in on the main thread. The most recent updates are also kept for a trace that
+	can be loaded in chrome://tracing to see which processes ran where within a frame.
 */
 class ProcessManager
 {
-	typedef std::list<StrongProcessPtr> ProcessList;
-	
+	typedef std::vector<Process*> ProcessBatch;
+
+	/// Maps a handle's slot to a process in one of the dense arrays
+	struct ProcessSlot
+	{
+		unsigned int m_Generation;	// bumped every time the slot is freed
+		unsigned int m_DenseIndex;	// index of the process in its array
+		unsigned int m_SleepSerial;	// bumped every time the process goes to sleep
+		bool m_Sleeping;			// true if the process is in the sleeping array
+	};
+
+	/// Densely packed processes and the slot of each one
+	struct ProcessArray
+	{
+		std::vector<StrongProcessPtr> m_Processes;
+		std::vector<unsigned int> m_Slots;
+	};
+
+	/// A sleeping process waiting to be woken
+	struct SleepWaiter
+	{
+		unsigned int m_Slot;
+		unsigned int m_SleepSerial;
+	};
+
+	/// A sleeping process waiting for a time
+	struct SleepTimer
+	{
+		double m_WakeTime;
+		SleepWaiter m_Waiter;
+
+		bool operator>(const SleepTimer& rhs) const { return m_WakeTime > rhs.m_WakeTime; }
+	};
+
+	/// One timed update, kept for the trace
+	struct ProcessTraceEvent
+	{
+		const char* m_pName;
+		unsigned long long m_StartNS;
+		unsigned long long m_DurationNS;
+		unsigned int m_ThreadId;	// 0 is the main thread, workers start at 1
+	};
+
+	/// Timings for one process type and its most recent update times
+	struct ProcessTypeProfile
+	{
+		std::string m_Name;			// copy of the type name, the stats point at it
+		ProcessTypeStats m_Stats;
+		std::vector<unsigned int> m_RecentNS;
+		unsigned int m_NextRecent;
+	};
+
+	typedef std::priority_queue<SleepTimer, std::vector<SleepTimer>, std::greater<SleepTimer>> SleepTimerHeap;
+	typedef std::unordered_map<EventType, std::vector<SleepWaiter>> SleepEventMap;
+	typedef std::unordered_map<unsigned long long, ProcessTypeProfile> ProcessProfileMap;
+
 public:
+	/// Constructor taking the job system for parallel safe processes -- without one every process is updated on the main thread.
+	/// The name labels the profile dumps and trace
+	explicit ProcessManager(JobSystem* pJobSystem = nullptr, const char* pName = "Processes");
+
 	/// Default destructor
 	~ProcessManager();
 
-	/// Update all processes in the process list
+	/// Update all attached processes
 	unsigned int UpdateProcesses(float deltaTime);
 
-	/// Attach a process to the process manager
-	WeakProcessPtr AttachProcess(StrongProcessPtr pProcess);
+	/// Attach a process to the process manager, it starts on the next update
+	ProcessHandle AttachProcess(StrongProcessPtr pProcess);
+
+	/// Return the process for a handle, or nullptr if it has been removed
+	StrongProcessPtr GetProcess(ProcessHandle handle) const;
+
+	/// Abort a process, it is removed on the next update -- returns false if the handle is stale or the process is already dead
+	bool AbortProcess(ProcessHandle handle);
 
-	/// Abort all processes in the process list
+	/// Abort all attached processes
 	void AbortAllProcesses(bool immediate);
 
-	/// Return the number of processes in the process list
+	/// Return the number of attached processes
 	unsigned int GetProcessCount() const;
 
+	/// Return the number of attached processes that are sleeping
+	unsigned int GetSleepingProcessCount() const;
+
+	/// Turn update profiling on or off -- turning it on starts a fresh profile
+	void EnableProfiling(bool enable);
+
+	/// Return true if updates are being profiled
+	bool IsProfilingEnabled() const { return m_ProfilingEnabled; }
+
+	/// Clear everything recorded so far
+	void ResetProfile();
+
+	/// Fill in everything recorded since profiling was enabled or reset
+	void GetProfileReport(ProcessProfileReport& report) const;
+
+	/// Write the profile to the "ProcessProfile" log, most expensive process types first
+	void DumpProfile() const;
+
+	/// Write the recent updates as a Chrome trace event JSON file -- returns false if the file can't be written
+	bool WriteProfileTrace(const std::string& fileName) const;
+
+	/// Count the frames where UpdateProcesses() takes longer than this many milliseconds -- 0 turns it off
+	void SetProfileFrameBudget(float budgetMillis) { m_ProfileFrameBudgetNS = (unsigned long long)(budgetMillis * 1000000.0f); }
+
+	/// Dump the profile from UpdateProcesses() every intervalMillis while profiling -- 0 turns it off
+	void SetProfileDumpInterval(unsigned long intervalMillis) { m_ProfileDumpIntervalMillis = intervalMillis; }
+
+	/// Write the trace to this file when the process manager is destroyed while profiling -- empty turns it off
+	void SetProfileTraceFile(const std::string& fileName) { m_ProfileTraceFile = fileName; }
+
 private:
-	/// Clears the process list -- called by the destructor
+	/// Clears every process -- called by the destructor
 	void ClearAllProcesses();
 
+	/// Update the parallel safe processes collected this frame
+	void UpdateParallelBatch(float deltaTime);
+
+	/// Return the slot of a handle, or -1 if the handle is stale
+	int GetSlot(ProcessHandle handle) const;
+
+	/// Return the process in a slot
+	const StrongProcessPtr& GetSlotProcess(unsigned int slot) const;
+
+	/// Remove the process at an index of the awake array and free its slot
+	void RemoveProcess(unsigned int denseIndex);
+
+	/// Move the process at an index of one array to the end of the other
+	void MoveProcess(bool toSleeping, unsigned int denseIndex);
+
+	/// Move the process at an index of the awake array to the sleeping array and start waiting for its wake up
+	void ParkProcess(unsigned int denseIndex);
+
+	/// Wake a sleeping process unless the wake up is left over from an earlier sleep
+	void WakeProcess(const SleepWaiter& waiter);
+
+	/// Wake every timed sleeper that is due and every sleeper whose event was sent
+	void WakeDueProcesses();
+
+	/// Listener for event types that processes are sleeping on
+	void OnWakeEvent(IEventPtr pEvent);
+
+	/// Drop a sleeping process from the waiters for its wake event, if it is waiting on one
+	void CancelEventWait(unsigned int slot);
+
+	/// Stop listening for an event type nothing waits on anymore
+	void StopWakeEvent(SleepEventMap::iterator eventIt);
+
+	/// Update a process from the parallel batch, timing it into its batch slot if profiling
+	void UpdateBatchProcess(unsigned int index, float deltaTime, bool profiling);
+
+	/// Return the trace thread id of the calling thread
+	unsigned int GetProfileThreadId() const;
+
+	/// Return the profile for a process type, adding it the first time the type is seen. Types are matched by the
+	/// text of their name, so the same name returned from different places shares one profile
+	ProcessTypeProfile& GetTypeProfile(const char* pName);
+
+	/// Add a timed update to its process type and the trace
+	void RecordUpdate(const ProcessTraceEvent& update);
+
+	/// Add a timed span to the trace, overwriting the oldest once it is full
+	void AddTraceEvent(const ProcessTraceEvent& traceEvent);
+
 private:
-	/// List of all processes currently in queue
-	ProcessList m_ProcessList;
+	/// Processes that are awake
+	ProcessArray m_Awake;
+
+	/// Processes that are sleeping
+	ProcessArray m_Sleeping;
+
+	/// Slot table that handles index into
+	std::vector<ProcessSlot> m_Slots;
+
+	/// Slots that are free to be reused
+	std::vector<unsigned int> m_FreeSlots;
+
+	/// Job system for parallel safe processes, not owned by the process manager
+	JobSystem* m_pJobSystem;
+
+	/// Parallel safe processes collected during an update, kept to reuse its memory
+	ProcessBatch m_ParallelBatch;
+
+	/// Total time the manager has been updated for, the clock timed sleepers wake on
+	double m_Time;
+
+	/// Timed sleepers, the soonest on top
+	SleepTimerHeap m_SleepTimers;
+
+	/// Sleepers for each event type, the manager listens for every type in the map and a type is only in the map while something waits on it
+	SleepEventMap m_SleepEvents;
+
+	/// Sleepers whose event was sent, woken at the start of the next update
+	std::vector<SleepWaiter> m_PendingEventWakes;
+
+	/// Name that labels the profile dumps and trace
+	const char* m_pName;
+
+	/// True if updates are being profiled
+	bool m_ProfilingEnabled;
+
+	/// Frame totals, the per type timings are kept in m_ProfileTypes
+	ProcessProfileReport m_Profile;
+
+	/// Timings for each process type, keyed by a hash of the type name
+	ProcessProfileMap m_ProfileTypes;
+
+	/// Timing of each process in the parallel batch, each worker only writes the slots it updates
+	std::vector<ProcessTraceEvent> m_ParallelTimings;
+
+	/// Recent timed updates, a ring buffer once it reaches PROCESSMANAGER_TRACE_CAPACITY
+	std::vector<ProcessTraceEvent> m_TraceEvents;
+
+	/// Index of the oldest trace event once the ring buffer is full
+	size_t m_NextTraceEvent;
+
+	/// Time the profile started, the trace is relative to it
+	unsigned long long m_ProfileStartNS;
+
+	/// Frame budget for UpdateProcesses(), or 0 for none
+	unsigned long long m_ProfileFrameBudgetNS;
+
+	/// Interval to dump the profile at, or 0 for never
+	unsigned long m_ProfileDumpIntervalMillis;
+
+	/// Time the profile was last dumped
+	unsigned long long m_LastProfileDumpNS;
+
+	/// File the trace is written to on destruction
+	std::string m_ProfileTraceFile;
 };
@@ -7,47 +7,64 @@
 
 #pragma once
 
-#include <Windows.h>
+#include <atomic>
 
+#include "JobSystem.h"
 #include "Process.h"
 
 /**
-	A real time process is a process that runs asynchronously on
-	its own thread.
+	A real time process is a process that runs asynchronously as a job
+	on the global job system instead of being updated every frame. The
+	process succeeds on the first update after ProcessProc() returns.
+	ProcessProc() holds on to a worker until it returns, so it should do
+	a finite piece of work rather than loop forever.
+
+	The job calls ProcessProc() on this object, so it has to finish before
+	the derived part of the object is destroyed. The process waits for it
+	when it fails, is aborted or is removed by its owner. Derived classes
+	that override OnFail(), OnAbort() or OnRemove() must call this version.
 */
 class RealTimeProcess : public Process
 {
 public:
-	/// Constructor sets the thread priority
-	RealTimeProcess(int priority = THREAD_PRIORITY_NORMAL);
+	/// Default constructor
+	RealTimeProcess();
 
-	/// Virtual destructor closes the thread handle
-	virtual ~RealTimeProcess() { CloseHandle(m_ThreadHandle); }
+	/// Virtual destructor, the job must have finished by now
+	virtual ~RealTimeProcess();
 
-	/// Procedure that runs on a separate thread. Pass a RealTimeProcess object
-	/// as the parameter and this procedure calls the implementation
-	/// specific ProcessProc() from that process
-	static DWORD WINAPI ThreadProc(LPVOID lpParam);
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "RealTimeProcess"; }
 
 protected:
-	/// Initialize the Process
+	/// Initialize the Process and submit the job
 	virtual void OnInit();
 
-	/// Update method (does nothing since this runs asynchronously)
-	virtual void OnUpdate(float deltaTime) { }
+	/// Update method succeeds the process once the job has finished
+	virtual void OnUpdate(float deltaTime);
+
+	/// Fail method waits for the job to finish
+	virtual void OnFail() override;
+
+	/// Abort method waits for the job to finish
+	virtual void OnAbort() override;
 
-	/// This is the procedure that will run on a separate thread and is
-	/// implementation specific for each real time process. It is called
-	/// by ThreadProc()
+	/// Remove method waits for the job to finish before the owner releases the process
+	virtual void OnRemove() override;
+
+	/// This is the procedure that runs on the job system and is
+	/// implementation specific for each real time process. It should
+	/// not change the state of the process, that is done on the main thread
 	virtual void ProcessProc() = 0; 
 
-protected:
-	/// A handle to the windows thread
-	HANDLE m_ThreadHandle;
+private:
+	/// Block until the job has finished, running other jobs meanwhile
+	void WaitForJob();
 
-	/// Id of the thread
-	DWORD m_ThreadId;
+protected:
+	/// The job running ProcessProc()
+	JobPtr m_pJob;
 
-	/// Priority of the thread
-	int m_ThreadPriority;
+	/// Set by the job once ProcessProc() returns
+	std::atomic<bool> m_Finished;
 };
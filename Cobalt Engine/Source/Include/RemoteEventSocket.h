@@ -19,7 +19,8 @@ public:
 	enum
 	{
 		NetMsg_Event,
-		NetMsg_PlayerLoginOk
+		NetMsg_PlayerLoginOk,
+		NetMsg_BinaryEvent
 	};
 
 	/// Constructor taking in a socket and ip
@@ -32,6 +33,9 @@ public:
 	virtual void HandleInput();
 
 protected:
-	/// Create an event from network data and dispatch the event
+	/// Create an event from text network data and dispatch the event
 	void CreateEvent(std::istream& in);
+
+	/// Create an event from binary network data and dispatch the event
+	void CreateEvent(EventReadStream& in);
 };
\ No newline at end of file
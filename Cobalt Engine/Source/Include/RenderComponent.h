@@ -75,6 +75,9 @@ protected:
 public:
 	/// Name of the component
 	static const char* g_Name;
+
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
 };
 
 
@@ -102,6 +105,9 @@ protected:
 public:
 	/// Name of the component
 	static const char* g_Name;
+
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
 	
 private:
 	/// Properties of a light component
@@ -134,6 +140,9 @@ public:
 	// Name of the component
 	static const char* g_Name;
 
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
+
 private:
 	/// Name of the texture resource for the sky
 	std::string m_TextureResource;
@@ -174,6 +183,9 @@ public:
 	/// Name of the component
 	static const char* g_Name;
 
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
+
 private:
 	/// Name of the texture resource for the grid
 	std::string m_TextureResource;
@@ -204,6 +216,7 @@ protected:
 
 public:
 	static const char* g_Name;
+	static const ComponentId g_Id;
 
 private:
 	unsigned int m_Segments;
@@ -231,4 +244,5 @@ protected:
 
 public:
 	static const char* g_Name;
+	static const ComponentId g_Id;
 };
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*
+	ResCachePolicy.h
+
+	Eviction policies for the resource cache, and a simulator that
+	replays a recorded access trace to compare them.
+*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// share of the resident resources the 2Q policy keeps on probation
+const float RESCACHEPOLICY_2Q_IN_SHARE = 0.25f;
+
+// how many evicted names the 2Q policy remembers, as a share of the resident resources
+const float RESCACHEPOLICY_2Q_OUT_SHARE = 0.5f;
+
+/**
+	Decides which resource the cache gives up when it needs room. The cache tells the policy
+	about every resource that comes in, gets used or leaves, and asks it for a victim. Policies
+	only see resource names, so the simulator can run them without loading anything.
+*/
+class IResCachePolicy
+{
+public:
+	/// Virtual destructor
+	virtual ~IResCachePolicy() { }
+
+	/// Return the name of the policy for stats
+	virtual const char* GetName() const = 0;
+
+	/// A resource was added to the cache
+	virtual void OnInsert(const std::string& name) = 0;
+
+	/// A resource in the cache was used
+	virtual void OnAccess(const std::string& name) = 0;
+
+	/// A resource left the cache
+	virtual void OnRemove(const std::string& name) = 0;
+
+	/// Return the resource to evict next, or an empty string if there is none
+	virtual std::string GetVictim() = 0;
+
+	/// Forget every resource
+	virtual void Clear() = 0;
+};
+
+/**
+	Evicts the least recently used resource. A hit moves the resource to the front of a list
+	and the map keeps each resource's place in it, so every operation is constant time. This
+	is the constant time LRU that ResCache kept itself before its policies became pluggable,
+	and it is still the cache's default.
+*/
+class LRUCachePolicy : public IResCachePolicy
+{
+	typedef std::list<std::string> NameList;
+	typedef std::unordered_map<std::string, NameList::iterator> NameMap;
+
+public:
+	virtual const char* GetName() const { return "LRU"; }
+	virtual void OnInsert(const std::string& name);
+	virtual void OnAccess(const std::string& name);
+	virtual void OnRemove(const std::string& name);
+	virtual std::string GetVictim();
+	virtual void Clear();
+
+private:
+	/// Most recently used at the front
+	NameList m_List;
+
+	/// Each resource's place in the list
+	NameMap m_Names;
+};
+
+/**
+	Evicts the least frequently used resource, and the least recently used of those on a tie.
+	Resources are kept in one list per use count, so a scan of shared assets that are used once
+	does not push out the ones used every frame.
+*/
+class LFUCachePolicy : public IResCachePolicy
+{
+	typedef std::list<std::string> NameList;
+
+	struct Entry
+	{
+		unsigned long m_Count;			// times the resource was used
+		NameList::iterator m_Position;	// place in the list for its count
+	};
+
+public:
+	virtual const char* GetName() const { return "LFU"; }
+	virtual void OnInsert(const std::string& name);
+	virtual void OnAccess(const std::string& name);
+	virtual void OnRemove(const std::string& name);
+	virtual std::string GetVictim();
+	virtual void Clear();
+
+private:
+	/// Resources by use count, the most recently used of each count at the front
+	std::map<unsigned long, NameList> m_Buckets;
+
+	/// Each resource's count and place
+	std::unordered_map<std::string, Entry> m_Entries;
+};
+
+/**
+	The 2Q policy. New resources go on probation in a FIFO queue and are evicted from it first,
+	so a resource used once never displaces the working set. A resource that comes back after
+	being evicted from probation is remembered by name and goes straight to the main LRU queue.
+*/
+class TwoQueueCachePolicy : public IResCachePolicy
+{
+	typedef std::list<std::string> NameList;
+	typedef std::unordered_map<std::string, NameList::iterator> NameMap;
+
+public:
+	virtual const char* GetName() const { return "2Q"; }
+	virtual void OnInsert(const std::string& name);
+	virtual void OnAccess(const std::string& name);
+	virtual void OnRemove(const std::string& name);
+	virtual std::string GetVictim();
+	virtual void Clear();
+
+private:
+	/// Remember the name of a resource evicted from probation
+	void AddGhost(const std::string& name);
+
+private:
+	/// Probation queue, newest at the front
+	NameList m_In;
+	NameMap m_InNames;
+
+	/// Main queue, most recently used at the front
+	NameList m_Main;
+	NameMap m_MainNames;
+
+	/// Names evicted from probation, newest at the front
+	NameList m_Out;
+	NameMap m_OutNames;
+};
+
+/// One use of a resource, with its size in the cache
+struct ResCacheAccess
+{
+	ResCacheAccess() : m_Size(0) { }
+	ResCacheAccess(const std::string& name, unsigned long long size) : m_Name(name), m_Size(size) { }
+
+	std::string m_Name;				// resource name
+	unsigned long long m_Size;		// bytes the resource takes in the cache, including its extra data
+};
+
+/// How well a cache did over a stretch of accesses
+struct ResCacheStats
+{
+	ResCacheStats() :
+		m_NumHits(0), m_NumMisses(0), m_NumEvictions(0), m_MissedBytes(0)
+	{ }
+
+	/// Return the share of accesses that were hits
+	float GetHitRate() const { return (m_NumHits + m_NumMisses > 0) ? (float)m_NumHits / (m_NumHits + m_NumMisses) : 0.0f; }
+
+	unsigned long m_NumHits;			// accesses that found the resource in the cache
+	unsigned long m_NumMisses;			// accesses that had to load it
+	unsigned long m_NumEvictions;		// resources pushed out to make room
+	unsigned long long m_MissedBytes;	// bytes loaded because of misses
+};
+
+/**
+	Replay an access trace, ex. one recorded with ResCache::RecordAccessTrace(), against a
+	policy and a budget in bytes, and return how the cache would have done. Running the same
+	trace through each policy shows which one suits a game's loading pattern.
+*/
+ResCacheStats SimulateResCachePolicy(const std::vector<ResCacheAccess>& trace, IResCachePolicy* pPolicy, unsigned long long budget);
+
+/// Return a new policy given its name, "LRU", "LFU" or "2Q", or nullptr if there is no such policy
+IResCachePolicy* CreateResCachePolicy(const std::string& name);
+
+/// Write an access trace to a text file, one access per line as its size and name
+bool SaveResCacheTrace(const std::string& fileName, const std::vector<ResCacheAccess>& trace);
+
+/// Read an access trace written by SaveResCacheTrace() -- returns false if the file is missing or malformed
+bool LoadResCacheTrace(const std::string& fileName, std::vector<ResCacheAccess>& trace);
\ No newline at end of file
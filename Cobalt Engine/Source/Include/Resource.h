@@ -11,6 +11,8 @@
 #include <cctype>
 #include <string>
 
+#include "ResourceInterfaces.h"
+
 /**
 	Stores the name of a resource to be used by a resource handle.
 */
@@ -7,33 +7,99 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <list>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
-#include "interfaces.h"
+#include "JobSystem.h"
+#include "ResCachePolicy.h"
+#include "ResourceInterfaces.h"
 
 class ResHandle;
 
+/// Called with the loaded handle, or nullptr if the resource could not be loaded
+typedef std::function<void(shared_ptr<ResHandle>)> ResLoadCallback;
+
 /**
-	Caches resources (as ResHandle's) that are currently loaded into memory in an LRU fashion. 
-	This Resource Cache stores two pointers to every currently loaded ResHandle. 
-	
-	The first is in a linked list where the nodes appear in order in which the resource was 
-	last used. When a resource is used, it is moved to the front of the list.  The front of 
-	the list is most recently used resources and the end of the list is least recently used.
+	A resource that is being loaded in the background, returned by ResCache::GetHandleAsync().
+	Poll IsReady() or block on GetHandle(). Completion callbacks run on the main thread once
+	the handle is in the cache.
+*/
+class ResRequest
+{
+	friend class ResCache;
+public:
+	/// Constructor taking the name of the resource being loaded
+	explicit ResRequest(const std::string& name);
+
+	/// Return the name of the resource being loaded
+	const std::string& GetName() const { return m_Name; }
+
+	/// Return true once the load has finished, whether or not it succeeded
+	bool IsReady() const { return m_Ready.load(); }
+
+	/// Wait for the load to finish and return the handle, nullptr if it failed -- waiting on the main thread runs other jobs meanwhile
+	shared_ptr<ResHandle> GetHandle();
 
-	The second is stored in a map to quickly find resource data with the unique resource id.
+private:
+	/// Name of the resource
+	std::string m_Name;
+
+	/// The load job, it finishes after the callbacks have run
+	JobPtr m_pJob;
+
+	/// Set once the handle is final
+	std::atomic<bool> m_Ready;
+
+	/// The loaded handle
+	shared_ptr<ResHandle> m_Handle;
+
+	/// Callbacks of everyone who asked for the resource while it was loading
+	std::vector<ResLoadCallback> m_Callbacks;
+};
+
+/**
+	Caches resources (as ResHandle's) that are currently loaded into memory. The handles are
+	stored in a map to quickly find resource data with the unique resource id, and an eviction
+	policy decides which resource to give up when the cache is full, LRU unless told otherwise.
+
+	The budget counts each handle's buffer and the memory its extra data reports, ex. a decoded
+	texture on the GPU, in bytes. Resources matching a pattern can be put in a group with its
+	own policy and budget, ex. so textures can not push out every sound, and groups can be
+	pinned so they are never evicted. When the whole cache is full the groups with the lowest
+	priority give up their resources first.
 
 	A list of resource loaders for all the different types stored in this cache is also kept.
+
+	Resources can also be loaded in the background with GetHandleAsync(). The file is read and
+	inflated on a worker, and so is the loader if IResourceLoader::IsThreadSafe() says it can
+	be, otherwise the loader runs on the main thread. Requests for a resource that is already
+	loading join the load in progress. Workers never evict anything, the cache is trimmed back
+	to its size on the main thread as each load finishes, so resources are only ever released
+	where they were used.
 */
 class ResCache
 {
 	friend class ResHandle;
-	typedef std::list<shared_ptr<ResHandle>> ResHandleList;
 	typedef std::unordered_map<std::string, shared_ptr<ResHandle>> ResHandleMap;
 	typedef std::list<shared_ptr<IResourceLoader>> ResourceLoaders;
+	typedef std::unordered_map<std::string, shared_ptr<ResRequest>> ResRequestMap;
+
+	/// Resources matching a pattern that share an eviction policy and a budget
+	struct ResCacheGroup
+	{
+		std::string m_Pattern;					// wildcard pattern of the resource names
+		shared_ptr<IResCachePolicy> m_pPolicy;	// picks the group's next victim
+		unsigned long long m_Budget;			// bytes the group may keep, 0 to only share the cache's size
+		unsigned long long m_Resident;			// bytes of the group's resources in the cache
+		int m_Priority;							// when the cache is full, lower priorities are evicted first
+		bool m_Pinned;							// never evicted
+	};
+
 public:
 	/// Construct the cache with a max size and resource file
 	ResCache(const unsigned int sizeInMb, IResourceFile *resourceFile);
@@ -47,9 +113,40 @@ public:
 	/// Register a resource loader with this cache
 	void RegisterLoader(shared_ptr<IResourceLoader> loader);
 
+	/// Set the size of the cache in bytes
+	void SetCacheSize(unsigned long long size);
+
+	/// Return the size of the cache in bytes
+	unsigned long long GetCacheSize() const { return m_CacheSize; }
+
+	/// Return the bytes allocated by resources, including ones that left the cache but are still held
+	unsigned long long GetAllocated() const { return m_Allocated; }
+
+	/// Set the eviction policy of the resources that are in no group
+	void SetPolicy(shared_ptr<IResCachePolicy> pPolicy);
+
+	/// Give resources matching a pattern their own policy and budget in bytes -- resources already in the cache that match move into it
+	void AddGroup(const std::string& pattern, shared_ptr<IResCachePolicy> pPolicy, unsigned long long budget = 0, int priority = 0);
+
+	/// Keep resources matching a pattern until the cache is flushed, including the ones already in it
+	void Pin(const std::string& pattern);
+
+	/// Set the job system used to load in the background -- nullptr loads everything on the calling thread
+	void SetJobSystem(JobSystem* pJobSystem);
+
 	/// Return a handle given a particular resource. If it is not yet in the cache it will be loaded
 	shared_ptr<ResHandle> GetHandle(Resource* r);
 
+	/// Start loading a resource in the background -- the callback runs straight away if it is already in the cache
+	shared_ptr<ResRequest> GetHandleAsync(Resource* r, const ResLoadCallback& callback = nullptr);
+
+	/// Wait for every background load to finish
+	void WaitForPendingLoads();
+
+	/// Read a resource a piece at a time through a bounded staging buffer without caching it, ex. for a large level file
+	/// -- unless the file is thread safe, the callback must not load resources since the file stays locked
+	bool StreamResource(Resource* r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback);
+
 	/// Preload resources matching the pattern into the cache
 	int PreLoad(const std::string& pattern, std::function<void(int, bool&)> progressCallback);
 
@@ -62,38 +159,89 @@ public:
 	/// Return true if using the games development directories
 	bool IsUsingDevelopmentDirectories() const;
 
+	/// Return true if the resource file is read through a memory mapping
+	bool IsMemoryMapped() const;
+
+	/// Return the hits, misses and evictions since the stats were reset
+	ResCacheStats GetStats();
+
+	/// Start counting the stats over
+	void ResetStats();
+
+	/// Log the stats and the memory use of each group under the "Resource Cache" tag
+	void DumpStats();
+
+	/// Turn recording every access on or off, the trace can be replayed with SimulateResCachePolicy()
+	void RecordAccessTrace(bool record);
+
+	/// Return the recorded accesses
+	std::vector<ResCacheAccess> GetAccessTrace();
+
 protected:
 	/// Return a handle to a resource if it exists in the cache
 	shared_ptr<ResHandle> Find(Resource* r);
 
-	/// Push the handle to the front of the LRU list marking it as most recently used
+	/// Tell the handle's policy it was used
 	void Update(shared_ptr<ResHandle> handle);
 
 	/// Load a resource from disk into the resource cache
 	shared_ptr<ResHandle> Load(Resource* r);
 
+	/// Return the loader for a resource
+	shared_ptr<IResourceLoader> FindLoader(const Resource& r);
+
+	/// Read a resource from the file into a buffer, or return a view of it in the file -- returns nullptr if it can not be read
+	char* ReadRawResource(const Resource& r, shared_ptr<IResourceLoader> loader, unsigned int& rawSize, bool& rawIsView, bool makeRoom);
+
+	/// Create a handle from the raw data, takes ownership of the raw buffer unless it is a view
+	shared_ptr<ResHandle> CreateHandle(const Resource& r, shared_ptr<IResourceLoader> loader, char* rawBuffer, unsigned int rawSize, bool rawIsView, bool makeRoom);
+
+	/// Add a loaded handle to the cache -- returns the handle already in the cache if someone else loaded it first
+	shared_ptr<ResHandle> Insert(shared_ptr<ResHandle> handle);
+
+	/// Create the job that reads a resource for a request on a worker and finishes it on the main thread
+	JobPtr CreateLoadJob(const shared_ptr<ResRequest>& pRequest, const Resource& resource);
+
+	/// Finish a background load on the main thread
+	void CompleteRequest(shared_ptr<ResRequest> pRequest, const Resource& r, shared_ptr<IResourceLoader> loader, char* rawBuffer, unsigned int rawSize, bool rawIsView);
+
 	/// Remove an item from cache -- memory will not be freed until ref count of the object is 0
 	void Free(shared_ptr<ResHandle> handle);
 
+	/// Remove an item from the cache, its group and its policy
+	void Remove(ResHandleMap::iterator it);
+
+	/// Return the index of the group a resource belongs to
+	unsigned int FindGroup(const std::string& name) const;
+
+	/// Remove resources from a group until it fits its budget
+	void TrimGroup(unsigned int groupIndex);
+
 	/// Attempt to make room in the cache for a given size
-	bool MakeRoom(unsigned int size);
+	bool MakeRoom(unsigned long long size);
+
+	/// Count memory against the cache size -- without making room the cache may go over its size until TrimToSize()
+	bool Reserve(unsigned int size, bool makeRoom = true);
 
-	/// Allocate space for an object and return a pointer to that memory
-	char* Allocate(unsigned int size);
+	/// Allocate space for an object and return a pointer to that memory -- without making room the cache may go over its size until TrimToSize()
+	char* Allocate(unsigned int size, bool makeRoom = true);
 
-	/// Remove the least recently used item from the cache -- memory will not be freed until ref count of the object is 0
-	void FreeOneResource();
+	/// Remove resources until the allocated memory fits the cache again
+	void TrimToSize();
+
+	/// Remove the victim of the lowest priority group from the cache -- memory will not be freed until ref count of the object is 0
+	bool FreeOneResource();
 
 	/// Decrease the total amount of allocated memory -- call this when the handle is finally freed
-	void MemoryHasBeenFreed(unsigned int size);
+	void MemoryHasBeenFreed(unsigned long long size);
 
 protected:
-	/// The LRU cache holding pointers to resource handles
-	ResHandleList m_LRU;
-
 	/// A map of names to resource handles
 	ResHandleMap m_Resources;
 
+	/// Groups of resources with their own policies and budgets, the first one holds every resource that matches no other
+	std::vector<ResCacheGroup> m_Groups;
+
 	/// A list of loaders for the files in this cache
 	ResourceLoaders m_ResourceLoaders;
 
@@ -101,8 +249,27 @@ protected:
 	IResourceFile* m_File;
 
 	/// Total size of the cache
-	unsigned int m_CacheSize;
+	unsigned long long m_CacheSize;
 
 	/// Total memory currently allocated
-	unsigned int m_Allocated;
+	unsigned long long m_Allocated;
+
+	/// Hits, misses and evictions since the stats were reset
+	ResCacheStats m_Stats;
+
+	/// Accesses recorded for the simulator
+	std::vector<ResCacheAccess> m_AccessTrace;
+	bool m_RecordAccessTrace;
+
+	/// Job system for background loads, nullptr to load everything on the calling thread
+	JobSystem* m_pJobSystem;
+
+	/// Background loads that have not finished, so a second request joins the first
+	ResRequestMap m_PendingLoads;
+
+	/// Guards the map, the groups, the pending loads and the memory counts -- recursive because freeing a handle reports back to the cache
+	std::recursive_mutex m_Mutex;
+
+	/// Reads of a resource file that is not thread safe go through a single file handle, one read at a time
+	std::mutex m_FileMutex;
 };
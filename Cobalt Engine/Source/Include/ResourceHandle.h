@@ -9,8 +9,10 @@
 
 #include <string>
 
-#include "interfaces.h"
 #include "Resource.h"
+#include "ResourceInterfaces.h"
+
+class ResCache;
 
 /**
 	This Handle pairs a loaded resource (the name) to the actual loaded data. This Handle manages
@@ -21,8 +23,8 @@ class ResHandle
 {
 	friend class ResCache;
 public:
-	/// Constructor to build a resource handle 
-	ResHandle(const Resource& resource, char* buffer, unsigned int size, ResCache* pCache);
+	/// Constructor to build a resource handle, a buffer it does not own is a view into the resource file and is never freed
+	ResHandle(const Resource& resource, char* buffer, unsigned int size, ResCache* pCache, bool ownsBuffer = true);
 
 	/// Virtual Destructor
 	virtual ~ResHandle();
@@ -36,7 +38,7 @@ public:
 	/// Return a read only pointer to the data buffer of the loaded resource
 	const char* Buffer() const;
 
-	/// Return a writable pointer to the data buffer of the loaded resource
+	/// Return a writable pointer to the data buffer of the loaded resource, null if the buffer is a read only view
 	char* WritableBuffer();
 
 	/// Return the extra data stored in the resource handle
@@ -45,6 +47,9 @@ public:
 	/// Set the resource handles extra data
 	void SetExtra(shared_ptr<IResourceExtraData> extra);
 
+	/// Return the memory the extra data reported when the resource was loaded
+	unsigned int GetExtraSize() const;
+
 protected:
 	/// The resource that is loaded
 	Resource m_Resouce;
@@ -55,9 +60,18 @@ protected:
 	/// Size of the loaded resource
 	unsigned int m_Size;
 
+	/// Does the handle own the buffer, or does it point into the resource file
+	bool m_OwnsBuffer;
+
 	/// Extra data belonging to the resource
 	shared_ptr<IResourceExtraData> m_Extra;
 
+	/// Memory the extra data reported, counted by the cache along with the buffer
+	unsigned int m_ExtraSize;
+
+	/// Index of the cache group the resource belongs to
+	unsigned int m_CacheGroup;
+
 	/// Pointer to the resource cache that owns this resource handle
 	ResCache* m_pResCache;
 };
@@ -0,0 +1,107 @@
+/*
+	ResourceInterfaces.h
+
+	The interfaces the resource cache is built on. They are kept apart
+	from interfaces.h so the cache can be compiled without the rendering
+	and platform headers, ex. by the tests.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+using std::shared_ptr;
+
+// forward declarations
+class JobSystem;
+class Resource;
+class ResHandle;
+
+/**
+	Interface for a resource file. This is the base class for a single resource file
+	that contains several resources inside of it. Subclasses must implement all the pure
+	virtual methods in this class.
+*/
+class IResourceFile
+{
+public:
+	/// Open the file and return success or failure
+	virtual bool Open() = 0;
+
+	/// Return the size of the resource based on the name of the resource
+	virtual int GetRawResourceSize(const Resource& r) = 0;
+
+	/// Read the resource into a buffer and return how many bytes were read
+	virtual int GetRawResource(const Resource& r, char* buffer) = 0;
+
+	/// Return a read only pointer to the resource's bytes if they can be used in place, ex. from a memory mapped file, otherwise null
+	virtual const char* GetRawResourceView(const Resource& r) { return nullptr; }
+
+	/// Read the resource a piece at a time through a staging buffer of the given size -- the callback returns false to stop
+	virtual bool StreamRawResource(const Resource& r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback) { return false; }
+
+	/// Return true if resources can be read from several threads at once
+	virtual bool IsThreadSafe() const { return false; }
+
+	/// Return true if the file is read through a memory mapping
+	virtual bool IsMemoryMapped() const { return false; }
+
+	/// Set the job system the file can spread its work across, ex. inflating -- nullptr works on the calling thread
+	virtual void SetJobSystem(JobSystem* pJobSystem) { }
+	
+	/// Return the number of resources in a resource file
+	virtual int GetNumResources() const = 0;
+
+	/// Return the name of the nth resource
+	virtual std::string GetResourceName(int n) const = 0;
+	
+	/// Return true if using the games development directories
+	virtual bool IsUsingDevelopmentDirectories() const = 0;
+
+	/// Virtual Destructor
+	virtual ~IResourceFile() { }
+};
+
+/**
+	Used to attach extra data to a resource such as length or file format.
+*/
+class IResourceExtraData
+{
+public:
+	/// Returns a string describing the extra data
+	virtual std::string ToStr() = 0;
+
+	/// Return the memory the extra data holds outside the resource's buffer, ex. a texture on the GPU
+	virtual unsigned int GetMemorySize() { return 0; }
+};
+
+/**
+	Defines the behavior that individual resource loaders must implement. Loaders are used
+	for resources that need additional processing on load.
+*/
+class IResourceLoader
+{
+public:
+	/// Returns a pattern that the resource cache uses to distinguish which loader is used with which files
+	virtual std::string GetPattern() = 0;
+
+	/// Return true if the resource loader can use the stored data with no extra processing
+	virtual bool UseRawFile() = 0;
+
+	/// Return whether to release the raw buffer of a resource after it has been loaded
+	virtual bool DiscardRawBufferAfterLoad() = 0;
+
+	/// Return whether the file buffer ends in a null terminator after the raw data
+	virtual bool AddNullZero() { return false; }
+
+	/// Return true if LoadResource() can run on a worker thread, ex. it only parses the buffer
+	virtual bool IsThreadSafe() { return false; }
+
+	/// Return the size of the loaded resource
+	virtual unsigned int GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize) = 0;
+
+	/// Load a resource into a resource handle
+	virtual bool LoadResource(char* rawBuffer, unsigned int rawSize, shared_ptr<ResHandle> handle) = 0;
+};
@@ -21,8 +21,8 @@ class Resource;
 class ResourceZipFile : public IResourceFile
 {
 public:
-	/// Constructor taking a file name as a param
-	ResourceZipFile(const std::wstring& resFileName);
+	/// Constructor taking a file name and whether to memory map the file
+	ResourceZipFile(const std::wstring& resFileName, bool memoryMap = true);
 
 	/// Virtual Destructor
 	virtual ~ResourceZipFile();
@@ -36,6 +36,21 @@ public:
 	/// Read the resource into a buffer and return how many bytes were read
 	virtual int GetRawResource(const Resource& r, char* buffer);
 
+	/// Return a pointer to the resource in the mapped zip file if it is stored uncompressed
+	virtual const char* GetRawResourceView(const Resource& r);
+
+	/// Inflate the resource a piece at a time through a staging buffer of the given size
+	virtual bool StreamRawResource(const Resource& r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback);
+
+	/// Return true if the zip file is mapped, reading then shares no file position
+	virtual bool IsThreadSafe() const;
+
+	/// Return true if the zip file was mapped, it falls back on stdio if mapping failed
+	virtual bool IsMemoryMapped() const;
+
+	/// Set the job system chunked files are inflated on
+	virtual void SetJobSystem(JobSystem* pJobSystem);
+
 	/// Return the number of resources in a resource file
 	virtual int GetNumResources() const;
 
@@ -51,6 +66,12 @@ private:
 
 	/// Name of the resource file on disk
 	std::wstring m_resFileName;
+
+	/// Memory map the zip file instead of reading it with stdio
+	bool m_MemoryMap;
+
+	/// Job system chunked files are inflated on, kept until the zip file is opened
+	JobSystem* m_pJobSystem;
 };
 
 
@@ -81,6 +102,18 @@ public:
 	/// Read the resource into a buffer and return how many bytes were read
 	virtual int GetRawResource(const Resource& r, char* buffer);
 
+	/// Return null, the asset files can change on disk so they are always read
+	virtual const char* GetRawResourceView(const Resource& r) { return nullptr; }
+
+	/// Return false, the asset files are not streamed
+	virtual bool StreamRawResource(const Resource& r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback) { return false; }
+
+	/// Return false, the asset files are read with stdio
+	virtual bool IsThreadSafe() const { return false; }
+
+	/// Return false, the asset files are read with stdio
+	virtual bool IsMemoryMapped() const { return false; }
+
 	/// Return the number of resources in a resource file
 	virtual int GetNumResources() const;
 
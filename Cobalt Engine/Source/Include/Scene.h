@@ -20,8 +20,25 @@ class RayCast;
 /// A hash map that allows fast lookup of a scene node given an id
 typedef std::unordered_map<GameObjectId, shared_ptr<ISceneNode>> SceneObjectMap;
 
+/// The transforms a moving object is drawn between
+struct SceneObjectMotion
+{
+	Mat4x4 m_Previous;		// transform at the end of the tick before last
+	Mat4x4 m_Current;		// transform at the end of the last tick
+	bool m_MovedThisTick;	// true once a move arrives during the current tick
+};
+
+/// A hash map of the objects that moved in the last tick
+typedef std::unordered_map<GameObjectId, SceneObjectMotion> SceneMotionMap;
+
 /**
 	A hierarchical container of scene nodes.
+
+	The game logic moves objects in fixed ticks that do not line up with frames. The scene
+	keeps the transforms from the end of the last two ticks for each object that is moving and
+	draws it in between, based on how far real time has got toward the next tick. Objects
+	that stop moving are dropped after a tick, so the cost scales with the number of moving
+	objects.
 */
 class Scene
 {
@@ -41,9 +58,12 @@ public:
 	/// Called when the device is lost
 	HRESULT OnLostDevice();
 	
-	/// Update the scene called once per frame
+	/// Update the scene called once per simulation tick
 	HRESULT OnUpdate(float deltaTime);
 
+	/// Set how far real time is between the last tick and the next one, from 0 to 1, for the next render
+	void SetInterpolation(float interpolation) { m_Interpolation = interpolation; }
+
 	/// Return a pointer to a scene node by giving a game object id
 	shared_ptr<ISceneNode> FindObject(GameObjectId id);
 
@@ -90,6 +110,9 @@ protected:
 	/// Render the nodes that have transparency
 	void RenderAlphaPass();
 
+	/// Move every moving object to its transform between the last two ticks
+	void InterpolateMotion();
+
 protected:
 	/// Root node in the scene graph
 	shared_ptr<SceneNode> m_Root;
@@ -111,4 +134,10 @@ protected:
 
 	/// A helper object to manage multiple directional lights
 	LightManager* m_LightManager;
+
+	/// Transforms for the objects that are moving
+	SceneMotionMap m_Motion;
+
+	/// Fraction of the way from the previous transforms to the current ones to draw at
+	float m_Interpolation;
 };
\ No newline at end of file
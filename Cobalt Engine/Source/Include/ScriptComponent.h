@@ -80,6 +80,7 @@ private:
 
 public:
 	static const char* g_Name;
+	static const ComponentId g_Id;
 
 private:
 	// private data members
@@ -60,6 +60,12 @@ public:
 	/// Pause the sound if it is playing
 	void PauseSound();
 
+	/// Polling the status of its own DirectSound buffer is safe from any thread
+	virtual bool IsParallelSafe() const override { return true; }
+
+	/// Return the name of the process type
+	virtual const char* GetName() const override { return "SoundProcess"; }
+
 protected:
 	/// Initialize the sound
 	virtual void OnInit();
@@ -70,6 +70,9 @@ public:
 	/// Name of the component
 	static const char* g_Name;
 
+	/// Id of the component, hashed from the name once at startup
+	static const ComponentId g_Id;
+
 private:
 	/// 4x4 matrix representing position, rotation, and scale
 	Mat4x4 m_Transform;
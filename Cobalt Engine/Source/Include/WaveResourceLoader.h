@@ -28,6 +28,9 @@ public:
 	/// Return true to release the raw wave buffer once the sound is loaded
 	virtual bool DiscardRawBufferAfterLoad();
 
+	/// Return true, decoding the wave only touches the buffers so it can run on a worker
+	virtual bool IsThreadSafe();
+
 	/// Return the size of the loaded wave resource
 	virtual unsigned int GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize);
 
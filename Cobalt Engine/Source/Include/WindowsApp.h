@@ -8,12 +8,16 @@
 #pragma once
 
 #include <DXUT.h>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
 #include "BaseSocketManager.h"
+#include "EventJournal.h"
 #include "EventManager.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
 #include "Initialization.h"
 #include "NetworkEventForwarder.h"
 #include "types.h"
@@ -50,6 +54,15 @@ public:
 	
 	/// Initialize the application layer
 	virtual bool InitInstance(HINSTANCE hInstance, LPWSTR lpCmdLine, HWND hWnd = nullptr, int screenWidth = 800, int screenHeight = 600);
+
+	/// Initialize the application layer as a dedicated server, without a window, device, renderer or audio
+	virtual bool InitHeadless(HINSTANCE hInstance);
+
+	/// Run the game logic and networking in fixed ticks until the game quits -- returns the exit code
+	int RunHeadless();
+
+	/// Is the application running as a headless server?
+	bool IsHeadless() const { return m_IsHeadless; }
 	
 	/// Message procedure callback for handling messages from the operating system
 	static LRESULT CALLBACK MsgProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, bool* pDoneProcessing, void* pUserContext);
@@ -75,6 +88,9 @@ public:
 	/// Create the intial game logic and view
 	virtual BaseGameLogic* CreateGameAndView() = 0;
 
+	/// Create the game logic for a headless server, with no human views -- games that support it override this
+	virtual BaseGameLogic* CreateGameServer();
+
 	/// Load a game
 	virtual bool LoadGame();
 
@@ -180,6 +196,21 @@ private:
 	/// Register engine events
 	void RegisterEngineEvents();
 
+	/// Create the systems both the windowed game and the headless server use -- media loaders are skipped without a renderer
+	bool InitEngineSystems(bool loadMedia);
+
+	/// Set the resource cache's policy, groups and pinned resources from the <ResCache> options
+	void ConfigureResCache();
+
+	/// Start recording or replaying events, once the game logic exists
+	void StartJournal();
+
+	/// Process events and update the game logic for as many fixed ticks as are due
+	void UpdateGame(float deltaTime);
+
+	/// Console handler that stops a headless server on ctrl+c or when the console closes
+	static BOOL WINAPI OnConsoleCtrl(DWORD ctrlType);
+
 public:
 	/// Pointer to the game logic layer
 	BaseGameLogic* m_pGame;
@@ -205,6 +236,18 @@ public:
 	/// Event manager for the game
 	EventManager* m_pEventManager;
 
+	/// Worker threads shared by engine systems
+	JobSystem* m_pJobSystem;
+
+	/// Records events for offline replay, or replays a recording
+	EventJournal* m_pEventJournal;
+
+	/// Runs the game logic in fixed ticks however fast frames are rendered
+	FixedTimestep m_Timestep;
+
+	/// Limits the frame rate without busy waiting and measures frame times
+	FramePacer m_FramePacer;
+
 protected:
 	/// Instance handle to the application
 	HINSTANCE m_hInstance;
@@ -218,8 +261,8 @@ protected:
 	/// Has quit been requested by the user?
 	bool m_QuitRequested;
 
-	/// Is the game currently shutting down
-	bool m_Quitting;
+	/// Is the game currently shutting down -- set from the console control handler's thread on a headless server
+	std::atomic<bool> m_Quitting;
 	Rect m_RCDesktop;
 
 	/// Size of the display screen in pixels
@@ -229,6 +272,9 @@ protected:
 	/// Is the editor currently running
 	bool m_IsEditorRunning;
 
+	/// Is the application a headless server with no window or renderer
+	bool m_IsHeadless;
+
 	std::unordered_map<std::wstring, std::wstring> m_TextResource;
 	std::unordered_map<std::wstring, unsigned int> m_HotKeys;
 	
@@ -19,6 +19,9 @@
 class XmlResourceExtraData : public IResourceExtraData
 {
 public:
+	/// Default constructor
+	XmlResourceExtraData() : m_MemorySize(0) { }
+
 	/// Get the root element of an xml document
 	TiXmlElement* GetRoot() { return m_XmlDocument.RootElement(); }
 
@@ -28,9 +31,15 @@ public:
 	/// Returns a string describing the extra data
 	virtual std::string ToStr() { return "XmlResourceExtraData"; }
 
+	/// Return an estimate of the memory the parsed document holds
+	virtual unsigned int GetMemorySize() { return m_MemorySize; }
+
 private:
 	/// The stored xml document
 	TiXmlDocument m_XmlDocument;
+
+	/// Bytes of the document's nodes, attributes and strings, counted once after parsing
+	unsigned int m_MemorySize;
 };
 
 
@@ -46,6 +55,9 @@ public:
 	/// Return true so the raw buffer will be discarded
 	virtual bool DiscardRawBufferAfterLoad() { return true; }
 
+	/// Return true, parsing only touches the buffer so it can run on a worker
+	virtual bool IsThreadSafe() { return true; }
+
 	/// Return the loaded resource size
 	virtual unsigned int GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize) { return rawSize; }
 
@@ -29,6 +29,17 @@
 	|======================|
 	|    TZipDirHeader     |
 	========================
+
+	Our own packed archives can split a large deflated file into chunks that inflate on their
+	own, so ReadFile() can inflate them on every core. The packer compresses each chunk of
+	uncompressed bytes with a Z_FULL_FLUSH after it, which ends the deflate block on a byte
+	boundary and drops the dictionary, so the file is still one valid deflate stream for any
+	other zip tool. The chunk table goes in the TZipDirFileHeader's extra field:
+
+	word	ZIPFILE_CHUNK_TABLE_ID
+	word	size of the data that follows
+	dword	uncompressed bytes in each chunk, the last one may be shorter
+	dword	offset of each chunk after the first in the compressed data
 */
 
 #pragma once
@@ -37,9 +48,20 @@
 #include <stdio.h>
 #include <unordered_map>
 
+class JobSystem;
+
 // Maps a path to a zip content id
 typedef std::unordered_map<std::string, int> ZipContentsMap;
 
+// Called with each piece of a file as it is inflated -- return false to stop reading
+typedef std::function<bool(const char*, unsigned int)> ZipStreamCallback;
+
+// staging buffer size used by ReadLargeFile(), and a good default for ReadFileStreamed()
+const unsigned int ZIPFILE_STREAM_STAGING_SIZE = 128 * 1024;
+
+// id of the extra field that holds the chunk table of a file that can be inflated in parallel
+const unsigned short ZIPFILE_CHUNK_TABLE_ID = 0x4243;
+
 /**
 	Represents a zip file existing in memory.
 
@@ -55,8 +77,8 @@ public:
 	/// Virtual destructor
 	virtual ~ZipFile();
 
-	/// Initialize a zip object from a zip file on disk
-	bool Init(const std::wstring& resourceFileName);
+	/// Initialize a zip object from a zip file on disk, memory mapping the file unless told not to
+	bool Init(const std::wstring& resourceFileName, bool memoryMap = true);
 
 	/// Clear the object and erase any memory
 	void End();
@@ -70,15 +92,27 @@ public:
 	/// Get the uncompressed size of a file given an index
 	int GetFileLength(int index) const;
 
-	/// Uncompress the contents of a file into a buffer. This method will block while the file is loaded.
+	/// Uncompress the contents of a file into a buffer. This method will block while the file is loaded. Chunked files inflate in parallel when mapped.
 	bool ReadFile(int index, void* pBuffer);
 
+	/// Inflate a file a piece at a time into a staging buffer of the given size and pass each piece to the callback
+	bool ReadFileStreamed(int index, unsigned int stagingSize, const ZipStreamCallback& callback);
+
 	/// Read a large file into a buffer asynchronously
 	bool ReadLargeFile(int index, void* pBuffer, std::function<void(int, bool&)> progressCallback);
 
 	/// Find the index of a particular file
 	int Find(const std::string& path) const;
 
+	/// Return true if the zip file is memory mapped instead of read with stdio
+	bool IsMemoryMapped() const;
+
+	/// Return a pointer to a stored file's bytes in the mapping, null if the file is compressed or the zip file is not mapped
+	const char* GetFileView(int index) const;
+
+	/// Set the job system chunked files are inflated on -- nullptr inflates them on the calling thread
+	void SetJobSystem(JobSystem* pJobSystem);
+
 	/// Map of names to indices in the object
 	ZipContentsMap m_ZipContentsMap;
 
@@ -92,9 +126,45 @@ private:
 	// Struct representing a Local Header before a file
 	struct TZipLocalHeader;
 
-	/// Pointer to the zip file on disk
+	/// Map the whole zip file into memory
+	bool Map(const std::wstring& resourceFileName);
+
+	/// Release the mapping or close the file
+	void Close();
+
+	/// Return the size of the zip file on disk
+	unsigned long GetArchiveSize();
+
+	/// Return a pointer to a range of the mapping, null if it is not mapped or the range is outside the file
+	const char* GetMappedData(unsigned long offset, unsigned long size) const;
+
+	/// Copy a range of the zip file into a buffer, from the mapping or the file
+	bool ReadAt(unsigned long offset, void* pBuffer, unsigned long size);
+
+	/// Read the local header of a file and find where its data starts
+	bool ReadLocalHeader(int index, TZipLocalHeader& h, unsigned long& dataOffset);
+
+	/// Check a local header against the file's directory entry and take the directory's sizes if the local ones were left out
+	bool CheckLocalHeader(int index, TZipLocalHeader& h) const;
+
+	/// Find a file's chunk table -- returns the number of chunks, 0 if the file is not chunked
+	unsigned int GetChunkTable(int index, unsigned long& chunkSize, const char*& pOffsets) const;
+
+	/// Inflate the chunks of a mapped file across the job system's threads
+	bool InflateChunks(const char* pSource, unsigned long cSize, char* pDest, unsigned long ucSize, unsigned long chunkSize, const char* pOffsets, unsigned int numChunks);
+
+	/// Pointer to the zip file on disk when it is read with stdio
 	FILE* m_pFile;
 
+	/// The whole zip file when it is memory mapped
+	const char* m_pMappedData;
+
+	/// Size of the mapping in bytes
+	unsigned long m_MappedSize;
+
+	/// Job system that chunked files are inflated on
+	JobSystem* m_pJobSystem;
+
 	/// Raw dir data
 	char* m_pDirData;
 
@@ -8,15 +8,15 @@
 
 #pragma once
 
-#include <concurrent_queue.h>
 #include <d3dx9.h>
 #include <FastDelegate.h>
+#include <functional>
 #include <list>
 #include <memory>
 #include <tinyxml.h>
 #include <Windows.h>
 
-#include "concurrent_queue.h"
+#include "MpscRingBuffer.h"
 
 using std::unique_ptr;
 using std::shared_ptr;
@@ -27,6 +27,7 @@ using std::dynamic_pointer_cast;
 // forward declarations
 class GameObject;
 class Component;
+class JobSystem;
 
 typedef unsigned int GameObjectId;
 typedef unsigned int ComponentId;
@@ -249,74 +250,7 @@ public:
 //====================================================
 //	Resource Interfaces
 //====================================================
-class Resource;
-class ResHandle;
-
-/**
-	Interface for a resource file. This is the base class for a single resource file
-	that contains several resources inside of it. Subclasses must implement all the pure
-	virtual methods in this class.
-*/
-class IResourceFile
-{
-public:
-	/// Open the file and return success or failure
-	virtual bool Open() = 0;
-
-	/// Return the size of the resource based on the name of the resource
-	virtual int GetRawResourceSize(const Resource& r) = 0;
-
-	/// Read the resource into a buffer and return how many bytes were read
-	virtual int GetRawResource(const Resource& r, char* buffer) = 0;
-	
-	/// Return the number of resources in a resource file
-	virtual int GetNumResources() const = 0;
-
-	/// Return the name of the nth resource
-	virtual std::string GetResourceName(int n) const = 0;
-	
-	/// Return true if using the games development directories
-	virtual bool IsUsingDevelopmentDirectories() const = 0;
-
-	/// Virtual Destructor
-	virtual ~IResourceFile() { }
-};
-
-/**
-	Used to attach extra data to a resource such as length or file format.
-*/
-class IResourceExtraData
-{
-public:
-	/// Returns a string describing the extra data
-	virtual std::string ToStr() = 0;
-};
-
-/**
-	Defines the behavior that individual resource loaders must implement. Loaders are used
-	for resources that need additional processing on load.
-*/
-class IResourceLoader
-{
-public:
-	/// Returns a pattern that the resource cache uses to distinguish which loader is used with which files
-	virtual std::string GetPattern() = 0;
-
-	/// Return true if the resource loader can use the stored data with no extra processing
-	virtual bool UseRawFile() = 0;
-
-	/// Return whether to release the raw buffer of a resource after it has been loaded
-	virtual bool DiscardRawBufferAfterLoad() = 0;
-
-	/// Return whether the file buffer ends in a null terminator after the raw data
-	virtual bool AddNullZero() { return false; }
-
-	/// Return the size of the loaded resource
-	virtual unsigned int GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize) = 0;
-
-	/// Load a resource into a resource handle
-	virtual bool LoadResource(char* rawBuffer, unsigned int rawSize, shared_ptr<ResHandle> handle) = 0;
-};
+#include "ResourceInterfaces.h"
  
 
 //====================================================
@@ -362,6 +296,8 @@ class IJoystickHandler
 typedef unsigned long EventType;
 class IEvent;
 typedef shared_ptr<IEvent> IEventPtr;
+class EventReadStream;
+class EventWriteStream;
 
 /**
 	Interface for every event object.
@@ -384,6 +320,12 @@ public:
 	/// Deserialize an event from an input stream
 	virtual void Deserialize(std::istream& in) = 0;
 
+	/// Serialize the event to a compact binary stream
+	virtual void SerializeBinary(EventWriteStream& out) const = 0;
+
+	/// Deserialize an event from a binary stream -- returns false if the data was malformed
+	virtual bool DeserializeBinary(EventReadStream& in) = 0;
+
 	/// Copy the event and return a pointer to it
 	virtual IEventPtr Copy() const = 0;
 
@@ -393,7 +335,7 @@ public:
 
 // create a typedef for an event listener function aka delegate
 typedef fastdelegate::FastDelegate1<IEventPtr> EventListenerDelegate;
-typedef concurrent_queue<IEventPtr> ThreadSafeEventQueue;
+typedef MpscRingBuffer<IEventPtr> ThreadSafeEventQueue;
 
 /**
 	Interface for an event manager. This object will maintain a list of registered events 
@@ -409,8 +351,9 @@ public:
 	/// Virtual destructor
 	virtual ~IEventManager();
 
-	/// Registers a delegate function that will get called when the event type is triggered -- returns true if successful
-	virtual bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type) = 0;
+	/// Registers a delegate function that will get called when the event type is triggered -- returns true if successful.
+	/// Listeners flagged concurrentSafe may be called from a worker thread at the same time as other listeners
+	virtual bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type, bool concurrentSafe = false) = 0;
 
 	/// Remove a delegate/event type pairing -- returns false if the pairing is not found
 	virtual bool RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type) = 0;
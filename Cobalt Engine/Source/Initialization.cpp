@@ -13,6 +13,8 @@
 #include <tchar.h>
 
 #include "EngineStd.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
 #include "Initialization.h"
 #include "Logger.h"
 #include "types.h"
@@ -159,6 +161,9 @@ GameOptions::GameOptions()
 	m_Level = "";
 	m_Renderer = "Direct3D 9";
 	m_RunFullSpeed = false;
+	m_FrameRate = FRAMEPACER_DEFAULT_FRAME_RATE;
+	m_FrameSpinTime = FRAMEPACER_DEFAULT_SPIN_MS;
+	m_FrameStatsDumpInterval = 0;
 	m_SoundEffectsVolume = 1.0f;
 	m_MusicVolume = 1.0f;
 	m_ExpectedPlayers = 1;
@@ -167,8 +172,19 @@ GameOptions::GameOptions()
 	m_NumAIs = 1;
 	m_MaxAIs = 4;
 	m_MaxPlayers = 4;
+	m_TextNetworkEvents = false;
+	m_Headless = false;
+	m_ServerTickRate = 0.0f;
+	m_TickRate = FIXEDTIMESTEP_DEFAULT_TICK_RATE;
+	m_MaxTicksPerFrame = FIXEDTIMESTEP_DEFAULT_MAX_TICKS;
+	m_EventStats = false;
+	m_EventStatsDumpInterval = 0;
+	m_ProcessProfile = false;
+	m_ProcessProfileDumpInterval = 0;
+	m_ProcessProfileFrameBudget = 0.0f;
 	m_ScreenSize = Point(1024, 768);
 	m_UseDevelopmentDirectories = false;
+	m_MemoryMapResources = true;
 	m_pDoc = nullptr;
 }
 
@@ -225,6 +241,25 @@ void GameOptions::Init(const char* xmlFilePath, LPWSTR lpCmdLine)
 			}
 		}
 
+		pNode = pRoot->FirstChildElement("FramePacing");
+		if (pNode)
+		{
+			// frames per second to limit rendering to, 0 is unlimited, how long to spin before each
+			// frame instead of sleeping, and how often to log the frame time stats
+			if (pNode->Attribute("frameRate"))
+			{
+				m_FrameRate = (float)atof(pNode->Attribute("frameRate"));
+			}
+			if (pNode->Attribute("spinTime"))
+			{
+				m_FrameSpinTime = (float)atof(pNode->Attribute("spinTime"));
+			}
+			if (pNode->Attribute("dumpInterval"))
+			{
+				m_FrameStatsDumpInterval = (unsigned long)atoi(pNode->Attribute("dumpInterval"));
+			}
+		}
+
 		pNode = pRoot->FirstChildElement("Sound");
 		if (pNode)
 		{
@@ -241,6 +276,13 @@ void GameOptions::Init(const char* xmlFilePath, LPWSTR lpCmdLine)
 			m_MaxPlayers = atoi(pNode->Attribute("maxPlayers"));
 			m_ListenPort = atoi(pNode->Attribute("listenPort"));
 			m_GameHost = pNode->Attribute("gameHost");
+
+			// events are sent as binary unless text is asked for to debug network traffic
+			const char* pTextEvents = pNode->Attribute("textEvents");
+			if (pTextEvents)
+			{
+				m_TextNetworkEvents = (std::string(pTextEvents) == "yes") ? true : false;
+			}
 		}
 
 		pNode = pRoot->FirstChildElement("ResCache");
@@ -248,6 +290,114 @@ void GameOptions::Init(const char* xmlFilePath, LPWSTR lpCmdLine)
 		{
 			std::string attribute(pNode->Attribute("useDevelopmentDirectories"));
 			m_UseDevelopmentDirectories = (attribute == "yes") ? true : false;
+
+			// read Assets.zip through a memory mapping, "no" reads it with stdio to compare load times
+			const char* pMemoryMap = pNode->Attribute("memoryMap");
+			if (pMemoryMap)
+			{
+				m_MemoryMapResources = (std::string(pMemoryMap) == "yes") ? true : false;
+			}
+
+			// eviction policy of the resources in no <Group>, and a file to write every access to for ResCacheSim
+			if (pNode->Attribute("policy"))
+			{
+				m_ResCachePolicy = pNode->Attribute("policy");
+			}
+			if (pNode->Attribute("trace"))
+			{
+				m_ResCacheTrace = pNode->Attribute("trace");
+			}
+		}
+
+		pNode = pRoot->FirstChildElement("Server");
+		if (pNode)
+		{
+			// run as a dedicated server with no window, renderer or audio, at its own tick rate, 0 uses the simulation's
+			const char* pHeadless = pNode->Attribute("headless");
+			if (pHeadless)
+			{
+				m_Headless = (std::string(pHeadless) == "yes") ? true : false;
+			}
+			if (pNode->Attribute("tickRate"))
+			{
+				m_ServerTickRate = (float)atof(pNode->Attribute("tickRate"));
+			}
+			if (pNode->Attribute("level"))
+			{
+				m_Level = pNode->Attribute("level");
+			}
+		}
+
+		pNode = pRoot->FirstChildElement("Simulation");
+		if (pNode)
+		{
+			// ticks per second the game logic runs at, 0 steps once per frame, and the most ticks to catch up in a frame
+			if (pNode->Attribute("tickRate"))
+			{
+				m_TickRate = (float)atof(pNode->Attribute("tickRate"));
+			}
+			if (pNode->Attribute("maxTicksPerFrame"))
+			{
+				m_MaxTicksPerFrame = (unsigned int)atoi(pNode->Attribute("maxTicksPerFrame"));
+			}
+		}
+
+		pNode = pRoot->FirstChildElement("Journal");
+		if (pNode)
+		{
+			// record events to a file, or replay a file that was recorded earlier
+			if (pNode->Attribute("record"))
+			{
+				m_JournalRecordFile = pNode->Attribute("record");
+			}
+			if (pNode->Attribute("replay"))
+			{
+				m_JournalReplayFile = pNode->Attribute("replay");
+			}
 		}
+
+		pNode = pRoot->FirstChildElement("EventStats");
+		if (pNode)
+		{
+			// count the traffic for each event type and optionally log it every few seconds
+			const char* pEnabled = pNode->Attribute("enabled");
+			if (pEnabled)
+			{
+				m_EventStats = (std::string(pEnabled) == "yes") ? true : false;
+			}
+			if (pNode->Attribute("dumpInterval"))
+			{
+				m_EventStatsDumpInterval = (unsigned long)atoi(pNode->Attribute("dumpInterval"));
+			}
+		}
+
+		pNode = pRoot->FirstChildElement("ProcessProfile");
+		if (pNode)
+		{
+			// time process updates by type, log them every few seconds and write a trace on shutdown
+			const char* pEnabled = pNode->Attribute("enabled");
+			if (pEnabled)
+			{
+				m_ProcessProfile = (std::string(pEnabled) == "yes") ? true : false;
+			}
+			if (pNode->Attribute("dumpInterval"))
+			{
+				m_ProcessProfileDumpInterval = (unsigned long)atoi(pNode->Attribute("dumpInterval"));
+			}
+			if (pNode->Attribute("frameBudget"))
+			{
+				m_ProcessProfileFrameBudget = (float)atof(pNode->Attribute("frameBudget"));
+			}
+			if (pNode->Attribute("trace"))
+			{
+				m_ProcessProfileTrace = pNode->Attribute("trace");
+			}
+		}
+	}
+
+	// the same executable runs as a dedicated server when started with -headless
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-headless"))
+	{
+		m_Headless = true;
 	}
 }
@@ -0,0 +1,333 @@
+/*
+	JobSystem.cpp
+*/
+
+#include "JobSystem.h"
+#include "Logger.h"
+
+// number of chunks ParallelFor() splits its range into for each thread, more chunks balance better
+const unsigned int JOBSYSTEM_CHUNKS_PER_THREAD = 4;
+
+static JobSystem* g_pJobSystem = nullptr;
+
+//====================================================
+//	Job definitions
+//====================================================
+Job::Job(const JobFunction& function, const JobPtr& pParent, JobAffinity affinity) :
+	m_Function(function),
+	m_pParent(pParent),
+	m_NumUnfinished(1),
+	m_Affinity(affinity)
+{
+}
+
+
+//====================================================
+//	JobSystem definitions
+//====================================================
+JobSystem::JobSystem(unsigned int numWorkers, bool setAsGlobal) :
+	m_NumQueuedJobs(0),
+	m_NextExternalQueue(0),
+	m_ShuttingDown(false)
+{
+	m_MainThreadId = std::this_thread::get_id();
+
+	// leave a hardware thread for the main thread
+	if (numWorkers == 0)
+	{
+		unsigned int numHardwareThreads = std::thread::hardware_concurrency();
+		numWorkers = (numHardwareThreads > 1) ? numHardwareThreads - 1 : 1;
+	}
+
+	// every deque has to exist before a worker can try to steal from it
+	for (unsigned int i = 0; i <= numWorkers; ++i)
+	{
+		m_Queues.push_back(CB_NEW JobQueue());
+	}
+
+	for (unsigned int i = 0; i < numWorkers; ++i)
+	{
+		m_Workers.push_back(std::thread(&JobSystem::WorkerThreadProc, this, i));
+		m_WorkerIds.push_back(m_Workers.back().get_id());
+	}
+
+	if (setAsGlobal)
+	{
+		if (g_pJobSystem)
+		{
+			CB_ERROR("Attempting to create two global job systems. This will overwrite the old one");
+		}
+
+		g_pJobSystem = this;
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// main thread jobs would never run once the workers are gone
+	RunMainThreadJobs();
+
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_ShuttingDown = true;
+	}
+	m_JobQueued.notify_all();
+
+	for (auto it = m_Workers.begin(); it != m_Workers.end(); ++it)
+	{
+		it->join();
+	}
+
+	for (auto it = m_Queues.begin(); it != m_Queues.end(); ++it)
+	{
+		CB_SAFE_DELETE(*it);
+	}
+
+	if (g_pJobSystem == this)
+		g_pJobSystem = nullptr;
+}
+
+JobSystem* JobSystem::Get()
+{
+	CB_ASSERT(g_pJobSystem);
+	return g_pJobSystem;
+}
+
+JobPtr JobSystem::CreateJob(const JobFunction& function, JobAffinity affinity)
+{
+	return JobPtr(CB_NEW Job(function, JobPtr(), affinity));
+}
+
+JobPtr JobSystem::CreateChildJob(const JobPtr& pParent, const JobFunction& function, JobAffinity affinity)
+{
+	CB_ASSERT(pParent);
+	CB_ASSERT(!pParent->IsFinished() && "Children must be added before the parent finishes");
+
+	pParent->m_NumUnfinished.fetch_add(1);
+	return JobPtr(CB_NEW Job(function, pParent, affinity));
+}
+
+void JobSystem::Run(const JobPtr& pJob)
+{
+	CB_ASSERT(pJob);
+
+	if (pJob->m_Affinity == JobAffinity_MainThread)
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadJobs.m_Mutex);
+		m_MainThreadJobs.m_Jobs.push_back(pJob);
+		return;
+	}
+
+	// threads outside the job system hand their jobs to the deques in turn
+	int queueIndex = GetQueueIndex();
+	if (queueIndex < 0)
+	{
+		queueIndex = (int)(m_NextExternalQueue.fetch_add(1) % m_Queues.size());
+	}
+
+	// counted first so a thief can never take the count below zero
+	m_NumQueuedJobs.fetch_add(1);
+	JobQueue* pQueue = m_Queues[queueIndex];
+	{
+		std::lock_guard<std::mutex> lock(pQueue->m_Mutex);
+		pQueue->m_Jobs.push_back(pJob);
+	}
+
+	// take the sleep lock so a worker that just checked the count can not miss the wake up
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_JobQueued.notify_one();
+}
+
+void JobSystem::Wait(const JobPtr& pJob, JobWaitMode mode)
+{
+	CB_ASSERT(pJob);
+	CB_ASSERT((mode == JobWait_Any || pJob->m_Affinity != JobAffinity_MainThread) && "Skipping main thread jobs while waiting on one never finishes");
+
+	int queueIndex = GetQueueIndex();
+	while (!pJob->IsFinished())
+	{
+		JobPtr pOtherJob = FindJob(queueIndex, mode);
+		if (pOtherJob)
+		{
+			Execute(pOtherJob);
+		}
+		else
+		{
+			// the remaining work is running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, const ParallelForFunction& func, JobWaitMode mode)
+{
+	if (count == 0)
+		return;
+
+	// not worth waking the workers for a single item
+	if (m_Workers.empty() || count == 1)
+	{
+		for (unsigned int i = 0; i < count; ++i)
+			func(i);
+		return;
+	}
+
+	unsigned int numChunks = (unsigned int)m_Queues.size() * JOBSYSTEM_CHUNKS_PER_THREAD;
+	if (numChunks > count)
+		numChunks = count;
+	unsigned int chunkSize = count / numChunks;
+	unsigned int remainder = count % numChunks;
+
+	// func outlives the jobs since this blocks until they finish, so it is captured by pointer
+	const ParallelForFunction* pFunc = &func;
+	JobPtr pParent = CreateJob(JobFunction());
+	unsigned int begin = 0;
+	for (unsigned int chunk = 0; chunk < numChunks; ++chunk)
+	{
+		unsigned int end = begin + chunkSize + (chunk < remainder ? 1 : 0);
+		Run(CreateChildJob(pParent, [pFunc, begin, end]()
+		{
+			for (unsigned int i = begin; i < end; ++i)
+				(*pFunc)(i);
+		}));
+		begin = end;
+	}
+
+	// the parent has no work of its own, it just joins the chunks
+	Finish(pParent);
+	Wait(pParent, mode);
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+	CB_ASSERT(IsMainThread());
+
+	for (;;)
+	{
+		JobPtr pJob;
+		{
+			std::lock_guard<std::mutex> lock(m_MainThreadJobs.m_Mutex);
+			if (m_MainThreadJobs.m_Jobs.empty())
+				break;
+
+			pJob = m_MainThreadJobs.m_Jobs.front();
+			m_MainThreadJobs.m_Jobs.pop_front();
+		}
+
+		Execute(pJob);
+	}
+}
+
+void JobSystem::WorkerThreadProc(unsigned int queueIndex)
+{
+	for (;;)
+	{
+		JobPtr pJob = FindJob((int)queueIndex);
+		if (pJob)
+		{
+			Execute(pJob);
+			continue;
+		}
+
+		// nothing to steal, sleep until something is queued
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_JobQueued.wait(lock, [this]() { return m_ShuttingDown || m_NumQueuedJobs.load() > 0; });
+		if (m_ShuttingDown && m_NumQueuedJobs.load() == 0)
+			return;
+	}
+}
+
+int JobSystem::GetQueueIndex() const
+{
+	std::thread::id threadId = std::this_thread::get_id();
+	if (threadId == m_MainThreadId)
+		return (int)m_Queues.size() - 1;
+
+	for (size_t i = 0; i < m_WorkerIds.size(); ++i)
+	{
+		if (m_WorkerIds[i] == threadId)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+JobPtr JobSystem::FindJob(int queueIndex, JobWaitMode mode)
+{
+	// newest job from this thread's own deque
+	if (queueIndex >= 0)
+	{
+		JobQueue* pQueue = m_Queues[queueIndex];
+		std::lock_guard<std::mutex> lock(pQueue->m_Mutex);
+		if (!pQueue->m_Jobs.empty())
+		{
+			JobPtr pJob = pQueue->m_Jobs.back();
+			pQueue->m_Jobs.pop_back();
+			m_NumQueuedJobs.fetch_sub(1);
+			return pJob;
+		}
+	}
+
+	// the main thread also owns the main thread jobs
+	if (queueIndex == (int)m_Queues.size() - 1 && mode == JobWait_Any)
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadJobs.m_Mutex);
+		if (!m_MainThreadJobs.m_Jobs.empty())
+		{
+			JobPtr pJob = m_MainThreadJobs.m_Jobs.front();
+			m_MainThreadJobs.m_Jobs.pop_front();
+			return pJob;
+		}
+	}
+
+	return StealJob(queueIndex);
+}
+
+JobPtr JobSystem::StealJob(int thiefIndex)
+{
+	// start with the deque after the thief's own so every thread does not pick on the same victim
+	unsigned int numQueues = (unsigned int)m_Queues.size();
+	unsigned int start = (thiefIndex >= 0) ? (unsigned int)thiefIndex + 1 : 0;
+	for (unsigned int i = 0; i < numQueues; ++i)
+	{
+		unsigned int victim = (start + i) % numQueues;
+		if ((int)victim == thiefIndex)
+			continue;
+
+		JobQueue* pQueue = m_Queues[victim];
+		std::lock_guard<std::mutex> lock(pQueue->m_Mutex);
+		if (!pQueue->m_Jobs.empty())
+		{
+			JobPtr pJob = pQueue->m_Jobs.front();
+			pQueue->m_Jobs.pop_front();
+			m_NumQueuedJobs.fetch_sub(1);
+			return pJob;
+		}
+	}
+
+	return JobPtr();
+}
+
+void JobSystem::Execute(const JobPtr& pJob)
+{
+	if (pJob->m_Function)
+	{
+		pJob->m_Function();
+
+		// let go of anything the function captured as soon as it is done
+		pJob->m_Function = nullptr;
+	}
+
+	Finish(pJob);
+}
+
+void JobSystem::Finish(const JobPtr& pJob)
+{
+	// the last unit to finish passes completion up the tree
+	if (pJob->m_NumUnfinished.fetch_sub(1) == 1 && pJob->m_pParent)
+	{
+		Finish(pJob->m_pParent);
+	}
+}
@@ -60,6 +60,7 @@ public:
 	void Init(const char* loggingConfigFilename);
 
 	// logging
+	bool IsTagEnabled(const std::string& tag);
 	void Log(const std::string& tag, const std::string& message, const char* funcName, const char* sourceFile, unsigned int lineNum);
 	void SetDisplayFlags(const std::string& tag, unsigned char flags);
 
@@ -152,6 +153,17 @@ void LogManager::Init(const char* loggingConfigFilename)
 }
 
 
+// check if a tag has any display flags set
+bool LogManager::IsTagEnabled(const std::string& tag)
+{
+	m_TagCriticalSection.Lock();
+	bool enabled = (m_Tags.find(tag) != m_Tags.end());
+	m_TagCriticalSection.Unlock();
+
+	return enabled;
+}
+
+
 // build up the log string and output it based on the display flags
 void LogManager::Log(const std::string& tag, const std::string& message, const char* funcName, const char* sourceFile, unsigned int lineNum)
 {
@@ -361,6 +373,12 @@ void Destroy()
 	CB_SAFE_DELETE(s_pLogMgr);
 }
 
+bool IsTagEnabled(const std::string& tag)
+{
+	CB_ASSERT(s_pLogMgr);
+	return s_pLogMgr->IsTagEnabled(tag);
+}
+
 void Log(const std::string& tag, const std::string& message, const char* funcName, const char* sourceFile, unsigned int lineNum)
 {
 	CB_ASSERT(s_pLogMgr);
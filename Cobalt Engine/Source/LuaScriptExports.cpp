@@ -18,17 +18,20 @@
 #include <memory>
 #include <set>
 #include <tinyxml.h>
+#include <vector>
 
 #include "EngineStd.h"
 #include "EventManager.h"
 #include "Events.h"
 #include "GameObject.h"
+#include "HighResClock.h"
 #include "interfaces.h"
 #include "Logger.h"
 #include "LuaScriptEvent.h"
 #include "LuaStateManager.h"
 #include "MathUtils.h"
 #include "Matrix.h"
+#include "ProcessManager.h"
 #include "Resource.h"
 #include "ResourceCache.h"
 #include "Vector.h"
@@ -136,17 +139,31 @@ public:
 	// script resource loading
 	static bool LoadAndExecuteScriptResource(const char* scriptResource);
 
+	// resource cache
+	static void SetResCachePolicy(const char* policyName);
+	static void DumpResCacheStats();
+	static void RecordResCacheTrace(bool record);
+	static bool WriteResCacheTrace(const char* fileName);
+
 	// game objects
 	static int CreateGameObject(const char* objectArchetype, LuaPlus::LuaObject luaPosition, LuaPlus::LuaObject luaYawPitchRoll);
+	static LuaPlus::LuaObject CreateGameObjects(const char* objectArchetype, LuaPlus::LuaObject luaPositions);
+	static void DestroyGameObjects(LuaPlus::LuaObject luaIds);
 
 	// event system
 	static unsigned long RegisterEventListener(EventType eventType, LuaPlus::LuaObject callbackFunction);
 	static void RemoveEventListener(unsigned long listenerId);
 	static bool QueueEvent(EventType eventType, LuaPlus::LuaObject eventData);
 	static bool TriggerEvent(EventType eventType, LuaPlus::LuaObject eventData);
+	static void EnableEventStats(bool enable);
+	static LuaPlus::LuaObject GetEventStats(EventType eventType);
+	static void DumpEventStats();
 
 	// process system
 	static void AttachScriptProcess(LuaPlus::LuaObject scriptProcess);
+	static void EnableProcessProfile(bool enable);
+	static void DumpProcessProfile();
+	static bool WriteProcessTrace(const char* fileName);
 
 	// math
 	static float GetYRotationFromVector(LuaPlus::LuaObject vec3);
@@ -207,6 +224,37 @@ bool LuaInternalScriptExports::LoadAndExecuteScriptResource(const char* scriptRe
 	}
 }
 
+// switch the eviction policy of the resources in no group from lua script, ex. SetResCachePolicy("2Q")
+void LuaInternalScriptExports::SetResCachePolicy(const char* policyName)
+{
+	IResCachePolicy* pPolicy = CreateResCachePolicy(policyName);
+	if (!pPolicy)
+	{
+		CB_ERROR(std::string("Unknown resource cache policy: ") + policyName);
+		return;
+	}
+
+	g_pApp->m_ResCache->SetPolicy(shared_ptr<IResCachePolicy>(pPolicy));
+}
+
+// write the resource cache's hits, misses and group usage to the log from lua script
+void LuaInternalScriptExports::DumpResCacheStats()
+{
+	g_pApp->m_ResCache->DumpStats();
+}
+
+// start or stop recording every resource cache access from lua script
+void LuaInternalScriptExports::RecordResCacheTrace(bool record)
+{
+	g_pApp->m_ResCache->RecordAccessTrace(record);
+}
+
+// write the recorded resource cache accesses to a file for ResCacheSim from lua script
+bool LuaInternalScriptExports::WriteResCacheTrace(const char* fileName)
+{
+	return SaveResCacheTrace(fileName, g_pApp->m_ResCache->GetAccessTrace());
+}
+
 // create a game object from lua
 int LuaInternalScriptExports::CreateGameObject(const char* objectArchetype, LuaPlus::LuaObject luaPosition, LuaPlus::LuaObject luaYawPitchRoll)
 {
@@ -245,6 +293,73 @@ int LuaInternalScriptExports::CreateGameObject(const char* objectArchetype, LuaP
 	return INVALID_GAMEOBJECT_ID;
 }
 
+// create a batch of game objects from one resource from lua, one at each position in an array of vec3 tables.
+// returns an array of the new ids
+LuaPlus::LuaObject LuaInternalScriptExports::CreateGameObjects(const char* objectArchetype, LuaPlus::LuaObject luaPositions)
+{
+	LuaPlus::LuaObject luaResult;
+	luaResult.AssignNewTable(LuaStateManager::Get()->GetLuaState());
+
+	// lua positions must be a table
+	if (!luaPositions.IsTable())
+	{
+		CB_ERROR("Invalid object passed to CreateGameObjects(). Type = " + std::string(luaPositions.TypeName()));
+		return luaResult;
+	}
+
+	int numPositions = luaPositions.GetN();
+	std::vector<Vec3> positions;
+	positions.reserve(numPositions);
+	for (int i = 1; i <= numPositions; ++i)
+	{
+		LuaPlus::LuaObject luaPosition = luaPositions[i];
+		if (!luaPosition.IsTable())
+		{
+			CB_ERROR("Invalid position passed to CreateGameObjects(). Type = " + std::string(luaPosition.TypeName()));
+			return luaResult;
+		}
+		positions.push_back(Vec3(luaPosition["x"].GetFloat(), luaPosition["y"].GetFloat(), luaPosition["z"].GetFloat()));
+	}
+
+	// create the whole batch from one parsed resource
+	std::vector<StrongGameObjectPtr> createdObjects;
+	g_pApp->m_pGame->CreateGameObjects(objectArchetype, nullptr, positions, &createdObjects);
+
+	// fire the new object created event for each object
+	int index = 1;
+	for (auto it = createdObjects.begin(); it != createdObjects.end(); ++it)
+	{
+		shared_ptr<Event_NewGameObject> pNewObjectEvent(CB_NEW Event_NewGameObject((*it)->GetId()));
+		IEventManager::Get()->QueueEvent(pNewObjectEvent);
+		luaResult.SetInteger(index++, (int)(*it)->GetId());
+	}
+
+	return luaResult;
+}
+
+// destroy an array of game objects from lua, they are removed at the end of the current update
+void LuaInternalScriptExports::DestroyGameObjects(LuaPlus::LuaObject luaIds)
+{
+	// lua ids must be a table
+	if (!luaIds.IsTable())
+	{
+		CB_ERROR("Invalid object passed to DestroyGameObjects(). Type = " + std::string(luaIds.TypeName()));
+		return;
+	}
+
+	int numIds = luaIds.GetN();
+	std::vector<GameObjectId> ids;
+	ids.reserve(numIds);
+	for (int i = 1; i <= numIds; ++i)
+	{
+		LuaPlus::LuaObject luaId = luaIds[i];
+		if (luaId.IsNumber())
+			ids.push_back((GameObjectId)luaId.GetInteger());
+	}
+
+	g_pApp->m_pGame->QueueDestroyGameObjects(ids);
+}
+
 // add a lua listener callback for an event type. this will still be inserted into the C++ event manager
 // which will fire events that are forward to the lua callback
 unsigned long LuaInternalScriptExports::RegisterEventListener(EventType eventType, LuaPlus::LuaObject callbackFunction)
@@ -306,6 +421,41 @@ bool LuaInternalScriptExports::TriggerEvent(EventType eventType, LuaPlus::LuaObj
 	return false;
 }
 
+// turn the event manager's per event type counters on or off from lua script
+void LuaInternalScriptExports::EnableEventStats(bool enable)
+{
+	g_pApp->m_pEventManager->EnableStats(enable);
+}
+
+// get the counters for an event type as a table, or nil if none have been recorded
+LuaPlus::LuaObject LuaInternalScriptExports::GetEventStats(EventType eventType)
+{
+	LuaPlus::LuaObject luaResult;
+
+	EventTypeStats stats;
+	if (!g_pApp->m_pEventManager->GetEventStats(eventType, stats))
+	{
+		luaResult.AssignNil(LuaStateManager::Get()->GetLuaState());
+		return luaResult;
+	}
+
+	luaResult.AssignNewTable(LuaStateManager::Get()->GetLuaState());
+	luaResult.SetString("name", stats.m_pName);
+	luaResult.SetInteger("queued", (int)stats.m_NumQueued);
+	luaResult.SetInteger("triggered", (int)stats.m_NumTriggered);
+	luaResult.SetInteger("dropped", (int)stats.m_NumDropped);
+	luaResult.SetInteger("listeners", (int)stats.m_NumListeners);
+	luaResult.SetNumber("listenerTimeMs", (double)stats.m_ListenerTimeNS / NANOSECONDS_PER_MILLISECOND);
+
+	return luaResult;
+}
+
+// write the event counters to the log from lua script
+void LuaInternalScriptExports::DumpEventStats()
+{
+	g_pApp->m_pEventManager->DumpStats();
+}
+
 // attach a process from lua script
 void LuaInternalScriptExports::AttachScriptProcess(LuaPlus::LuaObject scriptProcess)
 {
@@ -321,6 +471,24 @@ void LuaInternalScriptExports::AttachScriptProcess(LuaPlus::LuaObject scriptProc
 	}
 }
 
+// turn profiling of the game logic's processes on or off from lua script
+void LuaInternalScriptExports::EnableProcessProfile(bool enable)
+{
+	g_pApp->m_pGame->GetProcessManager()->EnableProfiling(enable);
+}
+
+// write the game logic's process profile to the log from lua script
+void LuaInternalScriptExports::DumpProcessProfile()
+{
+	g_pApp->m_pGame->GetProcessManager()->DumpProfile();
+}
+
+// write the game logic's recent process updates as a chrome trace from lua script
+bool LuaInternalScriptExports::WriteProcessTrace(const char* fileName)
+{
+	return g_pApp->m_pGame->GetProcessManager()->WriteProfileTrace(fileName);
+}
+
 // get the y rotation in radians from a lua vec3
 float LuaInternalScriptExports::GetYRotationFromVector(LuaPlus::LuaObject vec3)
 {
@@ -430,17 +598,31 @@ void LuaScriptExports::Register()
 	// resource loading
 	globals.RegisterDirect("LoadAndExecuteScriptResource", &LuaInternalScriptExports::LoadAndExecuteScriptResource);
 
+	// resource cache
+	globals.RegisterDirect("SetResCachePolicy", &LuaInternalScriptExports::SetResCachePolicy);
+	globals.RegisterDirect("DumpResCacheStats", &LuaInternalScriptExports::DumpResCacheStats);
+	globals.RegisterDirect("RecordResCacheTrace", &LuaInternalScriptExports::RecordResCacheTrace);
+	globals.RegisterDirect("WriteResCacheTrace", &LuaInternalScriptExports::WriteResCacheTrace);
+
 	// gameobjects
 	globals.RegisterDirect("CreateObject", &LuaInternalScriptExports::CreateGameObject);
+	globals.RegisterDirect("CreateObjects", &LuaInternalScriptExports::CreateGameObjects);
+	globals.RegisterDirect("DestroyObjects", &LuaInternalScriptExports::DestroyGameObjects);
 
 	// events
 	globals.RegisterDirect("RegisterEventListener", &LuaInternalScriptExports::RegisterEventListener);
 	globals.RegisterDirect("RemoveEventListener", &LuaInternalScriptExports::RemoveEventListener);
 	globals.RegisterDirect("QueueEvent", &LuaInternalScriptExports::QueueEvent);
 	globals.RegisterDirect("TriggerEvent", &LuaInternalScriptExports::TriggerEvent);
+	globals.RegisterDirect("EnableEventStats", &LuaInternalScriptExports::EnableEventStats);
+	globals.RegisterDirect("GetEventStats", &LuaInternalScriptExports::GetEventStats);
+	globals.RegisterDirect("DumpEventStats", &LuaInternalScriptExports::DumpEventStats);
 
 	// processes
 	globals.RegisterDirect("AttachProcess", &LuaInternalScriptExports::AttachScriptProcess);
+	globals.RegisterDirect("EnableProcessProfile", &LuaInternalScriptExports::EnableProcessProfile);
+	globals.RegisterDirect("DumpProcessProfile", &LuaInternalScriptExports::DumpProcessProfile);
+	globals.RegisterDirect("WriteProcessTrace", &LuaInternalScriptExports::WriteProcessTrace);
 
 	// math (these are registered to GccMath, not global
 	LuaPlus::LuaObject mathTable = globals.GetByName("GccMath");
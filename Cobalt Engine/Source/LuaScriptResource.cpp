@@ -9,13 +9,14 @@
 #include "EngineStd.h"
 #include "LuaScriptResource.h"
 #include "LuaStateManager.h"
+#include "ResourceHandle.h"
 
 shared_ptr<IResourceLoader> CreateLuaScriptResourceLoader()
 {
 	return shared_ptr<IResourceLoader>(CB_NEW LuaScriptResourceLoader());
 }
 
-bool LuaScriptResourceLoader::LoadResource(char* rawBuffer, unsigned int rawSize, shared_ptr<ResHandle>)
+bool LuaScriptResourceLoader::LoadResource(char* rawBuffer, unsigned int rawSize, shared_ptr<ResHandle> handle)
 {
 	if (rawSize <= 0)
 	{
@@ -24,7 +25,14 @@ bool LuaScriptResourceLoader::LoadResource(char* rawBuffer, unsigned int rawSize
 
 	if (!g_pApp->m_pGame || g_pApp->m_pGame->CanRunLua())
 	{
-		LuaStateManager::Get()->ExecuteString(rawBuffer);
+		// what the script leaves in the Lua State is the memory this resource costs, the collector may
+		// also run meanwhile and free more than the script took, which counts as nothing
+		LuaStateManager* pLuaStateManager = LuaStateManager::Get();
+		unsigned int memoryBefore = pLuaStateManager->GetMemoryUsed();
+		pLuaStateManager->ExecuteString(rawBuffer);
+		unsigned int memoryAfter = pLuaStateManager->GetMemoryUsed();
+
+		handle->SetExtra(shared_ptr<LuaScriptResourceExtraData>(CB_NEW LuaScriptResourceExtraData(memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0)));
 	}
 
 	return true;
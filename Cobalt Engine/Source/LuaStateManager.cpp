@@ -130,6 +130,12 @@ LuaPlus::LuaState* LuaStateManager::GetLuaState() const
 	return m_pLuaState;
 }
 
+unsigned int LuaStateManager::GetMemoryUsed() const
+{
+	// the count comes back as kilobytes and the bytes left over
+	return (unsigned int)m_pLuaState->GC(LUA_GCCOUNT, 0) * 1024 + (unsigned int)m_pLuaState->GC(LUA_GCCOUNTB, 0);
+}
+
 LuaPlus::LuaObject LuaStateManager::CreatePath(const char* pathString, bool toIgnoreLastElement)
 {
 	// this will create a table path in lua from a string
@@ -86,6 +86,11 @@ unsigned int MemoryPool::GetChunkSize() const
 	return m_ChunkSize;
 }
 
+unsigned int MemoryPool::GetNumBlocks() const
+{
+	return m_MemArraySize;
+}
+
 void MemoryPool::SetAllowResize(bool allowResize)
 {
 	m_AllowResize = allowResize;
@@ -5,11 +5,14 @@
 	by Mike McShaffry and David Graham
 */
 
-#include <strstream>
+#include <sstream>
 
 #include "BaseSocketManager.h"
 #include "BinaryPacket.h"
 #include "EngineStd.h"
+#include "EventStream.h"
+#include "Logger.h"
+#include "NetSocket.h"
 #include "NetworkEventForwarder.h"
 #include "RemoteEventSocket.h"
 
@@ -23,17 +26,44 @@ void NetworkEventForwarder::ForwardEvent(IEventPtr pEvent)
 	// this method serializes an event into a stream represented by
 	// event message id-- event itself -- event type, and sends the 
 	// stream to a specific socket
+	shared_ptr<BinaryPacket> eventMsg = CreateEventPacket(pEvent);
 
-	std::ostrstream out;
-
-	// serialze the event into an output stream
-	out << static_cast<int>(RemoteEventSocket::NetMsg_Event) << " ";
-	out << pEvent->GetEventType() << " ";
-	pEvent->Serialize(out);
-	out << "\r\n";
-
-	shared_ptr<BinaryPacket> eventMsg(CB_NEW BinaryPacket(out.rdbuf()->str(), (u_long)out.pcount()));
+	// the receiving socket drops the connection on a larger packet, events that can grow have to be split by the sender
+	CB_ASSERT(eventMsg->GetSize() <= MAX_PACKET_SIZE && "Event does not fit in a network packet");
 
 	// send the event across the network
 	g_pSocketManager->Send(m_SocketId, eventMsg);
 }
+
+shared_ptr<BinaryPacket> NetworkEventForwarder::CreateEventPacket(IEventPtr pEvent)
+{
+	shared_ptr<BinaryPacket> eventMsg;
+
+	if (g_pApp->m_Options.m_TextNetworkEvents)
+	{
+		// human readable fallback for debugging network traffic
+		std::ostringstream out;
+
+		// serialze the event into an output stream
+		out << static_cast<int>(RemoteEventSocket::NetMsg_Event) << " ";
+		out << pEvent->GetEventType() << " ";
+		pEvent->Serialize(out);
+		out << "\r\n";
+
+		std::string text = out.str();
+		eventMsg.reset(CB_NEW BinaryPacket(text.c_str(), (u_long)text.size()));
+	}
+	else
+	{
+		EventWriteStream out(true);
+
+		// serialize the event into a binary stream
+		out.WriteUInt8(RemoteEventSocket::NetMsg_BinaryEvent);
+		out.WriteUInt32(pEvent->GetEventType());
+		pEvent->SerializeBinary(out);
+
+		eventMsg.reset(CB_NEW BinaryPacket(out.GetData(), (u_long)out.GetSize()));
+	}
+
+	return eventMsg;
+}
@@ -154,6 +154,11 @@ bool OggResourceLoader::DiscardRawBufferAfterLoad()
 	return true;
 }
 
+bool OggResourceLoader::IsThreadSafe()
+{
+	return true;
+}
+
 unsigned int OggResourceLoader::GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize)
 {
 	OggVorbis_File vf;
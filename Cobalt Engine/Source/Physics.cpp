@@ -8,14 +8,16 @@
 #include <algorithm>
 #include <btBulletDynamicsCommon.h>
 #include <btBulletCollisionCommon.h>
+#include <cmath>
 #include <iterator>
 #include <memory>
-#include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "BaseGameLogic.h"
 #include "EventManager.h"
+#include "EventPool.h"
 #include "Events.h"
 #include "GameObject.h"
 #include "Logger.h"
@@ -30,6 +32,12 @@
 #pragma comment(lib, "BulletDynamics_debug.lib")
 #pragma comment(lib, "LinearMath_debug.lib")
 
+// longest single physics step in seconds, longer updates are split into sub steps
+const float PHYSICS_MAX_STEP_TIME = 1.0f / 60.0f;
+
+// most sub steps in one update
+const int PHYSICS_MAX_SUB_STEPS = 4;
+
 /**
 	Physics material properties.
 */
@@ -203,7 +211,7 @@ class BulletPhysics : public IGamePhysics
 	typedef std::unordered_map<GameObjectId, btRigidBody*> ObjectIDToRigidBodyMap;
 	typedef std::unordered_map<const btRigidBody*, GameObjectId> RigidBodyToObjectIDMap;
 	typedef std::pair<const btRigidBody*, const btRigidBody*> CollisionPair;
-	typedef std::set<CollisionPair> CollisionPairs;
+	typedef std::vector<CollisionPair> CollisionPairs;
 
 public:
 	BulletPhysics();
@@ -277,10 +285,14 @@ private:
 	ObjectIDToRigidBodyMap m_ObjectIdToRigidBody;
 	RigidBodyToObjectIDMap m_RigidBodyToObjectId;
 	
-	// store pairs of bodies that are colliding. when bodies first collide they
+	// store pairs of bodies that are colliding, sorted. when bodies first collide they
 	// are stored here and an event is sent. when they stop colliding, they are removed
 	// and another event is sent
 	CollisionPairs m_PreviousTickCollisionPairs;
+
+	// scratch lists for the tick callback, kept so their memory is reused every tick
+	CollisionPairs m_CurrentTickCollisionPairs;
+	CollisionPairs m_RemovedCollisionPairs;
 };
 
 
@@ -367,7 +379,7 @@ void BulletPhysics::SyncVisibleScene()
 		StrongGameObjectPtr pGameObject = MakeStrongPtr(g_pApp->m_pGame->GetGameObject(id));
 		if (pGameObject && objMotionState)
 		{
-			shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pGameObject->GetComponent<TransformComponent>(TransformComponent::g_Name));
+			shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pGameObject->GetComponent<TransformComponent>());
 			if (pTransformComponent)
 			{
 				// if the objects world position and physics position are different, update
@@ -375,7 +387,7 @@ void BulletPhysics::SyncVisibleScene()
 				{
 					// sync the transform and dispatch an event that an object has moved
 					pTransformComponent->SetTransform(objMotionState->m_WorldToPositionTransform);
-					shared_ptr<Event_MoveGameObject> pEvent(CB_NEW Event_MoveGameObject(id, objMotionState->m_WorldToPositionTransform));
+					shared_ptr<Event_MoveGameObject> pEvent = MakePooledEvent<Event_MoveGameObject>(id, objMotionState->m_WorldToPositionTransform);
 					IEventManager::Get()->QueueEvent(pEvent);
 				}
 			}
@@ -386,8 +398,15 @@ void BulletPhysics::SyncVisibleScene()
 
 void BulletPhysics::OnUpdate(float deltaTime)
 {
-	// step the physics sim with a max of 4 sub steps
-	m_DynamicsWorld->stepSimulation(deltaTime, 4);
+	// a fixed tick is one step of exactly its length, so bullet never carries time over or
+	// interpolates on its own. a longer variable tick is split into equal sub steps
+	int numSubSteps = (int)ceilf(deltaTime / PHYSICS_MAX_STEP_TIME - 0.001f);
+	if (numSubSteps < 1)
+		numSubSteps = 1;
+	else if (numSubSteps > PHYSICS_MAX_SUB_STEPS)
+		numSubSteps = PHYSICS_MAX_SUB_STEPS;
+
+	m_DynamicsWorld->stepSimulation(deltaTime, numSubSteps, deltaTime / numSubSteps);
 }
 
 
@@ -796,7 +815,7 @@ void BulletPhysics::SendCollisionPairAddEvent(const btPersistentManifold* manifo
 		
 		// send trigger event
 		const int triggerId = *static_cast<int*>(triggerBody->getUserPointer());
-		shared_ptr<Event_PhysTriggerEnter> pEvent(CB_NEW Event_PhysTriggerEnter(triggerId, FindObjectId(otherBody)));
+		shared_ptr<Event_PhysTriggerEnter> pEvent = MakePooledEvent<Event_PhysTriggerEnter>(triggerId, FindObjectId(otherBody));
 		IEventManager::Get()->QueueEvent(pEvent);
 	}
 	else
@@ -812,20 +831,22 @@ void BulletPhysics::SendCollisionPairAddEvent(const btPersistentManifold* manifo
 		}
 
 		// send collision began event
-		Vec3List collisionPoints;
+		Vec3 collisionPoints[PHYSEVENT_MAX_COLLISION_POINTS];
+		unsigned int numCollisionPoints = 0;
 		Vec3 sumNormalForce;
 		Vec3 sumFrictionForce;
 		for (int i = 0; i < manifold->getNumContacts(); i++)
 		{
 			const btManifoldPoint& point = manifold->getContactPoint(i);
 
-			collisionPoints.push_back(btVector3_to_Vec3(point.getPositionWorldOnB()));
+			if (numCollisionPoints < PHYSEVENT_MAX_COLLISION_POINTS)
+				collisionPoints[numCollisionPoints++] = btVector3_to_Vec3(point.getPositionWorldOnB());
 			sumNormalForce += btVector3_to_Vec3(point.m_combinedRestitution * point.m_normalWorldOnB);
 			sumFrictionForce += btVector3_to_Vec3(point.m_combinedFriction * point.m_lateralFrictionDir1);
 		}
 
 		// send game event
-		shared_ptr<Event_PhysCollision> pEvent(CB_NEW Event_PhysCollision(id0, id1, sumNormalForce, sumFrictionForce, collisionPoints));
+		shared_ptr<Event_PhysCollision> pEvent = MakePooledEvent<Event_PhysCollision>(id0, id1, sumNormalForce, sumFrictionForce, collisionPoints, numCollisionPoints);
 		IEventManager::Get()->QueueEvent(pEvent);
 	}
 }
@@ -855,7 +876,7 @@ void BulletPhysics::SendCollisionPairRemoveEvent(const btRigidBody* body0, const
 
 		// send trigger event
 		const int triggerId = *static_cast<int*>(triggerBody->getUserPointer());
-		shared_ptr<Event_PhysTriggerLeave> pEvent(CB_NEW Event_PhysTriggerLeave(triggerId, FindObjectId(otherBody)));
+		shared_ptr<Event_PhysTriggerLeave> pEvent = MakePooledEvent<Event_PhysTriggerLeave>(triggerId, FindObjectId(otherBody));
 		IEventManager::Get()->QueueEvent(pEvent);
 	}
 	else
@@ -871,7 +892,7 @@ void BulletPhysics::SendCollisionPairRemoveEvent(const btRigidBody* body0, const
 		}
 
 		// send the game event
-		shared_ptr<Event_PhysSeparation> pEvent(CB_NEW Event_PhysSeparation(id0, id1));
+		shared_ptr<Event_PhysSeparation> pEvent = MakePooledEvent<Event_PhysSeparation>(id0, id1);
 		IEventManager::Get()->QueueEvent(pEvent);
 	}
 }
@@ -897,7 +918,7 @@ void BulletPhysics::AddShape(StrongGameObjectPtr pGameObject, btCollisionShape*
 
 	// get the objects transform
 	Mat4x4 transform = Mat4x4::Identity;
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pGameObject->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pGameObject->GetComponent<TransformComponent>());
 	CB_ASSERT(pTransformComponent);
 	if (pTransformComponent)
 	{
@@ -934,18 +955,16 @@ void BulletPhysics::RemoveCollisionObject(btCollisionObject* obj)
 	// remove the pointer from the collision contacts list
 	for (auto it = m_PreviousTickCollisionPairs.begin(); it != m_PreviousTickCollisionPairs.end(); )
 	{
-		// step the iterator by 1
-		auto next = it;
-		++next;
-
-		// remove the object from any currently happening collision
+		// remove the object from any currently happening collision, erasing keeps the list sorted
 		if (it->first == obj || it->second == obj)
 		{
 			SendCollisionPairRemoveEvent(it->first, it->second);
-			m_PreviousTickCollisionPairs.erase(it);
+			it = m_PreviousTickCollisionPairs.erase(it);
+		}
+		else
+		{
+			++it;
 		}
-
-		it = next;
 	}
 
 	// if the object was a rigid body
@@ -976,7 +995,9 @@ void BulletPhysics::BulletInternalTickCallback(btDynamicsWorld* world, btScalar
 	CB_ASSERT(world->getWorldUserInfo());
 
 	BulletPhysics* bulletPhysics = static_cast<BulletPhysics*>(world->getWorldUserInfo());
-	CollisionPairs currentTickCollisionPairs;
+	const CollisionPairs& previousTickCollisionPairs = bulletPhysics->m_PreviousTickCollisionPairs;
+	CollisionPairs& currentTickCollisionPairs = bulletPhysics->m_CurrentTickCollisionPairs;
+	currentTickCollisionPairs.clear();
 
 	// look at all existing collisions
 	btDispatcher* dispatcher = world->getDispatcher();
@@ -996,23 +1017,28 @@ void BulletPhysics::BulletInternalTickCallback(btDynamicsWorld* world, btScalar
 		const btRigidBody* sortedBody0 = swapped ? body1 : body0;
 		const btRigidBody* sortedBody1 = swapped ? body0 : body1;
 
-		// insert the collision pair into the set
+		// add the collision pair to the list
 		const CollisionPair pair = std::make_pair(sortedBody0, sortedBody1);
-		currentTickCollisionPairs.insert(pair);
+		currentTickCollisionPairs.push_back(pair);
 		
 		// if this is a new contact, send an event
-		if (bulletPhysics->m_PreviousTickCollisionPairs.find(pair) == bulletPhysics->m_PreviousTickCollisionPairs.end())
+		if (!std::binary_search(previousTickCollisionPairs.begin(), previousTickCollisionPairs.end(), pair))
 		{
 			bulletPhysics->SendCollisionPairAddEvent(manifold, body0, body1);
 		}
 	}
 
-	CollisionPairs removedCollisionPairs;
+	// sort the pairs and drop bodies with more than one manifold, so the list can be searched next tick
+	std::sort(currentTickCollisionPairs.begin(), currentTickCollisionPairs.end());
+	currentTickCollisionPairs.erase(std::unique(currentTickCollisionPairs.begin(), currentTickCollisionPairs.end()), currentTickCollisionPairs.end());
+
+	CollisionPairs& removedCollisionPairs = bulletPhysics->m_RemovedCollisionPairs;
+	removedCollisionPairs.clear();
 
 	// use set difference to see which collisions existed last tick but are no longer colliding
-	std::set_difference(bulletPhysics->m_PreviousTickCollisionPairs.begin(), bulletPhysics->m_PreviousTickCollisionPairs.end(),
+	std::set_difference(previousTickCollisionPairs.begin(), previousTickCollisionPairs.end(),
 		currentTickCollisionPairs.begin(), currentTickCollisionPairs.end(),
-		std::inserter(removedCollisionPairs, removedCollisionPairs.begin()));
+		std::back_inserter(removedCollisionPairs));
 
 	// send collision exit events
 	for (auto it = removedCollisionPairs.begin(); it != removedCollisionPairs.end(); ++it)
@@ -1023,8 +1049,8 @@ void BulletPhysics::BulletInternalTickCallback(btDynamicsWorld* world, btScalar
 		bulletPhysics->SendCollisionPairRemoveEvent(body0, body1);
 	}
 
-	// update the collision pairs
-	bulletPhysics->m_PreviousTickCollisionPairs = currentTickCollisionPairs;
+	// update the collision pairs, swapping keeps both lists' memory
+	bulletPhysics->m_PreviousTickCollisionPairs.swap(currentTickCollisionPairs);
 }
 
 
@@ -20,6 +20,8 @@ const float DEFAULT_MAX_ANGULAR_VELOCITY = 1.2f;
 
 const char* PhysicsComponent::g_Name = "PhysicsComponent";
 
+const ComponentId PhysicsComponent::g_Id = Component::GetIdFromName(PhysicsComponent::g_Name);
+
 PhysicsComponent::PhysicsComponent()
 {
 	// zero out all member variables
@@ -143,7 +145,7 @@ void PhysicsComponent::PostInit()
 
 void PhysicsComponent::Update(float deltaTime)
 {
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (!pTransformComponent)
 	{
 		CB_ERROR("No transform component");
@@ -223,7 +225,7 @@ void PhysicsComponent::SetVelocity(const Vec3& velocity)
 void PhysicsComponent::RotateY(float angleRadians)
 {
 	// rotate the physics body around the y axis
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		Mat4x4 transform = pTransformComponent->GetTransform();
@@ -242,7 +244,7 @@ void PhysicsComponent::RotateY(float angleRadians)
 void PhysicsComponent::SetPosition(float x, float y, float z)
 {
 	// manually set the physics body
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		Mat4x4 transform = pTransformComponent->GetTransform();
@@ -13,6 +13,8 @@ Process::Process()
 {
 	m_State = UNINITIALIZED;
 	m_pChild = nullptr;
+	m_SleepTime = 0.0f;
+	m_WakeEventType = 0;
 }
 
 Process::~Process()
@@ -59,6 +61,33 @@ void Process::UnPause()
 	}
 }
 
+void Process::Sleep(float seconds)
+{
+	if (m_State == RUNNING)
+	{
+		m_State = SLEEPING;
+		m_SleepTime = (seconds > 0.0f) ? seconds : 0.0f;
+	}
+	else
+	{
+		CB_WARNING("Attempting to sleep a process that is not running");
+	}
+}
+
+void Process::SleepUntilEvent(const EventType& eventType)
+{
+	if (m_State == RUNNING)
+	{
+		m_State = SLEEPING;
+		m_SleepTime = -1.0f;
+		m_WakeEventType = eventType;
+	}
+	else
+	{
+		CB_WARNING("Attempting to sleep a process that is not running");
+	}
+}
+
 Process::State Process::GetState() const
 {
 	return m_State;
@@ -66,7 +95,7 @@ Process::State Process::GetState() const
 
 bool Process::IsAlive() const
 {
-	return (m_State == RUNNING || m_State == PAUSED);
+	return (m_State == RUNNING || m_State == PAUSED || m_State == SLEEPING);
 }
 
 bool Process::IsDead() const
@@ -84,6 +113,11 @@ bool Process::IsPaused() const
 	return m_State == PAUSED;
 }
 
+bool Process::IsSleeping() const
+{
+	return m_State == SLEEPING;
+}
+
 void Process::AttachChild(StrongProcessPtr pChild)
 {
 	if (m_pChild)
@@ -5,11 +5,47 @@
 	by Mike McShaffry and David Graham
 */
 
+#include <algorithm>
+#include <cstdio>
+
+#include "HighResClock.h"
+#include "JobSystem.h"
+#include "Logger.h"
 #include "ProcessManager.h"
+#include "StringUtil.h"
+
+// name of the trace span for a whole update
+static const char* PROCESSMANAGER_FRAME_TRACE_NAME = "UpdateProcesses";
+
+// convert nanoseconds to milliseconds for the log
+static float NanosecondsToMillis(unsigned long long nanoseconds)
+{
+	return (float)((double)nanoseconds / NANOSECONDS_PER_MILLISECOND);
+}
+
+ProcessManager::ProcessManager(JobSystem* pJobSystem, const char* pName)
+{
+	m_pJobSystem = pJobSystem;
+	m_Time = 0.0;
+	m_pName = pName;
+	m_ProfilingEnabled = false;
+	m_NextTraceEvent = 0;
+	m_ProfileStartNS = 0;
+	m_ProfileFrameBudgetNS = 0;
+	m_ProfileDumpIntervalMillis = 0;
+	m_LastProfileDumpNS = 0;
+}
 
 ProcessManager::~ProcessManager()
 {
+	if (m_ProfilingEnabled && !m_ProfileTraceFile.empty())
+	{
+		WriteProfileTrace(m_ProfileTraceFile);
+	}
+
+	// waking the sleepers stops listening for the events they were sleeping on
 	ClearAllProcesses();
+	CB_ASSERT(m_SleepEvents.empty());
 }
 
 unsigned int ProcessManager::UpdateProcesses(float deltaTime)
@@ -17,14 +53,25 @@ unsigned int ProcessManager::UpdateProcesses(float deltaTime)
 	unsigned short int successCount = 0;
 	unsigned short int failCount = 0;
 
-	auto it = m_ProcessList.begin();
-	while (it != m_ProcessList.end())
+	const bool profiling = m_ProfilingEnabled;
+	unsigned long long frameStartNS = profiling ? HighResClock::GetNanoseconds() : 0;
+
+	// sleepers that are due join this update
+	m_Time += deltaTime;
+	WakeDueProcesses();
+
+	// init every new process and update the ones that have to run on the main thread.
+	// processes attached along the way are appended and wait for the next update
+	m_ParallelBatch.clear();
+	size_t numProcesses = m_Awake.m_Processes.size();
+	if (profiling && numProcesses > m_Profile.m_PeakAwake)
 	{
-		StrongProcessPtr pCurrentProcess = (*it);
-		
-		// save an iterator to this process and increment our list iterator
-		auto thisIt = it;
-		++it;
+		m_Profile.m_PeakAwake = (unsigned int)numProcesses;
+	}
+
+	for (size_t i = 0; i < numProcesses; ++i)
+	{
+		Process* pCurrentProcess = m_Awake.m_Processes[i].get();
 
 		// init the current process if it has not intialized yet
 		if (pCurrentProcess->GetState() == Process::UNINITIALIZED)
@@ -32,64 +79,216 @@ unsigned int ProcessManager::UpdateProcesses(float deltaTime)
 			pCurrentProcess->OnInit();
 		}
 
-		// update a running process
+		// update a running process, or save it for the parallel batch
 		if (pCurrentProcess->GetState() == Process::RUNNING)
 		{
-			pCurrentProcess->OnUpdate(deltaTime);
+			if (pCurrentProcess->IsParallelSafe())
+			{
+				m_ParallelBatch.push_back(pCurrentProcess);
+			}
+			else if (profiling)
+			{
+				ProcessTraceEvent update;
+				update.m_pName = pCurrentProcess->GetName();
+				update.m_ThreadId = 0;
+				update.m_StartNS = HighResClock::GetNanoseconds();
+				pCurrentProcess->OnUpdate(deltaTime);
+				update.m_DurationNS = HighResClock::GetNanoseconds() - update.m_StartNS;
+				RecordUpdate(update);
+			}
+			else
+			{
+				pCurrentProcess->OnUpdate(deltaTime);
+			}
+		}
+	}
+
+	UpdateParallelBatch(deltaTime);
+
+	// handle the processes that died or went to sleep on the main thread and in array order
+	size_t i = 0;
+	while (i < m_Awake.m_Processes.size())
+	{
+		Process* pProcess = m_Awake.m_Processes[i].get();
+
+		// the last process moves into this index and is checked next
+		if (pProcess->IsSleeping())
+		{
+			ParkProcess((unsigned int)i);
+			continue;
+		}
+
+		if (!pProcess->IsDead())
+		{
+			++i;
+			continue;
 		}
 
-		// if a process is dead, run the correct exit method
-		if (pCurrentProcess->IsDead())
+		// keep the process alive through its exit method, which may attach more processes
+		StrongProcessPtr pCurrentProcess = m_Awake.m_Processes[i];
+		unsigned int slot = m_Awake.m_Slots[i];
+
+		// run the correct exit method
+		switch (pCurrentProcess->GetState())
 		{
-			switch (pCurrentProcess->GetState())
+		case Process::SUCCEEDED:
 			{
-			case Process::SUCCEEDED:
-				{
-					pCurrentProcess->OnSuccess();
-					StrongProcessPtr pChild = pCurrentProcess->RemoveChild();
-					if (pChild)
-						AttachProcess(pChild);
-					else
-						++successCount;
-					break;
-				}
-			case Process::FAILED:
-				{
-					pCurrentProcess->OnFail();
-					++failCount;
-					break;
-				}
-			case Process::ABORTED:
-				{
-					pCurrentProcess->OnAbort();
-					++failCount;
-					break;
-				}
+				pCurrentProcess->OnSuccess();
+				StrongProcessPtr pChild = pCurrentProcess->RemoveChild();
+				if (pChild)
+					AttachProcess(pChild);
+				else
+					++successCount;
+				break;
+			}
+		case Process::FAILED:
+			{
+				pCurrentProcess->OnFail();
+				++failCount;
+				break;
+			}
+		case Process::ABORTED:
+			{
+				pCurrentProcess->OnAbort();
+				++failCount;
+				break;
 			}
+		}
+
+		if (m_ProfilingEnabled)
+		{
+			ProcessTypeStats& stats = GetTypeProfile(pCurrentProcess->GetName()).m_Stats;
+			if (pCurrentProcess->GetState() == Process::SUCCEEDED)
+				++stats.m_NumSucceeded;
+			else
+				++stats.m_NumFailed;
+		}
+
+		// destroy the dead process
+		RemoveProcess(m_Slots[slot].m_DenseIndex);
+	}
+
+	// profiling may have been turned on or reset partway through
+	if (profiling && m_ProfilingEnabled && frameStartNS >= m_ProfileStartNS)
+	{
+		ProcessTraceEvent frame;
+		frame.m_pName = PROCESSMANAGER_FRAME_TRACE_NAME;
+		frame.m_ThreadId = 0;
+		frame.m_StartNS = frameStartNS;
+		frame.m_DurationNS = HighResClock::GetNanoseconds() - frameStartNS;
+		AddTraceEvent(frame);
 
-			// destroy the dead process
-			m_ProcessList.erase(thisIt);
+		++m_Profile.m_NumFrames;
+		m_Profile.m_TotalFrameNS += frame.m_DurationNS;
+		if (frame.m_DurationNS > m_Profile.m_MaxFrameNS)
+		{
+			m_Profile.m_MaxFrameNS = frame.m_DurationNS;
+		}
+		if (m_ProfileFrameBudgetNS != 0 && frame.m_DurationNS > m_ProfileFrameBudgetNS)
+		{
+			++m_Profile.m_NumOverBudgetFrames;
+		}
+
+		// dump the profile if it is time
+		unsigned long long currNS = frame.m_StartNS + frame.m_DurationNS;
+		if (m_ProfileDumpIntervalMillis != 0 && currNS - m_LastProfileDumpNS >= m_ProfileDumpIntervalMillis * NANOSECONDS_PER_MILLISECOND)
+		{
+			DumpProfile();
+			m_LastProfileDumpNS = currNS;
 		}
 	}
 
 	return (successCount << 16) | failCount;
 }
 
-WeakProcessPtr ProcessManager::AttachProcess(StrongProcessPtr pProcess)
+ProcessHandle ProcessManager::AttachProcess(StrongProcessPtr pProcess)
+{
+	CB_ASSERT(pProcess);
+
+	unsigned int slot;
+	if (!m_FreeSlots.empty())
+	{
+		slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		// generations start at 1 so no handle is ever INVALID_PROCESS_HANDLE
+		slot = (unsigned int)m_Slots.size();
+		ProcessSlot newSlot;
+		newSlot.m_Generation = 1;
+		newSlot.m_DenseIndex = 0;
+		newSlot.m_SleepSerial = 0;
+		newSlot.m_Sleeping = false;
+		m_Slots.push_back(newSlot);
+	}
+
+	m_Slots[slot].m_DenseIndex = (unsigned int)m_Awake.m_Processes.size();
+	m_Slots[slot].m_Sleeping = false;
+	m_Awake.m_Processes.push_back(pProcess);
+	m_Awake.m_Slots.push_back(slot);
+
+	if (m_ProfilingEnabled)
+	{
+		ProcessTypeStats& stats = GetTypeProfile(pProcess->GetName()).m_Stats;
+		++stats.m_NumAttached;
+		if (++stats.m_NumLive > stats.m_PeakLive)
+		{
+			stats.m_PeakLive = stats.m_NumLive;
+		}
+
+		++m_Profile.m_NumAttached;
+		if (GetProcessCount() > m_Profile.m_PeakProcesses)
+		{
+			m_Profile.m_PeakProcesses = GetProcessCount();
+		}
+	}
+
+	return ((ProcessHandle)m_Slots[slot].m_Generation << 32) | slot;
+}
+
+StrongProcessPtr ProcessManager::GetProcess(ProcessHandle handle) const
 {
-	m_ProcessList.push_front(pProcess);
-	return WeakProcessPtr(pProcess);
+	int slot = GetSlot(handle);
+	if (slot < 0)
+		return StrongProcessPtr();
+
+	return GetSlotProcess(slot);
+}
+
+bool ProcessManager::AbortProcess(ProcessHandle handle)
+{
+	int slot = GetSlot(handle);
+	if (slot < 0 || GetSlotProcess(slot)->IsDead())
+		return false;
+
+	// only awake processes are checked for death
+	if (m_Slots[slot].m_Sleeping)
+	{
+		CancelEventWait(slot);
+		++m_Slots[slot].m_SleepSerial;
+		MoveProcess(false, m_Slots[slot].m_DenseIndex);
+	}
+
+	GetSlotProcess(slot)->SetState(Process::ABORTED);
+	return true;
 }
 
 void ProcessManager::AbortAllProcesses(bool immediate)
 {
-	auto it = m_ProcessList.begin();
-	while (it != m_ProcessList.end())
+	// wake every sleeper so they are all handled the same way
+	while (!m_Sleeping.m_Processes.empty())
 	{
-		auto tempIt = it;
-		++it;
+		unsigned int lastIndex = (unsigned int)m_Sleeping.m_Processes.size() - 1;
+		CancelEventWait(m_Sleeping.m_Slots[lastIndex]);
+		++m_Slots[m_Sleeping.m_Slots[lastIndex]].m_SleepSerial;
+		MoveProcess(false, lastIndex);
+	}
 
-		StrongProcessPtr pProcess = *tempIt;
+	// walk backwards so removing a process only moves ones that were already visited
+	for (size_t i = m_Awake.m_Processes.size(); i > 0; --i)
+	{
+		StrongProcessPtr pProcess = m_Awake.m_Processes[i - 1];
 		if (pProcess->IsAlive())
 		{
 			pProcess->SetState(Process::ABORTED);
@@ -97,7 +296,11 @@ void ProcessManager::AbortAllProcesses(bool immediate)
 			if (immediate)
 			{
 				pProcess->OnAbort();
-				m_ProcessList.erase(tempIt);
+				if (m_ProfilingEnabled)
+				{
+					++GetTypeProfile(pProcess->GetName()).m_Stats.m_NumFailed;
+				}
+				RemoveProcess((unsigned int)(i - 1));
 			}
 		}
 	}
@@ -105,10 +308,487 @@ void ProcessManager::AbortAllProcesses(bool immediate)
 
 unsigned int ProcessManager::GetProcessCount() const
 {
-	return m_ProcessList.size();
+	return (unsigned int)(m_Awake.m_Processes.size() + m_Sleeping.m_Processes.size());
+}
+
+unsigned int ProcessManager::GetSleepingProcessCount() const
+{
+	return (unsigned int)m_Sleeping.m_Processes.size();
 }
 
 void ProcessManager::ClearAllProcesses()
 {
-	m_ProcessList.clear();
+	while (!m_Sleeping.m_Processes.empty())
+	{
+		unsigned int lastIndex = (unsigned int)m_Sleeping.m_Processes.size() - 1;
+		CancelEventWait(m_Sleeping.m_Slots[lastIndex]);
+		MoveProcess(false, lastIndex);
+	}
+
+	while (!m_Awake.m_Processes.empty())
+	{
+		RemoveProcess((unsigned int)m_Awake.m_Processes.size() - 1);
+	}
+}
+
+void ProcessManager::UpdateParallelBatch(float deltaTime)
+{
+	// a main thread process may have paused or aborted one of these since it was collected
+	auto endIt = std::remove_if(m_ParallelBatch.begin(), m_ParallelBatch.end(), [](Process* pProcess) { return pProcess->GetState() != Process::RUNNING; });
+	m_ParallelBatch.erase(endIt, m_ParallelBatch.end());
+
+	const bool profiling = m_ProfilingEnabled;
+	if (profiling)
+	{
+		m_ParallelTimings.resize(m_ParallelBatch.size());
+	}
+
+	// the process array keeps every process in the batch alive until the update is done. main thread jobs
+	// wait for the next RunMainThreadJobs(), their callbacks would re-enter game code partway through the update
+	if (m_pJobSystem && m_ParallelBatch.size() >= PROCESSMANAGER_MIN_PARALLEL_BATCH)
+	{
+		m_pJobSystem->ParallelFor((unsigned int)m_ParallelBatch.size(), [this, deltaTime, profiling](unsigned int index)
+		{
+			UpdateBatchProcess(index, deltaTime, profiling);
+		}, JobWait_SkipMainThread);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < m_ParallelBatch.size(); ++i)
+		{
+			UpdateBatchProcess(i, deltaTime, profiling);
+		}
+	}
+
+	// fold the timings in after the barrier so no shared state is written from the workers
+	if (profiling)
+	{
+		for (auto it = m_ParallelTimings.begin(); it != m_ParallelTimings.end(); ++it)
+		{
+			RecordUpdate(*it);
+		}
+		m_ParallelTimings.clear();
+	}
+
+	m_ParallelBatch.clear();
+}
+
+void ProcessManager::UpdateBatchProcess(unsigned int index, float deltaTime, bool profiling)
+{
+	Process* pProcess = m_ParallelBatch[index];
+	if (!profiling)
+	{
+		pProcess->OnUpdate(deltaTime);
+		return;
+	}
+
+	ProcessTraceEvent& update = m_ParallelTimings[index];
+	update.m_pName = pProcess->GetName();
+	update.m_ThreadId = GetProfileThreadId();
+	update.m_StartNS = HighResClock::GetNanoseconds();
+	pProcess->OnUpdate(deltaTime);
+	update.m_DurationNS = HighResClock::GetNanoseconds() - update.m_StartNS;
+}
+
+int ProcessManager::GetSlot(ProcessHandle handle) const
+{
+	unsigned int slot = (unsigned int)(handle & 0xffffffffULL);
+	unsigned int generation = (unsigned int)(handle >> 32);
+	if (slot >= m_Slots.size() || m_Slots[slot].m_Generation != generation)
+		return -1;
+
+	return (int)slot;
+}
+
+const StrongProcessPtr& ProcessManager::GetSlotProcess(unsigned int slot) const
+{
+	const ProcessArray& processes = m_Slots[slot].m_Sleeping ? m_Sleeping : m_Awake;
+	return processes.m_Processes[m_Slots[slot].m_DenseIndex];
+}
+
+void ProcessManager::RemoveProcess(unsigned int denseIndex)
+{
+	CB_ASSERT(denseIndex < m_Awake.m_Processes.size());
+
+	// let the process finish anything still using it while the whole object is alive. it is still in
+	// its slot, so anything this attaches gets a slot and index of its own
+	m_Awake.m_Processes[denseIndex]->OnRemove();
+
+	if (m_ProfilingEnabled)
+	{
+		ProcessTypeStats& stats = GetTypeProfile(m_Awake.m_Processes[denseIndex]->GetName()).m_Stats;
+		if (stats.m_NumLive > 0)
+			--stats.m_NumLive;
+		++m_Profile.m_NumRemoved;
+	}
+
+	// free the slot, bumping the generation makes every handle to it stale
+	unsigned int slot = m_Awake.m_Slots[denseIndex];
+	++m_Slots[slot].m_Generation;
+	if (m_Slots[slot].m_Generation == 0)
+		m_Slots[slot].m_Generation = 1;
+	m_FreeSlots.push_back(slot);
+
+	// move the last process into the hole
+	unsigned int lastIndex = (unsigned int)m_Awake.m_Processes.size() - 1;
+	if (denseIndex != lastIndex)
+	{
+		m_Awake.m_Processes[denseIndex].swap(m_Awake.m_Processes[lastIndex]);
+		m_Awake.m_Slots[denseIndex] = m_Awake.m_Slots[lastIndex];
+		m_Slots[m_Awake.m_Slots[denseIndex]].m_DenseIndex = denseIndex;
+	}
+
+	// release the process last, its destructor may abort its child
+	StrongProcessPtr pRemoved;
+	pRemoved.swap(m_Awake.m_Processes.back());
+	m_Awake.m_Processes.pop_back();
+	m_Awake.m_Slots.pop_back();
+}
+
+void ProcessManager::MoveProcess(bool toSleeping, unsigned int denseIndex)
+{
+	ProcessArray& from = toSleeping ? m_Awake : m_Sleeping;
+	ProcessArray& to = toSleeping ? m_Sleeping : m_Awake;
+	CB_ASSERT(denseIndex < from.m_Processes.size());
+
+	// append to the other array
+	unsigned int slot = from.m_Slots[denseIndex];
+	m_Slots[slot].m_DenseIndex = (unsigned int)to.m_Processes.size();
+	m_Slots[slot].m_Sleeping = toSleeping;
+	to.m_Processes.push_back(StrongProcessPtr());
+	to.m_Processes.back().swap(from.m_Processes[denseIndex]);
+	to.m_Slots.push_back(slot);
+
+	// and fill the hole with the last process
+	unsigned int lastIndex = (unsigned int)from.m_Processes.size() - 1;
+	if (denseIndex != lastIndex)
+	{
+		from.m_Processes[denseIndex].swap(from.m_Processes[lastIndex]);
+		from.m_Slots[denseIndex] = from.m_Slots[lastIndex];
+		m_Slots[from.m_Slots[denseIndex]].m_DenseIndex = denseIndex;
+	}
+	from.m_Processes.pop_back();
+	from.m_Slots.pop_back();
+}
+
+void ProcessManager::ParkProcess(unsigned int denseIndex)
+{
+	Process* pProcess = m_Awake.m_Processes[denseIndex].get();
+
+	SleepWaiter waiter;
+	waiter.m_Slot = m_Awake.m_Slots[denseIndex];
+	waiter.m_SleepSerial = ++m_Slots[waiter.m_Slot].m_SleepSerial;
+
+	if (pProcess->m_SleepTime >= 0.0f)
+	{
+		SleepTimer timer;
+		timer.m_WakeTime = m_Time + pProcess->m_SleepTime;
+		timer.m_Waiter = waiter;
+		m_SleepTimers.push(timer);
+	}
+	else
+	{
+		// start listening the first time anything sleeps on this event type
+		auto findIt = m_SleepEvents.find(pProcess->m_WakeEventType);
+		if (findIt == m_SleepEvents.end())
+		{
+			findIt = m_SleepEvents.insert(std::make_pair(pProcess->m_WakeEventType, std::vector<SleepWaiter>())).first;
+			IEventManager::Get()->AddListener(fastdelegate::MakeDelegate(this, &ProcessManager::OnWakeEvent), pProcess->m_WakeEventType);
+		}
+		findIt->second.push_back(waiter);
+	}
+
+	MoveProcess(true, denseIndex);
+}
+
+void ProcessManager::WakeProcess(const SleepWaiter& waiter)
+{
+	// the process may have been woken and put back to sleep, aborted or removed since this wake up was scheduled
+	ProcessSlot& slot = m_Slots[waiter.m_Slot];
+	if (!slot.m_Sleeping || slot.m_SleepSerial != waiter.m_SleepSerial)
+		return;
+
+	++slot.m_SleepSerial;
+	MoveProcess(false, slot.m_DenseIndex);
+
+	Process* pProcess = m_Awake.m_Processes.back().get();
+	pProcess->SetState(Process::RUNNING);
+	pProcess->OnWake();
+}
+
+void ProcessManager::WakeDueProcesses()
+{
+	while (!m_SleepTimers.empty() && m_SleepTimers.top().m_WakeTime <= m_Time)
+	{
+		SleepWaiter waiter = m_SleepTimers.top().m_Waiter;
+		m_SleepTimers.pop();
+		WakeProcess(waiter);
+	}
+
+	for (auto it = m_PendingEventWakes.begin(); it != m_PendingEventWakes.end(); ++it)
+	{
+		WakeProcess(*it);
+	}
+	m_PendingEventWakes.clear();
+}
+
+void ProcessManager::OnWakeEvent(IEventPtr pEvent)
+{
+	// the sleepers are woken at the start of the next update, processes are never moved while an update is walking them
+	auto findIt = m_SleepEvents.find(pEvent->GetEventType());
+	if (findIt != m_SleepEvents.end())
+	{
+		m_PendingEventWakes.insert(m_PendingEventWakes.end(), findIt->second.begin(), findIt->second.end());
+		StopWakeEvent(findIt);
+	}
+}
+
+void ProcessManager::CancelEventWait(unsigned int slot)
+{
+	// timed sleepers stay in the heap, the serial makes their wake up a no op
+	const StrongProcessPtr& pProcess = GetSlotProcess(slot);
+	if (pProcess->m_SleepTime >= 0.0f)
+		return;
+
+	// the event may already have been sent, then the process waits in the pending wakes instead
+	auto findIt = m_SleepEvents.find(pProcess->m_WakeEventType);
+	if (findIt == m_SleepEvents.end())
+		return;
+
+	std::vector<SleepWaiter>& waiters = findIt->second;
+	for (size_t i = 0; i < waiters.size(); ++i)
+	{
+		if (waiters[i].m_Slot == slot)
+		{
+			waiters[i] = waiters.back();
+			waiters.pop_back();
+			break;
+		}
+	}
+
+	if (waiters.empty())
+		StopWakeEvent(findIt);
+}
+
+void ProcessManager::StopWakeEvent(SleepEventMap::iterator eventIt)
+{
+	// removing a listener is safe while its event is being dispatched
+	IEventManager::Get()->RemoveListener(fastdelegate::MakeDelegate(this, &ProcessManager::OnWakeEvent), eventIt->first);
+	m_SleepEvents.erase(eventIt);
+}
+
+void ProcessManager::EnableProfiling(bool enable)
+{
+	if (enable && !m_ProfilingEnabled)
+	{
+		m_ProfilingEnabled = true;
+		ResetProfile();
+	}
+	else if (!enable)
+	{
+		m_ProfilingEnabled = false;
+	}
+}
+
+void ProcessManager::ResetProfile()
+{
+	m_Profile = ProcessProfileReport();
+	m_ProfileTypes.clear();
+	m_TraceEvents.clear();
+	m_NextTraceEvent = 0;
+	m_ProfileStartNS = HighResClock::GetNanoseconds();
+	m_LastProfileDumpNS = m_ProfileStartNS;
+
+	if (!m_ProfilingEnabled)
+		return;
+
+	// start the live counts from the processes that are already attached
+	const ProcessArray* processArrays[] = { &m_Awake, &m_Sleeping };
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		const std::vector<StrongProcessPtr>& processes = processArrays[i]->m_Processes;
+		for (auto it = processes.begin(); it != processes.end(); ++it)
+		{
+			ProcessTypeStats& stats = GetTypeProfile((*it)->GetName()).m_Stats;
+			stats.m_PeakLive = ++stats.m_NumLive;
+		}
+	}
+	m_Profile.m_PeakProcesses = GetProcessCount();
+}
+
+void ProcessManager::GetProfileReport(ProcessProfileReport& report) const
+{
+	report = m_Profile;
+	report.m_Types.clear();
+	report.m_Types.reserve(m_ProfileTypes.size());
+
+	std::vector<unsigned int> recentNS;
+	for (auto it = m_ProfileTypes.begin(); it != m_ProfileTypes.end(); ++it)
+	{
+		ProcessTypeStats stats = it->second.m_Stats;
+		if (stats.m_NumUpdates > 0)
+		{
+			stats.m_AverageNS = stats.m_TotalNS / stats.m_NumUpdates;
+
+			recentNS = it->second.m_RecentNS;
+			auto p99It = recentNS.begin() + (recentNS.size() * 99) / 100;
+			std::nth_element(recentNS.begin(), p99It, recentNS.end());
+			stats.m_P99NS = *p99It;
+		}
+
+		report.m_Types.push_back(stats);
+	}
+
+	std::sort(report.m_Types.begin(), report.m_Types.end(), [](const ProcessTypeStats& a, const ProcessTypeStats& b) { return a.m_TotalNS > b.m_TotalNS; });
+}
+
+void ProcessManager::DumpProfile() const
+{
+	ProcessProfileReport report;
+	GetProfileReport(report);
+
+	unsigned long long averageFrameNS = (report.m_NumFrames > 0) ? report.m_TotalFrameNS / report.m_NumFrames : 0;
+	CB_LOG("ProcessProfile", std::string(m_pName) + " over " + ToStr(report.m_NumFrames) + " frames:" +
+		" avg " + ToStr(NanosecondsToMillis(averageFrameNS)) + "ms" +
+		" max " + ToStr(NanosecondsToMillis(report.m_MaxFrameNS)) + "ms" +
+		" over budget " + ToStr(report.m_NumOverBudgetFrames) +
+		" attached " + ToStr(report.m_NumAttached) +
+		" removed " + ToStr(report.m_NumRemoved) +
+		" peak " + ToStr(report.m_PeakProcesses) +
+		" peak awake " + ToStr(report.m_PeakAwake));
+
+	for (auto it = report.m_Types.begin(); it != report.m_Types.end(); ++it)
+	{
+		CB_LOG("ProcessProfile", std::string(it->m_pName) +
+			" updates " + ToStr(it->m_NumUpdates) +
+			" total " + ToStr(NanosecondsToMillis(it->m_TotalNS)) + "ms" +
+			" min " + ToStr(NanosecondsToMillis(it->m_MinNS)) + "ms" +
+			" avg " + ToStr(NanosecondsToMillis(it->m_AverageNS)) + "ms" +
+			" p99 " + ToStr(NanosecondsToMillis(it->m_P99NS)) + "ms" +
+			" max " + ToStr(NanosecondsToMillis(it->m_MaxNS)) + "ms" +
+			" live " + ToStr(it->m_NumLive) +
+			" peak " + ToStr(it->m_PeakLive) +
+			" attached " + ToStr(it->m_NumAttached) +
+			" succeeded " + ToStr(it->m_NumSucceeded) +
+			" failed " + ToStr(it->m_NumFailed));
+	}
+}
+
+bool ProcessManager::WriteProfileTrace(const std::string& fileName) const
+{
+	FILE* pFile = nullptr;
+	fopen_s(&pFile, fileName.c_str(), "w");
+	if (!pFile)
+	{
+		CB_ERROR("Could not open the process trace file: " + fileName);
+		return false;
+	}
+
+	// name the process and its threads so the trace viewer labels the rows
+	fprintf(pFile, "{\"traceEvents\":[\n");
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"%s\"}},\n", m_pName);
+	fprintf(pFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main\"}}");
+	unsigned int numWorkers = m_pJobSystem ? m_pJobSystem->GetNumWorkers() : 0;
+	for (unsigned int i = 1; i <= numWorkers; ++i)
+	{
+		fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Worker %u\"}}", i, i);
+	}
+
+	// complete events in microseconds from the start of the profile, oldest first
+	size_t numEvents = m_TraceEvents.size();
+	for (size_t i = 0; i < numEvents; ++i)
+	{
+		const ProcessTraceEvent& traceEvent = m_TraceEvents[(m_NextTraceEvent + i) % numEvents];
+		if (traceEvent.m_StartNS < m_ProfileStartNS)
+			continue;
+
+		fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"process\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			traceEvent.m_pName, traceEvent.m_ThreadId,
+			(double)(traceEvent.m_StartNS - m_ProfileStartNS) / 1000.0, (double)traceEvent.m_DurationNS / 1000.0);
+	}
+
+	fprintf(pFile, "\n]}\n");
+	fclose(pFile);
+	return true;
+}
+
+unsigned int ProcessManager::GetProfileThreadId() const
+{
+	if (!m_pJobSystem)
+		return 0;
+
+	// the main thread's index comes after the workers
+	int threadIndex = m_pJobSystem->GetThreadIndex();
+	if (threadIndex < 0 || threadIndex == (int)m_pJobSystem->GetNumWorkers())
+		return 0;
+
+	return (unsigned int)threadIndex + 1;
+}
+
+ProcessManager::ProcessTypeProfile& ProcessManager::GetTypeProfile(const char* pName)
+{
+	// FNV-1a over the name, hashing the text instead of building a string keeps profiled updates from allocating
+	unsigned long long hash = 14695981039346656037ULL;
+	for (const char* pChar = pName; *pChar; ++pChar)
+	{
+		hash ^= (unsigned char)*pChar;
+		hash *= 1099511628211ULL;
+	}
+
+	ProcessTypeProfile& profile = m_ProfileTypes[hash];
+	if (!profile.m_Stats.m_pName)
+	{
+		profile.m_Name = pName;
+		profile.m_Stats.m_pName = profile.m_Name.c_str();
+		profile.m_NextRecent = 0;
+	}
+	CB_ASSERT(profile.m_Name == pName);
+
+	return profile;
+}
+
+void ProcessManager::RecordUpdate(const ProcessTraceEvent& update)
+{
+	ProcessTypeProfile& profile = GetTypeProfile(update.m_pName);
+	ProcessTypeStats& stats = profile.m_Stats;
+	if (stats.m_NumUpdates == 0 || update.m_DurationNS < stats.m_MinNS)
+	{
+		stats.m_MinNS = update.m_DurationNS;
+	}
+	if (update.m_DurationNS > stats.m_MaxNS)
+	{
+		stats.m_MaxNS = update.m_DurationNS;
+	}
+	stats.m_TotalNS += update.m_DurationNS;
+	++stats.m_NumUpdates;
+
+	// keep the most recent update times for the percentile, anything over 4 seconds is clamped
+	unsigned int durationNS = (update.m_DurationNS > 0xffffffffULL) ? 0xffffffff : (unsigned int)update.m_DurationNS;
+	if (profile.m_RecentNS.size() < PROCESSMANAGER_PROFILE_SAMPLES)
+	{
+		profile.m_RecentNS.push_back(durationNS);
+	}
+	else
+	{
+		profile.m_RecentNS[profile.m_NextRecent] = durationNS;
+		profile.m_NextRecent = (profile.m_NextRecent + 1) % PROCESSMANAGER_PROFILE_SAMPLES;
+	}
+
+	// the trace keeps the profile's copy of the name, the process may be gone when it is written
+	ProcessTraceEvent traceEvent = update;
+	traceEvent.m_pName = stats.m_pName;
+	AddTraceEvent(traceEvent);
+}
+
+void ProcessManager::AddTraceEvent(const ProcessTraceEvent& traceEvent)
+{
+	if (m_TraceEvents.size() < PROCESSMANAGER_TRACE_CAPACITY)
+	{
+		m_TraceEvents.push_back(traceEvent);
+	}
+	else
+	{
+		m_TraceEvents[m_NextTraceEvent] = traceEvent;
+		m_NextTraceEvent = (m_NextTraceEvent + 1) % PROCESSMANAGER_TRACE_CAPACITY;
+	}
 }
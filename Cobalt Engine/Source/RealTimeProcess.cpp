@@ -8,19 +8,15 @@
 #include "Logger.h"
 #include "RealTimeProcess.h"
 
-RealTimeProcess::RealTimeProcess(int priority)
+RealTimeProcess::RealTimeProcess() :
+	m_Finished(false)
 {
-	m_ThreadId = 0;
-	m_ThreadPriority = priority;
 }
 
-DWORD WINAPI RealTimeProcess::ThreadProc(LPVOID lpParam)
+RealTimeProcess::~RealTimeProcess()
 {
-	// cast the param to a real time procedure and call the process proc
-	RealTimeProcess *proc = static_cast<RealTimeProcess*>(lpParam);
-	proc->ProcessProc();
-
-	return TRUE;
+	// waiting here would be too late, the derived object ProcessProc() belongs to is already gone
+	CB_ASSERT(!m_pJob || m_pJob->IsFinished());
 }
 
 void RealTimeProcess::OnInit()
@@ -28,21 +24,50 @@ void RealTimeProcess::OnInit()
 	// call base class init
 	Process::OnInit();
 
-	// create a windows thread
-	m_ThreadHandle = CreateThread(
-		NULL,						// default security attributes
-		0,							// default stack size
-		ThreadProc,					// thread process
-		this,						// parameter is a pointer to this object
-		0,							// default creation flags
-		&m_ThreadId);				// return the id of the thread
+	// run the process proc as a job instead of on a thread of its own
+	m_pJob = JobSystem::Get()->CreateJob([this]()
+	{
+		ProcessProc();
+		m_Finished = true;
+	});
 
-	if (m_ThreadHandle == nullptr)
+	if (!m_pJob)
 	{
-		CB_ERROR("Could not create thread");
+		CB_ERROR("Could not create job");
 		Fail();
 		return;
 	}
 
-	SetThreadPriority(m_ThreadHandle, m_ThreadPriority);
+	JobSystem::Get()->Run(m_pJob);
+}
+
+void RealTimeProcess::OnUpdate(float deltaTime)
+{
+	if (m_Finished)
+	{
+		Succeed();
+	}
+}
+
+void RealTimeProcess::OnFail()
+{
+	WaitForJob();
+}
+
+void RealTimeProcess::OnAbort()
+{
+	WaitForJob();
+}
+
+void RealTimeProcess::OnRemove()
+{
+	WaitForJob();
+}
+
+void RealTimeProcess::WaitForJob()
+{
+	if (m_pJob && !m_pJob->IsFinished())
+	{
+		JobSystem::Get()->Wait(m_pJob);
+	}
 }
\ No newline at end of file
@@ -5,11 +5,12 @@
 	by Mike McShaffry and David Graham
 */
 
-#include <strstream>
+#include <sstream>
 
 #include "BinaryPacket.h"
 #include "EngineStd.h"
 #include "EventManager.h"
+#include "EventStream.h"
 #include "interfaces.h"
 #include "Logger.h"
 #include "NetworkEvents.h"
@@ -34,10 +35,19 @@ void RemoteEventSocket::HandleInput()
 		// if the packet is a binary packet
 		if (!strcmp(packet->GetType(), BinaryPacket::g_Type))
 		{
-			const char* buf = packet->GetData();
-			int size = static_cast<int>(packet->GetSize());
+			const char* buf = packet->GetData() + sizeof(u_long);
+			int size = static_cast<int>(packet->GetSize() - sizeof(u_long));
 
-			std::istrstream in(buf + sizeof(u_long), (size - sizeof(u_long)));
+			// binary messages start with the raw message id byte, text messages
+			// start with the message id written out as an ascii digit
+			if (size > 0 && buf[0] == NetMsg_BinaryEvent)
+			{
+				EventReadStream in(buf + 1, size - 1);
+				CreateEvent(in);
+				continue;
+			}
+
+			std::istringstream in(std::string(buf, size));
 
 			int type;
 			in >> type;
@@ -89,3 +99,27 @@ void RemoteEventSocket::CreateEvent(std::istream& in)
 		CB_ERROR("Error: Unknown event type from remote");
 	}
 }
+
+void RemoteEventSocket::CreateEvent(EventReadStream& in)
+{
+	// create an event and dispatch it to the event manager
+	EventType eventType = in.ReadUInt32();
+
+	IEventPtr pEvent(CREATE_EVENT(eventType));
+	if (pEvent)
+	{
+		// deserialize the event from the network and dispatch it
+		if (pEvent->DeserializeBinary(in))
+		{
+			IEventManager::Get()->QueueEvent(pEvent);
+		}
+		else
+		{
+			CB_ERROR("Error: Malformed " + std::string(pEvent->GetName()) + " from remote");
+		}
+	}
+	else
+	{
+		CB_ERROR("Error: Unknown event type from remote");
+	}
+}
@@ -27,6 +27,13 @@ const char* GridRenderComponent::g_Name = "GridRenderComponent";
 const char* LightRenderComponent::g_Name = "LightRenderComponent";
 const char* SkyRenderComponent::g_Name = "SkyRenderComponent";
 
+const ComponentId MeshRenderComponent::g_Id = Component::GetIdFromName(MeshRenderComponent::g_Name);
+const ComponentId SphereRenderComponent::g_Id = Component::GetIdFromName(SphereRenderComponent::g_Name);
+const ComponentId TeapotRenderComponent::g_Id = Component::GetIdFromName(TeapotRenderComponent::g_Name);
+const ComponentId GridRenderComponent::g_Id = Component::GetIdFromName(GridRenderComponent::g_Name);
+const ComponentId LightRenderComponent::g_Id = Component::GetIdFromName(LightRenderComponent::g_Name);
+const ComponentId SkyRenderComponent::g_Id = Component::GetIdFromName(SkyRenderComponent::g_Name);
+
 //====================================================
 //	BaseRenderComponent definitions
 //====================================================
@@ -41,6 +48,10 @@ bool BaseRenderComponent::Init(TiXmlElement* pData)
 
 void BaseRenderComponent::PostInit()
 {
+	// a headless server has no scene to draw the node in
+	if (g_pApp->IsHeadless())
+		return;
+
 	shared_ptr<SceneNode> pSceneNode(GetSceneNode());
 	// fire event that a new render component has been created
 	shared_ptr<Event_NewRenderComponent> pEvent(CB_NEW Event_NewRenderComponent(m_pOwner->GetId(), pSceneNode));
@@ -188,7 +199,7 @@ bool LightRenderComponent::DelegateInit(TiXmlElement* pData)
 
 shared_ptr<SceneNode> LightRenderComponent::CreateSceneNode()
 {
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		WeakBaseRenderComponentPtr weakThis(this);
@@ -307,7 +318,7 @@ bool GridRenderComponent::DelegateInit(TiXmlElement* pData)
 
 shared_ptr<SceneNode> GridRenderComponent::CreateSceneNode()
 {
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		WeakBaseRenderComponentPtr weakThis(this);
@@ -366,7 +377,7 @@ bool SphereRenderComponent::DelegateInit(TiXmlElement* pData)
 shared_ptr<SceneNode> SphereRenderComponent::CreateSceneNode()
 {
 	// get the transform
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (!pTransformComponent)
 	{
 		// can't render without a transform
@@ -414,7 +425,7 @@ void SphereRenderComponent::CreateInheritedXmlElements(TiXmlElement* pBaseElemen
 shared_ptr<SceneNode> TeapotRenderComponent::CreateSceneNode()
 {
 	// get the transform 
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		WeakBaseRenderComponentPtr weakThis(this);
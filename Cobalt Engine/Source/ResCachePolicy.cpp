@@ -0,0 +1,324 @@
+/*
+	ResCachePolicy.cpp
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include "ResCachePolicy.h"
+
+#include "EngineStd.h"
+
+// first line of a trace file, the number is bumped if the format changes
+const char* RESCACHEPOLICY_TRACE_HEADER = "ResCacheTrace 1";
+
+//====================================================
+//	LRUCachePolicy
+//====================================================
+void LRUCachePolicy::OnInsert(const std::string& name)
+{
+	if (m_Names.find(name) != m_Names.end())
+	{
+		OnAccess(name);
+		return;
+	}
+
+	m_List.push_front(name);
+	m_Names[name] = m_List.begin();
+}
+
+void LRUCachePolicy::OnAccess(const std::string& name)
+{
+	NameMap::iterator findIt = m_Names.find(name);
+	if (findIt != m_Names.end())
+	{
+		// relinking the node keeps the map's iterator valid
+		m_List.splice(m_List.begin(), m_List, findIt->second);
+	}
+}
+
+void LRUCachePolicy::OnRemove(const std::string& name)
+{
+	NameMap::iterator findIt = m_Names.find(name);
+	if (findIt != m_Names.end())
+	{
+		m_List.erase(findIt->second);
+		m_Names.erase(findIt);
+	}
+}
+
+std::string LRUCachePolicy::GetVictim()
+{
+	return m_List.empty() ? std::string() : m_List.back();
+}
+
+void LRUCachePolicy::Clear()
+{
+	m_Names.clear();
+	m_List.clear();
+}
+
+//====================================================
+//	LFUCachePolicy
+//====================================================
+void LFUCachePolicy::OnInsert(const std::string& name)
+{
+	if (m_Entries.find(name) != m_Entries.end())
+	{
+		OnAccess(name);
+		return;
+	}
+
+	NameList& bucket = m_Buckets[1];
+	bucket.push_front(name);
+
+	Entry entry;
+	entry.m_Count = 1;
+	entry.m_Position = bucket.begin();
+	m_Entries[name] = entry;
+}
+
+void LFUCachePolicy::OnAccess(const std::string& name)
+{
+	auto findIt = m_Entries.find(name);
+	if (findIt == m_Entries.end())
+		return;
+
+	// move the resource up to the next count
+	Entry& entry = findIt->second;
+	auto bucketIt = m_Buckets.find(entry.m_Count);
+	NameList& nextBucket = m_Buckets[entry.m_Count + 1];
+	nextBucket.splice(nextBucket.begin(), bucketIt->second, entry.m_Position);
+	if (bucketIt->second.empty())
+	{
+		m_Buckets.erase(bucketIt);
+	}
+
+	++entry.m_Count;
+}
+
+void LFUCachePolicy::OnRemove(const std::string& name)
+{
+	auto findIt = m_Entries.find(name);
+	if (findIt == m_Entries.end())
+		return;
+
+	auto bucketIt = m_Buckets.find(findIt->second.m_Count);
+	bucketIt->second.erase(findIt->second.m_Position);
+	if (bucketIt->second.empty())
+	{
+		m_Buckets.erase(bucketIt);
+	}
+
+	m_Entries.erase(findIt);
+}
+
+std::string LFUCachePolicy::GetVictim()
+{
+	return m_Buckets.empty() ? std::string() : m_Buckets.begin()->second.back();
+}
+
+void LFUCachePolicy::Clear()
+{
+	m_Entries.clear();
+	m_Buckets.clear();
+}
+
+//====================================================
+//	TwoQueueCachePolicy
+//====================================================
+void TwoQueueCachePolicy::OnInsert(const std::string& name)
+{
+	if (m_InNames.find(name) != m_InNames.end() || m_MainNames.find(name) != m_MainNames.end())
+	{
+		OnAccess(name);
+		return;
+	}
+
+	// a resource that came back soon after leaving probation has earned a place in the main queue
+	NameMap::iterator ghostIt = m_OutNames.find(name);
+	if (ghostIt != m_OutNames.end())
+	{
+		m_Out.erase(ghostIt->second);
+		m_OutNames.erase(ghostIt);
+
+		m_Main.push_front(name);
+		m_MainNames[name] = m_Main.begin();
+		return;
+	}
+
+	m_In.push_front(name);
+	m_InNames[name] = m_In.begin();
+}
+
+void TwoQueueCachePolicy::OnAccess(const std::string& name)
+{
+	// hits on probation do not count, a burst of uses of a new resource is still one use
+	NameMap::iterator findIt = m_MainNames.find(name);
+	if (findIt != m_MainNames.end())
+	{
+		m_Main.splice(m_Main.begin(), m_Main, findIt->second);
+	}
+}
+
+void TwoQueueCachePolicy::OnRemove(const std::string& name)
+{
+	NameMap::iterator findIt = m_InNames.find(name);
+	if (findIt != m_InNames.end())
+	{
+		m_In.erase(findIt->second);
+		m_InNames.erase(findIt);
+		AddGhost(name);
+		return;
+	}
+
+	findIt = m_MainNames.find(name);
+	if (findIt != m_MainNames.end())
+	{
+		m_Main.erase(findIt->second);
+		m_MainNames.erase(findIt);
+	}
+}
+
+std::string TwoQueueCachePolicy::GetVictim()
+{
+	size_t maxIn = (size_t)((m_In.size() + m_Main.size()) * RESCACHEPOLICY_2Q_IN_SHARE);
+	if (!m_In.empty() && (m_In.size() > maxIn || m_Main.empty()))
+		return m_In.back();
+
+	return m_Main.empty() ? std::string() : m_Main.back();
+}
+
+void TwoQueueCachePolicy::Clear()
+{
+	m_InNames.clear();
+	m_In.clear();
+	m_MainNames.clear();
+	m_Main.clear();
+	m_OutNames.clear();
+	m_Out.clear();
+}
+
+void TwoQueueCachePolicy::AddGhost(const std::string& name)
+{
+	if (m_OutNames.find(name) != m_OutNames.end())
+		return;
+
+	m_Out.push_front(name);
+	m_OutNames[name] = m_Out.begin();
+
+	// only remember as many names as there are resources, with a floor so a small cache still learns
+	size_t maxOut = (size_t)((m_In.size() + m_Main.size()) * RESCACHEPOLICY_2Q_OUT_SHARE);
+	if (maxOut < 16)
+		maxOut = 16;
+
+	while (m_Out.size() > maxOut)
+	{
+		m_OutNames.erase(m_Out.back());
+		m_Out.pop_back();
+	}
+}
+
+//====================================================
+//	Simulation
+//====================================================
+ResCacheStats SimulateResCachePolicy(const std::vector<ResCacheAccess>& trace, IResCachePolicy* pPolicy, unsigned long long budget)
+{
+	ResCacheStats stats;
+	std::unordered_map<std::string, unsigned long long> resident;
+	unsigned long long allocated = 0;
+
+	pPolicy->Clear();
+
+	for (auto it = trace.begin(); it != trace.end(); ++it)
+	{
+		if (resident.find(it->m_Name) != resident.end())
+		{
+			++stats.m_NumHits;
+			pPolicy->OnAccess(it->m_Name);
+			continue;
+		}
+
+		++stats.m_NumMisses;
+		stats.m_MissedBytes += it->m_Size;
+
+		// a resource bigger than the whole budget is loaded and dropped again, like the cache does
+		if (it->m_Size > budget)
+			continue;
+
+		while (allocated + it->m_Size > budget)
+		{
+			std::string victim = pPolicy->GetVictim();
+			if (victim.empty())
+				break;
+
+			allocated -= resident[victim];
+			resident.erase(victim);
+			pPolicy->OnRemove(victim);
+			++stats.m_NumEvictions;
+		}
+
+		resident[it->m_Name] = it->m_Size;
+		allocated += it->m_Size;
+		pPolicy->OnInsert(it->m_Name);
+	}
+
+	pPolicy->Clear();
+
+	return stats;
+}
+
+IResCachePolicy* CreateResCachePolicy(const std::string& name)
+{
+	if (name == "LRU")
+		return CB_NEW LRUCachePolicy;
+	if (name == "LFU")
+		return CB_NEW LFUCachePolicy;
+	if (name == "2Q")
+		return CB_NEW TwoQueueCachePolicy;
+
+	return nullptr;
+}
+
+//====================================================
+//	Trace files
+//====================================================
+bool SaveResCacheTrace(const std::string& fileName, const std::vector<ResCacheAccess>& trace)
+{
+	std::ofstream file(fileName.c_str());
+	if (!file)
+		return false;
+
+	// one access per line, the size first since a name may have spaces in it
+	file << RESCACHEPOLICY_TRACE_HEADER << "\n";
+	for (auto it = trace.begin(); it != trace.end(); ++it)
+	{
+		file << it->m_Size << " " << it->m_Name << "\n";
+	}
+
+	return file.good();
+}
+
+bool LoadResCacheTrace(const std::string& fileName, std::vector<ResCacheAccess>& trace)
+{
+	std::ifstream file(fileName.c_str());
+	std::string line;
+	if (!file || !std::getline(file, line) || line != RESCACHEPOLICY_TRACE_HEADER)
+		return false;
+
+	trace.clear();
+	while (std::getline(file, line))
+	{
+		if (line.empty())
+			continue;
+
+		std::istringstream stream(line);
+		ResCacheAccess access;
+		if (!(stream >> access.m_Size) || stream.get() != ' ' || !std::getline(stream, access.m_Name) || access.m_Name.empty())
+			return false;
+
+		trace.push_back(access);
+	}
+
+	return true;
+}
@@ -16,19 +16,52 @@
 #include "ResourceHandle.h"
 #include "StringUtil.h"
 
+static float BytesToMegabytes(unsigned long long bytes)
+{
+	return (float)((double)bytes / (1024.0 * 1024.0));
+}
+
+ResRequest::ResRequest(const std::string& name)
+{
+	m_Name = name;
+	m_Ready = false;
+}
+
+shared_ptr<ResHandle> ResRequest::GetHandle()
+{
+	if (!m_Ready.load() && m_pJob)
+	{
+		JobSystem::Get()->Wait(m_pJob);
+	}
+
+	CB_ASSERT(m_Ready.load());
+	return m_Handle;
+}
+
 ResCache::ResCache(const unsigned int sizeInMb, IResourceFile* resourceFile)
 {
-	m_CacheSize = sizeInMb * 1024 * 1024;
+	m_CacheSize = (unsigned long long)sizeInMb * 1024 * 1024;
 	m_Allocated = 0;
 	m_File = resourceFile;
+	m_pJobSystem = nullptr;
+	m_RecordAccessTrace = false;
+
+	// every resource that matches no other group falls back on the first one
+	ResCacheGroup defaultGroup;
+	defaultGroup.m_Pattern = "*";
+	defaultGroup.m_pPolicy.reset(CB_NEW LRUCachePolicy);
+	defaultGroup.m_Budget = 0;
+	defaultGroup.m_Resident = 0;
+	defaultGroup.m_Priority = 0;
+	defaultGroup.m_Pinned = false;
+	m_Groups.push_back(defaultGroup);
 }
 
 ResCache::~ResCache()
 {
-	while (!m_LRU.empty())
-	{
-		FreeOneResource();
-	}
+	CB_ASSERT(m_PendingLoads.empty() && "Resource cache destroyed while loading, call SetJobSystem(nullptr) first");
+
+	Flush();
 	CB_SAFE_DELETE(m_File);
 }
 
@@ -51,26 +84,235 @@ void ResCache::RegisterLoader(shared_ptr<IResourceLoader> loader)
 	m_ResourceLoaders.push_front(loader);
 }
 
+void ResCache::SetCacheSize(unsigned long long size)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	m_CacheSize = size;
+	TrimToSize();
+}
+
+void ResCache::SetPolicy(shared_ptr<IResCachePolicy> pPolicy)
+{
+	CB_ASSERT(pPolicy);
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	// the new policy learns about the resources that are already in the group, oldest first
+	ResCacheGroup& group = m_Groups[0];
+	std::vector<std::string> names;
+	for (std::string victim = group.m_pPolicy->GetVictim(); !victim.empty(); victim = group.m_pPolicy->GetVictim())
+	{
+		names.push_back(victim);
+		group.m_pPolicy->OnRemove(victim);
+	}
+
+	group.m_pPolicy = pPolicy;
+	for (auto it = names.begin(); it != names.end(); ++it)
+	{
+		group.m_pPolicy->OnInsert(*it);
+	}
+}
+
+void ResCache::AddGroup(const std::string& pattern, shared_ptr<IResCachePolicy> pPolicy, unsigned long long budget, int priority)
+{
+	CB_ASSERT(pPolicy);
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	ResCacheGroup group;
+	group.m_Pattern = pattern;
+	std::transform(group.m_Pattern.begin(), group.m_Pattern.end(), group.m_Pattern.begin(), (int(*)(int)) std::tolower);
+	group.m_pPolicy = pPolicy;
+	group.m_Budget = budget;
+	group.m_Resident = 0;
+	group.m_Priority = priority;
+	group.m_Pinned = false;
+	m_Groups.push_back(group);
+
+	// resources already in the cache that match move over, their use history starts over in the new group
+	unsigned int groupIndex = (unsigned int)m_Groups.size() - 1;
+	for (ResHandleMap::iterator it = m_Resources.begin(); it != m_Resources.end(); ++it)
+	{
+		shared_ptr<ResHandle> handle = it->second;
+		if (FindGroup(it->first) != groupIndex)
+			continue;
+
+		unsigned long long size = (unsigned long long)handle->m_Size + handle->m_ExtraSize;
+		ResCacheGroup& oldGroup = m_Groups[handle->m_CacheGroup];
+		oldGroup.m_Resident -= size;
+		oldGroup.m_pPolicy->OnRemove(it->first);
+
+		handle->m_CacheGroup = groupIndex;
+		m_Groups[groupIndex].m_Resident += size;
+		m_Groups[groupIndex].m_pPolicy->OnInsert(it->first);
+	}
+	TrimGroup(groupIndex);
+}
+
+void ResCache::Pin(const std::string& pattern)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	AddGroup(pattern, shared_ptr<IResCachePolicy>(CB_NEW LRUCachePolicy));
+	m_Groups.back().m_Pinned = true;
+}
+
+void ResCache::SetJobSystem(JobSystem* pJobSystem)
+{
+	// loads in flight finish on the job system that started them
+	if (m_pJobSystem && pJobSystem != m_pJobSystem)
+	{
+		WaitForPendingLoads();
+	}
+
+	m_pJobSystem = pJobSystem;
+	m_File->SetJobSystem(pJobSystem);
+}
+
 shared_ptr<ResHandle> ResCache::GetHandle(Resource* r)
 {
-	// attempt to locate the handle in the cache
-	shared_ptr<ResHandle> handle(Find(r));
-	if (handle == nullptr)
+	shared_ptr<ResRequest> pRequest;
 	{
-		// if the handle is not in the cache (miss), load it
-		handle = Load(r);
-		CB_ASSERT(handle);
+		std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+		// attempt to locate the handle in the cache
+		shared_ptr<ResHandle> handle(Find(r));
+		if (handle)
+		{
+			// if the handle was in the cache (hit), move it to the front
+			// of the LRU list
+			Update(handle);
+			return handle;
+		}
+
+		++m_Stats.m_NumMisses;
+		ResRequestMap::iterator findIt = m_PendingLoads.find(r->m_Name);
+		if (findIt != m_PendingLoads.end())
+		{
+			pRequest = findIt->second;
+		}
 	}
-	else
+
+	// if it is already loading in the background, wait for it rather than reading it twice
+	if (pRequest)
 	{
-		// if the handle was in the cache (hit), move it to the front
-		// of the LRU list
-		Update(handle);
+		return pRequest->GetHandle();
 	}
 
+	// if the handle is not in the cache (miss), load it
+	shared_ptr<ResHandle> handle = Load(r);
+	CB_ASSERT(handle);
+
 	return handle;
 }
 
+shared_ptr<ResRequest> ResCache::GetHandleAsync(Resource* r, const ResLoadCallback& callback)
+{
+	shared_ptr<ResRequest> pRequest;
+	shared_ptr<ResHandle> handle;
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+		handle = Find(r);
+		if (handle)
+		{
+			Update(handle);
+		}
+		else
+		{
+			++m_Stats.m_NumMisses;
+
+			// join a load that is already in progress
+			ResRequestMap::iterator findIt = m_PendingLoads.find(r->m_Name);
+			if (findIt != m_PendingLoads.end())
+			{
+				if (callback)
+				{
+					findIt->second->m_Callbacks.push_back(callback);
+				}
+				return findIt->second;
+			}
+
+			if (m_pJobSystem)
+			{
+				pRequest.reset(CB_NEW ResRequest(r->m_Name));
+				if (callback)
+				{
+					pRequest->m_Callbacks.push_back(callback);
+				}
+
+				// the job has to exist before the request is published, anyone who joins the load waits on it
+				pRequest->m_pJob = CreateLoadJob(pRequest, *r);
+				m_PendingLoads[r->m_Name] = pRequest;
+			}
+		}
+	}
+
+	if (!pRequest)
+	{
+		// already cached, or there is nothing to load in the background with
+		if (!handle)
+		{
+			handle = Load(r);
+		}
+
+		pRequest.reset(CB_NEW ResRequest(r->m_Name));
+		pRequest->m_Handle = handle;
+		pRequest->m_Ready = true;
+		if (callback)
+		{
+			callback(handle);
+		}
+		return pRequest;
+	}
+
+	m_pJobSystem->Run(pRequest->m_pJob);
+
+	return pRequest;
+}
+
+JobPtr ResCache::CreateLoadJob(const shared_ptr<ResRequest>& pRequest, const Resource& resource)
+{
+	// read and inflate on a worker, then finish on the main thread, as a child so waiting on the load job covers both
+	JobSystem* pJobSystem = m_pJobSystem;
+	return pJobSystem->CreateJob([this, pJobSystem, pRequest, resource]()
+	{
+		shared_ptr<IResourceLoader> loader = FindLoader(resource);
+		unsigned int rawSize = 0;
+		bool rawIsView = false;
+		char* rawBuffer = loader ? ReadRawResource(resource, loader, rawSize, rawIsView, false) : nullptr;
+
+		// the loaders that only parse the buffer can run here as well
+		if (rawBuffer && loader->IsThreadSafe())
+		{
+			pRequest->m_Handle = CreateHandle(resource, loader, rawBuffer, rawSize, rawIsView, false);
+			rawBuffer = nullptr;
+		}
+
+		JobPtr pComplete = pJobSystem->CreateChildJob(pRequest->m_pJob, [this, pRequest, resource, loader, rawBuffer, rawSize, rawIsView]()
+		{
+			CompleteRequest(pRequest, resource, loader, rawBuffer, rawSize, rawIsView);
+		}, JobAffinity_MainThread);
+		pJobSystem->Run(pComplete);
+	});
+}
+
+void ResCache::WaitForPendingLoads()
+{
+	std::vector<shared_ptr<ResRequest>> pendingLoads;
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+		for (ResRequestMap::iterator it = m_PendingLoads.begin(); it != m_PendingLoads.end(); ++it)
+		{
+			pendingLoads.push_back(it->second);
+		}
+	}
+
+	for (auto it = pendingLoads.begin(); it != pendingLoads.end(); ++it)
+	{
+		(*it)->GetHandle();
+	}
+}
+
 int ResCache::PreLoad(const std::string& pattern, std::function<void(int, bool&)> progressCallback)
 {
 	if (m_File == nullptr) 
@@ -80,6 +322,10 @@ int ResCache::PreLoad(const std::string& pattern, std::function<void(int, bool&)
 	int loaded = 0;
 	bool cancel = false;
 
+	// keep a few loads in flight so every worker has something to read, without going far over the cache size
+	std::list<shared_ptr<ResRequest>> inFlight;
+	size_t maxInFlight = m_pJobSystem ? 2 * (m_pJobSystem->GetNumWorkers() + 1) : 1;
+
 	for (int i = 0; i < numFiles; ++i)
 	{
 		if (cancel)
@@ -90,8 +336,14 @@ int ResCache::PreLoad(const std::string& pattern, std::function<void(int, bool&)
 		if (WildcardMatch(pattern.c_str(), resource.m_Name.c_str()))
 		{
 			// load any resources that match the given pattern
-			shared_ptr<ResHandle> handle = g_pApp->m_ResCache->GetHandle(&resource);
+			inFlight.push_back(GetHandleAsync(&resource));
 			++loaded;
+
+			if (inFlight.size() >= maxInFlight)
+			{
+				inFlight.front()->GetHandle();
+				inFlight.pop_front();
+			}
 		}
 
 		// if theres a callback, call it (load screen, progress bar, etc)
@@ -100,6 +352,11 @@ int ResCache::PreLoad(const std::string& pattern, std::function<void(int, bool&)
 			progressCallback(i * 100 / numFiles, cancel);
 		}
 	}
+
+	for (auto it = inFlight.begin(); it != inFlight.end(); ++it)
+	{
+		(*it)->GetHandle();
+	}
 	return loaded;
 }
 
@@ -130,12 +387,14 @@ std::vector<std::string> ResCache::Match(const std::string& pattern)
 
 void ResCache::Flush()
 {
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
 	// empty the cache
-	while (!m_LRU.empty())
+	m_Resources.clear();
+	for (auto it = m_Groups.begin(); it != m_Groups.end(); ++it)
 	{
-		shared_ptr<ResHandle> handle = m_LRU.front();
-		Free(handle);
-		m_LRU.pop_front();
+		it->m_pPolicy->Clear();
+		it->m_Resident = 0;
 	}
 }
 
@@ -145,6 +404,12 @@ bool ResCache::IsUsingDevelopmentDirectories() const
 	return m_File->IsUsingDevelopmentDirectories();
 }
 
+bool ResCache::IsMemoryMapped() const
+{
+	CB_ASSERT(m_File);
+	return m_File->IsMemoryMapped();
+}
+
 shared_ptr<ResHandle> ResCache::Find(Resource* r)
 {
 	// return the resource handle if it's in the cache
@@ -157,112 +422,310 @@ shared_ptr<ResHandle> ResCache::Find(Resource* r)
 
 void ResCache::Update(shared_ptr<ResHandle> handle)
 {
-	// move the handle to the front of the LRU list
-	m_LRU.remove(handle);
-	m_LRU.push_front(handle);
+	++m_Stats.m_NumHits;
+	m_Groups[handle->m_CacheGroup].m_pPolicy->OnAccess(handle->m_Resouce.m_Name);
+
+	if (m_RecordAccessTrace)
+	{
+		m_AccessTrace.push_back(ResCacheAccess(handle->m_Resouce.m_Name, (unsigned long long)handle->m_Size + handle->m_ExtraSize));
+	}
 }
 
 shared_ptr<ResHandle> ResCache::Load(Resource* r)
 {
-	shared_ptr<IResourceLoader> loader;
-	shared_ptr<ResHandle> handle;
+	shared_ptr<IResourceLoader> loader = FindLoader(*r);
+	if (!loader)
+	{
+		CB_ASSERT(loader && L"Could not find a resource loader");
+		return nullptr;
+	}
 
+	unsigned int rawSize = 0;
+	bool rawIsView = false;
+	char* rawBuffer = ReadRawResource(*r, loader, rawSize, rawIsView, true);
+	if (rawBuffer == nullptr)
+	{
+		return nullptr;
+	}
+
+	shared_ptr<ResHandle> handle = CreateHandle(*r, loader, rawBuffer, rawSize, rawIsView, true);
+	if (handle)
+	{
+		// if a handle was successfully created, add it to the cache, its extra data may have taken it over the size
+		handle = Insert(handle);
+		TrimToSize();
+	}
+
+	return handle;
+}
+
+bool ResCache::StreamResource(Resource* r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback)
+{
+	std::unique_lock<std::mutex> fileLock(m_FileMutex, std::defer_lock);
+	if (!m_File->IsThreadSafe())
+	{
+		fileLock.lock();
+	}
+
+	return m_File->StreamRawResource(*r, stagingSize, callback);
+}
+
+shared_ptr<IResourceLoader> ResCache::FindLoader(const Resource& r)
+{
 	// find the correct loader to load this resource
 	for (ResourceLoaders::iterator it = m_ResourceLoaders.begin(); it != m_ResourceLoaders.end(); ++it)
 	{
 		shared_ptr<IResourceLoader> testLoader = *it;
 
-		if (WildcardMatch(testLoader->GetPattern().c_str(), r->m_Name.c_str()))
+		if (WildcardMatch(testLoader->GetPattern().c_str(), r.m_Name.c_str()))
 		{
-			loader = testLoader;
-			break;
+			return testLoader;
 		}
 	}
-	
-	if (!loader)
+
+	return nullptr;
+}
+
+char* ResCache::ReadRawResource(const Resource& r, shared_ptr<IResourceLoader> loader, unsigned int& rawSize, bool& rawIsView, bool makeRoom)
+{
+	// a file read through one file position can only be read by one thread at a time
+	std::unique_lock<std::mutex> fileLock(m_FileMutex, std::defer_lock);
+	if (!m_File->IsThreadSafe())
 	{
-		CB_ASSERT(loader && L"Could not find a resource loader");
-		return nullptr;
+		fileLock.lock();
 	}
 
 	// find the resource in the file
-	int rawSize = m_File->GetRawResourceSize(*r);
-	if (rawSize < 0)
+	int fileSize = m_File->GetRawResourceSize(r);
+	if (fileSize < 0)
 	{
-		CB_ASSERT(rawSize > 0 && "Resource not found");
+		CB_ASSERT(fileSize > 0 && "Resource not found");
 		return nullptr;
 	}
+	rawSize = (unsigned int)fileSize;
+	rawIsView = false;
+
+	// use the bytes where they are in the file if it has them as stored, unless the loader needs a null zero after them
+	const char* rawView = loader->AddNullZero() ? nullptr : m_File->GetRawResourceView(r);
+	if (rawView)
+	{
+		// a raw file keeps the view as its buffer, it still counts against the cache size so eviction works the same
+		if (loader->UseRawFile() && !Reserve(rawSize, makeRoom))
+		{
+			CB_LOG("Resource Cache", "Out of Memory");
+			return nullptr;
+		}
+
+		// loaders only read the raw buffer, and a handle never writes to a buffer it does not own
+		rawIsView = true;
+		return const_cast<char*>(rawView);
+	}
 
 	// allocate a buffer to hold the resource in memory
-	int allocSize = rawSize + ((loader->AddNullZero()) ? (1) : (0));
+	unsigned int allocSize = rawSize + ((loader->AddNullZero()) ? (1) : (0));
 	// if not using the raw file, the raw buffer is allocated outside and is temporary
-	char* rawBuffer = loader->UseRawFile() ? Allocate(allocSize) : CB_NEW char[allocSize];
-	ZeroMemory(rawBuffer, allocSize);
+	char* rawBuffer = loader->UseRawFile() ? Allocate(allocSize, makeRoom) : CB_NEW char[allocSize];
 
-	// load the resource from disk into the memory buffer
-	if (rawBuffer == nullptr || m_File->GetRawResource(*r, rawBuffer) == 0)
+	if (rawBuffer == nullptr)
 	{
 		CB_LOG("Resource Cache", "Out of Memory");
 		return nullptr;
 	}
 
-	char* buffer = nullptr;
-	unsigned int size = 0;
+	// load the resource from disk into the memory buffer, a buffer from Allocate() gives its size back to the cache
+	if (m_File->GetRawResource(r, rawBuffer) == 0)
+	{
+		CB_LOG("Resource Cache", "Could not read " + r.m_Name);
+		delete[] rawBuffer;
+		if (loader->UseRawFile())
+		{
+			MemoryHasBeenFreed(allocSize);
+		}
+		return nullptr;
+	}
+
+	if (allocSize > rawSize)
+	{
+		rawBuffer[rawSize] = 0;
+	}
+
+	return rawBuffer;
+}
 
+shared_ptr<ResHandle> ResCache::CreateHandle(const Resource& r, shared_ptr<IResourceLoader> loader, char* rawBuffer, unsigned int rawSize, bool rawIsView, bool makeRoom)
+{
 	// if the loader uses raw files, create a handle for the resource using the raw buffer
 	if (loader->UseRawFile())
 	{
-		buffer = rawBuffer;
-		handle = shared_ptr<ResHandle>(CB_NEW ResHandle(*r, buffer, rawSize, this));
+		return shared_ptr<ResHandle>(CB_NEW ResHandle(r, rawBuffer, rawSize, this, !rawIsView));
 	}
-	else
-	{
-		// if the file requires more processing, get its loaded size, load it into a buffer
-		// of that size, and then load the resource appropriately
-		size = loader->GetLoadedResourceSize(rawBuffer, rawSize);
-		// allocate a new buffer for the loaded resource
-		buffer = Allocate(size);
-		if (buffer == nullptr)
-		{
-			CB_LOG("Resource Cache", "Out of Memory");
-			return nullptr;
-		}
-		handle = shared_ptr<ResHandle>(CB_NEW ResHandle(*r, buffer, size, this));
-		bool success = loader->LoadResource(rawBuffer, rawSize, handle);
 
-		// delete the temporary raw buffer after the loaded resource is created
-		if (loader->DiscardRawBufferAfterLoad())
+	// if the file requires more processing, get its loaded size, load it into a buffer
+	// of that size, and then load the resource appropriately
+	unsigned int size = loader->GetLoadedResourceSize(rawBuffer, rawSize);
+	// allocate a new buffer for the loaded resource
+	char* buffer = Allocate(size, makeRoom);
+	if (buffer == nullptr)
+	{
+		CB_LOG("Resource Cache", "Out of Memory");
+		if (!rawIsView)
 		{
 			CB_SAFE_DELETE_ARRAY(rawBuffer);
 		}
+		return nullptr;
+	}
+	shared_ptr<ResHandle> handle(CB_NEW ResHandle(r, buffer, size, this));
+	bool success = loader->LoadResource(rawBuffer, rawSize, handle);
+
+	// delete the temporary raw buffer after the loaded resource is created
+	if (loader->DiscardRawBufferAfterLoad() && !rawIsView)
+	{
+		CB_SAFE_DELETE_ARRAY(rawBuffer);
+	}
+
+	if (!success)
+	{
+		CB_LOG("Resource Cache", "Coule not load resource");
+		return nullptr;
+	}
+
+	// count what the loader created outside the buffer, ex. a texture on the GPU
+	shared_ptr<IResourceExtraData> pExtra = handle->GetExtra();
+	if (pExtra)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+		handle->m_ExtraSize = pExtra->GetMemorySize();
+		m_Allocated += handle->m_ExtraSize;
+	}
+
+	return handle;
+}
+
+shared_ptr<ResHandle> ResCache::Insert(shared_ptr<ResHandle> handle)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	ResHandleMap::iterator findIt = m_Resources.find(handle->m_Resouce.m_Name);
+	if (findIt != m_Resources.end())
+	{
+		m_Groups[findIt->second->m_CacheGroup].m_pPolicy->OnAccess(findIt->first);
+		return findIt->second;
+	}
+
+	unsigned long long size = (unsigned long long)handle->m_Size + handle->m_ExtraSize;
+	m_Stats.m_MissedBytes += size;
+	if (m_RecordAccessTrace)
+	{
+		m_AccessTrace.push_back(ResCacheAccess(handle->m_Resouce.m_Name, size));
+	}
 
-		if (!success)
+	handle->m_CacheGroup = FindGroup(handle->m_Resouce.m_Name);
+	ResCacheGroup& group = m_Groups[handle->m_CacheGroup];
+	group.m_Resident += size;
+	group.m_pPolicy->OnInsert(handle->m_Resouce.m_Name);
+	m_Resources[handle->m_Resouce.m_Name] = handle;
+
+	TrimGroup(handle->m_CacheGroup);
+	return handle;
+}
+
+void ResCache::CompleteRequest(shared_ptr<ResRequest> pRequest, const Resource& r, shared_ptr<IResourceLoader> loader, char* rawBuffer, unsigned int rawSize, bool rawIsView)
+{
+	// the loaders that are not thread safe get the raw buffer here, on the main thread
+	if (rawBuffer)
+	{
+		pRequest->m_Handle = CreateHandle(r, loader, rawBuffer, rawSize, rawIsView, false);
+	}
+
+	std::vector<ResLoadCallback> callbacks;
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+		if (pRequest->m_Handle)
 		{
-			CB_LOG("Resource Cache", "Coule not load resource");
-			return nullptr;
+			pRequest->m_Handle = Insert(pRequest->m_Handle);
 		}
+		m_PendingLoads.erase(pRequest->m_Name);
+
+		// the workers only add to the allocated memory, this is where it gets back under the cache size
+		TrimToSize();
+
+		callbacks.swap(pRequest->m_Callbacks);
+		pRequest->m_Ready = true;
 	}
 
-	if (handle)
+	if (!pRequest->m_Handle)
 	{
-		// if a handle was successfully created, add it to the list and map
-		m_LRU.push_front(handle);
-		m_Resources[r->m_Name] = handle;
+		CB_LOG("Resource Cache", "Could not load resource in the background: " + pRequest->m_Name);
 	}
 
-	return handle;
+	for (auto it = callbacks.begin(); it != callbacks.end(); ++it)
+	{
+		(*it)(pRequest->m_Handle);
+	}
 }
 
 void ResCache::Free(shared_ptr<ResHandle> handle)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
 	// removes the item from the cache, but the item might still be in memory
 	// if a shared_ptr still exists somewhere
-	m_LRU.remove(handle);
-	m_Resources.erase(handle->m_Resouce.m_Name);
+	ResHandleMap::iterator it = m_Resources.find(handle->m_Resouce.m_Name);
+	if (it == m_Resources.end() || it->second != handle)
+		return;
+
+	Remove(it);
+}
+
+void ResCache::Remove(ResHandleMap::iterator it)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	// hold on to the handle until the bookkeeping is done, erasing it may be the last reference
+	shared_ptr<ResHandle> handle = it->second;
+	ResCacheGroup& group = m_Groups[handle->m_CacheGroup];
+	group.m_Resident -= (unsigned long long)handle->m_Size + handle->m_ExtraSize;
+	group.m_pPolicy->OnRemove(handle->m_Resouce.m_Name);
+	m_Resources.erase(it);
+}
+
+unsigned int ResCache::FindGroup(const std::string& name) const
+{
+	// the groups added last are the most specific
+	for (size_t i = m_Groups.size() - 1; i > 0; --i)
+	{
+		if (WildcardMatch(m_Groups[i].m_Pattern.c_str(), name.c_str()))
+			return (unsigned int)i;
+	}
+
+	return 0;
+}
+
+void ResCache::TrimGroup(unsigned int groupIndex)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	ResCacheGroup& group = m_Groups[groupIndex];
+	if (group.m_Pinned || group.m_Budget == 0)
+		return;
+
+	while (group.m_Resident > group.m_Budget)
+	{
+		std::string victim = group.m_pPolicy->GetVictim();
+		ResHandleMap::iterator it = m_Resources.find(victim);
+		if (it == m_Resources.end())
+			break;
+
+		Remove(it);
+		++m_Stats.m_NumEvictions;
+	}
 }
 
-bool ResCache::MakeRoom(unsigned int size)
+bool ResCache::MakeRoom(unsigned long long size)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
 	// if trying to make more room than the total cache, return false
 	if (size > m_CacheSize)
 	{
@@ -270,49 +733,132 @@ bool ResCache::MakeRoom(unsigned int size)
 	}
 
 	// while the size needed is still larger than the free space, keep removing resources
-	while (size > (m_CacheSize - m_Allocated))
+	while (m_Allocated > m_CacheSize || size > (m_CacheSize - m_Allocated))
 	{
-		// if the cache is empty and theres still not enough room, return false
-		if (m_LRU.empty())
+		// if nothing else can be evicted and theres still not enough room, return false
+		if (!FreeOneResource())
 		{
 			return false;
 		}
+	}
 
-		FreeOneResource();
+	return true;
+}
+
+bool ResCache::Reserve(unsigned int size, bool makeRoom)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	/// if the cache cannot create enough room, fail
+	if (makeRoom ? !MakeRoom(size) : size > m_CacheSize)
+	{
+		return false;
 	}
 
+	m_Allocated += size;
 	return true;
 }
 
-char* ResCache::Allocate(unsigned int size)
+char* ResCache::Allocate(unsigned int size, bool makeRoom)
 {
-	/// if the cache cannot create enough room, return null
-	if (!MakeRoom(size))
+	if (!Reserve(size, makeRoom))
 	{
 		return nullptr;
 	}
 	
 	// allocate the memory and return a pointer to it
-	char* memory = CB_NEW char[size];
-	if (memory)
+	return CB_NEW char[size];
+}
+
+void ResCache::TrimToSize()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	while (m_Allocated > m_CacheSize && FreeOneResource())
 	{
-		m_Allocated += size;
 	}
-	
-	return memory;
 }
 
-void ResCache::FreeOneResource()
+bool ResCache::FreeOneResource()
 {
-	// remove the resource at the back of the LRU list -- the object may still
-	// exist in memory if a shared_ptr is held onto it outside of the cache
-	shared_ptr<ResHandle> handleToBeRemoved = m_LRU.back();
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
 
-	m_LRU.pop_back();
-	m_Resources.erase(handleToBeRemoved->m_Resouce.m_Name);
+	// pick the group to give up a resource, the lowest priority first and the one holding the most memory on a tie
+	ResHandleMap::iterator victimIt = m_Resources.end();
+	const ResCacheGroup* pVictimGroup = nullptr;
+	for (auto groupIt = m_Groups.begin(); groupIt != m_Groups.end(); ++groupIt)
+	{
+		if (groupIt->m_Pinned || groupIt->m_Resident == 0)
+			continue;
+
+		if (pVictimGroup && (groupIt->m_Priority > pVictimGroup->m_Priority ||
+			(groupIt->m_Priority == pVictimGroup->m_Priority && groupIt->m_Resident <= pVictimGroup->m_Resident)))
+			continue;
+
+		ResHandleMap::iterator it = m_Resources.find(groupIt->m_pPolicy->GetVictim());
+		if (it != m_Resources.end())
+		{
+			victimIt = it;
+			pVictimGroup = &(*groupIt);
+		}
+	}
+
+	if (victimIt == m_Resources.end())
+		return false;
+
+	// the object may still exist in memory if a shared_ptr is held onto it outside of the cache
+	Remove(victimIt);
+	++m_Stats.m_NumEvictions;
+	return true;
 }
 
-void ResCache::MemoryHasBeenFreed(unsigned int size)
+void ResCache::MemoryHasBeenFreed(unsigned long long size)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
 	m_Allocated -= size;
 }
+
+ResCacheStats ResCache::GetStats()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+void ResCache::ResetStats()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+	m_Stats = ResCacheStats();
+}
+
+void ResCache::DumpStats()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	CB_LOG("Resource Cache", ToStr(m_Stats.m_NumHits) + " hits " + ToStr(m_Stats.m_NumMisses) + " misses (" + ToStr(m_Stats.GetHitRate() * 100.0f) + "%) " +
+		ToStr(m_Stats.m_NumEvictions) + " evictions " + ToStr(BytesToMegabytes(m_Stats.m_MissedBytes)) + "MB loaded, " +
+		ToStr(BytesToMegabytes(m_Allocated)) + "MB of " + ToStr(BytesToMegabytes(m_CacheSize)) + "MB allocated");
+
+	for (auto it = m_Groups.begin(); it != m_Groups.end(); ++it)
+	{
+		CB_LOG("Resource Cache", "  " + it->m_Pattern + " " + it->m_pPolicy->GetName() + (it->m_Pinned ? " pinned " : " ") +
+			ToStr(BytesToMegabytes(it->m_Resident)) + "MB" + ((it->m_Budget > 0) ? " of " + ToStr(BytesToMegabytes(it->m_Budget)) + "MB" : std::string()));
+	}
+}
+
+void ResCache::RecordAccessTrace(bool record)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+	m_RecordAccessTrace = record;
+	if (record)
+	{
+		m_AccessTrace.clear();
+	}
+}
+
+std::vector<ResCacheAccess> ResCache::GetAccessTrace()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+	return m_AccessTrace;
+}
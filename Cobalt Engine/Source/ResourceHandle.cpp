@@ -10,19 +10,25 @@
 #include "EngineStd.h"
 #include "ResourceCache.h"
 
-ResHandle::ResHandle(const Resource& resource, char* buffer, unsigned int size, ResCache* pCache) :
+ResHandle::ResHandle(const Resource& resource, char* buffer, unsigned int size, ResCache* pCache, bool ownsBuffer) :
 m_Resouce(resource),
 m_Buffer(buffer),
 m_Size(size),
+m_OwnsBuffer(ownsBuffer),
 m_Extra(nullptr),
+m_ExtraSize(0),
+m_CacheGroup(0),
 m_pResCache(pCache)
 {}
 
 ResHandle::~ResHandle()
 {
-	CB_SAFE_DELETE(m_Buffer);
+	if (m_OwnsBuffer)
+	{
+		CB_SAFE_DELETE_ARRAY(m_Buffer);
+	}
 	// tell the resource cache how much memory has been freed
-	m_pResCache->MemoryHasBeenFreed(m_Size);
+	m_pResCache->MemoryHasBeenFreed((unsigned long long)m_Size + m_ExtraSize);
 }
 
 const std::string& ResHandle::GetName() const
@@ -42,7 +48,7 @@ const char* ResHandle::Buffer() const
 
 char* ResHandle::WritableBuffer()
 {
-	return m_Buffer;
+	return m_OwnsBuffer ? m_Buffer : nullptr;
 }
 
 shared_ptr<IResourceExtraData> ResHandle::GetExtra()
@@ -54,3 +60,8 @@ void ResHandle::SetExtra(shared_ptr<IResourceExtraData> extra)
 {
 	m_Extra = extra;
 }
+
+unsigned int ResHandle::GetExtraSize() const
+{
+	return m_ExtraSize;
+}
@@ -11,9 +11,11 @@
 #include "Resource.h"
 #include "StringUtil.h"
 
-ResourceZipFile::ResourceZipFile(const std::wstring& resFileName) :
+ResourceZipFile::ResourceZipFile(const std::wstring& resFileName, bool memoryMap) :
 m_pZipFile(nullptr),
-m_resFileName(resFileName)
+m_resFileName(resFileName),
+m_MemoryMap(memoryMap),
+m_pJobSystem(nullptr)
 {}
 
 ResourceZipFile::~ResourceZipFile()
@@ -26,7 +28,8 @@ bool ResourceZipFile::Open()
 	m_pZipFile = CB_NEW ZipFile;
 	if (m_pZipFile)
 	{
-		return m_pZipFile->Init(m_resFileName.c_str());
+		m_pZipFile->SetJobSystem(m_pJobSystem);
+		return m_pZipFile->Init(m_resFileName.c_str(), m_MemoryMap);
 	}
 	return false;
 }
@@ -47,12 +50,50 @@ int ResourceZipFile::GetRawResource(const Resource& r, char* buffer)
 	if (resourceNum >= 0)
 	{
 		size = m_pZipFile->GetFileLength(resourceNum);
-		m_pZipFile->ReadFile(resourceNum, buffer);
+		if (!m_pZipFile->ReadFile(resourceNum, buffer))
+			return 0;
 	}
 
 	return size;
 }
 
+const char* ResourceZipFile::GetRawResourceView(const Resource& r)
+{
+	if (m_pZipFile == nullptr)
+		return nullptr;
+
+	int resourceNum = m_pZipFile->Find(r.m_Name);
+	return (resourceNum >= 0) ? m_pZipFile->GetFileView(resourceNum) : nullptr;
+}
+
+bool ResourceZipFile::StreamRawResource(const Resource& r, unsigned int stagingSize, const std::function<bool(const char*, unsigned int)>& callback)
+{
+	if (m_pZipFile == nullptr)
+		return false;
+
+	int resourceNum = m_pZipFile->Find(r.m_Name);
+	return (resourceNum >= 0) ? m_pZipFile->ReadFileStreamed(resourceNum, stagingSize, callback) : false;
+}
+
+bool ResourceZipFile::IsThreadSafe() const
+{
+	return IsMemoryMapped();
+}
+
+bool ResourceZipFile::IsMemoryMapped() const
+{
+	return m_pZipFile != nullptr && m_pZipFile->IsMemoryMapped();
+}
+
+void ResourceZipFile::SetJobSystem(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	if (m_pZipFile != nullptr)
+	{
+		m_pZipFile->SetJobSystem(pJobSystem);
+	}
+}
+
 int ResourceZipFile::GetNumResources() const
 {
 	return (m_pZipFile == nullptr) ? 0 : m_pZipFile->GetNumFiles();
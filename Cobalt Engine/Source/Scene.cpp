@@ -18,11 +18,34 @@
 #include "Shaders.h"
 #include "StringUtil.h"
 
+// blend two transforms, slerping the rotation so the object does not shear or shrink part way
+static Mat4x4 InterpolateTransform(const Mat4x4& from, const Mat4x4& to, float alpha)
+{
+	D3DXVECTOR3 fromScale, toScale, fromPosition, toPosition;
+	D3DXQUATERNION fromRotation, toRotation;
+	if (FAILED(D3DXMatrixDecompose(&fromScale, &fromRotation, &fromPosition, &from)) ||
+		FAILED(D3DXMatrixDecompose(&toScale, &toRotation, &toPosition, &to)))
+	{
+		return to;
+	}
+
+	D3DXVECTOR3 scale, position;
+	D3DXQUATERNION rotation;
+	D3DXVec3Lerp(&scale, &fromScale, &toScale, alpha);
+	D3DXQuaternionSlerp(&rotation, &fromRotation, &toRotation, alpha);
+	D3DXVec3Lerp(&position, &fromPosition, &toPosition, alpha);
+
+	Mat4x4 result;
+	D3DXMatrixTransformation(&result, nullptr, nullptr, &scale, nullptr, &rotation, &position);
+	return result;
+}
+
 Scene::Scene(shared_ptr<IRenderer> renderer)
 {
 	m_Root.reset(CB_NEW RootNode());
 	m_Renderer = renderer;
 	m_LightManager = CB_NEW LightManager;
+	m_Interpolation = 1.0f;
 
 	D3DXCreateMatrixStack(0, &m_MatrixStack);
 
@@ -55,6 +78,8 @@ HRESULT Scene::OnRender()
 
 	if (m_Root && m_Camera)
 	{
+		InterpolateMotion();
+
 		m_Camera->SetViewTransform(this);
 
 		m_LightManager->CalcLighting(this);
@@ -97,6 +122,25 @@ HRESULT Scene::OnUpdate(float deltaTime)
 	if (!m_Root)
 		return S_OK;
 
+	// the tick is over, objects that did not move this tick come to rest where they are
+	for (auto it = m_Motion.begin(); it != m_Motion.end();)
+	{
+		SceneObjectMotion& motion = it->second;
+		if (motion.m_MovedThisTick)
+		{
+			motion.m_MovedThisTick = false;
+			++it;
+			continue;
+		}
+
+		shared_ptr<ISceneNode> pNode = FindObject(it->first);
+		if (pNode)
+		{
+			pNode->SetTransform(&motion.m_Current);
+		}
+		it = m_Motion.erase(it);
+	}
+
 	return m_Root->OnUpdate(this, deltaTime);
 }
 
@@ -140,6 +184,7 @@ bool Scene::RemoveChild(GameObjectId id)
 		m_LightManager->m_Lights.remove(pLight);
 	}
 	m_ObjectMap.erase(id);
+	m_Motion.erase(id);
 
 	return m_Root->RemoveChild(id);
 }
@@ -198,9 +243,46 @@ void Scene::MoveObjectDelegate(IEventPtr pEvent)
 	Mat4x4 transform = pCastEvent->GetMatrix();
 
 	shared_ptr<ISceneNode> pNode = FindObject(objectId);
-	if (pNode)
+	if (!pNode)
+		return;
+
+	// the first move in a tick starts from where the object was at the end of the last one
+	auto findIt = m_Motion.find(objectId);
+	if (findIt == m_Motion.end())
+	{
+		SceneObjectMotion motion;
+		motion.m_Current = pNode->Get()->ToWorld();
+		motion.m_MovedThisTick = false;
+		findIt = m_Motion.insert(std::make_pair(objectId, motion)).first;
+	}
+
+	SceneObjectMotion& motion = findIt->second;
+	if (!motion.m_MovedThisTick)
 	{
-		pNode->SetTransform(&transform);
+		motion.m_Previous = motion.m_Current;
+		motion.m_MovedThisTick = true;
+	}
+	motion.m_Current = transform;
+}
+
+void Scene::InterpolateMotion()
+{
+	for (auto it = m_Motion.begin(); it != m_Motion.end(); ++it)
+	{
+		shared_ptr<ISceneNode> pNode = FindObject(it->first);
+		if (!pNode)
+			continue;
+
+		const SceneObjectMotion& motion = it->second;
+		if (m_Interpolation >= 1.0f)
+		{
+			pNode->SetTransform(&motion.m_Current);
+		}
+		else
+		{
+			Mat4x4 transform = InterpolateTransform(motion.m_Previous, motion.m_Current, m_Interpolation);
+			pNode->SetTransform(&transform);
+		}
 	}
 }
 
@@ -140,7 +140,7 @@ HRESULT SceneNode::PreRender(Scene* pScene)
 	StrongGameObjectPtr pObject = MakeStrongPtr(g_pApp->GetGameLogic()->GetGameObject(m_Properties.m_ObjectId));
 	if (pObject)
 	{
-		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>(TransformComponent::g_Name));
+		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>());
 		if (pTransformComponent)
 		{
 			m_Properties.m_ToWorld = pTransformComponent->GetTransform();
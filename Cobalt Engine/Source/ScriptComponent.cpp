@@ -20,6 +20,8 @@
 static const char* LUA_METATABLE_NAME = "LuaScriptComponentMetaTable";
 const char* LuaScriptComponent::g_Name = "LuaScriptComponent";
 
+const ComponentId LuaScriptComponent::g_Id = Component::GetIdFromName(LuaScriptComponent::g_Name);
+
 LuaScriptComponent::LuaScriptComponent()
 {
 	m_ScriptObject.AssignNil(LuaStateManager::Get()->GetLuaState());
@@ -207,7 +209,7 @@ LuaPlus::LuaObject LuaScriptComponent::GetPos()
 	// return the objects position to lua
 	LuaPlus::LuaObject ret;
 
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 		LuaStateManager::Get()->ConvertVec3ToTable(pTransformComponent->GetPosition(), ret);
 	else
@@ -219,7 +221,7 @@ LuaPlus::LuaObject LuaScriptComponent::GetPos()
 void LuaScriptComponent::SetPos(LuaPlus::LuaObject newPos)
 {
 	// set the position of an object in lua
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		Vec3 pos;
@@ -237,7 +239,7 @@ LuaPlus::LuaObject LuaScriptComponent::GetLookAt() const
 	// return the look at vector of an object to lua
 	LuaPlus::LuaObject ret;
 
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 		LuaStateManager::Get()->ConvertVec3ToTable(pTransformComponent->GetLookAt(), ret);
 	else
@@ -249,7 +251,7 @@ LuaPlus::LuaObject LuaScriptComponent::GetLookAt() const
 float LuaScriptComponent::GetYOrientationRadians() const
 {
 	// return the look at vector of an object to lua
-	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>(TransformComponent::g_Name));
+	shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(m_pOwner->GetComponent<TransformComponent>());
 	if (pTransformComponent)
 	{
 		return (GetYRotationFromVector(pTransformComponent->GetLookAt()));
@@ -263,14 +265,14 @@ float LuaScriptComponent::GetYOrientationRadians() const
 
 void LuaScriptComponent::RotateY(float angleRadians)
 {
-	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>());
 	if (pPhysicalComponent)
 		pPhysicalComponent->RotateY(angleRadians);
 }
 
 void LuaScriptComponent::SetPosition(float x, float y, float z)
 {
-	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>());
 	if (pPhysicalComponent)
 		pPhysicalComponent->SetPosition(x, y, z);
 }
@@ -282,7 +284,7 @@ void LuaScriptComponent::LookAt(Vec3 target)
 
 void LuaScriptComponent::Stop()
 {
-	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+	shared_ptr<PhysicsComponent> pPhysicalComponent = MakeStrongPtr(m_pOwner->GetComponent<PhysicsComponent>());
 	if (pPhysicalComponent)
 		pPhysicalComponent->Stop();
 }
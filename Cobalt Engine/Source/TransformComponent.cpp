@@ -12,6 +12,8 @@
 
 const char* TransformComponent::g_Name = "TransformComponent";
 
+const ComponentId TransformComponent::g_Id = Component::GetIdFromName(TransformComponent::g_Name);
+
 bool TransformComponent::Init(TiXmlElement* pData)
 {
 	CB_ASSERT(pData);
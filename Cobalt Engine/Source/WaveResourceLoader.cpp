@@ -33,6 +33,11 @@ bool WaveResourceLoader::DiscardRawBufferAfterLoad()
 	return true;
 }
 
+bool WaveResourceLoader::IsThreadSafe()
+{
+	return true;
+}
+
 unsigned int WaveResourceLoader::GetLoadedResourceSize(char* rawBuffer, unsigned int rawSize)
 {
 	DWORD file = 0;
@@ -35,6 +35,20 @@ INT WINAPI WindowsAppMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 	// Initialize User Options
 	g_pApp->m_Options.Init("PlayerOptions.xml", cmdLine);
 
+	// a dedicated server skips DXUT entirely and runs its own loop
+	if (g_pApp->m_Options.m_Headless)
+	{
+		int exitCode = 1;
+		if (g_pApp->InitHeadless(hInstance))
+		{
+			exitCode = g_pApp->RunHeadless();
+		}
+
+		Logger::Destroy();
+
+		return exitCode;
+	}
+
 	// Setting up DirectX callbacks
 	DXUTSetCallbackMsgProc(WindowsApp::MsgProc);
 	DXUTSetCallbackFrameMove(WindowsApp::OnUpdate);
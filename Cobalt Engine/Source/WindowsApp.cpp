@@ -17,6 +17,7 @@
 #include "EventManager.h"
 #include "Events.h"
 #include "D3DRenderer.h"
+#include "HighResClock.h"
 #include "Logger.h"
 #include "LuaScriptExports.h"
 #include "LuaScriptProcess.h"
@@ -38,6 +39,10 @@ WindowsApp* g_pApp = nullptr;
 // pre-init lua script
 const char* SCRIPT_PREINIT_FILE = "Scripts\\PreInit.lua";
 
+// resource cache budgets, a headless server only caches xml and scripts
+const unsigned int WINDOWSAPP_RESCACHE_SIZE_MB = 50;
+const unsigned int WINDOWSAPP_HEADLESS_RESCACHE_SIZE_MB = 8;
+
 //====================================================
 //	WindowsApp
 //	Public method definitions
@@ -53,10 +58,13 @@ WindowsApp::WindowsApp()
 
 	m_IsRunning = false;
 	m_IsEditorRunning = false;
+	m_IsHeadless = false;
 	
 	m_HasModalDialog = 0;
 
 	m_pEventManager = nullptr;
+	m_pJobSystem = nullptr;
+	m_pEventJournal = nullptr;
 	m_ResCache = nullptr;
 
 	m_pNetworkEventForwarder = nullptr;
@@ -116,68 +124,8 @@ bool WindowsApp::InitInstance(HINSTANCE hInstance, LPWSTR lpCmdLine, HWND hWnd,
 
 	m_hInstance = hInstance;
 
-	// register events
-	RegisterEngineEvents();
-	RegisterGameEvents();
-
-	// initialize resource cache
-	IResourceFile* zipFile = (m_IsEditorRunning || m_Options.m_UseDevelopmentDirectories) ?
-		CB_NEW DevelopmentResourceZipFile(L"Assets.zip", DevelopmentResourceZipFile::Editor) :
-		CB_NEW ResourceZipFile(L"Assets.zip");
-
-	m_ResCache = CB_NEW ResCache(50, zipFile);
-	if (!m_ResCache->Init())
-	{
-		CB_ERROR("Failed to initialize resource cache. Check paths");
-		return false;
-	}
-	// register resource loaders
-	extern shared_ptr<IResourceLoader> CreateOggResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateWAVResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateDDSResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateJPGResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateXmlResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateSdkMeshResourceLoader();
-	extern shared_ptr<IResourceLoader> CreateLuaScriptResourceLoader();
-	m_ResCache->RegisterLoader(CreateOggResourceLoader());
-	m_ResCache->RegisterLoader(CreateWAVResourceLoader());
-	m_ResCache->RegisterLoader(CreateDDSResourceLoader());
-	m_ResCache->RegisterLoader(CreateJPGResourceLoader());
-	m_ResCache->RegisterLoader(CreateXmlResourceLoader());
-	m_ResCache->RegisterLoader(CreateSdkMeshResourceLoader());
-	m_ResCache->RegisterLoader(CreateLuaScriptResourceLoader());
-
-	if (!LoadStrings("English"))
-	{
-		CB_ERROR("Failed to load strings");
+	if (!InitEngineSystems(true))
 		return false;
-	}
-
-	// create the lua state manager and run the initial script
-	if (!LuaStateManager::Create())
-	{
-		CB_ERROR("Failed to initialize Lua");
-		return false;
-	}
-	// this is scoped so it will load into the cache then destroy the local resource
-	{
-		Resource res(SCRIPT_PREINIT_FILE);
-		shared_ptr<ResHandle> pResourceHandle = m_ResCache->GetHandle(&res);
-	}
-	// register functions exported to lua FROM C++
-	LuaScriptExports::Register();
-	LuaScriptProcess::RegisterScriptClass();
-	LuaScriptComponent::RegisterScriptFunctions();
-
-
-	// create event manager
-	m_pEventManager = CB_NEW EventManager("Event Manager", true);
-	if (!m_pEventManager)
-	{
-		CB_ERROR("Failed to create event manager");
-		return false;
-	}
-	
 
 	// DirectX initialization
 	DXUTInit(true, true, lpCmdLine, true);
@@ -202,6 +150,11 @@ bool WindowsApp::InitInstance(HINSTANCE hInstance, LPWSTR lpCmdLine, HWND hWnd,
 
 	m_ScreenSize = Point(screenWidth, screenHeight);
 
+	// sleep off the spare time in each frame unless the game is asked to run flat out
+	m_FramePacer.SetTargetFrameRate(m_Options.m_RunFullSpeed ? 0.0f : m_Options.m_FrameRate);
+	m_FramePacer.SetSpinTime(m_Options.m_FrameSpinTime);
+	m_FramePacer.SetStatsDumpInterval(m_Options.m_FrameStatsDumpInterval);
+
 	// create the d3d device
 	//DXUTCreateDevice(D3D_FEATURE_LEVEL_9_3, true, screenWidth, screenHeight);
 	DXUTCreateDevice(D3D_FEATURE_LEVEL_11_0, true, screenWidth, screenHeight);
@@ -222,8 +175,12 @@ bool WindowsApp::InitInstance(HINSTANCE hInstance, LPWSTR lpCmdLine, HWND hWnd,
 	m_pGame = CreateGameAndView();
 	if (!m_pGame)
 		return false;
+
+	// start recording or replaying events now that the logic's random generator exists
+	StartJournal();
 	
-	// preload resources
+	// preload resources, the time is logged so the first run after a reboot (cold) and later runs (warm) can be compared
+	unsigned long long preloadStartNS = HighResClock::GetNanoseconds();
 	m_ResCache->PreLoad("*.dds", nullptr);
 	m_ResCache->PreLoad("*.jpg", nullptr);
 	m_ResCache->PreLoad("*.wav", nullptr);
@@ -231,12 +188,109 @@ bool WindowsApp::InitInstance(HINSTANCE hInstance, LPWSTR lpCmdLine, HWND hWnd,
 	{
 		m_ResCache->PreLoad("*.sdkmesh", nullptr);
 	}
+	float preloadMS = (float)((double)(HighResClock::GetNanoseconds() - preloadStartNS) / NANOSECONDS_PER_MILLISECOND);
+	CB_LOG("Resource Cache", "Preloaded in " + ToStr(preloadMS) + "ms " + (m_ResCache->IsMemoryMapped() ? "with" : "without") + " a memory mapped Assets.zip");
 
 	m_IsRunning = true;
 
 	return true;
 }
 
+bool WindowsApp::InitHeadless(HINSTANCE hInstance)
+{
+	// a server runs from a console, attach to the one it was started from so ctrl+c shuts it down
+	if (!AttachConsole(ATTACH_PARENT_PROCESS))
+	{
+		AllocConsole();
+	}
+	SetConsoleCtrlHandler(WindowsApp::OnConsoleCtrl, TRUE);
+
+	if (m_Options.m_ListenPort < 0)
+	{
+		CB_ERROR("A headless server needs a listen port in the multiplayer options");
+		return false;
+	}
+	if (m_Options.m_Level.empty())
+	{
+		CB_ERROR("A headless server needs a level in the server options");
+		return false;
+	}
+
+	m_hInstance = hInstance;
+	m_IsHeadless = true;
+
+	// no window, device or sound, only the loaders the logic uses
+	if (!InitEngineSystems(false))
+		return false;
+
+	// the server can tick at its own rate, but always in fixed ticks since there are no frames to follow
+	float tickRate = (m_Options.m_ServerTickRate > 0.0f) ? m_Options.m_ServerTickRate : m_Options.m_TickRate;
+	m_Timestep.SetTickRate((tickRate > 0.0f) ? tickRate : FIXEDTIMESTEP_DEFAULT_TICK_RATE);
+
+	wcscpy_s(m_SaveGameDirectory, GetSaveGameDirectory(nullptr, GetGameAppDirectory()));
+
+	// create the game logic without any human views
+	m_pGame = CreateGameServer();
+	if (!m_pGame)
+	{
+		// the engine systems are up, release them the same way a shutdown does
+		OnClose();
+		return false;
+	}
+
+	StartJournal();
+
+	m_IsRunning = true;
+
+	return true;
+}
+
+int WindowsApp::RunHeadless()
+{
+	CB_LOG("Server", "Running headless at " + ToStr(1.0f / m_Timestep.GetTickDelta()) + " ticks per second on port " + ToStr(m_Options.m_ListenPort));
+
+	// the default 15.6 ms timer resolution would oversleep most ticks
+	timeBeginPeriod(1);
+
+	unsigned long long lastNS = HighResClock::GetNanoseconds();
+	while (!m_Quitting)
+	{
+		// read what the clients sent and send what is waiting, without blocking
+		if (m_pBaseSocketManager)
+		{
+			m_pBaseSocketManager->DoSelect(0);
+		}
+
+		unsigned long long currNS = HighResClock::GetNanoseconds();
+		float deltaTime = (float)(currNS - lastNS) / NANOSECONDS_PER_SECOND;
+		lastNS = currNS;
+
+		UpdateGame(deltaTime);
+
+		// sleep off the rest of the tick instead of spinning, the accumulator absorbs any oversleep
+		float timeToNextTick = (1.0f - m_Timestep.GetInterpolation()) * m_Timestep.GetTickDelta();
+		DWORD sleepMillis = (DWORD)(timeToNextTick * 1000.0f);
+		if (sleepMillis > 0)
+		{
+			Sleep(sleepMillis);
+		}
+	}
+
+	timeEndPeriod(1);
+
+	CB_LOG("Server", "Shutting down after " + ToStr((unsigned long)m_Timestep.GetNumTicks()) + " ticks, " + ToStr((unsigned long)m_Timestep.GetNumDroppedTicks()) + " dropped");
+
+	OnClose();
+
+	return 0;
+}
+
+BaseGameLogic* WindowsApp::CreateGameServer()
+{
+	CB_ERROR("This game can not run as a headless server");
+	return nullptr;
+}
+
 LRESULT CALLBACK WindowsApp::MsgProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, bool* pDoneProcessing, void* pUserContext)
 {
 	LRESULT result = 0;
@@ -370,12 +424,34 @@ LRESULT WindowsApp::OnClose()
 {
 	// release resources in reverse order
 
+	// finish the journal while the logic is still around for the final checksum
+	if (m_pEventJournal)
+	{
+		m_pEventJournal->Stop();
+	}
+
 	CB_SAFE_DELETE(m_pGame);
-	DestroyWindow(GetHwnd());
+	if (!m_IsHeadless)
+	{
+		DestroyWindow(GetHwnd());
+	}
 	DestroyNetworkEventForwarder();
 
 	CB_SAFE_DELETE(m_pBaseSocketManager);
 	CB_SAFE_DELETE(m_pEventManager);
+	if (m_ResCache)
+	{
+		// background loads finish before the workers go away
+		m_ResCache->SetJobSystem(nullptr);
+
+		m_ResCache->DumpStats();
+		if (!m_Options.m_ResCacheTrace.empty() && !SaveResCacheTrace(m_Options.m_ResCacheTrace, m_ResCache->GetAccessTrace()))
+		{
+			CB_ERROR("Could not write the resource cache trace " + m_Options.m_ResCacheTrace);
+		}
+	}
+	CB_SAFE_DELETE(m_pJobSystem);
+	CB_SAFE_DELETE(m_pEventJournal);
 
 	LuaScriptComponent::UnregisterScriptFunctions();
 	LuaScriptExports::Unregister();
@@ -408,6 +484,9 @@ void WindowsApp::AbortGame()
 
 int WindowsApp::GetExitCode()
 {
+	if (m_IsHeadless)
+		return 0;
+
 	return DXUTGetExitCode();
 }
 
@@ -585,6 +664,12 @@ int WindowsApp::Modal(shared_ptr<IScreenElement> pModalScreen, int defaultAnswer
 
 WindowsApp::Renderer WindowsApp::GetRendererImpl()
 {
+	// a headless server never creates a device
+	if (g_pApp && g_pApp->IsHeadless())
+	{
+		return Renderer::Renderer_Unknown;
+	}
+
 	DXUTDeviceVersion version = DXUTGetDeviceSettings().ver;
 	if (version == DXUT_D3D11_DEVICE)
 	{
@@ -601,6 +686,10 @@ WindowsApp::Renderer WindowsApp::GetRendererImpl()
 // CALLBACKS
 void CALLBACK WindowsApp::OnUpdate(double time, float deltaTime, void* pUserContext)
 {
+	// DXUT runs frames back to back, wait here until the next one is due so the update and
+	// render that follow start on time
+	g_pApp->m_FramePacer.WaitForNextFrame();
+
 	// dont update the scene if there is a modal up
 	if (g_pApp->HasModalDialog())
 	{
@@ -613,13 +702,11 @@ void CALLBACK WindowsApp::OnUpdate(double time, float deltaTime, void* pUserCont
 		PostMessage(g_pApp->GetHwnd(), WM_CLOSE, 0, 0);
 	}
 
-	// otherwise, process events and update the current game logic
+	// otherwise, process events and update the current game logic in fixed ticks, the views
+	// interpolate between the last two ticks when they render
 	if (g_pApp->m_pGame)
 	{
-		// allow 10 ms of events to process
-		IEventManager::Get()->Update(10);
-
-		g_pApp->m_pGame->OnUpdate((float)time, deltaTime);
+		g_pApp->UpdateGame(deltaTime);
 	}
 
 }
@@ -841,6 +928,7 @@ void WindowsApp::CreateNetworkEventForwarder()
 	// set up network event forwarding for certain events
 	IEventManager* pEventManger = IEventManager::Get();
 	pEventManger->AddListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObject::sk_EventType);
+	pEventManger->AddListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObjects::sk_EventType);
 	pEventManger->AddListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_EnvironmentLoaded::sk_EventType);
 	pEventManger->AddListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_PhysCollision::sk_EventType);
 }
@@ -851,6 +939,7 @@ void WindowsApp::DestroyNetworkEventForwarder()
 	{
 		IEventManager* pEventManger = IEventManager::Get();
 		pEventManger->RemoveListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObject::sk_EventType);
+		pEventManger->RemoveListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_RequestNewGameObjects::sk_EventType);
 		pEventManger->RemoveListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_EnvironmentLoaded::sk_EventType);
 		pEventManger->RemoveListener(fastdelegate::MakeDelegate(m_pNetworkEventForwarder, &NetworkEventForwarder::ForwardEvent), Event_PhysCollision::sk_EventType);
 		CB_SAFE_DELETE(m_pNetworkEventForwarder);
@@ -982,13 +1071,205 @@ void WindowsApp::RegisterEngineEvents()
 	REGISTER_EVENT(Event_DestroyGameObject);
 	REGISTER_EVENT(Event_MoveGameObject);
 	REGISTER_EVENT(Event_RequestNewGameObject);
+	REGISTER_EVENT(Event_RequestNewGameObjects);
+	REGISTER_EVENT(Event_RequestDestroyGameObject);
 
 	// render components
 	REGISTER_EVENT(Event_NewRenderComponent);
 	REGISTER_EVENT(Event_ModifiedRenderComponent);
 
+	// sound events
+	REGISTER_EVENT(Event_PlaySound);
+
 	// network events
 	REGISTER_EVENT(Event_NetworkPlayerObjectAssignment);
 	REGISTER_EVENT(Event_RemoteClient);
 	REGISTER_EVENT(Event_RemoteEnvironmentLoaded);
 }
+
+bool WindowsApp::InitEngineSystems(bool loadMedia)
+{
+	// register events
+	RegisterEngineEvents();
+	RegisterGameEvents();
+
+	// initialize resource cache
+	IResourceFile* zipFile = (m_IsEditorRunning || m_Options.m_UseDevelopmentDirectories) ?
+		CB_NEW DevelopmentResourceZipFile(L"Assets.zip", DevelopmentResourceZipFile::Editor) :
+		CB_NEW ResourceZipFile(L"Assets.zip", m_Options.m_MemoryMapResources);
+
+	m_ResCache = CB_NEW ResCache(loadMedia ? WINDOWSAPP_RESCACHE_SIZE_MB : WINDOWSAPP_HEADLESS_RESCACHE_SIZE_MB, zipFile);
+	if (!m_ResCache->Init())
+	{
+		CB_ERROR("Failed to initialize resource cache. Check paths");
+		return false;
+	}
+	// register resource loaders, textures, meshes and sounds are only needed with a renderer and audio
+	extern shared_ptr<IResourceLoader> CreateOggResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateWAVResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateDDSResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateJPGResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateXmlResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateSdkMeshResourceLoader();
+	extern shared_ptr<IResourceLoader> CreateLuaScriptResourceLoader();
+	if (loadMedia)
+	{
+		m_ResCache->RegisterLoader(CreateOggResourceLoader());
+		m_ResCache->RegisterLoader(CreateWAVResourceLoader());
+		m_ResCache->RegisterLoader(CreateDDSResourceLoader());
+		m_ResCache->RegisterLoader(CreateJPGResourceLoader());
+		m_ResCache->RegisterLoader(CreateSdkMeshResourceLoader());
+	}
+	m_ResCache->RegisterLoader(CreateXmlResourceLoader());
+	m_ResCache->RegisterLoader(CreateLuaScriptResourceLoader());
+	ConfigureResCache();
+
+	if (!LoadStrings("English"))
+	{
+		CB_ERROR("Failed to load strings");
+		return false;
+	}
+
+	// create the lua state manager and run the initial script
+	if (!LuaStateManager::Create())
+	{
+		CB_ERROR("Failed to initialize Lua");
+		return false;
+	}
+	// this is scoped so it will load into the cache then destroy the local resource
+	{
+		Resource res(SCRIPT_PREINIT_FILE);
+		shared_ptr<ResHandle> pResourceHandle = m_ResCache->GetHandle(&res);
+	}
+	// register functions exported to lua FROM C++
+	LuaScriptExports::Register();
+	LuaScriptProcess::RegisterScriptClass();
+	LuaScriptComponent::RegisterScriptFunctions();
+
+
+	// create event manager
+	m_pEventManager = CB_NEW EventManager("Event Manager", true);
+	if (!m_pEventManager)
+	{
+		CB_ERROR("Failed to create event manager");
+		return false;
+	}
+	// worker threads for listeners that are safe to run concurrently and for real time processes
+	m_pJobSystem = CB_NEW JobSystem(0, true);
+	m_pEventManager->SetJobSystem(m_pJobSystem);
+	m_ResCache->SetJobSystem(m_pJobSystem);
+
+	// objects can move many times before the queue is processed, only deliver the latest transform
+	m_pEventManager->SetCoalescePolicy(Event_MoveGameObject::sk_EventType, &Event_MoveGameObject::GetCoalesceKey);
+
+	// network traffic is handled before anything else, sounds can wait a frame if time runs out
+	m_pEventManager->SetEventLane(Event_NetworkPlayerObjectAssignment::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_RemoteClient::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_RemoteEnvironmentLoaded::sk_EventType, EventLane_Critical);
+	m_pEventManager->SetEventLane(Event_PlaySound::sk_EventType, EventLane_Cosmetic);
+
+	// the journal leaves out events the views regenerate and that can not be serialized
+	m_pEventJournal = CB_NEW EventJournal();
+	m_pEventJournal->IgnoreEventType(Event_UpdateTick::sk_EventType);
+	m_pEventJournal->IgnoreEventType(Event_NewRenderComponent::sk_EventType);
+	m_pEventManager->SetJournal(m_pEventJournal);
+
+	m_Timestep.SetTickRate(m_Options.m_TickRate);
+	m_Timestep.SetMaxTicksPerFrame(m_Options.m_MaxTicksPerFrame);
+
+	m_pEventManager->EnableStats(m_Options.m_EventStats);
+	m_pEventManager->SetStatsDumpInterval(m_Options.m_EventStatsDumpInterval);
+
+	return true;
+}
+
+void WindowsApp::ConfigureResCache()
+{
+	if (!m_Options.m_ResCachePolicy.empty())
+	{
+		IResCachePolicy* pPolicy = CreateResCachePolicy(m_Options.m_ResCachePolicy);
+		if (pPolicy)
+			m_ResCache->SetPolicy(shared_ptr<IResCachePolicy>(pPolicy));
+		else
+			CB_ERROR("Unknown resource cache policy " + m_Options.m_ResCachePolicy);
+	}
+
+	if (!m_Options.m_ResCacheTrace.empty())
+	{
+		m_ResCache->RecordAccessTrace(true);
+	}
+
+	TiXmlElement* pRoot = m_Options.m_pDoc ? m_Options.m_pDoc->RootElement() : nullptr;
+	TiXmlElement* pNode = pRoot ? pRoot->FirstChildElement("ResCache") : nullptr;
+	if (!pNode)
+		return;
+
+	// <Group pattern="audio\*" policy="LRU" budgetMb="16" priority="0"/> gives matching resources their own policy and budget
+	for (TiXmlElement* pGroup = pNode->FirstChildElement("Group"); pGroup; pGroup = pGroup->NextSiblingElement("Group"))
+	{
+		const char* pPattern = pGroup->Attribute("pattern");
+		const char* pPolicyName = pGroup->Attribute("policy");
+		IResCachePolicy* pPolicy = CreateResCachePolicy(pPolicyName ? pPolicyName : "LRU");
+		if (!pPattern || !pPolicy)
+		{
+			CB_ERROR("Bad resource cache group in the options");
+			CB_SAFE_DELETE(pPolicy);
+			continue;
+		}
+
+		double budgetMb = 0.0;
+		int priority = 0;
+		pGroup->Attribute("budgetMb", &budgetMb);
+		pGroup->Attribute("priority", &priority);
+		m_ResCache->AddGroup(pPattern, shared_ptr<IResCachePolicy>(pPolicy), (unsigned long long)(budgetMb * MEGABYTE), priority);
+	}
+
+	// <Pin pattern="gameobjects\*.xml"/> keeps matching resources until the cache is flushed
+	for (TiXmlElement* pPin = pNode->FirstChildElement("Pin"); pPin; pPin = pPin->NextSiblingElement("Pin"))
+	{
+		if (pPin->Attribute("pattern"))
+			m_ResCache->Pin(pPin->Attribute("pattern"));
+	}
+}
+
+void WindowsApp::UpdateGame(float deltaTime)
+{
+	m_Timestep.Step(deltaTime, [this](double tickTime, float tickDeltaTime)
+	{
+		// the journal records the tick, or swaps in the recorded times during a replay
+		float frameTime = (float)tickTime;
+		m_pEventJournal->BeginFrame(frameTime, tickDeltaTime);
+
+		// allow 10 ms of events to process
+		IEventManager::Get()->Update(10);
+
+		m_pGame->OnUpdate(frameTime, tickDeltaTime);
+
+		m_pEventJournal->EndFrame();
+	});
+
+	// run the work that other threads handed back to the main thread
+	m_pJobSystem->RunMainThreadJobs();
+}
+
+void WindowsApp::StartJournal()
+{
+	if (!m_Options.m_JournalReplayFile.empty())
+	{
+		m_pEventJournal->StartReplay(m_Options.m_JournalReplayFile, m_pGame);
+	}
+	else if (!m_Options.m_JournalRecordFile.empty())
+	{
+		m_pEventJournal->StartRecording(m_Options.m_JournalRecordFile, m_pGame);
+	}
+}
+
+BOOL WINAPI WindowsApp::OnConsoleCtrl(DWORD ctrlType)
+{
+	// ctrl+c, closing the console or logging off stops the server loop, which then shuts down normally
+	if (g_pApp)
+	{
+		g_pApp->AbortGame();
+	}
+	return TRUE;
+}
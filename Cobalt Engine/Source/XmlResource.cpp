@@ -9,9 +9,51 @@
 #include "ResourceHandle.h"
 #include "XmlResource.h"
 
+// estimate the heap memory of a node and everything under it, tiny xml keeps no count of its own
+static unsigned int GetXmlNodeMemorySize(const TiXmlNode* pNode)
+{
+	unsigned int size = (unsigned int)strlen(pNode->Value()) + 1;
+	switch (pNode->Type())
+	{
+	case TiXmlNode::TINYXML_ELEMENT:
+		size += sizeof(TiXmlElement);
+		for (const TiXmlAttribute* pAttribute = pNode->ToElement()->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next())
+		{
+			size += sizeof(TiXmlAttribute) + (unsigned int)strlen(pAttribute->Name()) + (unsigned int)strlen(pAttribute->Value()) + 2;
+		}
+		break;
+	case TiXmlNode::TINYXML_TEXT:
+		size += sizeof(TiXmlText);
+		break;
+	case TiXmlNode::TINYXML_COMMENT:
+		size += sizeof(TiXmlComment);
+		break;
+	case TiXmlNode::TINYXML_DECLARATION:
+		size += sizeof(TiXmlDeclaration);
+		break;
+	default:
+		size += sizeof(TiXmlUnknown);
+		break;
+	}
+
+	for (const TiXmlNode* pChild = pNode->FirstChild(); pChild; pChild = pChild->NextSibling())
+	{
+		size += GetXmlNodeMemorySize(pChild);
+	}
+
+	return size;
+}
+
 void XmlResourceExtraData::ParseXml(char* pRawBuffer)
 {
 	m_XmlDocument.Parse(pRawBuffer);
+
+	// the document itself is part of the extra data, only its children are on the heap
+	m_MemorySize = 0;
+	for (const TiXmlNode* pChild = m_XmlDocument.FirstChild(); pChild; pChild = pChild->NextSibling())
+	{
+		m_MemorySize += GetXmlNodeMemorySize(pChild);
+	}
 }
 
 
@@ -33,8 +75,11 @@ TiXmlElement* XmlResourceLoader::LoadAndReturnRootXmlElement(const char* resourc
 {
 	Resource resource(resourceString);
 	shared_ptr<ResHandle> pResHandle = g_pApp->m_ResCache->GetHandle(&resource);
+	if (!pResHandle)
+		return nullptr;
+
 	shared_ptr<XmlResourceExtraData> pExtraData = static_pointer_cast<XmlResourceExtraData>(pResHandle->GetExtra());
-	return pExtraData->GetRoot();
+	return pExtraData ? pExtraData->GetRoot() : nullptr;
 }
 
 
@@ -7,14 +7,26 @@
 */
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <vector>
 #include <zlib.h>
 
+#ifndef _WIN32
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
 #include "EngineStd.h"
+#include "JobSystem.h"
 #include "Logger.h"
+#include "StringUtil.h"
 #include "ZipFile.h"
 
-typedef unsigned long dword;
+// the headers' sizes are fixed by the zip format, unsigned long is 8 bytes on 64 bit Linux
+typedef unsigned int dword;
 typedef unsigned short word;
 typedef unsigned char byte;
 
@@ -93,45 +105,56 @@ ZipFile::ZipFile()
 {
 	m_nEntries = 0;
 	m_pFile = nullptr;
+	m_pMappedData = nullptr;
+	m_MappedSize = 0;
+	m_pJobSystem = nullptr;
 	m_pDirData = nullptr;
 }
 
 ZipFile::~ZipFile()
 {
 	End();
-	fclose(m_pFile);
 }
 
-bool ZipFile::Init(const std::wstring& resourceFileName)
+bool ZipFile::Init(const std::wstring& resourceFileName, bool memoryMap)
 {
 	End();
 
-	// get a pointer to the file
-	_wfopen_s(&m_pFile, resourceFileName.c_str(), L"rb");
-	if (!m_pFile)
-		return false;
+	// fall back to reading the file with stdio if it cannot be mapped
+	if (!memoryMap || !Map(resourceFileName))
+	{
+		_wfopen_s(&m_pFile, resourceFileName.c_str(), L"rb");
+		if (!m_pFile)
+			return false;
+	}
 
 	TZipDirHeader dh;
-
-	// seek backwards from the end of the file to get the dirHeader
-	fseek(m_pFile, -(int)sizeof(dh), SEEK_END);
-	long dhOffset = ftell(m_pFile); // store header's location in the file
 	ZeroMemory(&dh, sizeof(dh));
-	fread(&dh, sizeof(dh), 1, m_pFile);
 
-	// check to make sure it worked
-	if (dh.sig != TZipDirHeader::SIGNATURE)
+	// the dirHeader is at the very end of the file
+	unsigned long archiveSize = GetArchiveSize();
+	if (archiveSize < sizeof(dh))
+		return false;
+	unsigned long dhOffset = archiveSize - sizeof(dh); // store header's location in the file
+	if (!ReadAt(dhOffset, &dh, sizeof(dh)))
 		return false;
 
-	// go to the beginning of the directory
-	fseek(m_pFile, dhOffset - dh.dirSize, SEEK_SET);
+	// check to make sure it worked
+	if (dh.sig != TZipDirHeader::SIGNATURE || dh.dirSize > dhOffset)
+		return false;
 
 	// allocate enough space for the dir headers PLUS pointers to each dir header
 	m_pDirData = CB_NEW char[dh.dirSize + dh.nDirEntries * sizeof(*m_ppDir)];
 	if (!m_pDirData)
 		return false;
 	ZeroMemory(m_pDirData, dh.dirSize + dh.nDirEntries * sizeof(*m_ppDir));
-	fread(m_pDirData, dh.dirSize, 1, m_pFile);
+
+	// the directory is copied even from a mapping, its names are rewritten below
+	if (!ReadAt(dhOffset - dh.dirSize, m_pDirData, dh.dirSize))
+	{
+		CB_SAFE_DELETE_ARRAY(m_pDirData);
+		return false;
+	}
 
 	// now handle each directory entry
 	char* pfh = m_pDirData;
@@ -186,7 +209,7 @@ bool ZipFile::Init(const std::wstring& resourceFileName)
 	}
 	if (!success)
 	{
-		CB_SAFE_DELETE(m_pDirData);
+		CB_SAFE_DELETE_ARRAY(m_pDirData);
 	}
 	else
 	{
@@ -201,6 +224,7 @@ void ZipFile::End()
 	m_ZipContentsMap.clear();
 	CB_SAFE_DELETE_ARRAY(m_pDirData);
 	m_nEntries = 0;
+	Close();
 }
 
 int ZipFile::GetNumFiles() const
@@ -234,34 +258,47 @@ bool ZipFile::ReadFile(int index, void* pBuffer)
 	if (pBuffer == nullptr || index < 0 || index >= m_nEntries)
 		return false;
 
-	// seek to the actual files location on disk and read the local header
-	fseek(m_pFile, m_ppDir[index]->hdrOffset, SEEK_SET);
-
 	TZipLocalHeader h;
-	ZeroMemory(&h, sizeof(h));
-	fread(&h, sizeof(h), 1, m_pFile);
-	if (h.sig != TZipLocalHeader::SIGNATURE)
+	unsigned long dataOffset = 0;
+	if (!ReadLocalHeader(index, h, dataOffset))
 		return false;
 
-	// skip extra fields
-	fseek(m_pFile, h.fnameLen + h.xtraLen, SEEK_CUR);
-
 	// if the file is uncompressed, read it into the buffer and return
 	if (h.compression == Z_NO_COMPRESSION)
 	{
-		fread(pBuffer, h.cSize, 1, m_pFile);
-		return true;
+		return ReadAt(dataOffset, pBuffer, h.cSize);
 	}
 	else if (h.compression != Z_DEFLATED)
 		return false;
 
-	// allocate a compressed buffer, read the data, then uncompress
-	char* pcData = CB_NEW char[h.cSize];
-	if (!pcData)
-		return false;
-	
-	ZeroMemory(pcData, h.cSize);
-	fread(pcData, h.cSize, 1, m_pFile);
+	// inflate straight from the mapping, otherwise read the compressed data into a buffer first
+	char* pcData = nullptr;
+	const char* pSource = GetMappedData(dataOffset, h.cSize);
+	if (!pSource)
+	{
+		if (m_pMappedData)
+			return false;
+
+		pcData = CB_NEW char[h.cSize];
+		if (!pcData)
+			return false;
+
+		if (!ReadAt(dataOffset, pcData, h.cSize))
+		{
+			delete[] pcData;
+			return false;
+		}
+		pSource = pcData;
+	}
+	else if (m_pJobSystem)
+	{
+		// chunked files are only split up when mapped, every chunk can then read the mapping without a lock
+		unsigned long chunkSize = 0;
+		const char* pOffsets = nullptr;
+		unsigned int numChunks = GetChunkTable(index, chunkSize, pOffsets);
+		if (numChunks > 1)
+			return InflateChunks(pSource, h.cSize, (char*)pBuffer, h.ucSize, chunkSize, pOffsets, numChunks);
+	}
 
 	bool ret = true;
 
@@ -269,7 +306,7 @@ bool ZipFile::ReadFile(int index, void* pBuffer)
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef*)pcData;
+	stream.next_in = (Bytef*)pSource;
 	stream.avail_in = (uInt)h.cSize;
 	stream.next_out = (Bytef*)pBuffer;
 	stream.avail_out = h.ucSize;
@@ -283,7 +320,6 @@ bool ZipFile::ReadFile(int index, void* pBuffer)
 		inflateEnd(&stream);
 		if (err == Z_STREAM_END)
 			err = Z_OK;
-		inflateEnd(&stream);
 	}
 	if (err != Z_OK)
 		ret = false;
@@ -297,78 +333,114 @@ bool ZipFile::ReadLargeFile(int index, void *pBuffer, std::function<void(int, bo
 	if (pBuffer == nullptr || index < 0 || index >= m_nEntries)
 		return false;
 
-	// seek to the actual files location and read the local header
-	fseek(m_pFile, m_ppDir[index]->hdrOffset, SEEK_SET);
+	// copy each piece into place as it is inflated and report how far along the file is
+	char* pDest = (char*)pBuffer;
+	unsigned long long length = m_ppDir[index]->ucSize;
+	unsigned long long written = 0;
+	return ReadFileStreamed(index, ZIPFILE_STREAM_STAGING_SIZE, [&](const char* pData, unsigned int size) -> bool
+	{
+		if (size > length - written)
+			return false;
+
+		memcpy(pDest + written, pData, size);
+		written += size;
+
+		bool cancel = false;
+		if (progressCallback)
+		{
+			progressCallback((int)(written * 100 / length), cancel);
+		}
+		return !cancel;
+	});
+}
+
+bool ZipFile::ReadFileStreamed(int index, unsigned int stagingSize, const ZipStreamCallback& callback)
+{
+	if (!callback || stagingSize == 0 || index < 0 || index >= m_nEntries)
+		return false;
 
 	TZipLocalHeader h;
-	ZeroMemory(&h, sizeof(h));
-	fread(&h, sizeof(h), 1, m_pFile);
-	if (h.sig != TZipLocalHeader::SIGNATURE)
+	unsigned long dataOffset = 0;
+	if (!ReadLocalHeader(index, h, dataOffset))
 		return false;
 
-	// skip extra fields
-	fseek(m_pFile, h.fnameLen + h.xtraLen, SEEK_CUR);
+	if (h.compression != Z_NO_COMPRESSION && h.compression != Z_DEFLATED)
+		return false;
 
-	// if the file is uncompressed, read it into the buffer and return
-	if (h.compression == Z_NO_COMPRESSION)
+	// the mapping is read in place, otherwise the compressed data is read a piece at a time as well
+	const char* pMapped = GetMappedData(dataOffset, h.cSize);
+	if (m_pMappedData && !pMapped)
+		return false;
+
+	// stored pieces come straight from the mapping
+	if (h.compression == Z_NO_COMPRESSION && pMapped)
 	{
-		fread(pBuffer, h.cSize, 1, m_pFile);
+		for (unsigned long pos = 0; pos < h.cSize; pos += stagingSize)
+		{
+			unsigned long size = (h.cSize - pos < stagingSize) ? h.cSize - pos : stagingSize;
+			if (!callback(pMapped + pos, size))
+				return false;
+		}
 		return true;
 	}
-	else if (h.compression != Z_DEFLATED)
-		return false;
 
-	// allocate a compressed buffer, read the data, then uncompress
-	char* pcData = CB_NEW char[h.cSize];
-	if (!pcData)
+	char* pStaging = CB_NEW char[stagingSize];
+	if (!pStaging)
 		return false;
 
-	ZeroMemory(pcData, h.cSize);
-	fread(pcData, h.cSize, 1, m_pFile);
-
 	bool ret = true;
+	if (h.compression == Z_NO_COMPRESSION)
+	{
+		for (unsigned long pos = 0; pos < h.cSize && ret; pos += stagingSize)
+		{
+			unsigned long size = (h.cSize - pos < stagingSize) ? h.cSize - pos : stagingSize;
+			ret = ReadAt(dataOffset + pos, pStaging, size) && callback(pStaging, size);
+		}
 
-	// start decompressing the file
-	z_stream stream;
-	int err;
+		delete[] pStaging;
+		return ret;
+	}
 
-	stream.next_in = (Bytef*)pcData;
-	stream.avail_in = (uInt)h.cSize;
-	stream.next_out = (Bytef*)pBuffer;
-	stream.avail_out = (128 * 1024); // read 128k at a time
-	stream.zalloc = (alloc_func)0;
-	stream.zfree = (free_func)0;
+	char* pInput = pMapped ? nullptr : CB_NEW char[stagingSize];
+	unsigned long inputPos = 0;
 
-	err = inflateInit2(&stream, -MAX_WBITS);
-	if (err == Z_OK)
+	z_stream stream;
+	ZeroMemory(&stream, sizeof(stream));
+	stream.next_in = (Bytef*)pMapped;
+	stream.avail_in = pMapped ? (uInt)h.cSize : 0;
+
+	int err = inflateInit2(&stream, -MAX_WBITS);
+	while (err == Z_OK)
 	{
-		uInt count = 0;
-		bool cancel = false;
-		while (stream.total_in < (uInt)h.cSize && !cancel)
+		// refill the input from the file when it runs dry
+		if (stream.avail_in == 0 && pInput && inputPos < h.cSize)
 		{
-			err = inflate(&stream, Z_SYNC_FLUSH);
-			if (err == Z_STREAM_END)
-			{
-				err = Z_OK;
+			unsigned long size = (h.cSize - inputPos < stagingSize) ? h.cSize - inputPos : stagingSize;
+			if (!ReadAt(dataOffset + inputPos, pInput, size))
 				break;
-			}
-			else if (err != Z_OK)
-			{
-				CB_ASSERT(0 && "Something bad happened.");
-				break;
-			}
 
-			stream.avail_out = (128 * 1024);
-			stream.next_out += stream.total_out;
-
-			progressCallback(count * 100 / h.cSize, cancel);
+			stream.next_in = (Bytef*)pInput;
+			stream.avail_in = size;
+			inputPos += size;
 		}
-		inflateEnd(&stream);
+
+		// inflate until the staging buffer is full or the input runs out, then hand over what there is
+		stream.next_out = (Bytef*)pStaging;
+		stream.avail_out = stagingSize;
+		err = inflate(&stream, Z_NO_FLUSH);
+
+		unsigned int produced = stagingSize - stream.avail_out;
+		if ((err == Z_OK || err == Z_STREAM_END) && produced > 0 && !callback(pStaging, produced))
+			break;
 	}
-	if (err != Z_OK)
+	inflateEnd(&stream);
+
+	// stopping early, or input that ran out before the end of the stream, is a failure
+	if (err != Z_STREAM_END)
 		ret = false;
 
-	delete[] pcData;
+	delete[] pInput;
+	delete[] pStaging;
 	return ret;
 }
 
@@ -382,3 +454,262 @@ int ZipFile::Find(const std::string& path) const
 		return -1;
 	return it->second;
 }
+
+bool ZipFile::IsMemoryMapped() const
+{
+	return m_pMappedData != nullptr;
+}
+
+void ZipFile::SetJobSystem(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+}
+
+const char* ZipFile::GetFileView(int index) const
+{
+	if (!m_pMappedData || index < 0 || index >= m_nEntries)
+		return nullptr;
+
+	// the local header's name and extra field can differ in length from the directory's
+	const TZipDirFileHeader& fh = *m_ppDir[index];
+	const char* pHeader = GetMappedData(fh.hdrOffset, sizeof(TZipLocalHeader));
+	if (!pHeader)
+		return nullptr;
+
+	TZipLocalHeader h;
+	memcpy(&h, pHeader, sizeof(h));
+	if (!CheckLocalHeader(index, h) || h.compression != Z_NO_COMPRESSION)
+		return nullptr;
+
+	return GetMappedData(fh.hdrOffset + sizeof(h) + h.fnameLen + h.xtraLen, h.cSize);
+}
+
+bool ZipFile::Map(const std::wstring& resourceFileName)
+{
+#ifdef _WIN32
+	HANDLE hFile = CreateFileW(resourceFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || fileSize.HighPart != 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	// the view keeps the mapping and the file open, so both handles can be closed right away
+	HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(hFile);
+	if (!hMapping)
+		return false;
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (!pView)
+		return false;
+
+	m_pMappedData = (const char*)pView;
+	m_MappedSize = fileSize.LowPart;
+#else
+	int fd = open(ws2s(resourceFileName).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	// the mapping keeps the file open, so the descriptor can be closed right away
+	void* pView = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pView == MAP_FAILED)
+		return false;
+
+	m_pMappedData = (const char*)pView;
+	m_MappedSize = (unsigned long)fileInfo.st_size;
+#endif
+
+	return true;
+}
+
+void ZipFile::Close()
+{
+	if (m_pMappedData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pMappedData);
+#else
+		munmap((void*)m_pMappedData, m_MappedSize);
+#endif
+		m_pMappedData = nullptr;
+		m_MappedSize = 0;
+	}
+
+	if (m_pFile)
+	{
+		fclose(m_pFile);
+		m_pFile = nullptr;
+	}
+}
+
+unsigned long ZipFile::GetArchiveSize()
+{
+	if (m_pMappedData)
+		return m_MappedSize;
+
+	if (!m_pFile || fseek(m_pFile, 0, SEEK_END) != 0)
+		return 0;
+
+	long size = ftell(m_pFile);
+	return (size > 0) ? (unsigned long)size : 0;
+}
+
+const char* ZipFile::GetMappedData(unsigned long offset, unsigned long size) const
+{
+	if (!m_pMappedData || offset > m_MappedSize || size > m_MappedSize - offset)
+		return nullptr;
+
+	return m_pMappedData + offset;
+}
+
+bool ZipFile::ReadAt(unsigned long offset, void* pBuffer, unsigned long size)
+{
+	if (m_pMappedData)
+	{
+		const char* pData = GetMappedData(offset, size);
+		if (!pData)
+			return false;
+
+		memcpy(pBuffer, pData, size);
+		return true;
+	}
+
+	if (!m_pFile || fseek(m_pFile, (long)offset, SEEK_SET) != 0)
+		return false;
+
+	return size == 0 || fread(pBuffer, size, 1, m_pFile) == 1;
+}
+
+bool ZipFile::ReadLocalHeader(int index, TZipLocalHeader& h, unsigned long& dataOffset)
+{
+	ZeroMemory(&h, sizeof(h));
+	if (!ReadAt(m_ppDir[index]->hdrOffset, &h, sizeof(h)) || !CheckLocalHeader(index, h))
+		return false;
+
+	// skip extra fields
+	dataOffset = m_ppDir[index]->hdrOffset + sizeof(h) + h.fnameLen + h.xtraLen;
+	return true;
+}
+
+bool ZipFile::CheckLocalHeader(int index, TZipLocalHeader& h) const
+{
+	const TZipDirFileHeader& fh = *m_ppDir[index];
+	if (h.sig != TZipLocalHeader::SIGNATURE || h.compression != fh.compression)
+		return false;
+
+	// a file written with a data descriptor has its sizes after the data, the directory has them as well
+	if (h.cSize == 0 && h.ucSize == 0)
+	{
+		h.cSize = fh.cSize;
+		h.ucSize = fh.ucSize;
+	}
+	else if (h.cSize != fh.cSize || h.ucSize != fh.ucSize)
+	{
+		CB_ERROR("Zip file entry " + ToStr(index) + " has different sizes in its local header and the directory");
+		return false;
+	}
+
+	// callers size their buffers from the directory, a stored file must fill exactly that
+	if (h.compression == Z_NO_COMPRESSION && h.cSize != h.ucSize)
+		return false;
+
+	return true;
+}
+
+unsigned int ZipFile::GetChunkTable(int index, unsigned long& chunkSize, const char*& pOffsets) const
+{
+	const TZipDirFileHeader& fh = *m_ppDir[index];
+	const char* pExtra = fh.GetExtra();
+	const char* pExtraEnd = pExtra + fh.xtraLen;
+
+	// the extra field is a list of records, each an id and a size followed by that many bytes
+	while (pExtra + 2 * sizeof(word) <= pExtraEnd)
+	{
+		word id, size;
+		memcpy(&id, pExtra, sizeof(id));
+		memcpy(&size, pExtra + sizeof(id), sizeof(size));
+		pExtra += 2 * sizeof(word);
+		if (pExtra + size > pExtraEnd)
+			return 0;
+
+		if (id == ZIPFILE_CHUNK_TABLE_ID && size >= sizeof(dword))
+		{
+			dword tableChunkSize;
+			memcpy(&tableChunkSize, pExtra, sizeof(tableChunkSize));
+			if (tableChunkSize == 0)
+				return 0;
+
+			// there is an offset for every chunk but the first
+			unsigned int numChunks = (unsigned int)((fh.ucSize + tableChunkSize - 1) / tableChunkSize);
+			if (numChunks == 0 || size != sizeof(dword) * numChunks)
+				return 0;
+
+			chunkSize = tableChunkSize;
+			pOffsets = pExtra + sizeof(dword);
+			return numChunks;
+		}
+
+		pExtra += size;
+	}
+
+	return 0;
+}
+
+bool ZipFile::InflateChunks(const char* pSource, unsigned long cSize, char* pDest, unsigned long ucSize, unsigned long chunkSize, const char* pOffsets, unsigned int numChunks)
+{
+	// the offsets have to go forward and stay inside the compressed data, or the chunks would overlap
+	std::vector<unsigned long> chunkStarts(numChunks + 1, 0);
+	for (unsigned int i = 1; i < numChunks; ++i)
+	{
+		dword offset;
+		memcpy(&offset, pOffsets + (i - 1) * sizeof(dword), sizeof(offset));
+		if (offset <= chunkStarts[i - 1] || offset >= cSize)
+			return false;
+		chunkStarts[i] = offset;
+	}
+	chunkStarts[numChunks] = cSize;
+
+	// waiting on the main thread must not run main thread jobs in the middle of the read, ex. a load's completion that reads another resource
+	std::atomic<bool> failed(false);
+	m_pJobSystem->ParallelFor(numChunks, [&](unsigned int chunk)
+	{
+		unsigned long outStart = chunk * chunkSize;
+		unsigned long outSize = (ucSize - outStart < chunkSize) ? ucSize - outStart : chunkSize;
+
+		// each chunk starts on a fresh deflate block with no dictionary, so it inflates like its own stream
+		z_stream stream;
+		ZeroMemory(&stream, sizeof(stream));
+		stream.next_in = (Bytef*)(pSource + chunkStarts[chunk]);
+		stream.avail_in = (uInt)(chunkStarts[chunk + 1] - chunkStarts[chunk]);
+		stream.next_out = (Bytef*)(pDest + outStart);
+		stream.avail_out = (uInt)outSize;
+
+		int err = inflateInit2(&stream, -MAX_WBITS);
+		if (err == Z_OK)
+		{
+			err = inflate(&stream, Z_SYNC_FLUSH);
+			inflateEnd(&stream);
+		}
+
+		if ((err != Z_OK && err != Z_STREAM_END) || stream.total_out != outSize)
+		{
+			failed = true;
+		}
+	}, JobWait_SkipMainThread);
+
+	return !failed;
+}
@@ -0,0 +1,232 @@
+/*
+	FixedTimestepTest.cpp
+
+	Tests for FixedTimestep: how many ticks a frame runs for the time it
+	took, the limit on ticks per frame and the count of ticks dropped past
+	it, and the interpolation staying between 0 and 1. The tick rates use
+	tick lengths that are exact in binary so the counts do not depend on
+	rounding. The benchmark drives a small simulation headless to measure
+	how many ticks a second the driver can run.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "FixedTimestep.h"
+#include "TestUtil.h"
+
+// 1/64 of a second is exact in a float, so a tick's worth of frames adds up to exactly a tick
+const float TIMESTEPTEST_TICK_RATE = 64.0f;
+const float TIMESTEPTEST_TICK_DELTA = 1.0f / TIMESTEPTEST_TICK_RATE;
+
+// headless benchmark
+const unsigned int TIMESTEPTEST_BENCH_NUM_BODIES = 1000;
+const unsigned int TIMESTEPTEST_BENCH_NUM_TICKS = 20000;
+
+/// Records every tick it is called for
+struct TickRecorder
+{
+	std::vector<double> m_Times;
+	std::vector<float> m_Deltas;
+
+	TickFunction GetTick()
+	{
+		return [this](double time, float deltaTime)
+		{
+			m_Times.push_back(time);
+			m_Deltas.push_back(deltaTime);
+		};
+	}
+};
+
+static void TestTickCountForElapsedTime()
+{
+	FixedTimestep timestep(TIMESTEPTEST_TICK_RATE);
+	TickRecorder recorder;
+	TEST_CHECK(timestep.GetTickDelta() == TIMESTEPTEST_TICK_DELTA);
+
+	// a quarter tick per frame runs a tick on every fourth frame
+	unsigned int numTicks = 0;
+	for (unsigned int frame = 1; frame <= 256; ++frame)
+	{
+		unsigned int frameTicks = timestep.Step(TIMESTEPTEST_TICK_DELTA / 4.0f, recorder.GetTick());
+		TEST_CHECK(frameTicks == ((frame % 4 == 0) ? 1u : 0u));
+		numTicks += frameTicks;
+	}
+	TEST_CHECK(numTicks == 64);
+	TEST_CHECK(timestep.GetNumTicks() == 64);
+	TEST_CHECK(timestep.GetSimulationTime() == 1.0);
+
+	// a frame of three and a half ticks runs three and leaves half a tick waiting
+	TEST_CHECK(timestep.Step(3.5f * TIMESTEPTEST_TICK_DELTA, recorder.GetTick()) == 3);
+	TEST_CHECK(timestep.GetInterpolation() == 0.5f);
+
+	// the other half arrives with the next frame
+	TEST_CHECK(timestep.Step(0.5f * TIMESTEPTEST_TICK_DELTA, recorder.GetTick()) == 1);
+	TEST_CHECK(timestep.GetInterpolation() == 0.0f);
+
+	// every tick is a whole tick long and the time passed to it is the end of the tick
+	TEST_CHECK(recorder.m_Times.size() == 68);
+	for (size_t i = 0; i < recorder.m_Times.size(); ++i)
+	{
+		TEST_CHECK(recorder.m_Deltas[i] == TIMESTEPTEST_TICK_DELTA);
+		TEST_CHECK(recorder.m_Times[i] == (double)(i + 1) * TIMESTEPTEST_TICK_DELTA);
+	}
+	TEST_CHECK(timestep.GetNumDroppedTicks() == 0);
+
+	// a frame that went backwards runs nothing
+	TEST_CHECK(timestep.Step(-1.0f, recorder.GetTick()) == 0);
+	TEST_CHECK(timestep.GetNumTicks() == 68);
+}
+
+static void TestMaxTicksDropsTheBacklog()
+{
+	FixedTimestep timestep(TIMESTEPTEST_TICK_RATE, 5);
+	TickRecorder recorder;
+
+	// half a second is 32 ticks, only 5 run and the other 27 are dropped
+	TEST_CHECK(timestep.Step(0.5f, recorder.GetTick()) == 5);
+	TEST_CHECK(timestep.GetNumTicks() == 5);
+	TEST_CHECK(timestep.GetNumDroppedTicks() == 27);
+	TEST_CHECK(timestep.GetInterpolation() == 0.0f);
+
+	// the simulation falls behind real time instead of catching up on the next frame
+	TEST_CHECK(timestep.Step(0.0f, recorder.GetTick()) == 0);
+	TEST_CHECK(timestep.GetSimulationTime() == 5.0 * TIMESTEPTEST_TICK_DELTA);
+
+	// the part of a tick left over after the dropped ticks is kept
+	TEST_CHECK(timestep.Step(0.5f + 0.5f * TIMESTEPTEST_TICK_DELTA, recorder.GetTick()) == 5);
+	TEST_CHECK(timestep.GetNumDroppedTicks() == 54);
+	TEST_CHECK(timestep.GetInterpolation() == 0.5f);
+
+	// a frame right at the limit drops nothing
+	timestep.Reset();
+	TEST_CHECK(timestep.Step(5.0f * TIMESTEPTEST_TICK_DELTA, recorder.GetTick()) == 5);
+	TEST_CHECK(timestep.GetNumDroppedTicks() == 54);
+
+	// a limit of 0 still makes progress
+	timestep.SetMaxTicksPerFrame(0);
+	TEST_CHECK(timestep.Step(2.0f * TIMESTEPTEST_TICK_DELTA, recorder.GetTick()) == 1);
+	TEST_CHECK(timestep.GetNumDroppedTicks() == 55);
+	TEST_CHECK(recorder.m_Times.size() == 16);
+}
+
+static void TestInterpolationRange()
+{
+	FixedTimestep timestep(60.0f, 3);
+	TickRecorder recorder;
+
+	// frames of every length from a sliver of a tick to well past the limit
+	unsigned int seed = 12345;
+	for (unsigned int frame = 0; frame < 10000; ++frame)
+	{
+		seed = seed * 1664525 + 1013904223;
+		float deltaTime = (float)(seed >> 8) / (float)(1 << 24) * 0.1f;
+		timestep.Step(deltaTime, recorder.GetTick());
+
+		float interpolation = timestep.GetInterpolation();
+		TEST_CHECK(interpolation >= 0.0f && interpolation < 1.0f);
+		if (!(interpolation >= 0.0f && interpolation < 1.0f))
+			break;
+	}
+
+	// throwing away the accumulator starts the next tick from nothing
+	timestep.Reset();
+	TEST_CHECK(timestep.GetInterpolation() == 0.0f);
+
+	// a variable step runs one tick the length of the frame and is always right up to date
+	timestep.SetTickRate(0.0f);
+	TEST_CHECK(timestep.GetTickDelta() == 0.0f);
+	TEST_CHECK(timestep.GetInterpolation() == 1.0f);
+	recorder.m_Deltas.clear();
+	TEST_CHECK(timestep.Step(0.25f, recorder.GetTick()) == 1);
+	TEST_CHECK(timestep.Step(0.0f, recorder.GetTick()) == 1);
+	TEST_CHECK(recorder.m_Deltas.size() == 2 && recorder.m_Deltas[0] == 0.25f && recorder.m_Deltas[1] == 0.0f);
+	TEST_CHECK(timestep.GetInterpolation() == 1.0f);
+}
+
+/// Simple stand in for a game's simulation, moves bodies under gravity and bounces them off the ground
+struct BenchSimulation
+{
+	std::vector<float> m_Heights;
+	std::vector<float> m_Speeds;
+
+	BenchSimulation() : m_Heights(TIMESTEPTEST_BENCH_NUM_BODIES), m_Speeds(TIMESTEPTEST_BENCH_NUM_BODIES, 0.0f)
+	{
+		for (unsigned int i = 0; i < TIMESTEPTEST_BENCH_NUM_BODIES; ++i)
+			m_Heights[i] = 1.0f + (float)(i % 100);
+	}
+
+	void Tick(float deltaTime)
+	{
+		for (unsigned int i = 0; i < TIMESTEPTEST_BENCH_NUM_BODIES; ++i)
+		{
+			m_Speeds[i] -= 9.8f * deltaTime;
+			m_Heights[i] += m_Speeds[i] * deltaTime;
+			if (m_Heights[i] < 0.0f)
+			{
+				m_Heights[i] = -m_Heights[i];
+				m_Speeds[i] = -m_Speeds[i] * 0.9f;
+			}
+		}
+	}
+
+	float GetTotalHeight() const
+	{
+		float total = 0.0f;
+		for (unsigned int i = 0; i < TIMESTEPTEST_BENCH_NUM_BODIES; ++i)
+			total += m_Heights[i];
+		return total;
+	}
+};
+
+static void BenchHeadlessTicks()
+{
+	// ticks run back to back with no real time, the way a headless server or a test would
+	{
+		FixedTimestep timestep;
+		BenchSimulation simulation;
+		unsigned long long start = HighResClock::GetMicroseconds();
+		timestep.RunTicks(TIMESTEPTEST_BENCH_NUM_TICKS, [&simulation](double time, float deltaTime) { simulation.Tick(deltaTime); });
+		unsigned long long elapsed = HighResClock::GetMicroseconds() - start;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "RunTicks, %u bodies", TIMESTEPTEST_BENCH_NUM_BODIES);
+		ReportThroughput(name, TIMESTEPTEST_BENCH_NUM_TICKS, elapsed);
+		TEST_CHECK(timestep.GetNumTicks() == TIMESTEPTEST_BENCH_NUM_TICKS);
+		TEST_CHECK(std::isfinite(simulation.GetTotalHeight()));
+	}
+
+	// the same ticks fed by uneven frames, to see what the accumulator costs over running them directly
+	{
+		FixedTimestep timestep(FIXEDTIMESTEP_DEFAULT_TICK_RATE, 8);
+		BenchSimulation simulation;
+		const float frameDeltas[] = { 0.004f, 0.016f, 0.033f, 0.011f, 0.05f, 0.0f, 0.02f };
+		unsigned int numFrames = 0;
+		unsigned long long start = HighResClock::GetMicroseconds();
+		while (timestep.GetNumTicks() < TIMESTEPTEST_BENCH_NUM_TICKS)
+		{
+			timestep.Step(frameDeltas[numFrames % (sizeof(frameDeltas) / sizeof(frameDeltas[0]))], [&simulation](double time, float deltaTime) { simulation.Tick(deltaTime); });
+			++numFrames;
+		}
+		unsigned long long elapsed = HighResClock::GetMicroseconds() - start;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "Step, %u bodies", TIMESTEPTEST_BENCH_NUM_BODIES);
+		ReportThroughput(name, timestep.GetNumTicks(), elapsed);
+		std::printf("  (%u frames, %llu ticks dropped)\n", numFrames, timestep.GetNumDroppedTicks());
+		TEST_CHECK(timestep.GetNumDroppedTicks() == 0);
+		TEST_CHECK(std::isfinite(simulation.GetTotalHeight()));
+	}
+}
+
+int main()
+{
+	RUN_TEST(TestTickCountForElapsedTime);
+	RUN_TEST(TestMaxTicksDropsTheBacklog);
+	RUN_TEST(TestInterpolationRange);
+	RUN_TEST(BenchHeadlessTicks);
+
+	return TestExitCode();
+}
@@ -0,0 +1,130 @@
+/*
+	FramePacerTest.cpp
+
+	Tests for FramePacer: a limited loop runs at the target rate and spends
+	the spare time waiting, and an unlimited loop never waits. The harness
+	runs an idle loop, one that does no work at all, limited and at full
+	speed and prints the process CPU usage of each, which is what the
+	limiter is there to save. Timing checks are loose so a busy machine
+	does not fail them.
+*/
+
+#include <cstdio>
+
+#include "FramePacer.h"
+#include "TestUtil.h"
+
+const float PACERTEST_FRAME_RATE = 100.0f;
+const unsigned int PACERTEST_NUM_FRAMES = 50;
+
+// how long each idle run lasts
+const unsigned long long PACERTEST_IDLE_RUN_NS = 1000000000ULL;
+
+/// Spin for a number of microseconds to stand in for a frame's work
+static void Work(unsigned long long microseconds)
+{
+	unsigned long long start = HighResClock::GetMicroseconds();
+	while (HighResClock::GetMicroseconds() - start < microseconds)
+	{
+	}
+}
+
+static void TestLimitedLoopHoldsTheFrameRate()
+{
+	FramePacer pacer(PACERTEST_FRAME_RATE);
+	TEST_CHECK(pacer.GetTargetFrameRate() > 99.9f && pacer.GetTargetFrameRate() < 100.1f);
+
+	// the first call starts the clock, every later one ends a frame
+	pacer.WaitForNextFrame();
+	float totalDeltaTime = 0.0f;
+	for (unsigned int frame = 0; frame < PACERTEST_NUM_FRAMES; ++frame)
+	{
+		Work(1000);
+		totalDeltaTime += pacer.WaitForNextFrame();
+	}
+
+	FramePacerStats stats = pacer.GetStats();
+	TEST_CHECK(stats.m_NumFrames == PACERTEST_NUM_FRAMES);
+
+	// frames stay on the grid, so one that starts late is followed by a shorter one and the average holds
+	TEST_CHECK(stats.m_AvgFrameMS > 9.9f && stats.m_AvgFrameMS < 15.0f);
+	TEST_CHECK(stats.m_MinFrameMS <= stats.m_AvgFrameMS && stats.m_AvgFrameMS <= stats.m_MaxFrameMS);
+	TEST_CHECK(stats.m_P99FrameMS >= stats.m_MinFrameMS && stats.m_P99FrameMS <= stats.m_MaxFrameMS);
+	TEST_CHECK(stats.m_AvgWaitMS > stats.m_AvgWorkMS);
+	TEST_CHECK(totalDeltaTime > 0.49f && totalDeltaTime < 0.75f);
+}
+
+static void TestUnlimitedLoopDoesNotWait()
+{
+	FramePacer pacer(0.0f);
+	TEST_CHECK(pacer.GetTargetFrameRate() == 0.0f);
+
+	pacer.WaitForNextFrame();
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (unsigned int frame = 0; frame < PACERTEST_NUM_FRAMES; ++frame)
+	{
+		Work(100);
+		pacer.WaitForNextFrame();
+	}
+	unsigned long long elapsed = HighResClock::GetMicroseconds() - start;
+
+	FramePacerStats stats = pacer.GetStats();
+	TEST_CHECK(stats.m_NumFrames == PACERTEST_NUM_FRAMES);
+	TEST_CHECK(stats.m_AvgWaitMS < 0.05f);
+	TEST_CHECK(elapsed < PACERTEST_NUM_FRAMES * 1000);
+
+	// setting a target part way limits the frames from then on
+	pacer.SetTargetFrameRate(PACERTEST_FRAME_RATE);
+	pacer.ResetStats();
+	for (unsigned int frame = 0; frame < 5; ++frame)
+		pacer.WaitForNextFrame();
+	TEST_CHECK(pacer.GetStats().m_AvgWaitMS > 5.0f);
+}
+
+/// Run an idle loop for a while at a frame rate and return its stats
+static FramePacerStats RunIdle(float framesPerSecond, float spinMS)
+{
+	FramePacer pacer(framesPerSecond);
+	pacer.SetSpinTime(spinMS);
+	pacer.WaitForNextFrame();
+	pacer.ResetStats();
+
+	unsigned long long start = HighResClock::GetNanoseconds();
+	while (HighResClock::GetNanoseconds() - start < PACERTEST_IDLE_RUN_NS)
+	{
+		pacer.WaitForNextFrame();
+	}
+
+	return pacer.GetStats();
+}
+
+static void PrintIdleRun(const char* name, const FramePacerStats& stats)
+{
+	std::printf("  %-22s %8lu frames  avg %7.3fms  p99 %7.3fms  jitter %6.3fms  cpu %5.1f%%\n",
+		name, stats.m_NumFrames, stats.m_AvgFrameMS, stats.m_P99FrameMS, stats.m_JitterMS, stats.m_CpuUsage * 100.0f);
+}
+
+static void BenchIdleCpuUsage()
+{
+	FramePacerStats limited = RunIdle(FRAMEPACER_DEFAULT_FRAME_RATE, FRAMEPACER_DEFAULT_SPIN_MS);
+	FramePacerStats sleepOnly = RunIdle(FRAMEPACER_DEFAULT_FRAME_RATE, 0.0f);
+	FramePacerStats fullSpeed = RunIdle(0.0f, 0.0f);
+
+	PrintIdleRun("60 fps, sleep and spin", limited);
+	PrintIdleRun("60 fps, sleep only", sleepOnly);
+	PrintIdleRun("full speed", fullSpeed);
+
+	// an idle loop at full speed keeps a core busy, the limiter only spins the end of each frame
+	TEST_CHECK(limited.m_NumFrames > 0 && fullSpeed.m_NumFrames > limited.m_NumFrames);
+	TEST_CHECK(limited.m_CpuUsage < fullSpeed.m_CpuUsage * 0.5f);
+	TEST_CHECK(sleepOnly.m_CpuUsage <= limited.m_CpuUsage + 0.05f);
+}
+
+int main()
+{
+	RUN_TEST(TestLimitedLoopHoldsTheFrameRate);
+	RUN_TEST(TestUnlimitedLoopDoesNotWait);
+	RUN_TEST(BenchIdleCpuUsage);
+
+	return TestExitCode();
+}
@@ -0,0 +1,245 @@
+/*
+	JobSystemTest.cpp
+
+	Tests for the job system's fork/join, parent/child and main thread
+	rules, and benchmarks of how ParallelFor() and small jobs scale with
+	the number of workers.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "TestUtil.h"
+
+const int JOBTEST_NUM_JOBS = 10000;
+const unsigned int JOBTEST_BENCH_ITEMS = 1 << 16;
+const unsigned int JOBTEST_BENCH_WORK_PER_ITEM = 2000;
+
+/// Some integer work the compiler can't fold away
+static unsigned int Churn(unsigned int seed, unsigned int rounds)
+{
+	unsigned int x = seed | 1;
+	for (unsigned int i = 0; i < rounds; ++i)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+	}
+	return x;
+}
+
+static void TestEveryJobRunsOnce()
+{
+	JobSystem jobSystem(4);
+	std::vector<std::atomic<int> > runs(JOBTEST_NUM_JOBS);
+	for (auto it = runs.begin(); it != runs.end(); ++it)
+		*it = 0;
+
+	std::vector<JobPtr> jobs;
+	jobs.reserve(JOBTEST_NUM_JOBS);
+	for (int i = 0; i < JOBTEST_NUM_JOBS; ++i)
+	{
+		std::atomic<int>* pRuns = &runs[i];
+		jobs.push_back(jobSystem.CreateJob([pRuns]() { pRuns->fetch_add(1); }));
+		jobSystem.Run(jobs.back());
+	}
+
+	for (auto it = jobs.begin(); it != jobs.end(); ++it)
+	{
+		jobSystem.Wait(*it);
+		TEST_CHECK((*it)->IsFinished());
+	}
+
+	for (auto it = runs.begin(); it != runs.end(); ++it)
+		TEST_CHECK(it->load() == 1);
+}
+
+static void TestParentWaitsForChildren()
+{
+	JobSystem jobSystem(4);
+	std::atomic<int> numLeaves(0);
+	std::atomic<bool> slowChildDone(false);
+
+	// the parent forks children from its own function, and each child forks leaves of its own
+	JobSystem* pJobSystem = &jobSystem;
+	JobPtr pParent;
+	pParent = jobSystem.CreateJob([pJobSystem, &numLeaves, &slowChildDone, &pParent]()
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			JobPtr pChild = pJobSystem->CreateChildJob(pParent, [pJobSystem, &numLeaves, &pParent]()
+			{
+				for (int j = 0; j < 8; ++j)
+					pJobSystem->Run(pJobSystem->CreateChildJob(pParent, [&numLeaves]() { numLeaves.fetch_add(1); }));
+			});
+			pJobSystem->Run(pChild);
+		}
+
+		// a child that is still running keeps the parent unfinished
+		pJobSystem->Run(pJobSystem->CreateChildJob(pParent, [&slowChildDone]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			slowChildDone = true;
+		}));
+	});
+
+	jobSystem.Run(pParent);
+	jobSystem.Wait(pParent);
+
+	TEST_CHECK(pParent->IsFinished());
+	TEST_CHECK(slowChildDone.load());
+	TEST_CHECK(numLeaves.load() == 64);
+}
+
+static void TestMainThreadJobsRunOnMainThread()
+{
+	JobSystem jobSystem(4);
+	const std::thread::id mainThreadId = std::this_thread::get_id();
+	std::atomic<int> numOffMainThread(0);
+	std::atomic<int> numRuns(0);
+
+	JobPtr pParent = jobSystem.CreateJob(JobFunction());
+	for (int i = 0; i < 100; ++i)
+	{
+		jobSystem.Run(jobSystem.CreateChildJob(pParent, [mainThreadId, &numOffMainThread, &numRuns]()
+		{
+			if (std::this_thread::get_id() != mainThreadId)
+				numOffMainThread.fetch_add(1);
+			numRuns.fetch_add(1);
+		}, JobAffinity_MainThread));
+	}
+
+	// no worker may pick these up, so nothing runs until the main thread waits
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	TEST_CHECK(numRuns.load() == 0);
+	TEST_CHECK(jobSystem.IsMainThread());
+
+	jobSystem.Run(pParent);
+	jobSystem.Wait(pParent);
+
+	TEST_CHECK(numRuns.load() == 100);
+	TEST_CHECK(numOffMainThread.load() == 0);
+}
+
+static void TestParallelForCanSkipMainThreadJobs()
+{
+	JobSystem jobSystem(2);
+	std::atomic<int> numMainThreadRuns(0);
+	jobSystem.Run(jobSystem.CreateJob([&numMainThreadRuns]() { numMainThreadRuns.fetch_add(1); }, JobAffinity_MainThread));
+
+	// enough items that the main thread waits on the workers and goes looking for other jobs
+	std::atomic<int> numItems(0);
+	jobSystem.ParallelFor(1000, [&numItems](unsigned int i)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(10));
+		numItems.fetch_add(1);
+	}, JobWait_SkipMainThread);
+
+	TEST_CHECK(numItems.load() == 1000);
+	TEST_CHECK(numMainThreadRuns.load() == 0);
+
+	jobSystem.RunMainThreadJobs();
+	TEST_CHECK(numMainThreadRuns.load() == 1);
+}
+
+static void TestParallelForCoversRange()
+{
+	JobSystem jobSystem(3);
+	const unsigned int counts[] = { 0, 1, 2, 7, 64, 1000, 100003 };
+	for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+	{
+		std::vector<std::atomic<int> > hits(counts[c]);
+		for (auto it = hits.begin(); it != hits.end(); ++it)
+			*it = 0;
+
+		jobSystem.ParallelFor(counts[c], [&hits](unsigned int i) { hits[i].fetch_add(1); });
+
+		for (auto it = hits.begin(); it != hits.end(); ++it)
+			TEST_CHECK(it->load() == 1);
+	}
+}
+
+static void TestThreadIndices()
+{
+	JobSystem jobSystem(4, true);
+	TEST_CHECK(JobSystem::Get() == &jobSystem);
+	TEST_CHECK(jobSystem.GetNumWorkers() == 4);
+	TEST_CHECK(jobSystem.GetThreadIndex() == 4);
+
+	// every index ParallelFor() runs on is a worker or the main thread
+	std::atomic<int> numBadIndices(0);
+	jobSystem.ParallelFor(10000, [&jobSystem, &numBadIndices](unsigned int i)
+	{
+		int index = jobSystem.GetThreadIndex();
+		if (index < 0 || index > 4)
+			numBadIndices.fetch_add(1);
+	});
+	TEST_CHECK(numBadIndices.load() == 0);
+
+	// a thread outside the job system has no index but can still submit work
+	std::atomic<bool> ran(false);
+	std::thread outsider([&jobSystem, &ran]()
+	{
+		TEST_CHECK(jobSystem.GetThreadIndex() == -1);
+		JobPtr pJob = jobSystem.CreateJob([&ran]() { ran = true; });
+		jobSystem.Run(pJob);
+		jobSystem.Wait(pJob);
+	});
+	outsider.join();
+	TEST_CHECK(ran.load());
+}
+
+static void BenchScaling()
+{
+	unsigned int maxWorkers = std::thread::hardware_concurrency();
+	if (maxWorkers < 2)
+		maxWorkers = 2;
+
+	unsigned long long baseMicroseconds = 0;
+	for (unsigned int numWorkers = 1; numWorkers < maxWorkers * 2; numWorkers *= 2)
+	{
+		JobSystem jobSystem(numWorkers);
+		std::vector<unsigned int> results(JOBTEST_BENCH_ITEMS);
+
+		// ParallelFor over evenly sized items
+		unsigned long long start = HighResClock::GetMicroseconds();
+		jobSystem.ParallelFor(JOBTEST_BENCH_ITEMS, [&results](unsigned int i) { results[i] = Churn(i, JOBTEST_BENCH_WORK_PER_ITEM); });
+		unsigned long long microseconds = HighResClock::GetMicroseconds() - start;
+		if (numWorkers == 1)
+			baseMicroseconds = microseconds;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "ParallelFor, %u workers (%.2fx)", numWorkers,
+			microseconds > 0 ? (double)baseMicroseconds / (double)microseconds : 0.0);
+		ReportThroughput(name, JOBTEST_BENCH_ITEMS, microseconds);
+
+		// many tiny jobs forked from one parent measure the scheduling overhead
+		std::atomic<unsigned int> numRuns(0);
+		start = HighResClock::GetMicroseconds();
+		JobPtr pParent = jobSystem.CreateJob(JobFunction());
+		for (int i = 0; i < JOBTEST_NUM_JOBS; ++i)
+			jobSystem.Run(jobSystem.CreateChildJob(pParent, [&numRuns]() { numRuns.fetch_add(1, std::memory_order_relaxed); }));
+		jobSystem.Run(pParent);
+		jobSystem.Wait(pParent);
+		microseconds = HighResClock::GetMicroseconds() - start;
+
+		std::snprintf(name, sizeof(name), "empty child jobs, %u workers", numWorkers);
+		ReportThroughput(name, JOBTEST_NUM_JOBS, microseconds);
+		TEST_CHECK(numRuns.load() == (unsigned int)JOBTEST_NUM_JOBS);
+	}
+}
+
+int main()
+{
+	RUN_TEST(TestEveryJobRunsOnce);
+	RUN_TEST(TestParentWaitsForChildren);
+	RUN_TEST(TestMainThreadJobsRunOnMainThread);
+	RUN_TEST(TestParallelForCoversRange);
+	RUN_TEST(TestParallelForCanSkipMainThreadJobs);
+	RUN_TEST(TestThreadIndices);
+	RUN_TEST(BenchScaling);
+	return TestExitCode();
+}
@@ -0,0 +1,217 @@
+/*
+	MpscRingBufferTest.cpp
+
+	Tests and throughput numbers for MpscRingBuffer. The stress test runs
+	several producers against one consumer and checks that every item
+	arrives exactly once and in the order each producer pushed it.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "MpscRingBuffer.h"
+#include "TestUtil.h"
+
+// each item carries its producer in the high bits and a per producer sequence number in the low bits
+const int RING_PRODUCER_SHIFT = 40;
+const unsigned long long RING_SEQUENCE_MASK = (1ULL << RING_PRODUCER_SHIFT) - 1;
+
+static void TestCapacityRoundsUpToPowerOf2()
+{
+	MpscRingBuffer<int> ring1(1);
+	MpscRingBuffer<int> ring100(100);
+	MpscRingBuffer<int> ring1024(1024);
+
+	TEST_CHECK(ring1.GetCapacity() == 2);
+	TEST_CHECK(ring100.GetCapacity() == 128);
+	TEST_CHECK(ring1024.GetCapacity() == 1024);
+}
+
+static void TestFifoOrderAcrossLaps()
+{
+	MpscRingBuffer<int> ring(8);
+	TEST_CHECK(ring.Empty());
+
+	// push and pop in uneven batches so the positions wrap many times
+	int next = 0, expected = 0;
+	for (int lap = 0; lap < 1000; ++lap)
+	{
+		int batch = 1 + (lap % 8);
+		for (int i = 0; i < batch; ++i)
+			TEST_CHECK(ring.Push(next++));
+
+		int value = -1;
+		for (int i = 0; i < batch; ++i)
+		{
+			TEST_CHECK(ring.TryPop(value));
+			TEST_CHECK(value == expected++);
+		}
+	}
+
+	int value;
+	TEST_CHECK(ring.Empty());
+	TEST_CHECK(!ring.TryPop(value));
+	TEST_CHECK(ring.GetOverflowCount() == 0);
+}
+
+static void TestOverflowIsCountedAndDropped()
+{
+	MpscRingBuffer<int> ring(16);
+	for (int i = 0; i < 16; ++i)
+		TEST_CHECK(ring.Push(i));
+
+	// the ring is full, these are dropped
+	for (int i = 0; i < 5; ++i)
+		TEST_CHECK(!ring.Push(100 + i));
+	TEST_CHECK(ring.GetOverflowCount() == 5);
+
+	// draining frees the space again and nothing dropped shows up
+	int sum = 0;
+	size_t popped = ring.Drain([&sum](int value) { sum += value; });
+	TEST_CHECK(popped == 16);
+	TEST_CHECK(sum == 15 * 16 / 2);
+	TEST_CHECK(ring.Push(42));
+}
+
+static void TestDrainStopsAtMaxCount()
+{
+	MpscRingBuffer<int> ring(32);
+	for (int i = 0; i < 20; ++i)
+		ring.Push(i);
+
+	int last = -1;
+	TEST_CHECK(ring.Drain([&last](int value) { last = value; }, 7) == 7);
+	TEST_CHECK(last == 6);
+	TEST_CHECK(ring.Drain([&last](int value) { last = value; }) == 13);
+	TEST_CHECK(last == 19);
+}
+
+/// Run numProducers threads pushing itemsPerProducer items each while this thread consumes -- returns the elapsed microseconds
+static unsigned long long RunProducers(MpscRingBuffer<unsigned long long>& ring, int numProducers, unsigned long long itemsPerProducer, bool retryWhenFull, std::vector<unsigned long long>& lastSequence, unsigned long long& received, bool& inOrder)
+{
+	std::atomic<int> producersDone(0);
+	std::atomic<bool> start(false);
+	std::vector<std::thread> producers;
+
+	for (int p = 0; p < numProducers; ++p)
+	{
+		producers.push_back(std::thread([&, p]()
+		{
+			while (!start.load(std::memory_order_acquire))
+				std::this_thread::yield();
+
+			unsigned long long tag = (unsigned long long)p << RING_PRODUCER_SHIFT;
+			for (unsigned long long i = 1; i <= itemsPerProducer; ++i)
+			{
+				while (!ring.Push(tag | i) && retryWhenFull)
+					std::this_thread::yield();
+			}
+
+			producersDone.fetch_add(1, std::memory_order_release);
+		}));
+	}
+
+	lastSequence.assign(numProducers, 0);
+	received = 0;
+	inOrder = true;
+
+	auto consume = [&](unsigned long long value)
+	{
+		int producer = (int)(value >> RING_PRODUCER_SHIFT);
+		unsigned long long sequence = value & RING_SEQUENCE_MASK;
+		if (producer >= numProducers || sequence <= lastSequence[producer])
+			inOrder = false;
+		else
+			lastSequence[producer] = sequence;
+		++received;
+	};
+
+	unsigned long long startTime = HighResClock::GetMicroseconds();
+	start.store(true, std::memory_order_release);
+
+	while (producersDone.load(std::memory_order_acquire) < numProducers)
+	{
+		if (ring.Drain(consume, 256) == 0)
+			std::this_thread::yield();
+	}
+	ring.Drain(consume);
+
+	unsigned long long elapsed = HighResClock::GetMicroseconds() - startTime;
+	for (auto& producer : producers)
+		producer.join();
+
+	return elapsed;
+}
+
+static void TestManyProducersDeliverEverythingInOrder()
+{
+	const int numProducers = 8;
+	const unsigned long long itemsPerProducer = 100000;
+
+	// a small ring so the producers keep running into the consumer
+	MpscRingBuffer<unsigned long long> ring(256);
+	std::vector<unsigned long long> lastSequence;
+	unsigned long long received = 0;
+	bool inOrder = false;
+	RunProducers(ring, numProducers, itemsPerProducer, true, lastSequence, received, inOrder);
+
+	TEST_CHECK(inOrder);
+	TEST_CHECK(received == numProducers * itemsPerProducer);
+	for (int p = 0; p < numProducers; ++p)
+		TEST_CHECK(lastSequence[p] == itemsPerProducer);
+	TEST_CHECK(ring.Empty());
+}
+
+static void TestDroppedPushesMatchOverflowCount()
+{
+	const int numProducers = 4;
+	const unsigned long long itemsPerProducer = 50000;
+
+	// producers never retry, whatever doesn't fit has to show up in the overflow count
+	MpscRingBuffer<unsigned long long> ring(64);
+	std::vector<unsigned long long> lastSequence;
+	unsigned long long received = 0;
+	bool inOrder = false;
+	RunProducers(ring, numProducers, itemsPerProducer, false, lastSequence, received, inOrder);
+
+	TEST_CHECK(inOrder);
+	TEST_CHECK(received + ring.GetOverflowCount() == numProducers * itemsPerProducer);
+}
+
+static void BenchThroughput()
+{
+	const unsigned long long totalItems = 2000000;
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	if (numThreads == 0)
+		numThreads = 1;
+
+	for (int numProducers = 1; numProducers <= 8; numProducers *= 2)
+	{
+		MpscRingBuffer<unsigned long long> ring(4096);
+		std::vector<unsigned long long> lastSequence;
+		unsigned long long received = 0;
+		bool inOrder = false;
+		unsigned long long elapsed = RunProducers(ring, numProducers, totalItems / numProducers, true, lastSequence, received, inOrder);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "push/pop, %d producer(s)", numProducers);
+		ReportThroughput(name, received, elapsed);
+		TEST_CHECK(inOrder);
+	}
+
+	std::printf("  (%u hardware threads)\n", numThreads);
+}
+
+int main()
+{
+	RUN_TEST(TestCapacityRoundsUpToPowerOf2);
+	RUN_TEST(TestFifoOrderAcrossLaps);
+	RUN_TEST(TestOverflowIsCountedAndDropped);
+	RUN_TEST(TestDrainStopsAtMaxCount);
+	RUN_TEST(TestManyProducersDeliverEverythingInOrder);
+	RUN_TEST(TestDroppedPushesMatchOverflowCount);
+	RUN_TEST(BenchThroughput);
+
+	return TestExitCode();
+}
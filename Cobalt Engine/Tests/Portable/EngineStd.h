@@ -0,0 +1,43 @@
+/*
+	EngineStd.h
+
+	Stand in for the engine's EngineStd.h when building the tests. Only
+	the memory macros, the resource interfaces and the few Windows and CRT
+	functions the zip reader uses are needed by the platform independent
+	sources.
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN
+ #define NOMINMAX
+ #include <Windows.h>
+#else
+ #define ZeroMemory(p, size) std::memset((p), 0, (size))
+ #define _MAX_PATH 260
+
+/// Open a file with a wide name, the name is narrowed with ws2s()
+extern int _wfopen_s(FILE** ppFile, const wchar_t* pFileName, const wchar_t* pMode);
+
+/// Convert a string to lower case in place
+extern int _strlwr_s(char* pStr, size_t size);
+#endif
+
+#include "ResourceInterfaces.h"
+
+#define CB_SAFE_DELETE(p) { if (p) { delete (p); (p) = nullptr; } }
+#define CB_SAFE_DELETE_ARRAY(p) { if (p) { delete[] (p); (p) = nullptr; } }
+
+#define CB_NEW new
+
+using std::unique_ptr;
+using std::weak_ptr;
+using std::static_pointer_cast;
+using std::dynamic_pointer_cast;
+
+extern const int MEGABYTE;
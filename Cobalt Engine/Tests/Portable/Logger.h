@@ -0,0 +1,55 @@
+/*
+	Logger.h
+
+	Stand in for the engine's Logger.h when building the tests. Messages
+	are written to stderr and a failed assert aborts the test.
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "EngineStd.h"
+
+#define CB_LOG(tag, str) \
+	do \
+	{ \
+		std::cerr << "[" << (tag) << "] " << (str) << std::endl; \
+	} \
+	while (0)
+
+#define CB_ERROR(str) \
+	do \
+	{ \
+		std::cerr << __FILE__ << "(" << __LINE__ << "): error: " << (str) << std::endl; \
+	} \
+	while (0)
+
+#define CB_WARNING(str) \
+	do \
+	{ \
+		std::cerr << __FILE__ << "(" << __LINE__ << "): warning: " << (str) << std::endl; \
+	} \
+	while (0)
+
+#define CB_ASSERT(x) \
+	do \
+	{ \
+		if (!(x)) \
+		{ \
+			std::cerr << __FILE__ << "(" << __LINE__ << "): assert failed: " << #x << std::endl; \
+			std::abort(); \
+		} \
+	} \
+	while (0)
+
+#define CB_FATAL(str) \
+	do \
+	{ \
+		std::cerr << __FILE__ << "(" << __LINE__ << "): fatal: " << (str) << std::endl; \
+		std::abort(); \
+	} \
+	while (0)
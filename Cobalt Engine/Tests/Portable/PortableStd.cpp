@@ -0,0 +1,110 @@
+/*
+	PortableStd.cpp
+
+	Definitions for the stand in headers: the globals from EngineStd.cpp,
+	the parts of StringUtil.cpp that the tests need with ASCII only string
+	conversions, and the CRT functions that are missing off Windows.
+*/
+
+#include "EngineStd.h"
+#include "StringUtil.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+
+const int MEGABYTE = 1024 * 1024;
+
+// same matcher as the engine's StringUtil.cpp
+bool WildcardMatch(const char *pat, const char *str)
+{
+	int i, star;
+
+new_segment:
+
+	star = 0;
+	if (*pat == '*') {
+		star = 1;
+		do { pat++; } while (*pat == '*'); /* enddo */
+	} /* endif */
+
+test_match:
+
+	for (i = 0; pat[i] && (pat[i] != '*'); i++) {
+		if (str[i] != pat[i]) {
+			if (!str[i]) return 0;
+			if ((pat[i] == '?') && (str[i] != '.')) continue;
+			if (!star) return 0;
+			str++;
+			goto test_match;
+		}
+	}
+	if (pat[i] == '*') {
+		str += i;
+		pat += i;
+		goto new_segment;
+	}
+	if (!str[i]) return 1;
+	if (i && pat[i - 1] == '*') return 1;
+	if (!star) return 0;
+	str++;
+	goto test_match;
+}
+
+std::string ToStr(int num, int base)
+{
+	return (base == 16) ? ToStr((unsigned long)num, base) : std::to_string(num);
+}
+
+std::string ToStr(unsigned int num, int base)
+{
+	return ToStr((unsigned long)num, base);
+}
+
+std::string ToStr(unsigned long num, int base)
+{
+	if (base != 16)
+		return std::to_string(num);
+
+	char str[32];
+	std::snprintf(str, sizeof(str), "%lx", num);
+	return str;
+}
+
+std::string ToStr(float num)
+{
+	char str[64];
+	std::snprintf(str, sizeof(str), "%f", num);
+	return str;
+}
+
+std::string ws2s(const std::wstring& s)
+{
+	std::string r(s.length(), '\0');
+	for (size_t i = 0; i < s.length(); ++i)
+		r[i] = (s[i] < 0x80) ? (char)s[i] : '?';
+	return r;
+}
+
+std::wstring s2ws(const std::string& s)
+{
+	std::wstring r(s.length(), L'\0');
+	for (size_t i = 0; i < s.length(); ++i)
+		r[i] = (wchar_t)(unsigned char)s[i];
+	return r;
+}
+
+#ifndef _WIN32
+int _wfopen_s(FILE** ppFile, const wchar_t* pFileName, const wchar_t* pMode)
+{
+	*ppFile = std::fopen(ws2s(pFileName).c_str(), ws2s(pMode).c_str());
+	return *ppFile ? 0 : errno;
+}
+
+int _strlwr_s(char* pStr, size_t size)
+{
+	for (size_t i = 0; i < size && pStr[i]; ++i)
+		pStr[i] = (char)std::tolower((unsigned char)pStr[i]);
+	return 0;
+}
+#endif
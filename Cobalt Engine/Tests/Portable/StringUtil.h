@@ -0,0 +1,22 @@
+/*
+	StringUtil.h
+
+	Stand in for the engine's StringUtil.h when building the tests.
+*/
+
+#pragma once
+
+#include <string>
+
+/// Match a string against a pattern with * and ? wildcards
+extern bool WildcardMatch(const char *pat, const char *str);
+
+/// Convert a number to a string
+extern std::string ToStr(int num, int base = 10);
+extern std::string ToStr(unsigned int num, int base = 10);
+extern std::string ToStr(unsigned long num, int base = 10);
+extern std::string ToStr(float num);
+
+/// Convert between wide and standard strings, only ASCII survives the trip
+extern std::string ws2s(const std::wstring& s);
+extern std::wstring s2ws(const std::string& s);
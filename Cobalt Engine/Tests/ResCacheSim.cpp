@@ -0,0 +1,79 @@
+/*
+	ResCacheSim.cpp
+
+	Replays a resource cache access trace, written by the game with the
+	<ResCache trace="..."/> option or WriteResCacheTrace() from lua,
+	through each eviction policy at several budgets and prints how each
+	would have done:
+
+	  ResCacheSim <trace file> [budget in MB...]
+
+	Without budgets it tries shares of the trace's working set, the bytes
+	of every resource it touched.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ResCachePolicy.h"
+
+const char* RESCACHESIM_POLICIES[] = { "LRU", "LFU", "2Q" };
+const double RESCACHESIM_WORKING_SET_SHARES[] = { 0.1, 0.25, 0.5, 0.75 };
+
+/// Return the bytes of every resource in the trace, counted once
+static unsigned long long GetWorkingSet(const std::vector<ResCacheAccess>& trace)
+{
+	std::unordered_map<std::string, unsigned long long> sizes;
+	for (auto it = trace.begin(); it != trace.end(); ++it)
+		sizes[it->m_Name] = it->m_Size;
+
+	unsigned long long total = 0;
+	for (auto it = sizes.begin(); it != sizes.end(); ++it)
+		total += it->second;
+	return total;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <trace file> [budget in MB...]\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<ResCacheAccess> trace;
+	if (!LoadResCacheTrace(argv[1], trace))
+	{
+		std::fprintf(stderr, "could not read the trace %s\n", argv[1]);
+		return 1;
+	}
+
+	unsigned long long workingSet = GetWorkingSet(trace);
+	std::printf("%zu accesses, %.2fMB working set\n", trace.size(), (double)workingSet / (1024.0 * 1024.0));
+
+	std::vector<unsigned long long> budgets;
+	for (int i = 2; i < argc; ++i)
+		budgets.push_back((unsigned long long)(std::atof(argv[i]) * 1024.0 * 1024.0));
+	if (budgets.empty())
+	{
+		for (size_t i = 0; i < sizeof(RESCACHESIM_WORKING_SET_SHARES) / sizeof(RESCACHESIM_WORKING_SET_SHARES[0]); ++i)
+			budgets.push_back((unsigned long long)((double)workingSet * RESCACHESIM_WORKING_SET_SHARES[i]));
+	}
+
+	std::printf("%-8s %12s %10s %12s %12s\n", "policy", "budget MB", "hit rate", "evictions", "loaded MB");
+	for (size_t p = 0; p < sizeof(RESCACHESIM_POLICIES) / sizeof(RESCACHESIM_POLICIES[0]); ++p)
+	{
+		std::unique_ptr<IResCachePolicy> pPolicy(CreateResCachePolicy(RESCACHESIM_POLICIES[p]));
+		for (auto it = budgets.begin(); it != budgets.end(); ++it)
+		{
+			ResCacheStats stats = SimulateResCachePolicy(trace, pPolicy.get(), *it);
+			std::printf("%-8s %12.2f %9.1f%% %12lu %12.2f\n", pPolicy->GetName(), (double)*it / (1024.0 * 1024.0),
+				stats.GetHitRate() * 100.0f, stats.m_NumEvictions, (double)stats.m_MissedBytes / (1024.0 * 1024.0));
+		}
+	}
+
+	return 0;
+}
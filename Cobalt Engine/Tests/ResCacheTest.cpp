@@ -0,0 +1,474 @@
+/*
+	ResCacheTest.cpp
+
+	Loads the game's assets through the resource cache from several threads
+	at once, so requests for the same resource race to start and join the
+	same background load, and reports the latency from each request to its
+	callback. Also checks groups and access traces, and benchmarks cache
+	hits with 50k resident handles under a Zipf access pattern.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <EngineStd.h>
+
+#include "JobSystem.h"
+#include "ResourceCache.h"
+#include "ResourceHandle.h"
+#include "TestUtil.h"
+
+const int RESCACHETEST_NUM_REQUESTERS = 4;
+const int RESCACHETEST_NUM_ROUNDS = 8;
+const unsigned int RESCACHETEST_CACHE_MB = 64;
+const int RESCACHETEST_ZIPF_NUM_RESOURCES = 50000;
+const int RESCACHETEST_ZIPF_NUM_ACCESSES = 1000000;
+const unsigned int RESCACHETEST_ZIPF_RESOURCE_SIZE = 256;
+const double RESCACHETEST_ZIPF_EXPONENT = 1.0;
+
+/// Resource file over a directory on disk, named the way the game's resource files name them
+class DirectoryResourceFile : public IResourceFile
+{
+public:
+	explicit DirectoryResourceFile(const std::string& directory) : m_Directory(directory) { }
+
+	virtual bool Open() override
+	{
+		std::error_code error;
+		for (std::filesystem::recursive_directory_iterator it(m_Directory, error), end; !error && it != end; it.increment(error))
+		{
+			if (!it->is_regular_file())
+				continue;
+
+			// lowercase with backslashes, ex. gameobjects\light.xml
+			std::string name = std::filesystem::relative(it->path(), m_Directory).generic_string();
+			std::replace(name.begin(), name.end(), '/', '\\');
+			name = Resource(name).m_Name;
+
+			m_Index[name] = (int)m_Files.size();
+			m_Names.push_back(name);
+			m_Files.push_back(it->path());
+		}
+		return !error && !m_Files.empty();
+	}
+
+	virtual int GetRawResourceSize(const Resource& r) override
+	{
+		int index = Find(r);
+		return (index < 0) ? -1 : (int)std::filesystem::file_size(m_Files[index]);
+	}
+
+	virtual int GetRawResource(const Resource& r, char* buffer) override
+	{
+		int index = Find(r);
+		if (index < 0)
+			return 0;
+
+		std::ifstream file(m_Files[index], std::ios::binary);
+		std::streamsize size = (std::streamsize)std::filesystem::file_size(m_Files[index]);
+		if (!file.read(buffer, size))
+			return 0;
+		return (int)size;
+	}
+
+	// every read opens its own stream
+	virtual bool IsThreadSafe() const override { return true; }
+
+	virtual int GetNumResources() const override { return (int)m_Names.size(); }
+	virtual std::string GetResourceName(int n) const override { return m_Names[n]; }
+	virtual bool IsUsingDevelopmentDirectories() const override { return true; }
+
+	/// Return the bytes of a resource read straight from disk
+	std::vector<char> ReadFile(const std::string& name) const
+	{
+		auto findIt = m_Index.find(name);
+		if (findIt == m_Index.end())
+			return std::vector<char>();
+
+		std::ifstream file(m_Files[findIt->second], std::ios::binary);
+		return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+private:
+	int Find(const Resource& r) const
+	{
+		auto findIt = m_Index.find(r.m_Name);
+		return (findIt == m_Index.end()) ? -1 : findIt->second;
+	}
+
+	std::filesystem::path m_Directory;
+	std::vector<std::filesystem::path> m_Files;
+	std::vector<std::string> m_Names;
+	std::unordered_map<std::string, int> m_Index;
+};
+
+/// Resource file of generated resources that are all the same size
+class GeneratedResourceFile : public IResourceFile
+{
+public:
+	GeneratedResourceFile(int numResources, unsigned int size) : m_NumResources(numResources), m_Size(size) { }
+
+	virtual bool Open() override { return true; }
+	virtual int GetRawResourceSize(const Resource& r) override { return (int)m_Size; }
+
+	virtual int GetRawResource(const Resource& r, char* buffer) override
+	{
+		std::fill(buffer, buffer + m_Size, (char)r.m_Name.size());
+		return (int)m_Size;
+	}
+
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual int GetNumResources() const override { return m_NumResources; }
+	virtual std::string GetResourceName(int n) const override { return "generated\\" + std::to_string(n) + ".bin"; }
+	virtual bool IsUsingDevelopmentDirectories() const override { return false; }
+
+private:
+	int m_NumResources;
+	unsigned int m_Size;
+};
+
+/// Generated resource file whose reads all fail, ex. a file that went missing after the archive was opened
+class UnreadableResourceFile : public GeneratedResourceFile
+{
+public:
+	UnreadableResourceFile(int numResources, unsigned int size) : GeneratedResourceFile(numResources, size) { }
+
+	virtual int GetRawResource(const Resource& r, char* buffer) override { return 0; }
+};
+
+/// One GetHandleAsync() call and when its callback ran
+struct LoadSample
+{
+	unsigned long long m_Requested;
+	std::atomic<unsigned long long> m_Completed;
+	std::atomic<int> m_NumCallbacks;
+	shared_ptr<ResHandle> m_Handle;
+};
+
+static void ReportLatency(const char* name, std::vector<unsigned long long>& latencies)
+{
+	if (latencies.empty())
+		return;
+
+	std::sort(latencies.begin(), latencies.end());
+	unsigned long long total = 0;
+	for (auto it = latencies.begin(); it != latencies.end(); ++it)
+		total += *it;
+
+	std::printf("  %-46s %6zu loads  avg %.3fms  p50 %.3fms  p99 %.3fms  max %.3fms\n", name, latencies.size(),
+		(double)total / (double)latencies.size() / 1000.0,
+		(double)latencies[latencies.size() / 2] / 1000.0,
+		(double)latencies[(latencies.size() * 99) / 100] / 1000.0,
+		(double)latencies.back() / 1000.0);
+}
+
+static void TestConcurrentLoads()
+{
+	JobSystem jobSystem(4, true);
+	DirectoryResourceFile* pFile = CB_NEW DirectoryResourceFile(COBALT_TEST_ASSETS_DIR);
+	ResCache cache(RESCACHETEST_CACHE_MB, pFile);
+	TEST_CHECK(cache.Init());
+	cache.SetJobSystem(&jobSystem);
+
+	std::vector<std::string> names = cache.Match("*");
+	TEST_CHECK(!names.empty());
+
+	std::vector<unsigned long long> coldLatencies;
+	std::vector<unsigned long long> joinedLatencies;
+	unsigned long long numBytes = 0;
+	unsigned long long start = HighResClock::GetMicroseconds();
+
+	for (int round = 0; round < RESCACHETEST_NUM_ROUNDS; ++round)
+	{
+		// every requester asks for every asset, starting at a different one, so most loads are joined while in flight
+		std::vector<LoadSample> samples(names.size() * RESCACHETEST_NUM_REQUESTERS);
+		std::atomic<int> numRequestersDone(0);
+		std::vector<std::thread> requesters;
+		for (int t = 0; t < RESCACHETEST_NUM_REQUESTERS; ++t)
+		{
+			requesters.push_back(std::thread([&, t]()
+			{
+				std::vector<shared_ptr<ResRequest>> requests;
+				for (size_t i = 0; i < names.size(); ++i)
+				{
+					size_t nameIndex = (i + t * names.size() / RESCACHETEST_NUM_REQUESTERS) % names.size();
+					LoadSample* pSample = &samples[t * names.size() + nameIndex];
+					pSample->m_Completed = 0;
+					pSample->m_NumCallbacks = 0;
+					pSample->m_Requested = HighResClock::GetMicroseconds();
+
+					Resource resource(names[nameIndex]);
+					requests.push_back(cache.GetHandleAsync(&resource, [pSample](shared_ptr<ResHandle> handle)
+					{
+						pSample->m_Handle = handle;
+						pSample->m_Completed = HighResClock::GetMicroseconds();
+						pSample->m_NumCallbacks.fetch_add(1);
+					}));
+				}
+
+				// a joined request has to be waitable as soon as it is returned, even from outside the job system
+				for (auto it = requests.begin(); it != requests.end(); ++it)
+					TEST_CHECK((*it)->GetHandle());
+				numRequestersDone.fetch_add(1);
+			}));
+		}
+
+		// the loads finish on the main thread
+		while (numRequestersDone.load() < RESCACHETEST_NUM_REQUESTERS)
+		{
+			jobSystem.RunMainThreadJobs();
+			std::this_thread::yield();
+		}
+		for (auto it = requesters.begin(); it != requesters.end(); ++it)
+			it->join();
+		cache.WaitForPendingLoads();
+
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			LoadSample& sample = samples[i];
+			TEST_CHECK(sample.m_NumCallbacks.load() == 1);
+			TEST_CHECK(sample.m_Handle);
+			if (!sample.m_Handle)
+				continue;
+
+			const std::string& name = names[i % names.size()];
+			TEST_CHECK(sample.m_Handle->GetName() == name);
+			numBytes += sample.m_Handle->Size();
+
+			// the first requester's copy is checked against the file, the rest must share its handle
+			if (i < names.size())
+			{
+				std::vector<char> bytes = pFile->ReadFile(name);
+				TEST_CHECK(bytes.size() == sample.m_Handle->Size());
+				TEST_CHECK(bytes.empty() || std::equal(bytes.begin(), bytes.end(), sample.m_Handle->Buffer()));
+			}
+			else
+			{
+				TEST_CHECK(sample.m_Handle == samples[i % names.size()].m_Handle);
+			}
+		}
+
+		// whoever asked for a resource first started its load, everyone after joined it
+		for (size_t n = 0; n < names.size(); ++n)
+		{
+			size_t first = n;
+			for (size_t i = n + names.size(); i < samples.size(); i += names.size())
+			{
+				if (samples[i].m_Requested < samples[first].m_Requested)
+					first = i;
+			}
+
+			for (size_t i = n; i < samples.size(); i += names.size())
+			{
+				unsigned long long latency = samples[i].m_Completed.load() - samples[i].m_Requested;
+				if (i == first)
+					coldLatencies.push_back(latency);
+				else
+					joinedLatencies.push_back(latency);
+			}
+		}
+
+		samples.clear();
+		cache.Flush();
+	}
+
+	unsigned long long microseconds = HighResClock::GetMicroseconds() - start;
+	char name[64];
+	std::snprintf(name, sizeof(name), "GetHandleAsync(), %d requesting threads", RESCACHETEST_NUM_REQUESTERS);
+	ReportThroughput(name, (unsigned long long)names.size() * RESCACHETEST_NUM_REQUESTERS * RESCACHETEST_NUM_ROUNDS, microseconds);
+	std::printf("  %.2fMB handed out, %lu hits %lu misses\n", (double)numBytes / (1024.0 * 1024.0), cache.GetStats().m_NumHits, cache.GetStats().m_NumMisses);
+	ReportLatency("request to callback, first asked", coldLatencies);
+	ReportLatency("request to callback, joined or cached", joinedLatencies);
+
+	cache.SetJobSystem(nullptr);
+}
+
+/// Return resource indices drawn from a Zipf distribution, index 0 the most popular
+static std::vector<int> GetZipfAccesses(int numResources, int numAccesses, double exponent)
+{
+	std::vector<double> cumulative(numResources);
+	double total = 0.0;
+	for (int i = 0; i < numResources; ++i)
+	{
+		total += 1.0 / std::pow((double)(i + 1), exponent);
+		cumulative[i] = total;
+	}
+
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<double> uniform(0.0, total);
+	std::vector<int> accesses(numAccesses);
+	for (auto it = accesses.begin(); it != accesses.end(); ++it)
+	{
+		int index = (int)(std::upper_bound(cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin());
+		*it = std::min(index, numResources - 1);
+	}
+	return accesses;
+}
+
+/// Return the names of the generated resources, in index order
+static std::vector<Resource> GetGeneratedResources(ResCache& cache)
+{
+	std::vector<Resource> resources;
+	std::vector<std::string> names = cache.Match("*");
+	resources.reserve(names.size());
+	for (auto it = names.begin(); it != names.end(); ++it)
+		resources.push_back(Resource(*it));
+	return resources;
+}
+
+/// Run the accesses through GetHandle() and report the throughput and hit rate
+static void RunZipfAccesses(ResCache& cache, const std::vector<Resource>& resources, const std::vector<int>& accesses, const char* name)
+{
+	cache.ResetStats();
+	unsigned long long numBytes = 0;
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (auto it = accesses.begin(); it != accesses.end(); ++it)
+	{
+		shared_ptr<ResHandle> handle = cache.GetHandle(const_cast<Resource*>(&resources[*it]));
+		numBytes += handle->Size();
+	}
+	ReportThroughput(name, accesses.size(), HighResClock::GetMicroseconds() - start);
+
+	ResCacheStats stats = cache.GetStats();
+	std::printf("  %.1f%% hits, %lu evictions\n", stats.GetHitRate() * 100.0f, stats.m_NumEvictions);
+	TEST_CHECK(numBytes == (unsigned long long)accesses.size() * RESCACHETEST_ZIPF_RESOURCE_SIZE);
+	TEST_CHECK(stats.m_NumHits + stats.m_NumMisses == (unsigned long)accesses.size());
+}
+
+static void BenchZipfHits()
+{
+	ResCache cache(RESCACHETEST_CACHE_MB, CB_NEW GeneratedResourceFile(RESCACHETEST_ZIPF_NUM_RESOURCES, RESCACHETEST_ZIPF_RESOURCE_SIZE));
+	TEST_CHECK(cache.Init());
+
+	std::vector<Resource> resources = GetGeneratedResources(cache);
+	std::vector<std::string> names = cache.Match("*");
+	std::vector<int> accesses = GetZipfAccesses(RESCACHETEST_ZIPF_NUM_RESOURCES, RESCACHETEST_ZIPF_NUM_ACCESSES, RESCACHETEST_ZIPF_EXPONENT);
+
+	// every resource resident, so each access is a hit that moves the handle to the front of the LRU
+	TEST_CHECK(cache.PreLoad("*", nullptr) == RESCACHETEST_ZIPF_NUM_RESOURCES);
+	RunZipfAccesses(cache, resources, accesses, "GetHandle() hits, 50k resident");
+	TEST_CHECK(cache.GetStats().m_NumMisses == 0);
+
+	// room for a quarter of them, so the tail keeps getting evicted and loaded again
+	cache.SetCacheSize((unsigned long long)RESCACHETEST_ZIPF_NUM_RESOURCES * RESCACHETEST_ZIPF_RESOURCE_SIZE / 4);
+	RunZipfAccesses(cache, resources, accesses, "GetHandle() with evictions, 12.5k resident");
+
+	// the policy on its own, without the cache's map and lock
+	LRUCachePolicy policy;
+	for (auto it = names.begin(); it != names.end(); ++it)
+		policy.OnInsert(*it);
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (auto it = accesses.begin(); it != accesses.end(); ++it)
+		policy.OnAccess(names[*it]);
+	ReportThroughput("LRUCachePolicy::OnAccess(), 50k resident", accesses.size(), HighResClock::GetMicroseconds() - start);
+}
+
+static void TestGroupsTakeResidentResources()
+{
+	const int numResources = 100;
+	ResCache cache(RESCACHETEST_CACHE_MB, CB_NEW GeneratedResourceFile(numResources, RESCACHETEST_ZIPF_RESOURCE_SIZE));
+	TEST_CHECK(cache.Init());
+	std::vector<Resource> resources = GetGeneratedResources(cache);
+	TEST_CHECK(cache.PreLoad("*", nullptr) == numResources);
+
+	// a group added after the loads takes the ten that match and trims them to its budget
+	const unsigned long long size = RESCACHETEST_ZIPF_RESOURCE_SIZE;
+	cache.AddGroup("generated\\1?.bin", shared_ptr<IResCachePolicy>(CB_NEW LRUCachePolicy), 4 * size);
+	TEST_CHECK(cache.GetAllocated() == (numResources - 6) * size);
+
+	// pinned resources that are already loaded survive the cache shrinking to nothing
+	cache.Pin("generated\\2?.bin");
+	cache.SetCacheSize(0);
+	TEST_CHECK(cache.GetAllocated() == 10 * size);
+
+	cache.ResetStats();
+	for (int i = 20; i < 30; ++i)
+		cache.GetHandle(&resources[i]);
+	TEST_CHECK(cache.GetStats().m_NumHits == 10);
+	TEST_CHECK(cache.GetStats().m_NumMisses == 0);
+}
+
+static void TestFailedReadsGiveBackTheirMemory()
+{
+	const int numResources = 10;
+	ResCache cache(RESCACHETEST_CACHE_MB, CB_NEW UnreadableResourceFile(numResources, RESCACHETEST_ZIPF_RESOURCE_SIZE));
+	TEST_CHECK(cache.Init());
+	std::vector<Resource> resources = GetGeneratedResources(cache);
+
+	// the raw buffer is reserved against the cache size before the read, a failed read has to hand it back
+	for (int i = 0; i < numResources / 2; ++i)
+		TEST_CHECK(!cache.GetHandleAsync(&resources[i], nullptr)->GetHandle());
+	TEST_CHECK(cache.GetAllocated() == 0);
+
+	// the same on the background loads
+	JobSystem jobSystem(2, true);
+	cache.SetJobSystem(&jobSystem);
+	for (int i = numResources / 2; i < numResources; ++i)
+		TEST_CHECK(!cache.GetHandleAsync(&resources[i], nullptr)->GetHandle());
+	TEST_CHECK(cache.GetAllocated() == 0);
+	cache.SetJobSystem(nullptr);
+}
+
+static void TestTraceReplaysLikeTheCache()
+{
+	ResCache cache(RESCACHETEST_CACHE_MB, CB_NEW GeneratedResourceFile(RESCACHETEST_ZIPF_NUM_RESOURCES, RESCACHETEST_ZIPF_RESOURCE_SIZE));
+	TEST_CHECK(cache.Init());
+	std::vector<Resource> resources = GetGeneratedResources(cache);
+	std::vector<int> accesses = GetZipfAccesses(RESCACHETEST_ZIPF_NUM_RESOURCES, RESCACHETEST_ZIPF_NUM_ACCESSES / 10, RESCACHETEST_ZIPF_EXPONENT);
+
+	unsigned long long budget = (unsigned long long)RESCACHETEST_ZIPF_NUM_RESOURCES * RESCACHETEST_ZIPF_RESOURCE_SIZE / 4;
+	cache.SetCacheSize(budget);
+	cache.RecordAccessTrace(true);
+	for (auto it = accesses.begin(); it != accesses.end(); ++it)
+		cache.GetHandle(&resources[*it]);
+	cache.RecordAccessTrace(false);
+	ResCacheStats live = cache.GetStats();
+
+	// the trace survives a trip through a file
+	std::vector<ResCacheAccess> trace = cache.GetAccessTrace();
+	TEST_CHECK(trace.size() == accesses.size());
+	const char* fileName = "ResCacheTest_trace.txt";
+	TEST_CHECK(SaveResCacheTrace(fileName, trace));
+	std::vector<ResCacheAccess> loaded;
+	TEST_CHECK(LoadResCacheTrace(fileName, loaded));
+	std::remove(fileName);
+	TEST_CHECK(loaded.size() == trace.size());
+	for (size_t i = 0; i < loaded.size() && i < trace.size(); ++i)
+	{
+		if (loaded[i].m_Name != trace[i].m_Name || loaded[i].m_Size != trace[i].m_Size)
+		{
+			TEST_CHECK(!"trace changed on its way through the file");
+			break;
+		}
+	}
+
+	// replaying it through the cache's own policy and budget gives the same result
+	std::unique_ptr<IResCachePolicy> pPolicy(CreateResCachePolicy("LRU"));
+	ResCacheStats simulated = SimulateResCachePolicy(loaded, pPolicy.get(), budget);
+	TEST_CHECK(simulated.m_NumHits == live.m_NumHits);
+	TEST_CHECK(simulated.m_NumMisses == live.m_NumMisses);
+	TEST_CHECK(simulated.m_NumEvictions == live.m_NumEvictions);
+
+	TEST_CHECK(!CreateResCachePolicy("ARC"));
+	TEST_CHECK(!LoadResCacheTrace("ResCacheTest_missing.txt", loaded));
+}
+
+int main()
+{
+	RUN_TEST(TestConcurrentLoads);
+	RUN_TEST(TestGroupsTakeResidentResources);
+	RUN_TEST(TestFailedReadsGiveBackTheirMemory);
+	RUN_TEST(TestTraceReplaysLikeTheCache);
+	RUN_TEST(BenchZipfHits);
+	return TestExitCode();
+}
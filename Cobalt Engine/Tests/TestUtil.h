@@ -0,0 +1,62 @@
+/*
+	TestUtil.h
+
+	A minimal test harness shared by the engine tests. Each test is a
+	function run by RUN_TEST(), checks count failures instead of stopping
+	so a whole run reports everything that went wrong, and main() returns
+	TestExitCode() so ctest sees the result.
+*/
+
+#pragma once
+
+#include <cstdio>
+
+#include "HighResClock.h"
+
+/// Number of failed checks so far, shared by every file in a test program
+inline int& TestFailures()
+{
+	static int s_NumFailures = 0;
+	return s_NumFailures;
+}
+
+/// Record a failure if x is false
+#define TEST_CHECK(x) \
+	do \
+	{ \
+		if (!(x)) \
+		{ \
+			std::fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #x); \
+			++TestFailures(); \
+		} \
+	} \
+	while (0)
+
+/// Run a test function and print how long it took
+#define RUN_TEST(func) \
+	do \
+	{ \
+		int failuresBefore = TestFailures(); \
+		unsigned long long start = HighResClock::GetMicroseconds(); \
+		func(); \
+		double ms = (double)(HighResClock::GetMicroseconds() - start) / 1000.0; \
+		std::printf("%-48s %s (%.2fms)\n", #func, (TestFailures() == failuresBefore) ? "passed" : "FAILED", ms); \
+	} \
+	while (0)
+
+/// Print a benchmark result as operations per second
+inline void ReportThroughput(const char* name, unsigned long long operations, unsigned long long microseconds)
+{
+	double seconds = (double)microseconds / 1000000.0;
+	double perSecond = (seconds > 0.0) ? (double)operations / seconds : 0.0;
+	std::printf("  %-46s %12llu ops in %9.2fms  %14.0f ops/s\n", name, operations, (double)microseconds / 1000.0, perSecond);
+}
+
+/// Return the process exit code for the test run
+inline int TestExitCode()
+{
+	if (TestFailures() > 0)
+		std::printf("%d check(s) failed\n", TestFailures());
+
+	return (TestFailures() > 0) ? 1 : 0;
+}
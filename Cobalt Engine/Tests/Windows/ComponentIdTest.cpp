@@ -0,0 +1,108 @@
+/*
+	ComponentIdTest.cpp
+
+	Checks that the component ids hashed at startup match the names the
+	components report, and times the typed GetComponent<T>() against the
+	name-based lookup it replaced in the per-frame code.
+*/
+
+#include <EngineStd.h>
+#include <vector>
+
+#include <GameObject.h>
+#include <GameObjectFactory.h>
+#include <TransformComponent.h>
+
+#include "TestUtil.h"
+
+const int COMPONENTIDTEST_NUM_OBJECTS = 1000;
+const int COMPONENTIDTEST_NUM_PASSES = 1000;
+
+/// Build a row of objects that only have a transform
+static void CreateObjects(GameObjectFactory& factory, std::vector<StrongGameObjectPtr>& objects)
+{
+	TiXmlDocument objectTemplate;
+	objectTemplate.Parse("<GameObject type=\"Prop\"><TransformComponent><Position x=\"0\" y=\"0\" z=\"0\"/></TransformComponent></GameObject>");
+
+	objects.reserve(COMPONENTIDTEST_NUM_OBJECTS);
+	for (int i = 0; i < COMPONENTIDTEST_NUM_OBJECTS; ++i)
+	{
+		StrongGameObjectPtr pObject = factory.CreateGameObjectFromTemplate(objectTemplate.RootElement(), "test prop", nullptr, nullptr, INVALID_GAMEOBJECT_ID);
+		TEST_CHECK(pObject);
+		if (pObject)
+			objects.push_back(pObject);
+	}
+}
+
+static void DestroyObjects(std::vector<StrongGameObjectPtr>& objects)
+{
+	for (auto it = objects.begin(); it != objects.end(); ++it)
+		(*it)->Destroy();
+
+	objects.clear();
+}
+
+static void TestComponentIdsMatchNames()
+{
+	// building the factory runs the one-time check against the precomputed ids
+	GameObjectFactory factory;
+	std::vector<StrongGameObjectPtr> objects;
+	CreateObjects(factory, objects);
+
+	TEST_CHECK(TransformComponent::g_Id == Component::GetIdFromName(TransformComponent::g_Name));
+
+	for (auto it = objects.begin(); it != objects.end(); ++it)
+	{
+		shared_ptr<TransformComponent> pTyped = MakeStrongPtr((*it)->GetComponent<TransformComponent>());
+		shared_ptr<TransformComponent> pNamed = MakeStrongPtr((*it)->GetComponent<TransformComponent>(TransformComponent::g_Name));
+		TEST_CHECK(pTyped && pTyped == pNamed);
+		TEST_CHECK(pTyped && pTyped->GetId() == TransformComponent::g_Id);
+	}
+
+	DestroyObjects(objects);
+}
+
+static void BenchComponentLookup()
+{
+	GameObjectFactory factory;
+	std::vector<StrongGameObjectPtr> objects;
+	CreateObjects(factory, objects);
+
+	const unsigned long long numLookups = (unsigned long long)COMPONENTIDTEST_NUM_OBJECTS * COMPONENTIDTEST_NUM_PASSES;
+
+	// count the hits so the lookups can't be optimized away
+	unsigned long long typedHits = 0;
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (int pass = 0; pass < COMPONENTIDTEST_NUM_PASSES; ++pass)
+	{
+		for (auto it = objects.begin(); it != objects.end(); ++it)
+		{
+			if (!(*it)->GetComponent<TransformComponent>().expired())
+				++typedHits;
+		}
+	}
+	ReportThroughput("GetComponent<T>() by startup id", numLookups, HighResClock::GetMicroseconds() - start);
+
+	unsigned long long namedHits = 0;
+	start = HighResClock::GetMicroseconds();
+	for (int pass = 0; pass < COMPONENTIDTEST_NUM_PASSES; ++pass)
+	{
+		for (auto it = objects.begin(); it != objects.end(); ++it)
+		{
+			if (!(*it)->GetComponent<TransformComponent>(TransformComponent::g_Name).expired())
+				++namedHits;
+		}
+	}
+	ReportThroughput("GetComponent<T>(name) hashing per call", numLookups, HighResClock::GetMicroseconds() - start);
+
+	TEST_CHECK(typedHits == numLookups);
+	TEST_CHECK(namedHits == numLookups);
+
+	DestroyObjects(objects);
+}
+
+void RunComponentIdTests()
+{
+	RUN_TEST(TestComponentIdsMatchNames);
+	RUN_TEST(BenchComponentLookup);
+}
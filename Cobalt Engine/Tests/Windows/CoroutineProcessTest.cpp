@@ -0,0 +1,261 @@
+/*
+	CoroutineProcessTest.cpp
+
+	Checks what a coroutine does with whatever it is waiting on when it
+	ends early: aborting it aborts the awaited process and releases the
+	process's child, aborting or removing it waits for an awaited job, and
+	removing it lets go of the awaited process and stops listening for an
+	awaited event.
+*/
+
+#include <EngineStd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BaseEvent.h>
+#include <CoroutineProcess.h>
+#include <EventManager.h>
+#include <JobSystem.h>
+#include <ProcessManager.h>
+
+#include "TestUtil.h"
+
+// how long the test thread holds an awaited job before letting it finish
+const unsigned int COROUTINETEST_JOB_HOLD_MS = 50;
+
+// longest an awaited job waits for the test to let it finish
+const unsigned long long COROUTINETEST_JOB_TIMEOUT_US = 2000000;
+
+/// Event a coroutine awaits
+class CoroutineTestEvent : public BaseEvent
+{
+public:
+	virtual const EventType& GetEventType() const { return sk_EventType; }
+	virtual IEventPtr Copy() const { return IEventPtr(CB_NEW CoroutineTestEvent()); }
+	virtual const char* GetName() const { return "CoroutineTestEvent"; }
+
+public:
+	static const EventType sk_EventType;
+};
+
+const EventType CoroutineTestEvent::sk_EventType(0x7e57e201);
+
+/// Process that runs until it is stopped and logs its exit callbacks, ex. "awaited abort"
+class LoggingProcess : public Process
+{
+public:
+	LoggingProcess(const char* pName, std::vector<std::string>* pLog) : m_pName(pName), m_pLog(pLog) { }
+
+protected:
+	virtual void OnUpdate(float deltaTime) override { }
+	virtual void OnAbort() override { m_pLog->push_back(std::string(m_pName) + " abort"); }
+	virtual void OnRemove() override { m_pLog->push_back(std::string(m_pName) + " remove"); }
+
+private:
+	const char* m_pName;
+	std::vector<std::string>* m_pLog;
+};
+
+/// Coroutine that awaits a process with a child, a job, or an event
+class AwaitingCoroutine : public CoroutineProcess
+{
+public:
+	enum AwaitKind
+	{
+		Await_Process,
+		Await_Job,
+		Await_Event
+	};
+
+	AwaitingCoroutine(AwaitKind kind, std::vector<std::string>* pLog, const std::atomic<bool>* pJobGate = nullptr, std::atomic<bool>* pJobFinished = nullptr) :
+		m_Kind(kind), m_pLog(pLog), m_pJobGate(pJobGate), m_pJobFinished(pJobFinished) { }
+
+protected:
+	virtual void Run(float deltaTime) override
+	{
+		CB_CO_BEGIN
+		if (m_Kind == Await_Process)
+		{
+			m_pAwaited.reset(CB_NEW LoggingProcess("awaited", m_pLog));
+			m_pAwaited->AttachChild(StrongProcessPtr(CB_NEW LoggingProcess("child", m_pLog)));
+			CB_CO_AWAIT_PROCESS(m_pAwaited);
+		}
+		else if (m_Kind == Await_Job)
+		{
+			CB_CO_AWAIT_JOB(JobSystem::Get()->CreateJob([this]()
+			{
+				unsigned long long start = HighResClock::GetMicroseconds();
+				while (!*m_pJobGate && HighResClock::GetMicroseconds() - start < COROUTINETEST_JOB_TIMEOUT_US)
+				{
+					std::this_thread::yield();
+				}
+				*m_pJobFinished = true;
+			}));
+		}
+		else
+		{
+			CB_CO_AWAIT_EVENT(CoroutineTestEvent::sk_EventType);
+		}
+		m_pLog->push_back("coroutine resumed");
+		CB_CO_END
+	}
+
+	virtual void OnAbort() override
+	{
+		m_pLog->push_back("coroutine abort");
+		CoroutineProcess::OnAbort();
+	}
+
+	virtual void OnRemove() override
+	{
+		m_pLog->push_back("coroutine remove");
+		CoroutineProcess::OnRemove();
+	}
+
+public:
+	/// The awaited process, only held until the await starts so the coroutine is its only owner
+	StrongProcessPtr m_pAwaited;
+
+private:
+	AwaitKind m_Kind;
+	std::vector<std::string>* m_pLog;
+	const std::atomic<bool>* m_pJobGate;
+	std::atomic<bool>* m_pJobFinished;
+};
+
+/// Open a gate from another thread after a short while
+static std::thread OpenGateLater(std::atomic<bool>* pGate)
+{
+	return std::thread([pGate]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(COROUTINETEST_JOB_HOLD_MS));
+		*pGate = true;
+	});
+}
+
+/// Return true if the log holds the entries in this order, with anything in between
+static bool LogHasInOrder(const std::vector<std::string>& log, const char** ppEntries, size_t numEntries)
+{
+	size_t next = 0;
+	for (auto it = log.begin(); it != log.end() && next < numEntries; ++it)
+	{
+		if (*it == ppEntries[next])
+			++next;
+	}
+	return next == numEntries;
+}
+
+static void TestAbortingAbortsTheAwaitedProcess()
+{
+	std::vector<std::string> log;
+	ProcessManager processManager;
+	shared_ptr<AwaitingCoroutine> pCoroutine(CB_NEW AwaitingCoroutine(AwaitingCoroutine::Await_Process, &log));
+	ProcessHandle handle = processManager.AttachProcess(pCoroutine);
+
+	// the first update starts the await, the second runs the awaited process
+	processManager.UpdateProcesses(0.1f);
+	pCoroutine->m_pAwaited.reset();
+	processManager.UpdateProcesses(0.1f);
+	TEST_CHECK(log.empty());
+
+	TEST_CHECK(processManager.AbortProcess(handle));
+	processManager.UpdateProcesses(0.1f);
+
+	// the awaited process is aborted before it is let go, and letting it go aborts its child
+	const char* expected[] = { "coroutine abort", "awaited abort", "awaited remove", "child abort", "coroutine remove" };
+	TEST_CHECK(log.size() == 5 && LogHasInOrder(log, expected, 5));
+	TEST_CHECK(pCoroutine->GetAwaitedState() == Process::ABORTED);
+	TEST_CHECK(processManager.GetProcessCount() == 0);
+}
+
+static void TestAbortingWaitsForTheAwaitedJob()
+{
+	JobSystem jobSystem(2, true);
+	std::vector<std::string> log;
+	std::atomic<bool> gate(false);
+	std::atomic<bool> jobFinished(false);
+
+	ProcessManager processManager;
+	shared_ptr<AwaitingCoroutine> pCoroutine(CB_NEW AwaitingCoroutine(AwaitingCoroutine::Await_Job, &log, &gate, &jobFinished));
+	ProcessHandle handle = processManager.AttachProcess(pCoroutine);
+	processManager.UpdateProcesses(0.1f);
+	processManager.UpdateProcesses(0.1f);
+	TEST_CHECK(!jobFinished);
+
+	// the job may still use the coroutine, so the abort holds the update until the job is done
+	TEST_CHECK(processManager.AbortProcess(handle));
+	std::thread opener = OpenGateLater(&gate);
+	processManager.UpdateProcesses(0.1f);
+	TEST_CHECK(jobFinished);
+	opener.join();
+
+	const char* expected[] = { "coroutine abort", "coroutine remove" };
+	TEST_CHECK(log.size() == 2 && LogHasInOrder(log, expected, 2));
+	TEST_CHECK(processManager.GetProcessCount() == 0);
+}
+
+static void TestRemovingWhileAwaiting()
+{
+	JobSystem jobSystem(2, true);
+	EventManager eventManager("Coroutine Test", true);
+	eventManager.EnableStats(true);
+
+	// a manager torn down while the coroutine awaits a job waits for the job
+	{
+		std::vector<std::string> log;
+		std::atomic<bool> gate(false);
+		std::atomic<bool> jobFinished(false);
+		std::thread opener;
+		{
+			ProcessManager processManager;
+			processManager.AttachProcess(StrongProcessPtr(CB_NEW AwaitingCoroutine(AwaitingCoroutine::Await_Job, &log, &gate, &jobFinished)));
+			processManager.UpdateProcesses(0.1f);
+			opener = OpenGateLater(&gate);
+		}
+		TEST_CHECK(jobFinished);
+		opener.join();
+		TEST_CHECK(log.size() == 1 && log[0] == "coroutine remove");
+	}
+
+	// one torn down while it awaits a process lets go of the process the way the manager lets go of its own
+	{
+		std::vector<std::string> log;
+		{
+			ProcessManager processManager;
+			shared_ptr<AwaitingCoroutine> pCoroutine(CB_NEW AwaitingCoroutine(AwaitingCoroutine::Await_Process, &log));
+			processManager.AttachProcess(pCoroutine);
+			processManager.UpdateProcesses(0.1f);
+			pCoroutine->m_pAwaited.reset();
+			processManager.UpdateProcesses(0.1f);
+		}
+		const char* expected[] = { "coroutine remove", "awaited remove", "child abort" };
+		TEST_CHECK(log.size() == 3 && LogHasInOrder(log, expected, 3));
+	}
+
+	// one torn down while it awaits an event stops the manager listening for it
+	{
+		std::vector<std::string> log;
+		{
+			ProcessManager processManager;
+			processManager.AttachProcess(StrongProcessPtr(CB_NEW AwaitingCoroutine(AwaitingCoroutine::Await_Event, &log)));
+			processManager.UpdateProcesses(0.1f);
+			TEST_CHECK(processManager.GetSleepingProcessCount() == 1);
+			eventManager.QueueEvent(IEventPtr(CB_NEW CoroutineTestEvent()));
+			eventManager.AbortEvent(CoroutineTestEvent::sk_EventType);
+		}
+
+		EventTypeStats stats;
+		TEST_CHECK(eventManager.GetEventStats(CoroutineTestEvent::sk_EventType, stats) && stats.m_NumListeners == 0);
+		TEST_CHECK(log.size() == 1 && log[0] == "coroutine remove");
+	}
+}
+
+void RunCoroutineProcessTests()
+{
+	RUN_TEST(TestAbortingAbortsTheAwaitedProcess);
+	RUN_TEST(TestAbortingWaitsForTheAwaitedJob);
+	RUN_TEST(TestRemovingWhileAwaiting);
+}
@@ -0,0 +1,235 @@
+/*
+	EventJournalTest.cpp
+
+	Records a session of game code moving objects around with the logic's
+	random generator, replays the journal into a fresh logic and checks the
+	transforms come out the same, then checks that a logic that starts out
+	different is reported as a desync. The benchmark times the same frames
+	with and without recording.
+*/
+
+#include <EngineStd.h>
+#include <cstdio>
+#include <vector>
+
+#include <BaseGameLogic.h>
+#include <EventJournal.h>
+#include <EventManager.h>
+#include <EventPool.h>
+#include <Events.h>
+#include <GameObject.h>
+#include <LuaStateManager.h>
+#include <TransformComponent.h>
+
+#include "TestUtil.h"
+
+const char* JOURNALTEST_FILE = "EventJournalTest.cbj";
+const char* JOURNALTEST_OBJECT_RESOURCE = "gameobjects\\light.xml";
+const float JOURNALTEST_FRAME_SECONDS = 1.0f / 60.0f;
+
+// recorded session, long enough for several checksums
+const unsigned int JOURNALTEST_NUM_OBJECTS = 100;
+const unsigned int JOURNALTEST_NUM_FRAMES = 300;
+const unsigned int JOURNALTEST_MOVES_PER_FRAME = 20;
+
+// recording overhead benchmark
+const unsigned int JOURNALTEST_BENCH_NUM_OBJECTS = 1000;
+const unsigned int JOURNALTEST_BENCH_NUM_FRAMES = 600;
+const unsigned int JOURNALTEST_BENCH_MOVES_PER_FRAME = 1000;
+
+/// Game logic that is always running and applies move events to the objects' transforms
+class JournalTestLogic : public BaseGameLogic
+{
+public:
+	JournalTestLogic()
+	{
+		Init();
+		m_State = BaseGameState::Running;
+		IEventManager::Get()->AddListener(fastdelegate::MakeDelegate(this, &JournalTestLogic::MoveGameObjectDelegate), Event_MoveGameObject::sk_EventType);
+	}
+
+	virtual ~JournalTestLogic()
+	{
+		IEventManager::Get()->RemoveListener(fastdelegate::MakeDelegate(this, &JournalTestLogic::MoveGameObjectDelegate), Event_MoveGameObject::sk_EventType);
+	}
+
+	virtual void MoveGameObject(const GameObjectId id, const Mat4x4& mat) override
+	{
+		StrongGameObjectPtr pObject = MakeStrongPtr(GetGameObject(id));
+		if (!pObject)
+			return;
+
+		shared_ptr<TransformComponent> pTransformComponent = MakeStrongPtr(pObject->GetComponent<TransformComponent>());
+		if (pTransformComponent)
+			pTransformComponent->SetTransform(mat);
+	}
+
+	/// Create the objects, their ids start at 1 in every logic
+	void CreateObjects(unsigned int numObjects)
+	{
+		for (unsigned int i = 0; i < numObjects; ++i)
+			CreateGameObject(JOURNALTEST_OBJECT_RESOURCE, nullptr);
+	}
+
+	size_t GetNumObjects() const { return m_Objects.size(); }
+};
+
+/// Play one frame: the event manager and logic update, then game code moves random objects to random spots
+static void PlayFrame(JournalTestLogic& logic, EventJournal* pJournal, float& time, unsigned int numMoves)
+{
+	float deltaTime = JOURNALTEST_FRAME_SECONDS;
+	time += deltaTime;
+	if (pJournal)
+		pJournal->BeginFrame(time, deltaTime);
+
+	IEventManager::Get()->Update();
+	logic.OnUpdate(time, deltaTime);
+
+	RandomGenerator& random = logic.GetRNG();
+	for (unsigned int i = 0; i < numMoves; ++i)
+	{
+		GameObjectId id = (GameObjectId)(random.Random((unsigned int)logic.GetNumObjects()) + 1);
+		Mat4x4 transform = Mat4x4::Identity;
+		transform.SetPosition(Vec3(random.Random() * 100.0f, random.Random() * 10.0f, random.Random() * 100.0f));
+		IEventManager::Get()->QueueEvent(MakePooledEvent<Event_MoveGameObject>(id, transform));
+	}
+
+	if (pJournal)
+		pJournal->EndFrame();
+}
+
+static void TestReplayMatchesRecording()
+{
+	EventManager eventManager("Journal Test", true);
+	REGISTER_EVENT(Event_MoveGameObject);
+	TEST_CHECK(LuaStateManager::Create());
+
+	unsigned int recordedChecksum = 0;
+	{
+		JournalTestLogic logic;
+		g_pApp->m_pGame = &logic;
+		logic.CreateObjects(JOURNALTEST_NUM_OBJECTS);
+		unsigned int startChecksum = logic.GetTransformChecksum();
+
+		EventJournal journal;
+		TEST_CHECK(journal.StartRecording(JOURNALTEST_FILE, &logic));
+		eventManager.SetJournal(&journal);
+
+		float time = 0.0f;
+		for (unsigned int frame = 0; frame < JOURNALTEST_NUM_FRAMES; ++frame)
+			PlayFrame(logic, &journal, time, JOURNALTEST_MOVES_PER_FRAME);
+
+		journal.Stop();
+		eventManager.SetJournal(nullptr);
+		recordedChecksum = logic.GetTransformChecksum();
+		TEST_CHECK(recordedChecksum != startChecksum);
+
+		// drop the moves still queued from the last frame, the replay leaves the same ones queued
+		eventManager.AbortEvent(Event_MoveGameObject::sk_EventType, true);
+		g_pApp->m_pGame = nullptr;
+	}
+
+	// a fresh logic with the same objects ends up with the same transforms without running any game code
+	{
+		JournalTestLogic logic;
+		g_pApp->m_pGame = &logic;
+		logic.CreateObjects(JOURNALTEST_NUM_OBJECTS);
+
+		EventJournal journal;
+		eventManager.SetJournal(&journal);
+		TEST_CHECK(journal.StartReplay(JOURNALTEST_FILE, &logic));
+		TEST_CHECK(journal.ReplayAll());
+		TEST_CHECK(journal.GetNumChecksumMismatches() == 0);
+		TEST_CHECK(logic.GetTransformChecksum() == recordedChecksum);
+
+		eventManager.SetJournal(nullptr);
+		eventManager.AbortEvent(Event_MoveGameObject::sk_EventType, true);
+		g_pApp->m_pGame = nullptr;
+	}
+
+	// a logic missing an object can't reach the recorded transforms, so every checksum reports a desync
+	{
+		JournalTestLogic logic;
+		g_pApp->m_pGame = &logic;
+		logic.CreateObjects(JOURNALTEST_NUM_OBJECTS - 1);
+
+		EventJournal journal;
+		eventManager.SetJournal(&journal);
+		TEST_CHECK(journal.StartReplay(JOURNALTEST_FILE, &logic));
+		TEST_CHECK(!journal.ReplayAll());
+		TEST_CHECK(journal.GetNumChecksumMismatches() == JOURNALTEST_NUM_FRAMES / EVENTJOURNAL_CHECKSUM_INTERVAL + 1);
+
+		eventManager.SetJournal(nullptr);
+		eventManager.AbortEvent(Event_MoveGameObject::sk_EventType, true);
+		g_pApp->m_pGame = nullptr;
+	}
+
+	std::remove(JOURNALTEST_FILE);
+	LuaStateManager::Destroy();
+}
+
+/// Play the benchmark frames, recording them if a journal is given, and return how long they took
+static unsigned long long TimeFrames(EventManager& eventManager, EventJournal* pJournal)
+{
+	JournalTestLogic logic;
+	g_pApp->m_pGame = &logic;
+	logic.CreateObjects(JOURNALTEST_BENCH_NUM_OBJECTS);
+
+	if (pJournal)
+	{
+		TEST_CHECK(pJournal->StartRecording(JOURNALTEST_FILE, &logic));
+		eventManager.SetJournal(pJournal);
+	}
+
+	float time = 0.0f;
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (unsigned int frame = 0; frame < JOURNALTEST_BENCH_NUM_FRAMES; ++frame)
+		PlayFrame(logic, pJournal, time, JOURNALTEST_BENCH_MOVES_PER_FRAME);
+	if (pJournal)
+		pJournal->Stop();
+	unsigned long long microseconds = HighResClock::GetMicroseconds() - start;
+
+	eventManager.SetJournal(nullptr);
+	eventManager.AbortEvent(Event_MoveGameObject::sk_EventType, true);
+	g_pApp->m_pGame = nullptr;
+	return microseconds;
+}
+
+static void BenchRecordingOverhead()
+{
+	EventManager eventManager("Journal Test", true);
+	TEST_CHECK(LuaStateManager::Create());
+
+	// the first run warms up the event pools so both timed runs start from the same place
+	TimeFrames(eventManager, nullptr);
+	unsigned long long plainMicroseconds = TimeFrames(eventManager, nullptr);
+
+	EventJournal journal;
+	unsigned long long recordingMicroseconds = TimeFrames(eventManager, &journal);
+
+	long journalSize = 0;
+	FILE* pFile = nullptr;
+	fopen_s(&pFile, JOURNALTEST_FILE, "rb");
+	if (pFile)
+	{
+		std::fseek(pFile, 0, SEEK_END);
+		journalSize = std::ftell(pFile);
+		std::fclose(pFile);
+	}
+	std::remove(JOURNALTEST_FILE);
+
+	unsigned int numEvents = JOURNALTEST_BENCH_NUM_FRAMES * JOURNALTEST_BENCH_MOVES_PER_FRAME;
+	std::printf("  %u frames of %u moves: %.2fms without recording, %.2fms recording, %.1f%% overhead\n",
+		JOURNALTEST_BENCH_NUM_FRAMES, JOURNALTEST_BENCH_MOVES_PER_FRAME, (double)plainMicroseconds / 1000.0, (double)recordingMicroseconds / 1000.0,
+		plainMicroseconds ? 100.0 * ((double)recordingMicroseconds - (double)plainMicroseconds) / (double)plainMicroseconds : 0.0);
+	std::printf("  journal is %ld bytes, %.1f bytes per event\n", journalSize, (double)journalSize / (double)numEvents);
+
+	TEST_CHECK(journalSize > 0);
+	LuaStateManager::Destroy();
+}
+
+void RunEventJournalTests()
+{
+	RUN_TEST(TestReplayMatchesRecording);
+	RUN_TEST(BenchRecordingOverhead);
+}
@@ -0,0 +1,491 @@
+/*
+	EventManagerTest.cpp
+
+	Tests for event dispatch: listeners added and removed while an event is
+	being dispatched, coalescing, including events deferred to the next
+	update, priority lanes and deferral, and the concurrent batch staying
+	inside the update's deadline without running main thread jobs while it
+	waits. One benchmark dispatches 1M events across 10k listeners stored
+	the way the event manager used to store them, in a std::list per type,
+	and the way it does now, in an array per type. Another compares queue
+	length and dispatch time with and without coalescing when every object
+	moves several times a tick.
+*/
+
+#include <EngineStd.h>
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <BaseEvent.h>
+#include <EventManager.h>
+#include <JobSystem.h>
+#include <StringUtil.h>
+
+#include "TestUtil.h"
+
+// listener table benchmark, the listeners are spread evenly over the event types
+const unsigned int EVENTTEST_BENCH_NUM_DISPATCHES = 1000000;
+const unsigned int EVENTTEST_BENCH_NUM_LISTENERS = 10000;
+const unsigned int EVENTTEST_BENCH_NUM_TYPES = 100;
+
+// coalescing benchmark, every object moves several times a tick the way a physics step can report it
+const unsigned int EVENTTEST_BENCH_NUM_OBJECTS = 1000;
+const unsigned int EVENTTEST_BENCH_MOVES_PER_TICK = 4;
+const unsigned int EVENTTEST_BENCH_NUM_TICKS = 60;
+
+// events queued for the concurrent batch tests
+const unsigned int EVENTTEST_NUM_BATCH_EVENTS = 200;
+
+// time each concurrent listener call takes in the deadline test
+const unsigned int EVENTTEST_LISTENER_MICROSECONDS = 500;
+
+// deadline for the update that has to defer some of the batch
+const unsigned long EVENTTEST_DEADLINE_MILLIS = 5;
+
+/// Event with a key, ex. the object it is about, and a value, ex. its position. The type can be changed to test several types at once
+class TestEvent : public BaseEvent
+{
+public:
+	explicit TestEvent(unsigned int key = 0, unsigned int value = 0, EventType type = sk_EventType) : m_Key(key), m_Value(value), m_Type(type) { }
+
+	virtual const EventType& GetEventType() const { return m_Type; }
+	virtual IEventPtr Copy() const { return IEventPtr(CB_NEW TestEvent(m_Key, m_Value, m_Type)); }
+	virtual const char* GetName() const { return "TestEvent"; }
+
+	unsigned int GetKey() const { return m_Key; }
+	unsigned int GetValue() const { return m_Value; }
+
+public:
+	static const EventType sk_EventType;
+
+private:
+	unsigned int m_Key;
+	unsigned int m_Value;
+	EventType m_Type;
+};
+
+const EventType TestEvent::sk_EventType(0x7e57e001);
+
+// more event types for the lane tests
+const EventType EVENTTEST_CRITICAL_TYPE = 0x7e57e002;
+const EventType EVENTTEST_COSMETIC_TYPE = 0x7e57e003;
+
+/// Coalesce key function for test events
+static unsigned int GetTestEventKey(const IEventPtr& pEvent)
+{
+	return static_pointer_cast<TestEvent>(pEvent)->GetKey();
+}
+
+/// Records every event it hears, and can take a while over each one
+class RecordingListener
+{
+public:
+	RecordingListener() : m_Microseconds(0) { }
+
+	void OnEvent(IEventPtr pEvent)
+	{
+		m_Events.push_back(static_pointer_cast<TestEvent>(pEvent));
+
+		unsigned long long start = HighResClock::GetMicroseconds();
+		while (HighResClock::GetMicroseconds() - start < m_Microseconds) { }
+	}
+
+	/// Return the type, key and value of each event as a string, ex. "2:1=3 2:4=0"
+	std::string GetLog() const
+	{
+		std::string log;
+		for (auto it = m_Events.begin(); it != m_Events.end(); ++it)
+		{
+			if (!log.empty())
+				log += " ";
+			log += ToStr((unsigned long)((*it)->GetEventType() & 0xf)) + ":" + ToStr((*it)->GetKey()) + "=" + ToStr((*it)->GetValue());
+		}
+		return log;
+	}
+
+	unsigned long long m_Microseconds;
+	std::vector<shared_ptr<TestEvent> > m_Events;
+};
+
+/// Concurrent safe listener that takes a while and checks no main thread job ran while it was called
+class SlowListener
+{
+public:
+	SlowListener(const std::atomic<bool>* pMainThreadJobRan, unsigned int microseconds) :
+		m_pMainThreadJobRan(pMainThreadJobRan), m_Microseconds(microseconds), m_NumEvents(0), m_NumInterleaved(0) { }
+
+	void OnEvent(IEventPtr pEvent)
+	{
+		if (m_pMainThreadJobRan && *m_pMainThreadJobRan)
+			m_NumInterleaved.fetch_add(1);
+
+		// spin rather than sleep, a sleep can take a whole scheduler tick
+		unsigned long long start = HighResClock::GetMicroseconds();
+		while (HighResClock::GetMicroseconds() - start < m_Microseconds) { }
+		m_NumEvents.fetch_add(1);
+	}
+
+	const std::atomic<bool>* m_pMainThreadJobRan;
+	unsigned int m_Microseconds;
+	std::atomic<unsigned int> m_NumEvents;
+	std::atomic<unsigned int> m_NumInterleaved;
+};
+
+/// Listener that counts its events and can add or remove listeners while it is called
+class CountingListener
+{
+public:
+	CountingListener() : m_pEventManager(nullptr), m_pRemove(nullptr), m_pAdd(nullptr), m_NumEvents(0) { }
+
+	EventListenerDelegate GetDelegate() { return fastdelegate::MakeDelegate(this, &CountingListener::OnEvent); }
+
+	void OnEvent(IEventPtr pEvent)
+	{
+		++m_NumEvents;
+		if (m_pRemove)
+		{
+			m_pEventManager->RemoveListener(m_pRemove->GetDelegate(), pEvent->GetEventType());
+			m_pRemove = nullptr;
+		}
+		if (m_pAdd)
+		{
+			m_pEventManager->AddListener(m_pAdd->GetDelegate(), pEvent->GetEventType());
+			m_pAdd = nullptr;
+		}
+	}
+
+	EventManager* m_pEventManager;
+	CountingListener* m_pRemove;
+	CountingListener* m_pAdd;
+	unsigned long m_NumEvents;
+};
+
+static void TestListenersChangedDuringDispatch()
+{
+	EventManager eventManager("Event Test", true);
+	CountingListener listeners[4];
+	for (int i = 0; i < 3; ++i)
+	{
+		listeners[i].m_pEventManager = &eventManager;
+		TEST_CHECK(eventManager.AddListener(listeners[i].GetDelegate(), TestEvent::sk_EventType));
+	}
+
+	// the first listener removes the next one and adds a fourth, which can reallocate the array mid dispatch
+	listeners[0].m_pRemove = &listeners[1];
+	listeners[0].m_pAdd = &listeners[3];
+	TEST_CHECK(eventManager.TriggerEvent(IEventPtr(CB_NEW TestEvent)));
+	TEST_CHECK(listeners[0].m_NumEvents == 1);
+	TEST_CHECK(listeners[1].m_NumEvents == 0);
+	TEST_CHECK(listeners[2].m_NumEvents == 1);
+	TEST_CHECK(listeners[3].m_NumEvents == 0);
+
+	// the removed listener's slot is compacted out on the next update, the added one hears the next event
+	TEST_CHECK(eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent)));
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listeners[0].m_NumEvents == 2);
+	TEST_CHECK(listeners[1].m_NumEvents == 0);
+	TEST_CHECK(listeners[2].m_NumEvents == 2);
+	TEST_CHECK(listeners[3].m_NumEvents == 1);
+
+	TEST_CHECK(!eventManager.RemoveListener(listeners[1].GetDelegate(), TestEvent::sk_EventType));
+	TEST_CHECK(eventManager.RemoveListener(listeners[3].GetDelegate(), TestEvent::sk_EventType));
+}
+
+/// Send every dispatch to the listeners of one type in a table, the loop body the event manager runs
+template<class ListenerTable>
+static unsigned long long DispatchToTable(const std::unordered_map<EventType, ListenerTable>& table, bool copyDelegates)
+{
+	IEventPtr pEvent(CB_NEW TestEvent);
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (unsigned int i = 0; i < EVENTTEST_BENCH_NUM_DISPATCHES; ++i)
+	{
+		auto findIt = table.find((EventType)(i % EVENTTEST_BENCH_NUM_TYPES));
+		if (findIt == table.end())
+			continue;
+
+		for (auto it = findIt->second.begin(); it != findIt->second.end(); ++it)
+		{
+			if (copyDelegates)
+			{
+				EventListenerDelegate listener = (*it);
+				listener(pEvent);
+			}
+			else if (!it->empty())
+			{
+				(*it)(pEvent);
+			}
+		}
+	}
+	return HighResClock::GetMicroseconds() - start;
+}
+
+static void BenchListenerTables()
+{
+	std::vector<CountingListener> listeners(EVENTTEST_BENCH_NUM_LISTENERS);
+	std::unordered_map<EventType, std::list<EventListenerDelegate> > listTable;
+	std::unordered_map<EventType, std::vector<EventListenerDelegate> > arrayTable;
+	for (unsigned int i = 0; i < EVENTTEST_BENCH_NUM_LISTENERS; ++i)
+	{
+		EventType type = (EventType)(i % EVENTTEST_BENCH_NUM_TYPES);
+		listTable[type].push_back(listeners[i].GetDelegate());
+		arrayTable[type].push_back(listeners[i].GetDelegate());
+	}
+
+	unsigned long long numCalls = (unsigned long long)EVENTTEST_BENCH_NUM_DISPATCHES * (EVENTTEST_BENCH_NUM_LISTENERS / EVENTTEST_BENCH_NUM_TYPES);
+	ReportThroughput("std::list per type, copying each delegate", numCalls, DispatchToTable(listTable, true));
+	ReportThroughput("array per type, called in place", numCalls, DispatchToTable(arrayTable, false));
+
+	// both runs reach every listener equally often
+	unsigned long expected = 2 * EVENTTEST_BENCH_NUM_DISPATCHES / EVENTTEST_BENCH_NUM_TYPES;
+	for (auto it = listeners.begin(); it != listeners.end(); ++it)
+		TEST_CHECK(it->m_NumEvents == expected);
+}
+
+static void TestCoalescing()
+{
+	EventManager eventManager("Event Test", true);
+	RecordingListener listener;
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &RecordingListener::OnEvent), TestEvent::sk_EventType);
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &RecordingListener::OnEvent), EVENTTEST_COSMETIC_TYPE);
+	eventManager.SetCoalescePolicy(TestEvent::sk_EventType, GetTestEventKey);
+
+	// the latest event for each key takes the place of the first one queued, other types are left alone
+	for (unsigned int value = 0; value < 3; ++value)
+	{
+		for (unsigned int key = 0; key < 2; ++key)
+		{
+			eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(key, value)));
+			eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(key, value, EVENTTEST_COSMETIC_TYPE)));
+		}
+	}
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "1:0=2 3:0=0 1:1=2 3:1=0 3:0=1 3:1=1 3:0=2 3:1=2");
+	TEST_CHECK(eventManager.GetNumCoalescedEvents() == 4);
+
+	// an aborted event is forgotten, so the next one for its key is queued on its own
+	listener.m_Events.clear();
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 5)));
+	TEST_CHECK(eventManager.AbortEvent(TestEvent::sk_EventType));
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 6)));
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 7)));
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "1:0=7");
+
+	// without the policy every event is delivered
+	listener.m_Events.clear();
+	eventManager.RemoveCoalescePolicy(TestEvent::sk_EventType);
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 8)));
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 9)));
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "1:0=8 1:0=9");
+	TEST_CHECK(eventManager.GetNumCoalescedEvents() == 5);
+}
+
+static void TestLanes()
+{
+	EventManager eventManager("Event Test", true);
+	eventManager.SetEventLane(EVENTTEST_CRITICAL_TYPE, EventLane_Critical);
+	eventManager.SetEventLane(EVENTTEST_COSMETIC_TYPE, EventLane_Cosmetic);
+	TEST_CHECK(eventManager.GetEventLane(TestEvent::sk_EventType) == EventLane_Normal);
+
+	RecordingListener listener;
+	const EventType types[] = { EVENTTEST_COSMETIC_TYPE, TestEvent::sk_EventType, EVENTTEST_CRITICAL_TYPE };
+	for (int i = 0; i < 3; ++i)
+		eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &RecordingListener::OnEvent), types[i]);
+
+	// each lane runs in priority order, and in queue order within the lane
+	for (unsigned int value = 0; value < 2; ++value)
+	{
+		for (int i = 0; i < 3; ++i)
+			eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, value, types[i])));
+	}
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "2:0=0 2:0=1 1:0=0 1:0=1 3:0=0 3:0=1");
+
+	const EventLaneReport& report = eventManager.GetLastUpdateReport();
+	for (int lane = 0; lane < EventLane_Count; ++lane)
+	{
+		TEST_CHECK(report.m_NumProcessed[lane] == 2);
+		TEST_CHECK(report.m_NumDeferred[lane] == 0);
+	}
+
+	// when the deadline passes the rest wait, ahead of anything queued in the meantime
+	listener.m_Events.clear();
+	listener.m_Microseconds = 2000;
+	for (unsigned int value = 0; value < 3; ++value)
+	{
+		eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, value, EVENTTEST_CRITICAL_TYPE)));
+		eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, value, EVENTTEST_COSMETIC_TYPE)));
+	}
+	TEST_CHECK(!eventManager.Update(1));
+	TEST_CHECK(listener.GetLog() == "2:0=0");
+	TEST_CHECK(report.m_NumProcessed[EventLane_Critical] == 1 && report.m_NumDeferred[EventLane_Critical] == 2);
+	TEST_CHECK(report.m_NumProcessed[EventLane_Cosmetic] == 0 && report.m_NumDeferred[EventLane_Cosmetic] == 3);
+
+	listener.m_Microseconds = 0;
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 3, EVENTTEST_COSMETIC_TYPE)));
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "2:0=0 2:0=1 2:0=2 3:0=0 3:0=1 3:0=2 3:0=3");
+}
+
+/// Takes a while over each event and queues another event while it is being dispatched
+class QueueingListener
+{
+public:
+	QueueingListener(EventManager* pEventManager, const IEventPtr& pEventToQueue, unsigned long long microseconds) :
+		m_pEventManager(pEventManager), m_pEventToQueue(pEventToQueue), m_Microseconds(microseconds) { }
+
+	void OnEvent(IEventPtr pEvent)
+	{
+		unsigned long long start = HighResClock::GetMicroseconds();
+		while (HighResClock::GetMicroseconds() - start < m_Microseconds) { }
+
+		m_pEventManager->QueueEvent(m_pEventToQueue);
+	}
+
+private:
+	EventManager* m_pEventManager;
+	IEventPtr m_pEventToQueue;
+	unsigned long long m_Microseconds;
+};
+
+static void TestDeferredEventsCoalesce()
+{
+	EventManager eventManager("Event Test", true);
+	eventManager.SetEventLane(EVENTTEST_CRITICAL_TYPE, EventLane_Critical);
+	eventManager.SetCoalescePolicy(TestEvent::sk_EventType, GetTestEventKey);
+
+	RecordingListener listener;
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &RecordingListener::OnEvent), TestEvent::sk_EventType);
+	QueueingListener slowListener(&eventManager, IEventPtr(CB_NEW TestEvent(1, 9)), 2000);
+	eventManager.AddListener(fastdelegate::MakeDelegate(&slowListener, &QueueingListener::OnEvent), EVENTTEST_CRITICAL_TYPE);
+
+	// the critical event runs past the deadline, so the normal lane is deferred behind the event it queued for key 1
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 0)));
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(1, 0)));
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 0, EVENTTEST_CRITICAL_TYPE)));
+	TEST_CHECK(!eventManager.Update(1));
+	TEST_CHECK(eventManager.GetLastUpdateReport().m_NumDeferred[EventLane_Normal] == 2);
+	TEST_CHECK(listener.m_Events.empty());
+
+	// the deferred events are merged with the one queued during dispatch and with ones queued after the update
+	eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(0, 7)));
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.GetLog() == "1:0=7 1:1=9");
+	TEST_CHECK(eventManager.GetNumCoalescedEvents() == 2);
+}
+
+/// Queue and dispatch every object's moves for a number of ticks, returning the events dispatched
+static unsigned long RunMoveTicks(bool coalesce, unsigned long long& microseconds)
+{
+	EventManager eventManager("Event Test", true);
+	RecordingListener listener;
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &RecordingListener::OnEvent), TestEvent::sk_EventType);
+	if (coalesce)
+		eventManager.SetCoalescePolicy(TestEvent::sk_EventType, GetTestEventKey);
+
+	unsigned long numDispatched = 0;
+	unsigned long long start = HighResClock::GetMicroseconds();
+	for (unsigned int tick = 0; tick < EVENTTEST_BENCH_NUM_TICKS; ++tick)
+	{
+		for (unsigned int move = 0; move < EVENTTEST_BENCH_MOVES_PER_TICK; ++move)
+		{
+			for (unsigned int object = 0; object < EVENTTEST_BENCH_NUM_OBJECTS; ++object)
+				eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(object, move)));
+		}
+
+		eventManager.Update();
+		numDispatched += eventManager.GetLastUpdateReport().m_NumProcessed[EventLane_Normal];
+		listener.m_Events.clear();
+	}
+	microseconds = HighResClock::GetMicroseconds() - start;
+	return numDispatched;
+}
+
+static void BenchCoalescing()
+{
+	unsigned long long plainMicroseconds = 0;
+	unsigned long long coalescedMicroseconds = 0;
+	unsigned long plainDispatched = RunMoveTicks(false, plainMicroseconds);
+	unsigned long coalescedDispatched = RunMoveTicks(true, coalescedMicroseconds);
+
+	std::printf("  %u objects moving %u times a tick for %u ticks:\n", EVENTTEST_BENCH_NUM_OBJECTS, EVENTTEST_BENCH_MOVES_PER_TICK, EVENTTEST_BENCH_NUM_TICKS);
+	std::printf("    without coalescing %lu events a tick, %.2fms\n", plainDispatched / EVENTTEST_BENCH_NUM_TICKS, (double)plainMicroseconds / 1000.0);
+	std::printf("    with coalescing    %lu events a tick, %.2fms\n", coalescedDispatched / EVENTTEST_BENCH_NUM_TICKS, (double)coalescedMicroseconds / 1000.0);
+
+	TEST_CHECK(plainDispatched == EVENTTEST_BENCH_NUM_OBJECTS * EVENTTEST_BENCH_MOVES_PER_TICK * EVENTTEST_BENCH_NUM_TICKS);
+	TEST_CHECK(coalescedDispatched == EVENTTEST_BENCH_NUM_OBJECTS * EVENTTEST_BENCH_NUM_TICKS);
+}
+
+static void TestConcurrentBatchSkipsMainThreadJobs()
+{
+	JobSystem jobSystem(2, true);
+	EventManager eventManager("Event Test", true);
+	eventManager.SetJobSystem(&jobSystem);
+
+	// ex. a resource load's completion, which has to wait for the frame's RunMainThreadJobs()
+	std::atomic<bool> mainThreadJobRan(false);
+	jobSystem.Run(jobSystem.CreateJob([&mainThreadJobRan]() { mainThreadJobRan = true; }, JobAffinity_MainThread));
+
+	SlowListener listener(&mainThreadJobRan, 10);
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &SlowListener::OnEvent), TestEvent::sk_EventType, true);
+	for (unsigned int i = 0; i < EVENTTEST_NUM_BATCH_EVENTS; ++i)
+		eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(i)));
+
+	TEST_CHECK(eventManager.Update());
+	TEST_CHECK(listener.m_NumEvents.load() == EVENTTEST_NUM_BATCH_EVENTS);
+	TEST_CHECK(listener.m_NumInterleaved.load() == 0);
+	TEST_CHECK(!mainThreadJobRan);
+
+	jobSystem.RunMainThreadJobs();
+	TEST_CHECK(mainThreadJobRan);
+}
+
+static void TestConcurrentBatchCountsAgainstDeadline()
+{
+	JobSystem jobSystem(2, true);
+	EventManager eventManager("Event Test", true);
+	eventManager.SetJobSystem(&jobSystem);
+
+	SlowListener listener(nullptr, EVENTTEST_LISTENER_MICROSECONDS);
+	eventManager.AddListener(fastdelegate::MakeDelegate(&listener, &SlowListener::OnEvent), TestEvent::sk_EventType, true);
+
+	// a first batch without a deadline times the listener
+	for (unsigned int i = 0; i < 8; ++i)
+		eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(i)));
+	TEST_CHECK(eventManager.Update());
+
+	// every event goes to the batch, so only the batch's expected time can stop the update
+	for (unsigned int i = 0; i < EVENTTEST_NUM_BATCH_EVENTS; ++i)
+		eventManager.QueueEvent(IEventPtr(CB_NEW TestEvent(i)));
+
+	unsigned long long start = HighResClock::GetMicroseconds();
+	bool flushed = eventManager.Update(EVENTTEST_DEADLINE_MILLIS);
+	double ms = (double)(HighResClock::GetMicroseconds() - start) / 1000.0;
+
+	const EventLaneReport& report = eventManager.GetLastUpdateReport();
+	std::printf("  %u events with a %lums deadline: %u dispatched, %u deferred in %.2fms\n", EVENTTEST_NUM_BATCH_EVENTS, EVENTTEST_DEADLINE_MILLIS,
+		report.m_NumProcessed[EventLane_Normal], report.m_NumDeferred[EventLane_Normal], ms);
+
+	TEST_CHECK(!flushed);
+	TEST_CHECK(report.m_NumDeferred[EventLane_Normal] > 0);
+	TEST_CHECK(report.m_NumProcessed[EventLane_Normal] + report.m_NumDeferred[EventLane_Normal] == EVENTTEST_NUM_BATCH_EVENTS);
+
+	// the rest go out over the next updates
+	while (!eventManager.Update(EVENTTEST_DEADLINE_MILLIS)) { }
+	TEST_CHECK(listener.m_NumEvents.load() == 8 + EVENTTEST_NUM_BATCH_EVENTS);
+}
+
+void RunEventManagerTests()
+{
+	RUN_TEST(TestListenersChangedDuringDispatch);
+	RUN_TEST(TestCoalescing);
+	RUN_TEST(TestLanes);
+	RUN_TEST(TestDeferredEventsCoalesce);
+	RUN_TEST(TestConcurrentBatchSkipsMainThreadJobs);
+	RUN_TEST(TestConcurrentBatchCountsAgainstDeadline);
+	RUN_TEST(BenchListenerTables);
+	RUN_TEST(BenchCoalescing);
+}
@@ -0,0 +1,293 @@
+/*
+	EventStreamTest.cpp
+
+	Round trip tests for the binary event serialization of every event in
+	Events.h, NetworkEvents.h, PhysicsEvents.h and the game's GameEvents.h,
+	plus the text format for the events that still support it. The
+	benchmark prints the encoded size and encode/decode time of each event
+	in both formats.
+
+	Event_UpdateTick is left out, it refuses to be serialized.
+*/
+
+#include <EngineStd.h>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <Events.h>
+#include <EventStream.h>
+#include <NetworkEvents.h>
+#include <PhysicsEvents.h>
+#include <GameEvents.h>
+
+#include "TestUtil.h"
+
+// number of times each event is encoded and decoded by the benchmark
+const int EVENTSTREAMTEST_BENCH_ITERATIONS = 100000;
+
+/// Record a failure for an event
+static void CheckEvent(bool passed, const IEvent& event, const char* what)
+{
+	if (!passed)
+	{
+		std::fprintf(stderr, "%s: %s\n", event.GetName(), what);
+		++TestFailures();
+	}
+}
+
+/// Return true if two streams hold the same bytes
+static bool SameBytes(const EventWriteStream& a, const EventWriteStream& b)
+{
+	return a.GetSize() == b.GetSize() && (a.GetSize() == 0 || memcmp(a.GetData(), b.GetData(), a.GetSize()) == 0);
+}
+
+/// Decode the binary encoding of an event into a default constructed event and check it encodes to the same bytes
+template<class EventClass>
+static void CheckBinaryRoundTrip(const EventClass& event)
+{
+	EventWriteStream out;
+	event.SerializeBinary(out);
+
+	EventClass decoded;
+	EventReadStream in(out.GetData(), out.GetSize());
+	CheckEvent(decoded.DeserializeBinary(in), event, "binary decode failed");
+	CheckEvent(in.GetBytesRemaining() == 0, event, "binary decode left bytes unread");
+
+	EventWriteStream reencoded;
+	decoded.SerializeBinary(reencoded);
+	CheckEvent(SameBytes(out, reencoded), event, "binary round trip changed the event");
+
+	// every byte belongs to some field, so losing the last one must be caught
+	if (out.GetSize() > 0)
+	{
+		EventClass truncated;
+		EventReadStream truncatedIn(out.GetData(), out.GetSize() - 1);
+		CheckEvent(!truncated.DeserializeBinary(truncatedIn), event, "truncated binary decode did not fail");
+	}
+}
+
+/// Decode the text encoding of an event and check it matches the original's binary encoding
+template<class EventClass>
+static void CheckTextRoundTrip(const EventClass& event)
+{
+	std::ostringstream out;
+	event.Serialize(out);
+
+	EventClass decoded;
+	std::istringstream in(out.str());
+	decoded.Deserialize(in);
+
+	EventWriteStream expected, actual;
+	event.SerializeBinary(expected);
+	decoded.SerializeBinary(actual);
+	CheckEvent(SameBytes(expected, actual), event, "text round trip changed the event");
+}
+
+/// Print the size and encode/decode time of an event in both formats
+template<class EventClass>
+static void BenchEvent(const EventClass& event, bool hasText)
+{
+	EventWriteStream out(true);
+	unsigned long long start = HighResClock::GetNanoseconds();
+	for (int i = 0; i < EVENTSTREAMTEST_BENCH_ITERATIONS; ++i)
+	{
+		out.Clear();
+		event.SerializeBinary(out);
+	}
+	double encodeNS = (double)(HighResClock::GetNanoseconds() - start) / EVENTSTREAMTEST_BENCH_ITERATIONS;
+
+	EventClass decoded;
+	start = HighResClock::GetNanoseconds();
+	for (int i = 0; i < EVENTSTREAMTEST_BENCH_ITERATIONS; ++i)
+	{
+		EventReadStream in(out.GetData(), out.GetSize());
+		decoded.DeserializeBinary(in);
+	}
+	double decodeNS = (double)(HighResClock::GetNanoseconds() - start) / EVENTSTREAMTEST_BENCH_ITERATIONS;
+
+	if (!hasText)
+	{
+		std::printf("  %-38s %5u bytes %8.1fns %8.1fns\n", event.GetName(), (unsigned int)out.GetSize(), encodeNS, decodeNS);
+		return;
+	}
+
+	// the text format goes through iostreams, a tenth of the iterations is plenty
+	const int textIterations = EVENTSTREAMTEST_BENCH_ITERATIONS / 10;
+	std::string text;
+	start = HighResClock::GetNanoseconds();
+	for (int i = 0; i < textIterations; ++i)
+	{
+		std::ostringstream textOut;
+		event.Serialize(textOut);
+		text = textOut.str();
+	}
+	double textEncodeNS = (double)(HighResClock::GetNanoseconds() - start) / textIterations;
+
+	start = HighResClock::GetNanoseconds();
+	for (int i = 0; i < textIterations; ++i)
+	{
+		std::istringstream textIn(text);
+		decoded.Deserialize(textIn);
+	}
+	double textDecodeNS = (double)(HighResClock::GetNanoseconds() - start) / textIterations;
+
+	std::printf("  %-38s %5u bytes %8.1fns %8.1fns | text %5u bytes %8.1fns %8.1fns\n", event.GetName(), (unsigned int)out.GetSize(), encodeNS, decodeNS,
+		(unsigned int)text.size(), textEncodeNS, textDecodeNS);
+}
+
+/// A rigid transform with a rotation that doesn't print exactly as text
+static Mat4x4 MakeRotatedTransform()
+{
+	Mat4x4 transform;
+	transform.BuildYawPitchRoll(0.7f, -0.3f, 0.2f);
+	transform.SetPosition(Vec3(12.5f, -3.25f, 100.0f));
+	return transform;
+}
+
+/// A transform that prints exactly as text
+static Mat4x4 MakeTranslation()
+{
+	Mat4x4 transform;
+	transform.BuildTranslation(12.5f, -3.25f, 100.0f);
+	return transform;
+}
+
+static void TestEngineEvents()
+{
+	Mat4x4 rotated = MakeRotatedTransform();
+	Mat4x4 translation = MakeTranslation();
+
+	std::vector<GameObjectId> ids;
+	std::vector<Vec3> positions;
+	for (int i = 0; i < 5; ++i)
+	{
+		ids.push_back(100 + i);
+		positions.push_back(Vec3(i * 2.5f, 0.0f, -i * 1.5f));
+	}
+
+	CheckBinaryRoundTrip(Event_NewGameObject(42, 3));
+	CheckBinaryRoundTrip(Event_DestroyGameObject(42));
+	CheckBinaryRoundTrip(Event_MoveGameObject(42, rotated));
+	CheckBinaryRoundTrip(Event_NewRenderComponent(42, shared_ptr<SceneNode>()));
+	CheckBinaryRoundTrip(Event_ModifiedRenderComponent(42));
+	CheckBinaryRoundTrip(Event_RequestNewGameObject("gameobjects\\sphere.xml", &rotated, 42, 3));
+	CheckBinaryRoundTrip(Event_RequestNewGameObject("gameobjects\\sphere.xml"));
+	CheckBinaryRoundTrip(Event_RequestNewGameObjects("gameobjects\\ai_teapot.xml", ids, positions));
+	CheckBinaryRoundTrip(Event_RequestDestroyGameObject(42));
+	CheckBinaryRoundTrip(Event_EnvironmentLoaded());
+	CheckBinaryRoundTrip(Event_RequestStartGame());
+	CheckBinaryRoundTrip(Event_PlaySound("audio\\explosion.wav"));
+
+	CheckTextRoundTrip(Event_NewGameObject(42, 3));
+	CheckTextRoundTrip(Event_DestroyGameObject(42));
+	CheckTextRoundTrip(Event_MoveGameObject(42, translation));
+	CheckTextRoundTrip(Event_ModifiedRenderComponent(42));
+	CheckTextRoundTrip(Event_RequestNewGameObject("gameobjects\\sphere.xml", &translation, 42, 3));
+	CheckTextRoundTrip(Event_RequestNewGameObjects("gameobjects\\ai_teapot.xml", ids, positions));
+	CheckTextRoundTrip(Event_RequestDestroyGameObject(42));
+	CheckTextRoundTrip(Event_PlaySound("audio\\explosion.wav"));
+}
+
+static void TestQuantizedMoveStaysClose()
+{
+	Mat4x4 rotated = MakeRotatedTransform();
+	Event_MoveGameObject event(42, rotated);
+
+	EventWriteStream full, quantized(true);
+	event.SerializeBinary(full);
+	event.SerializeBinary(quantized);
+	TEST_CHECK(quantized.GetSize() < full.GetSize());
+
+	Event_MoveGameObject decoded;
+	EventReadStream in(quantized.GetData(), quantized.GetSize());
+	TEST_CHECK(decoded.DeserializeBinary(in));
+	TEST_CHECK(decoded.GetId() == 42);
+
+	// 16 bits over [-1, 1] is good to about 0.00003
+	float maxError = 0.0f;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			float error = fabsf(decoded.GetMatrix().m[i][j] - rotated.m[i][j]);
+			maxError = (error > maxError) ? error : maxError;
+		}
+	}
+	TEST_CHECK(maxError < 0.001f);
+}
+
+static void TestNetworkEvents()
+{
+	CheckBinaryRoundTrip(Event_NetworkPlayerObjectAssignment(42, 7));
+	CheckBinaryRoundTrip(Event_RemoteClient(7, 0x7f000001));
+	CheckBinaryRoundTrip(Event_RemoteEnvironmentLoaded());
+
+	CheckTextRoundTrip(Event_NetworkPlayerObjectAssignment(42, 7));
+	CheckTextRoundTrip(Event_RemoteClient(7, 0x7f000001));
+}
+
+static void TestPhysicsEvents()
+{
+	Vec3 points[PHYSEVENT_MAX_COLLISION_POINTS] = { Vec3(1.0f, 2.0f, 3.0f), Vec3(-1.0f, 0.5f, 0.0f), Vec3(0.25f, 0.0f, 8.0f), Vec3(0.0f, 0.0f, 0.0f) };
+
+	CheckBinaryRoundTrip(Event_PhysTriggerEnter(3, 42));
+	CheckBinaryRoundTrip(Event_PhysTriggerLeave(3, 42));
+	CheckBinaryRoundTrip(Event_PhysCollision(1, 2, Vec3(0.0f, 9.8f, 0.0f), Vec3(0.5f, 0.0f, -0.5f), points, 3));
+	CheckBinaryRoundTrip(Event_PhysCollision(1, 2, Vec3(0.0f, 9.8f, 0.0f), Vec3(0.5f, 0.0f, -0.5f), points, 0));
+	CheckBinaryRoundTrip(Event_PhysSeparation(1, 2));
+}
+
+static void TestGameEvents()
+{
+	CheckBinaryRoundTrip(Event_FireWeapon(42));
+	CheckBinaryRoundTrip(Event_StartThrust(42, 2.5f));
+	CheckBinaryRoundTrip(Event_EndThrust(42));
+	CheckBinaryRoundTrip(Event_StartSteer(42, -1.5f));
+	CheckBinaryRoundTrip(Event_EndSteer(42));
+	CheckBinaryRoundTrip(Event_GameplayUIUpdate("score:100"));
+	CheckBinaryRoundTrip(Event_SetControlledObject(42));
+
+	CheckTextRoundTrip(Event_FireWeapon(42));
+	CheckTextRoundTrip(Event_StartThrust(42, 2.5f));
+	CheckTextRoundTrip(Event_EndThrust(42));
+	CheckTextRoundTrip(Event_StartSteer(42, -1.5f));
+	CheckTextRoundTrip(Event_EndSteer(42));
+	CheckTextRoundTrip(Event_GameplayUIUpdate("score:100"));
+	CheckTextRoundTrip(Event_SetControlledObject(42));
+}
+
+static void BenchEventSerialization()
+{
+	Mat4x4 rotated = MakeRotatedTransform();
+	std::vector<GameObjectId> ids;
+	std::vector<Vec3> positions;
+	for (int i = 0; i < 5; ++i)
+	{
+		ids.push_back(100 + i);
+		positions.push_back(Vec3(i * 2.5f, 0.0f, -i * 1.5f));
+	}
+	Vec3 points[PHYSEVENT_MAX_COLLISION_POINTS];
+
+	std::printf("  %-38s %11s %10s %10s (binary, quantized where allowed)\n", "event", "size", "encode", "decode");
+	BenchEvent(Event_NewGameObject(42, 3), true);
+	BenchEvent(Event_DestroyGameObject(42), true);
+	BenchEvent(Event_MoveGameObject(42, rotated), true);
+	BenchEvent(Event_RequestNewGameObject("gameobjects\\sphere.xml", &rotated, 42, 3), true);
+	BenchEvent(Event_RequestNewGameObjects("gameobjects\\ai_teapot.xml", ids, positions), true);
+	BenchEvent(Event_NetworkPlayerObjectAssignment(42, 7), true);
+	BenchEvent(Event_PhysCollision(1, 2, Vec3(0.0f, 9.8f, 0.0f), Vec3(0.5f, 0.0f, -0.5f), points, 4), false);
+	BenchEvent(Event_FireWeapon(42), true);
+	BenchEvent(Event_StartThrust(42, 2.5f), true);
+}
+
+void RunEventStreamTests()
+{
+	RUN_TEST(TestEngineEvents);
+	RUN_TEST(TestQuantizedMoveStaysClose);
+	RUN_TEST(TestNetworkEvents);
+	RUN_TEST(TestPhysicsEvents);
+	RUN_TEST(TestGameEvents);
+	RUN_TEST(BenchEventSerialization);
+}
@@ -0,0 +1,184 @@
+/*
+	GameObjectSpawnTest.cpp
+
+	Times spawning and destroying 10k game objects one at a time against
+	the batch calls, and checks that a server's batch spawn events fit in
+	a network packet in both the binary and the text format.
+*/
+
+#include <EngineStd.h>
+#include <vector>
+
+#include <BaseGameLogic.h>
+#include <BinaryPacket.h>
+#include <EventManager.h>
+#include <Events.h>
+#include <GameObject.h>
+#include <LuaStateManager.h>
+#include <NetSocket.h>
+#include <NetworkEventForwarder.h>
+
+#include "TestUtil.h"
+
+const int SPAWNTEST_NUM_OBJECTS = 10000;
+const int SPAWNTEST_NUM_BROADCAST_OBJECTS = 1000;
+const char* SPAWNTEST_OBJECT_RESOURCE = "gameobjects\\light.xml";
+
+/// Game logic that lets the test set its state and run the end of update sweep on its own
+class SpawnTestLogic : public BaseGameLogic
+{
+public:
+	void SetState(BaseGameState state) { m_State = state; }
+	void DestroyQueued() { DestroyQueuedGameObjects(); }
+	size_t GetNumObjects() const { return m_Objects.size(); }
+};
+
+/// Checks every batch spawn event a server sends
+class BroadcastChecker
+{
+public:
+	BroadcastChecker() : m_NumEvents(0), m_NumObjects(0), m_NumOversized(0), m_LargestPacket(0) { }
+
+	void OnNewObjects(IEventPtr pEvent)
+	{
+		shared_ptr<Event_RequestNewGameObjects> pCastEvent = static_pointer_cast<Event_RequestNewGameObjects>(pEvent);
+		unsigned long packetSize = NetworkEventForwarder::CreateEventPacket(pEvent)->GetSize();
+
+		++m_NumEvents;
+		m_NumObjects += (unsigned long)pCastEvent->GetServerObjectIds().size();
+		if (packetSize > MAX_PACKET_SIZE)
+			++m_NumOversized;
+		if (packetSize > m_LargestPacket)
+			m_LargestPacket = packetSize;
+	}
+
+	unsigned long m_NumEvents;
+	unsigned long m_NumObjects;
+	unsigned long m_NumOversized;
+	unsigned long m_LargestPacket;
+};
+
+static void GetSpawnPositions(int numObjects, std::vector<Vec3>& positions)
+{
+	positions.clear();
+	positions.reserve(numObjects);
+	for (int i = 0; i < numObjects; ++i)
+	{
+		positions.push_back(Vec3((float)(i % 100), 0.0f, (float)(i / 100)));
+	}
+}
+
+static void DestroyAll(SpawnTestLogic& logic, const std::vector<GameObjectId>& ids, const char* name)
+{
+	unsigned long long start = HighResClock::GetMicroseconds();
+	logic.QueueDestroyGameObjects(ids);
+	logic.DestroyQueued();
+	ReportThroughput(name, ids.size(), HighResClock::GetMicroseconds() - start);
+
+	TEST_CHECK(logic.GetNumObjects() == 0);
+}
+
+static void BenchSpawnAndDestroy(SpawnTestLogic& logic)
+{
+	std::vector<Vec3> positions;
+	GetSpawnPositions(SPAWNTEST_NUM_OBJECTS, positions);
+
+	// one at a time, looking up the resource for each object
+	std::vector<GameObjectId> ids;
+	ids.reserve(SPAWNTEST_NUM_OBJECTS);
+	unsigned long long start = HighResClock::GetMicroseconds();
+	Mat4x4 transform = Mat4x4::Identity;
+	for (auto it = positions.begin(); it != positions.end(); ++it)
+	{
+		transform.SetPosition(*it);
+		StrongGameObjectPtr pObject = logic.CreateGameObject(SPAWNTEST_OBJECT_RESOURCE, nullptr, &transform);
+		if (pObject)
+			ids.push_back(pObject->GetId());
+	}
+	ReportThroughput("CreateGameObject() one at a time", ids.size(), HighResClock::GetMicroseconds() - start);
+	TEST_CHECK(ids.size() == (size_t)SPAWNTEST_NUM_OBJECTS);
+
+	DestroyAll(logic, ids, "QueueDestroyGameObjects() sweep");
+
+	// the same objects as one batch from one parsed template
+	std::vector<StrongGameObjectPtr> createdObjects;
+	start = HighResClock::GetMicroseconds();
+	unsigned int numCreated = logic.CreateGameObjects(SPAWNTEST_OBJECT_RESOURCE, nullptr, positions, &createdObjects);
+	ReportThroughput("CreateGameObjects() batch", numCreated, HighResClock::GetMicroseconds() - start);
+	TEST_CHECK(numCreated == (unsigned int)SPAWNTEST_NUM_OBJECTS);
+	TEST_CHECK(createdObjects.size() == numCreated);
+	TEST_CHECK(logic.GetNumObjects() == numCreated);
+
+	ids.clear();
+	for (auto it = createdObjects.begin(); it != createdObjects.end(); ++it)
+		ids.push_back((*it)->GetId());
+	createdObjects.clear();
+
+	// queuing an object twice must only destroy it once
+	ids.push_back(ids.front());
+	DestroyAll(logic, ids, "QueueDestroyGameObjects() batch sweep");
+}
+
+static void CheckBroadcastFits(SpawnTestLogic& logic, bool textEvents)
+{
+	BroadcastChecker checker;
+	IEventManager::Get()->AddListener(fastdelegate::MakeDelegate(&checker, &BroadcastChecker::OnNewObjects), Event_RequestNewGameObjects::sk_EventType);
+
+	bool oldTextEvents = g_pApp->m_Options.m_TextNetworkEvents;
+	g_pApp->m_Options.m_TextNetworkEvents = textEvents;
+
+	std::vector<Vec3> positions;
+	GetSpawnPositions(SPAWNTEST_NUM_BROADCAST_OBJECTS, positions);
+
+	std::vector<StrongGameObjectPtr> createdObjects;
+	unsigned long long start = HighResClock::GetMicroseconds();
+	logic.CreateGameObjects(SPAWNTEST_OBJECT_RESOURCE, nullptr, positions, &createdObjects);
+	unsigned long long microseconds = HighResClock::GetMicroseconds() - start;
+
+	g_pApp->m_Options.m_TextNetworkEvents = oldTextEvents;
+	IEventManager::Get()->RemoveListener(fastdelegate::MakeDelegate(&checker, &BroadcastChecker::OnNewObjects), Event_RequestNewGameObjects::sk_EventType);
+
+	ReportThroughput(textEvents ? "CreateGameObjects() broadcast, text" : "CreateGameObjects() broadcast, binary", createdObjects.size(), microseconds);
+	std::printf("  %lu objects in %lu events, largest packet %lu of %d bytes\n", checker.m_NumObjects, checker.m_NumEvents, checker.m_LargestPacket, MAX_PACKET_SIZE);
+
+	// every object is sent exactly once and no client would be dropped for an oversized packet
+	TEST_CHECK(checker.m_NumObjects == (unsigned long)createdObjects.size());
+	TEST_CHECK(checker.m_NumOversized == 0);
+	TEST_CHECK(checker.m_NumEvents > 1);
+
+	std::vector<GameObjectId> ids;
+	for (auto it = createdObjects.begin(); it != createdObjects.end(); ++it)
+		ids.push_back((*it)->GetId());
+	createdObjects.clear();
+
+	logic.QueueDestroyGameObjects(ids);
+	logic.DestroyQueued();
+}
+
+static void TestSpawnBatches()
+{
+	EventManager eventManager("Spawn Test", true);
+	TEST_CHECK(LuaStateManager::Create());
+
+	{
+		SpawnTestLogic logic;
+		TEST_CHECK(logic.Init());
+		g_pApp->m_pGame = &logic;
+
+		BenchSpawnAndDestroy(logic);
+
+		// a running server broadcasts what it spawns
+		logic.SetState(BaseGameState::Running);
+		CheckBroadcastFits(logic, false);
+		CheckBroadcastFits(logic, true);
+
+		g_pApp->m_pGame = nullptr;
+	}
+
+	LuaStateManager::Destroy();
+}
+
+void RunGameObjectSpawnTests()
+{
+	RUN_TEST(TestSpawnBatches);
+}
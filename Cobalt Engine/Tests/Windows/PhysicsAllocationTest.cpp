@@ -0,0 +1,194 @@
+/*
+	PhysicsAllocationTest.cpp
+
+	Checks that a physics step, syncing the scene and dispatching the
+	collision and move events it sends never touch the heap once the world,
+	the event pools and the queues are warm. Allocations are counted with
+	the debug CRT's allocation hook, so the counts are only checked in
+	Debug builds.
+*/
+
+#include <EngineStd.h>
+#include <crtdbg.h>
+#include <vector>
+
+#include <BaseGameLogic.h>
+#include <EventManager.h>
+#include <EventPool.h>
+#include <Events.h>
+#include <GameObject.h>
+#include <GameObjectFactory.h>
+#include <LuaStateManager.h>
+#include <Physics.h>
+#include <PhysicsEvents.h>
+
+#include "TestUtil.h"
+
+const int PHYSICSTEST_NUM_BODIES = 1000;
+const int PHYSICSTEST_NUM_TICKS = 60;
+const float PHYSICSTEST_TICK_SECONDS = 1.0f / 60.0f;
+
+// spheres are packed a little closer than their diameter so they are colliding from the first tick
+const float PHYSICSTEST_SPHERE_RADIUS = 0.25f;
+const float PHYSICSTEST_SPHERE_SPACING = 0.45f;
+
+static long s_NumAllocations = 0;
+
+/// Debug CRT hook that counts every allocation that isn't the CRT's own bookkeeping
+static int __cdecl CountAllocations(int allocType, void* pUserData, size_t size, int blockType, long requestNumber, const unsigned char* pFileName, int lineNumber)
+{
+	if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && blockType != _CRT_BLOCK)
+		++s_NumAllocations;
+
+	return TRUE;
+}
+
+/// Game logic the test adds its bodies to, so syncing the scene can find them
+class PhysicsTestLogic : public BaseGameLogic
+{
+public:
+	void AddBody(const StrongGameObjectPtr& pBody) { m_Objects[pBody->GetId()] = pBody; }
+	void ClearBodies() { m_Objects.clear(); }
+};
+
+/// Counts the collision and move events dispatched to it
+class CollisionCounter
+{
+public:
+	CollisionCounter() { Reset(); }
+
+	void Reset() { m_NumCollisions = 0; m_NumSeparations = 0; m_NumMoves = 0; }
+
+	void OnCollision(IEventPtr pEvent) { ++m_NumCollisions; }
+	void OnSeparation(IEventPtr pEvent) { ++m_NumSeparations; }
+	void OnMove(IEventPtr pEvent) { ++m_NumMoves; }
+
+	unsigned long m_NumCollisions;
+	unsigned long m_NumSeparations;
+	unsigned long m_NumMoves;
+};
+
+/// Result of one simulation run
+struct PhysicsRun
+{
+	long m_NumAllocations;
+	long m_MostAllocationsInATick;
+	unsigned long m_NumCollisions;
+	unsigned long m_NumSeparations;
+	unsigned long m_NumMoves;
+	unsigned long long m_Microseconds;
+};
+
+/// Drop the bodies into the world and tick it, counting the allocations each physics step, scene sync and event update makes
+static PhysicsRun SimulateBodies(IGamePhysics* pPhysics, PhysicsTestLogic& logic, EventManager& eventManager, CollisionCounter& counter)
+{
+	PhysicsRun run = { 0, 0, 0, 0, 0, 0 };
+
+	TiXmlDocument bodyTemplate;
+	bodyTemplate.Parse("<GameObject type=\"Body\"><TransformComponent><Position x=\"0\" y=\"0\" z=\"0\"/></TransformComponent></GameObject>");
+
+	GameObjectFactory factory;
+	std::vector<StrongGameObjectPtr> bodies;
+	bodies.reserve(PHYSICSTEST_NUM_BODIES);
+	for (int i = 0; i < PHYSICSTEST_NUM_BODIES; ++i)
+	{
+		Mat4x4 transform = Mat4x4::Identity;
+		transform.SetPosition(Vec3((i % 10) * PHYSICSTEST_SPHERE_SPACING, (i / 100) * PHYSICSTEST_SPHERE_SPACING, ((i / 10) % 10) * PHYSICSTEST_SPHERE_SPACING));
+
+		StrongGameObjectPtr pBody = factory.CreateGameObjectFromTemplate(bodyTemplate.RootElement(), "test body", nullptr, &transform, INVALID_GAMEOBJECT_ID);
+		TEST_CHECK(pBody);
+		if (!pBody)
+			return run;
+
+		pPhysics->AddSphere(PHYSICSTEST_SPHERE_RADIUS, pBody, "pine", "Bouncy");
+		logic.AddBody(pBody);
+		bodies.push_back(pBody);
+	}
+
+	counter.Reset();
+	_CRT_ALLOC_HOOK pOldHook = _CrtSetAllocHook(CountAllocations);
+	unsigned long long start = HighResClock::GetMicroseconds();
+
+	for (int tick = 0; tick < PHYSICSTEST_NUM_TICKS; ++tick)
+	{
+		long allocationsBefore = s_NumAllocations;
+
+		pPhysics->OnUpdate(PHYSICSTEST_TICK_SECONDS);
+		pPhysics->SyncVisibleScene();
+		eventManager.Update();
+
+		long tickAllocations = s_NumAllocations - allocationsBefore;
+		run.m_NumAllocations += tickAllocations;
+		if (tickAllocations > run.m_MostAllocationsInATick)
+			run.m_MostAllocationsInATick = tickAllocations;
+	}
+
+	run.m_Microseconds = HighResClock::GetMicroseconds() - start;
+	_CrtSetAllocHook(pOldHook);
+	run.m_NumCollisions = counter.m_NumCollisions;
+	run.m_NumSeparations = counter.m_NumSeparations;
+	run.m_NumMoves = counter.m_NumMoves;
+
+	// removing the bodies sends separation events for the ones still touching
+	logic.ClearBodies();
+	for (auto it = bodies.begin(); it != bodies.end(); ++it)
+	{
+		pPhysics->RemoveGameObject((*it)->GetId());
+		(*it)->Destroy();
+	}
+	eventManager.Update();
+
+	return run;
+}
+
+static void TestPhysicsStepsDoNotAllocate()
+{
+	EventManager eventManager("Physics Test", true);
+	TEST_CHECK(LuaStateManager::Create());
+
+	{
+		PhysicsTestLogic logic;
+		g_pApp->m_pGame = &logic;
+
+		CollisionCounter counter;
+		eventManager.AddListener(fastdelegate::MakeDelegate(&counter, &CollisionCounter::OnCollision), Event_PhysCollision::sk_EventType);
+		eventManager.AddListener(fastdelegate::MakeDelegate(&counter, &CollisionCounter::OnSeparation), Event_PhysSeparation::sk_EventType);
+		eventManager.AddListener(fastdelegate::MakeDelegate(&counter, &CollisionCounter::OnMove), Event_MoveGameObject::sk_EventType);
+
+		unique_ptr<IGamePhysics> pPhysics(CreateGamePhysics());
+		TEST_CHECK(pPhysics);
+		if (pPhysics)
+		{
+			// the first run grows the world, the event pools, the queues and the collision pair lists to their
+			// working size. the second drops the same bodies into the same world, so every step should reuse that memory
+			PhysicsRun warmRun = SimulateBodies(pPhysics.get(), logic, eventManager, counter);
+			unsigned long blocksBefore = EventMemoryPool::GetTotalBlockAllocations();
+			PhysicsRun run = SimulateBodies(pPhysics.get(), logic, eventManager, counter);
+
+			std::printf("  %d bodies, %d ticks: %lu collision, %lu separation and %lu move events in %.2fms\n", PHYSICSTEST_NUM_BODIES, PHYSICSTEST_NUM_TICKS,
+				run.m_NumCollisions, run.m_NumSeparations, run.m_NumMoves, (double)run.m_Microseconds / 1000.0);
+			std::printf("  heap allocations: %ld while warming up, %ld once warm, at most %ld in a tick, %lu new event pool blocks\n",
+				warmRun.m_NumAllocations, run.m_NumAllocations, run.m_MostAllocationsInATick, EventMemoryPool::GetTotalBlockAllocations() - blocksBefore);
+
+			TEST_CHECK(run.m_NumCollisions > 0);
+			TEST_CHECK(run.m_NumMoves > 0);
+
+#ifdef _DEBUG
+			TEST_CHECK(run.m_MostAllocationsInATick == 0);
+			TEST_CHECK(EventMemoryPool::GetTotalBlockAllocations() == blocksBefore);
+#else
+			std::printf("  allocation counts are only checked in Debug builds\n");
+#endif
+		}
+
+		pPhysics.reset();
+		g_pApp->m_pGame = nullptr;
+	}
+
+	LuaStateManager::Destroy();
+}
+
+void RunPhysicsAllocationTests()
+{
+	RUN_TEST(TestPhysicsStepsDoNotAllocate);
+}
@@ -0,0 +1,357 @@
+/*
+	ProcessManagerTest.cpp
+
+	Checks that the process manager removes the process it was asked to
+	remove, so a real time process is only released once its job is done.
+	Timed sleepers wake on the first update their time has passed, in wake
+	time order whatever order they went to sleep in, and processes sleeping
+	until an event wake when it is sent, with the manager only listening
+	for the event while something waits on it. Profiles group processes by
+	the text of their type name, not where the name is stored.
+*/
+
+#include <EngineStd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BaseEvent.h>
+#include <EventManager.h>
+#include <JobSystem.h>
+#include <ProcessManager.h>
+#include <RealTimeProcess.h>
+
+#include "TestUtil.h"
+
+// longest a gated job waits for the test to open its gate
+const unsigned long long PROCESSTEST_GATE_TIMEOUT_US = 2000000;
+
+// update length for the sleep tests, exact in binary so wake times land on whole updates
+const float PROCESSTEST_FRAME_SECONDS = 0.25f;
+
+/// Real time process whose job waits for a gate, and that records when the manager removes it
+class GatedProcess : public RealTimeProcess
+{
+public:
+	GatedProcess(int id, const std::atomic<bool>* pGate, std::vector<int>* pRemoved) :
+		m_Id(id), m_pGate(pGate), m_pRemoved(pRemoved) { }
+
+	bool IsJobFinished() const { return m_Finished; }
+
+	virtual const char* GetName() const override { return "GatedProcess"; }
+
+protected:
+	virtual void ProcessProc() override
+	{
+		unsigned long long start = HighResClock::GetMicroseconds();
+		while (m_pGate && !*m_pGate && HighResClock::GetMicroseconds() - start < PROCESSTEST_GATE_TIMEOUT_US)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	virtual void OnRemove() override
+	{
+		m_pRemoved->push_back(m_Id);
+		RealTimeProcess::OnRemove();
+	}
+
+private:
+	int m_Id;
+	const std::atomic<bool>* m_pGate;
+	std::vector<int>* m_pRemoved;
+};
+
+/// Event the sleepers wait on
+class WakeEvent : public BaseEvent
+{
+public:
+	virtual const EventType& GetEventType() const { return sk_EventType; }
+	virtual IEventPtr Copy() const { return IEventPtr(CB_NEW WakeEvent()); }
+	virtual const char* GetName() const { return "WakeEvent"; }
+
+public:
+	static const EventType sk_EventType;
+};
+
+const EventType WakeEvent::sk_EventType(0x7e57e101);
+
+/// Process that goes to sleep on its first update and succeeds on the update after it wakes
+class SleeperProcess : public Process
+{
+public:
+	/// Sleep for a number of seconds, or until an event if the event type is not 0
+	SleeperProcess(const unsigned int* pFrame, float sleepSeconds, EventType wakeEventType = 0) :
+		m_pFrame(pFrame), m_SleepSeconds(sleepSeconds), m_WakeEventType(wakeEventType),
+		m_NumUpdates(0), m_NumWakes(0), m_NumAborts(0), m_WokenFrame(0) { }
+
+	virtual const char* GetName() const override { return "SleeperProcess"; }
+
+	unsigned int m_NumUpdates;
+	unsigned int m_NumWakes;
+	unsigned int m_NumAborts;
+	unsigned int m_WokenFrame;
+
+protected:
+	virtual void OnUpdate(float deltaTime) override
+	{
+		if (m_NumUpdates++ > 0)
+			Succeed();
+		else if (m_WakeEventType != 0)
+			SleepUntilEvent(m_WakeEventType);
+		else
+			Sleep(m_SleepSeconds);
+	}
+
+	virtual void OnWake() override
+	{
+		++m_NumWakes;
+		m_WokenFrame = *m_pFrame;
+	}
+
+	virtual void OnAbort() override { ++m_NumAborts; }
+
+private:
+	const unsigned int* m_pFrame;
+	float m_SleepSeconds;
+	EventType m_WakeEventType;
+};
+
+/// Process that runs forever under a name built at runtime, so every instance has its own copy of the name
+class NamedProcess : public Process
+{
+public:
+	explicit NamedProcess(const char* pName) : m_Name(pName) { }
+
+	virtual const char* GetName() const override { return m_Name.c_str(); }
+
+protected:
+	virtual void OnUpdate(float deltaTime) override { }
+
+private:
+	std::string m_Name;
+};
+
+/// Return the number of listeners for an event type -- the event manager must be collecting stats and have queued the type
+static unsigned int CountListeners(const EventManager& eventManager, const EventType& type)
+{
+	EventTypeStats stats;
+	return eventManager.GetEventStats(type, stats) ? stats.m_NumListeners : 0;
+}
+
+/// Update the processes until the condition is true or the gate timeout passes
+template<class Condition>
+static void UpdateUntil(ProcessManager& processManager, Condition condition)
+{
+	unsigned long long start = HighResClock::GetMicroseconds();
+	while (!condition() && HighResClock::GetMicroseconds() - start < PROCESSTEST_GATE_TIMEOUT_US)
+	{
+		processManager.UpdateProcesses(0.0f);
+		std::this_thread::yield();
+	}
+}
+
+static void TestRemovingAProcessOnlyWaitsOnItsOwnJob()
+{
+	JobSystem jobSystem(2, true);
+	ProcessManager processManager(&jobSystem);
+	std::atomic<bool> gate(false);
+	std::vector<int> removed;
+
+	// the first process finishes right away, the others hold their jobs until the gate opens
+	shared_ptr<GatedProcess> pSecond(CB_NEW GatedProcess(1, &gate, &removed));
+	shared_ptr<GatedProcess> pLast(CB_NEW GatedProcess(2, &gate, &removed));
+	processManager.AttachProcess(StrongProcessPtr(CB_NEW GatedProcess(0, nullptr, &removed)));
+	processManager.AttachProcess(pSecond);
+	processManager.AttachProcess(pLast);
+
+	// removing the first process moves the last one into its place
+	UpdateUntil(processManager, [&]() { return !removed.empty(); });
+
+	// only the finished process was told it is being removed, and nothing waited on the gated jobs
+	TEST_CHECK(removed.size() == 1 && removed[0] == 0);
+	TEST_CHECK(processManager.GetProcessCount() == 2);
+	TEST_CHECK(!pSecond->IsJobFinished() && !pLast->IsJobFinished());
+
+	gate = true;
+	UpdateUntil(processManager, [&]() { return processManager.GetProcessCount() == 0; });
+	TEST_CHECK(processManager.GetProcessCount() == 0);
+	TEST_CHECK(removed.size() == 3);
+}
+
+static void TestTimedSleepers()
+{
+	ProcessManager processManager;
+	unsigned int frame = 0;
+
+	// sleepers go to sleep on the first update in a jumbled order, the one at index i sleeps for i updates
+	const unsigned int sleepFrames[] = { 5, 1, 7, 0, 3, 2, 8, 4, 6 };
+	const unsigned int numSleepers = sizeof(sleepFrames) / sizeof(sleepFrames[0]);
+	std::vector<shared_ptr<SleeperProcess> > sleepers;
+	for (unsigned int i = 0; i < numSleepers; ++i)
+	{
+		sleepers.push_back(shared_ptr<SleeperProcess>(CB_NEW SleeperProcess(&frame, sleepFrames[i] * PROCESSTEST_FRAME_SECONDS)));
+		processManager.AttachProcess(sleepers.back());
+	}
+
+	++frame;
+	processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+	TEST_CHECK(processManager.GetSleepingProcessCount() == numSleepers);
+
+	// each one wakes on the update its time passes, and is not updated while it sleeps. a zero second sleep wakes on the next update
+	for (unsigned int i = 0; i < 9; ++i)
+	{
+		++frame;
+		processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+
+		unsigned int numAsleep = 0;
+		for (unsigned int j = 0; j < numSleepers; ++j)
+		{
+			if (frame < 1 + (sleepFrames[j] > 0 ? sleepFrames[j] : 1))
+			{
+				++numAsleep;
+				TEST_CHECK(sleepers[j]->m_NumUpdates == 1 && sleepers[j]->m_NumWakes == 0);
+			}
+		}
+		TEST_CHECK(processManager.GetSleepingProcessCount() == numAsleep);
+	}
+
+	for (unsigned int i = 0; i < numSleepers; ++i)
+	{
+		TEST_CHECK(sleepers[i]->m_NumWakes == 1);
+		TEST_CHECK(sleepers[i]->m_WokenFrame == 1 + (sleepFrames[i] > 0 ? sleepFrames[i] : 1));
+		TEST_CHECK(sleepers[i]->m_NumUpdates == 2);
+	}
+	TEST_CHECK(processManager.GetProcessCount() == 0);
+
+	// an aborted sleeper's timer is still in the heap when it comes due, it must not wake the process asleep in its slot
+	shared_ptr<SleeperProcess> pAborted(CB_NEW SleeperProcess(&frame, 4 * PROCESSTEST_FRAME_SECONDS));
+	ProcessHandle abortedHandle = processManager.AttachProcess(pAborted);
+	unsigned int sleepFrame = ++frame;
+	processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+	TEST_CHECK(processManager.AbortProcess(abortedHandle));
+	++frame;
+	processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+	TEST_CHECK(pAborted->m_NumAborts == 1 && pAborted->m_NumWakes == 0);
+
+	shared_ptr<SleeperProcess> pReused(CB_NEW SleeperProcess(&frame, 4 * PROCESSTEST_FRAME_SECONDS));
+	processManager.AttachProcess(pReused);
+	while (frame < sleepFrame + 8)
+	{
+		++frame;
+		processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+	}
+	TEST_CHECK(pReused->m_NumWakes == 1);
+	TEST_CHECK(pReused->m_WokenFrame == sleepFrame + 6);
+	TEST_CHECK(pAborted->m_NumWakes == 0);
+}
+
+static void TestSleepingUntilAnEvent()
+{
+	EventManager eventManager("Process Test", true);
+	eventManager.EnableStats(true);
+	unsigned int frame = 0;
+
+	{
+		ProcessManager processManager;
+		shared_ptr<SleeperProcess> pFirst(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType));
+		shared_ptr<SleeperProcess> pSecond(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType));
+		processManager.AttachProcess(pFirst);
+		processManager.AttachProcess(pSecond);
+
+		// both park on the event and the manager listens for it once
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(processManager.GetSleepingProcessCount() == 2);
+		TEST_CHECK(eventManager.QueueEvent(IEventPtr(CB_NEW WakeEvent())));
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 1);
+
+		// the event wakes every waiter and the listener goes with the last of them
+		eventManager.Update();
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 0);
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(pFirst->m_NumWakes == 1 && pSecond->m_NumWakes == 1);
+		TEST_CHECK(pFirst->m_WokenFrame == 2 && pSecond->m_WokenFrame == 2);
+		TEST_CHECK(processManager.GetProcessCount() == 0);
+
+		// aborting the waiters stops the listening once none are left
+		pFirst.reset(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType));
+		pSecond.reset(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType));
+		ProcessHandle firstHandle = processManager.AttachProcess(pFirst);
+		ProcessHandle secondHandle = processManager.AttachProcess(pSecond);
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 1);
+		TEST_CHECK(processManager.AbortProcess(firstHandle));
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 1);
+		TEST_CHECK(processManager.AbortProcess(secondHandle));
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 0);
+
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(pFirst->m_NumAborts == 1 && pSecond->m_NumAborts == 1);
+		TEST_CHECK(pFirst->m_NumWakes == 0 && pSecond->m_NumWakes == 0);
+		TEST_CHECK(processManager.GetProcessCount() == 0);
+
+		// a waiter aborted after its event was sent is not woken by it
+		pFirst.reset(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType));
+		firstHandle = processManager.AttachProcess(pFirst);
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(eventManager.QueueEvent(IEventPtr(CB_NEW WakeEvent())));
+		eventManager.Update();
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 0);
+		TEST_CHECK(processManager.AbortProcess(firstHandle));
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(pFirst->m_NumAborts == 1 && pFirst->m_NumWakes == 0);
+
+		// a manager destroyed while a process waits stops listening too
+		processManager.AttachProcess(StrongProcessPtr(CB_NEW SleeperProcess(&frame, 0.0f, WakeEvent::sk_EventType)));
+		++frame;
+		processManager.UpdateProcesses(1.0f);
+		TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 1);
+	}
+
+	TEST_CHECK(CountListeners(eventManager, WakeEvent::sk_EventType) == 0);
+}
+
+static void TestProfileGroupsTypesByName()
+{
+	ProcessManager processManager;
+	processManager.EnableProfiling(true);
+
+	// the names are built separately, so the two pathfinders name their type from different buffers
+	std::string pathName = std::string("Path") + "Process";
+	processManager.AttachProcess(StrongProcessPtr(CB_NEW NamedProcess(pathName.c_str())));
+	processManager.AttachProcess(StrongProcessPtr(CB_NEW NamedProcess("PathProcess")));
+	processManager.AttachProcess(StrongProcessPtr(CB_NEW NamedProcess("SteerProcess")));
+	pathName.clear();
+
+	for (unsigned int frame = 0; frame < 3; ++frame)
+		processManager.UpdateProcesses(PROCESSTEST_FRAME_SECONDS);
+
+	ProcessProfileReport report;
+	processManager.GetProfileReport(report);
+	TEST_CHECK(report.m_Types.size() == 2);
+	for (auto it = report.m_Types.begin(); it != report.m_Types.end(); ++it)
+	{
+		bool isPath = std::string(it->m_pName) == "PathProcess";
+		TEST_CHECK(isPath || std::string(it->m_pName) == "SteerProcess");
+		TEST_CHECK(it->m_NumAttached == (isPath ? 2u : 1u));
+		TEST_CHECK(it->m_NumUpdates == (isPath ? 6u : 3u));
+		TEST_CHECK(it->m_NumLive == it->m_NumAttached);
+	}
+
+	processManager.EnableProfiling(false);
+}
+
+void RunProcessManagerTests()
+{
+	RUN_TEST(TestRemovingAProcessOnlyWaitsOnItsOwnJob);
+	RUN_TEST(TestTimedSleepers);
+	RUN_TEST(TestSleepingUntilAnEvent);
+	RUN_TEST(TestProfileGroupsTypesByName);
+}
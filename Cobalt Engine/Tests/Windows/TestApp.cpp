@@ -0,0 +1,32 @@
+/*
+	TestApp.cpp
+*/
+
+#include "TestApp.h"
+
+#include <ResourceCache.h>
+#include <ResourceZipFile.h>
+
+// the global instance, its constructor sets g_pApp
+TestApp g_TestApp;
+
+bool InitTestResources()
+{
+	// read the loose files in City Protectors\Assets so the tests don't depend on a packed Assets.zip
+	IResourceFile* pAssets = CB_NEW DevelopmentResourceZipFile(L"Assets.zip", DevelopmentResourceZipFile::Editor);
+	g_pApp->m_ResCache = CB_NEW ResCache(TESTAPP_RESCACHE_SIZE_MB, pAssets);
+	if (!g_pApp->m_ResCache->Init())
+	{
+		CB_SAFE_DELETE(g_pApp->m_ResCache);
+		return false;
+	}
+
+	extern shared_ptr<IResourceLoader> CreateXmlResourceLoader();
+	g_pApp->m_ResCache->RegisterLoader(CreateXmlResourceLoader());
+	return true;
+}
+
+void DestroyTestResources()
+{
+	CB_SAFE_DELETE(g_pApp->m_ResCache);
+}
@@ -0,0 +1,38 @@
+/*
+	TestApp.h
+
+	A do nothing application layer for the Windows tests. The engine
+	reaches the resource cache and game logic through g_pApp, so the
+	tests need one even though they never open a window.
+*/
+
+#pragma once
+
+#include <EngineStd.h>
+#include <WindowsApp.h>
+
+// size of the resource cache the tests load from
+const unsigned int TESTAPP_RESCACHE_SIZE_MB = 50;
+
+/**
+	Application layer for the tests. Creating the global instance points g_pApp at it.
+*/
+class TestApp : public WindowsApp
+{
+public:
+	/// The tests never open a window, so render components skip their scene nodes the way they do on a dedicated server
+	TestApp() { m_IsHeadless = true; }
+
+	virtual TCHAR* GetGameTitle() { return L"Cobalt Engine Tests"; }
+	virtual TCHAR* GetGameAppDirectory() { return L"Cobalt Engine Tests"; }
+	virtual HICON GetIcon() { return nullptr; }
+
+protected:
+	virtual BaseGameLogic* CreateGameAndView() { return nullptr; }
+};
+
+/// Create the resource cache over the City Protectors assets directory -- the working directory must be City Protectors\Game
+bool InitTestResources();
+
+/// Release the resource cache
+void DestroyTestResources();
@@ -0,0 +1,49 @@
+/*
+	WindowsTests.cpp
+
+	Entry point for the tests that need the whole engine library and
+	so only build on Windows. The portable tests are built by the CMake
+	project one directory up.
+*/
+
+#include <EngineStd.h>
+#include <Logger.h>
+
+#include "TestApp.h"
+#include "TestUtil.h"
+
+// test groups, one per file
+void RunPhysicsAllocationTests();
+void RunEventStreamTests();
+void RunComponentIdTests();
+void RunGameObjectSpawnTests();
+void RunProcessManagerTests();
+void RunEventManagerTests();
+void RunEventJournalTests();
+void RunCoroutineProcessTests();
+
+int main()
+{
+	// no logging config, errors still show a dialog
+	Logger::Init(nullptr);
+
+	if (!InitTestResources())
+	{
+		std::printf("Could not open the assets, run the tests from City Protectors\\Game\n");
+		Logger::Destroy();
+		return 1;
+	}
+
+	RunPhysicsAllocationTests();
+	RunEventStreamTests();
+	RunComponentIdTests();
+	RunGameObjectSpawnTests();
+	RunProcessManagerTests();
+	RunEventManagerTests();
+	RunEventJournalTests();
+	RunCoroutineProcessTests();
+
+	DestroyTestResources();
+	Logger::Destroy();
+	return TestExitCode();
+}
@@ -0,0 +1,402 @@
+/*
+	ZipFileTest.cpp
+
+	Packs the game's assets into an archive and checks that the memory
+	mapped and stdio backends both read back every file as it is on disk.
+	A generated archive checks streamed reads, and files split into chunks
+	read on one thread and across the job system, including chunk tables
+	with offsets that are out of order or past the data. The benchmark loads every file in the archive cold, straight after
+	dropping the archive from the page cache, and warm, once it is cached,
+	with each backend, for the assets deflated and for them all stored.
+	Off Linux the page cache can't be dropped without admin rights, so the
+	cold numbers are only printed there.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+#ifndef _WIN32
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+#include <EngineStd.h>
+
+#include "JobSystem.h"
+#include "StringUtil.h"
+#include "TestUtil.h"
+#include "ZipFile.h"
+#include "ZipWriter.h"
+
+const char* ZIPTEST_ASSETS_ARCHIVE = "ZipFileTest_Assets.zip";
+
+const char* ZIPTEST_GENERATED_ARCHIVE = "ZipFileTest_Generated.zip";
+
+// the chunked file is a little over 16 chunks, so the last chunk is short
+const unsigned int ZIPTEST_CHUNK_SIZE = 64 * 1024;
+const unsigned int ZIPTEST_CHUNKED_FILE_SIZE = 16 * ZIPTEST_CHUNK_SIZE + 1234;
+
+// warm loads are timed this many times and the best is kept
+const unsigned int ZIPTEST_WARM_RUNS = 5;
+
+/// How a benchmark run reads the archive
+struct ZipLoadMode
+{
+	const char* m_pName;
+	bool m_MemoryMap;
+	bool m_UseViews;	// stored files are used in place instead of copied, the way the resource cache uses them
+};
+
+/// Read a whole file from disk
+static std::vector<char> ReadDiskFile(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/// Return text that deflates well but not to nothing, the same every run
+static std::vector<char> GenerateText(unsigned int size, unsigned int seed)
+{
+	const char* words[] = { "city ", "protector ", "bullet ", "physics ", "engine ", "cobalt ", "zip ", "chunk ", "\n" };
+	std::vector<char> text;
+	text.reserve(size);
+	while (text.size() < size)
+	{
+		seed = seed * 1664525 + 1013904223;
+		const char* pWord = words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+		for (; *pWord && text.size() < size; ++pWord)
+			text.push_back(*pWord);
+	}
+	return text;
+}
+
+/// Read a file a piece at a time and return the pieces joined back up
+static bool ReadStreamed(ZipFile& zip, int index, unsigned int stagingSize, std::vector<char>& data)
+{
+	data.clear();
+	return zip.ReadFileStreamed(index, stagingSize, [&](const char* pData, unsigned int size) -> bool
+	{
+		data.insert(data.end(), pData, pData + size);
+		return true;
+	});
+}
+
+/// Overwrite one number in a file's chunk table on disk, 0 is the chunk size and n the offset of chunk n. The table is found by walking the directory
+static bool SetChunkTableEntry(const char* pFileName, const std::string& name, unsigned int entry, unsigned int value)
+{
+	std::vector<char> data = ReadDiskFile(pFileName);
+	auto get16 = [&](size_t pos) { return (unsigned int)(unsigned char)data[pos] | ((unsigned int)(unsigned char)data[pos + 1] << 8); };
+	auto get32 = [&](size_t pos) { return get16(pos) | (get16(pos + 2) << 16); };
+
+	// the end record is the last 22 bytes and holds the directory's offset, each entry is 46 bytes before its name
+	size_t pos = get32(data.size() - 22 + 16);
+	while (pos + 46 <= data.size() && get32(pos) == 0x02014b50)
+	{
+		unsigned int nameLength = get16(pos + 28), extraLength = get16(pos + 30), commentLength = get16(pos + 32);
+		size_t extra = pos + 46 + nameLength;
+		if (std::string(&data[pos + 46], nameLength) == name && extraLength >= 8 && get16(extra) == ZIPFILE_CHUNK_TABLE_ID)
+		{
+			// after the record's id and size comes the chunk size, then the offset of each chunk after the first
+			size_t entryPos = extra + 4 + 4 * entry;
+			for (int i = 0; i < 4; ++i)
+				data[entryPos + i] = (char)((value >> (8 * i)) & 0xff);
+
+			std::ofstream file(pFileName, std::ios::binary | std::ios::trunc);
+			file.write(data.data(), data.size());
+			return file.good();
+		}
+		pos += 46 + nameLength + extraLength + commentLength;
+	}
+	return false;
+}
+
+/// Pack a stored file, a deflated one, a chunked one and one that fits in a single chunk
+static bool WriteGeneratedArchive(const std::vector<char>& small, const std::vector<char>& chunked)
+{
+	ZipWriter writer;
+	return writer.AddFile("data/stored.txt", small.data(), (unsigned int)small.size(), ZipWriter_Stored) &&
+		writer.AddFile("data/deflated.txt", small.data(), (unsigned int)small.size(), ZipWriter_Deflated) &&
+		writer.AddFile("data/chunked.txt", chunked.data(), (unsigned int)chunked.size(), ZipWriter_Deflated, ZIPTEST_CHUNK_SIZE) &&
+		writer.AddFile("data/onechunk.txt", small.data(), (unsigned int)small.size(), ZipWriter_Deflated, ZIPTEST_CHUNK_SIZE) &&
+		writer.Save(ZIPTEST_GENERATED_ARCHIVE);
+}
+
+/// Pack the game's assets, deflating the ones that shrink or storing them all
+static bool PackAssets(const char* pFileName, ZipWriterMethod method, unsigned int& numStored)
+{
+	ZipWriter writer;
+	if (!writer.AddDirectory(COBALT_TEST_ASSETS_DIR, method) || !writer.Save(pFileName))
+		return false;
+
+	ZipFile zip;
+	if (!zip.Init(s2ws(pFileName)))
+		return false;
+
+	numStored = 0;
+	for (int i = 0; i < zip.GetNumFiles(); ++i)
+	{
+		if (zip.GetFileView(i))
+			++numStored;
+	}
+	return zip.GetNumFiles() == (int)writer.GetNumFiles();
+}
+
+/// Evict a file from the page cache, returns false if the platform can't
+static bool DropFromPageCache(const char* pFileName)
+{
+#ifdef _WIN32
+	return false;
+#else
+	int fd = open(pFileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	// dirty pages are not dropped, so the archive that was just written has to reach the disk first
+	bool dropped = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(fd);
+	return dropped;
+#endif
+}
+
+/// Open the archive and read every file, returns the time taken and a checksum of everything read
+static unsigned long long LoadArchive(const char* pFileName, const ZipLoadMode& mode, unsigned long& checksum, unsigned long long& numBytes)
+{
+	checksum = adler32(0, Z_NULL, 0);
+	numBytes = 0;
+	unsigned long long start = HighResClock::GetMicroseconds();
+
+	ZipFile zip;
+	TEST_CHECK(zip.Init(s2ws(pFileName), mode.m_MemoryMap));
+	TEST_CHECK(zip.IsMemoryMapped() == mode.m_MemoryMap);
+	for (int i = 0; i < zip.GetNumFiles(); ++i)
+	{
+		int length = zip.GetFileLength(i);
+		const char* pView = mode.m_UseViews ? zip.GetFileView(i) : nullptr;
+
+		// the checksum touches every byte, so a view is paged in the same as a copy is read
+		if (pView)
+		{
+			checksum = adler32(checksum, (const Bytef*)pView, length);
+		}
+		else
+		{
+			std::unique_ptr<char[]> pBuffer(CB_NEW char[length]);
+			TEST_CHECK(zip.ReadFile(i, pBuffer.get()));
+			checksum = adler32(checksum, (const Bytef*)pBuffer.get(), length);
+		}
+		numBytes += length;
+	}
+
+	return HighResClock::GetMicroseconds() - start;
+}
+
+static void TestBackendsMatchTheAssets()
+{
+	unsigned int numStored = 0;
+	TEST_CHECK(PackAssets(ZIPTEST_ASSETS_ARCHIVE, ZipWriter_Deflated, numStored));
+
+	ZipFile mapped, streamed;
+	TEST_CHECK(mapped.Init(s2ws(ZIPTEST_ASSETS_ARCHIVE)) && mapped.IsMemoryMapped());
+	TEST_CHECK(streamed.Init(s2ws(ZIPTEST_ASSETS_ARCHIVE), false) && !streamed.IsMemoryMapped());
+	TEST_CHECK(mapped.GetNumFiles() > 0 && mapped.GetNumFiles() == streamed.GetNumFiles());
+
+	for (int i = 0; i < mapped.GetNumFiles(); ++i)
+	{
+		// names come back lower case with backslashes, the way the resource cache asks for them
+		std::string name = mapped.GetFileName(i);
+		TEST_CHECK(mapped.Find(name) == i && streamed.Find(name) == i);
+		std::replace(name.begin(), name.end(), '\\', '/');
+		std::vector<char> expected = ReadDiskFile(std::filesystem::path(COBALT_TEST_ASSETS_DIR) / name);
+		TEST_CHECK(mapped.GetFileLength(i) == (int)expected.size());
+
+		std::vector<char> fromMapping(expected.size()), fromFile(expected.size());
+		TEST_CHECK(mapped.ReadFile(i, fromMapping.data()) && fromMapping == expected);
+		TEST_CHECK(streamed.ReadFile(i, fromFile.data()) && fromFile == expected);
+
+		// stored files are viewed in place when mapped, and never when read with stdio
+		const char* pView = mapped.GetFileView(i);
+		TEST_CHECK(!pView || std::equal(expected.begin(), expected.end(), pView));
+		TEST_CHECK(!streamed.GetFileView(i));
+	}
+
+	// the assets hold files that compress and files that don't, so both paths are covered
+	TEST_CHECK(numStored > 0 && numStored < (unsigned int)mapped.GetNumFiles());
+
+	mapped.End();
+	streamed.End();
+	std::remove(ZIPTEST_ASSETS_ARCHIVE);
+}
+
+static void TestStreamedReads()
+{
+	std::vector<char> small = GenerateText(100000, 1);
+	std::vector<char> chunked = GenerateText(ZIPTEST_CHUNKED_FILE_SIZE, 2);
+	TEST_CHECK(WriteGeneratedArchive(small, chunked));
+
+	for (int memoryMap = 0; memoryMap < 2; ++memoryMap)
+	{
+		ZipFile zip;
+		TEST_CHECK(zip.Init(s2ws(ZIPTEST_GENERATED_ARCHIVE), memoryMap != 0));
+
+		// staging sizes that don't divide the files, and one bigger than all of them
+		const unsigned int stagingSizes[] = { 1000, ZIPFILE_STREAM_STAGING_SIZE, 4 * 1024 * 1024 };
+		for (unsigned int s = 0; s < sizeof(stagingSizes) / sizeof(stagingSizes[0]); ++s)
+		{
+			std::vector<char> data;
+			TEST_CHECK(ReadStreamed(zip, zip.Find("data\\stored.txt"), stagingSizes[s], data) && data == small);
+			TEST_CHECK(ReadStreamed(zip, zip.Find("data\\deflated.txt"), stagingSizes[s], data) && data == small);
+
+			// the chunks make one ordinary deflate stream, so a streamed read goes straight through them
+			TEST_CHECK(ReadStreamed(zip, zip.Find("data\\chunked.txt"), stagingSizes[s], data) && data == chunked);
+		}
+
+		// the callback can stop a read part way
+		unsigned int numPieces = 0;
+		TEST_CHECK(!zip.ReadFileStreamed(zip.Find("data\\chunked.txt"), 1000, [&](const char* pData, unsigned int size) { return ++numPieces < 3; }));
+		TEST_CHECK(numPieces == 3);
+
+		// large reads report their progress up to the whole file
+		std::vector<char> data(chunked.size());
+		int lastProgress = 0;
+		TEST_CHECK(zip.ReadLargeFile(zip.Find("data\\chunked.txt"), data.data(), [&](int progress, bool& cancel) { lastProgress = progress; }));
+		TEST_CHECK(data == chunked && lastProgress == 100);
+	}
+
+	std::remove(ZIPTEST_GENERATED_ARCHIVE);
+}
+
+static void TestChunkedReads()
+{
+	std::vector<char> small = GenerateText(100000, 3);
+	std::vector<char> chunked = GenerateText(ZIPTEST_CHUNKED_FILE_SIZE, 4);
+	TEST_CHECK(WriteGeneratedArchive(small, chunked));
+
+	JobSystem jobSystem(4);
+	for (int mode = 0; mode < 3; ++mode)
+	{
+		// serial reads ignore the chunk table, a mapped file on a job system inflates every chunk on its own
+		ZipFile zip;
+		TEST_CHECK(zip.Init(s2ws(ZIPTEST_GENERATED_ARCHIVE), mode != 0));
+		if (mode == 2)
+			zip.SetJobSystem(&jobSystem);
+
+		std::vector<char> data(chunked.size());
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\chunked.txt"), data.data()) && data == chunked);
+
+		// a file no longer than a chunk has no table and reads the ordinary way
+		data.assign(small.size(), 0);
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\onechunk.txt"), data.data()) && data == small);
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\deflated.txt"), data.data()) && data == small);
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\stored.txt"), data.data()) && data == small);
+	}
+
+	std::remove(ZIPTEST_GENERATED_ARCHIVE);
+}
+
+static void TestCorruptChunkOffsets()
+{
+	std::vector<char> small = GenerateText(1000, 5);
+	std::vector<char> chunked = GenerateText(ZIPTEST_CHUNKED_FILE_SIZE, 6);
+	JobSystem jobSystem(4);
+
+	// offsets that are zero, go backwards, or point past the compressed data
+	const unsigned int chunks[] = { 1, 6, 16, 16 };
+	const unsigned int offsets[] = { 0, 1, 0xffffff, 0xffffffff };
+	for (unsigned int c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+	{
+		TEST_CHECK(WriteGeneratedArchive(small, chunked));
+		TEST_CHECK(SetChunkTableEntry(ZIPTEST_GENERATED_ARCHIVE, "data/chunked.txt", chunks[c], offsets[c]));
+
+		// the parallel read checks the table and fails instead of inflating overlapping chunks
+		ZipFile zip;
+		TEST_CHECK(zip.Init(s2ws(ZIPTEST_GENERATED_ARCHIVE)));
+		zip.SetJobSystem(&jobSystem);
+		std::vector<char> data(chunked.size());
+		TEST_CHECK(!zip.ReadFile(zip.Find("data\\chunked.txt"), data.data()));
+
+		// the table is only a hint, a serial read of the same file doesn't use it
+		zip.SetJobSystem(nullptr);
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\chunked.txt"), data.data()) && data == chunked);
+	}
+
+	// a chunk size that doesn't match the number of offsets makes the table unusable, and the file reads in one go
+	TEST_CHECK(WriteGeneratedArchive(small, chunked));
+	TEST_CHECK(SetChunkTableEntry(ZIPTEST_GENERATED_ARCHIVE, "data/chunked.txt", 0, 2 * ZIPTEST_CHUNK_SIZE));
+	{
+		ZipFile zip;
+		TEST_CHECK(zip.Init(s2ws(ZIPTEST_GENERATED_ARCHIVE)));
+		zip.SetJobSystem(&jobSystem);
+		std::vector<char> data(chunked.size());
+		TEST_CHECK(zip.ReadFile(zip.Find("data\\chunked.txt"), data.data()) && data == chunked);
+	}
+
+	std::remove(ZIPTEST_GENERATED_ARCHIVE);
+}
+
+/// Time loading an archive cold and warm with each backend
+static void BenchArchive(ZipWriterMethod method)
+{
+	unsigned int numStored = 0;
+	TEST_CHECK(PackAssets(ZIPTEST_ASSETS_ARCHIVE, method, numStored));
+	std::printf("  %s: %u files stored, %.2fMB on disk\n", (method == ZipWriter_Deflated) ? "deflated" : "stored", numStored,
+		(double)std::filesystem::file_size(ZIPTEST_ASSETS_ARCHIVE) / MEGABYTE);
+
+	const ZipLoadMode modes[] =
+	{
+		{ "mmap, stored in place", true, true },
+		{ "mmap, copied", true, false },
+		{ "fread", false, false }
+	};
+
+	unsigned long expectedChecksum = 0;
+	for (unsigned int m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+	{
+		unsigned long checksum = 0;
+		unsigned long long numBytes = 0;
+
+		bool cold = DropFromPageCache(ZIPTEST_ASSETS_ARCHIVE);
+		unsigned long long coldMicroseconds = LoadArchive(ZIPTEST_ASSETS_ARCHIVE, modes[m], checksum, numBytes);
+		if (m == 0)
+			expectedChecksum = checksum;
+		TEST_CHECK(checksum == expectedChecksum);
+
+		unsigned long long warmMicroseconds = 0;
+		for (unsigned int run = 0; run < ZIPTEST_WARM_RUNS; ++run)
+		{
+			unsigned long long microseconds = LoadArchive(ZIPTEST_ASSETS_ARCHIVE, modes[m], checksum, numBytes);
+			if (run == 0 || microseconds < warmMicroseconds)
+				warmMicroseconds = microseconds;
+			TEST_CHECK(checksum == expectedChecksum);
+		}
+
+		char coldText[32] = "n/a";
+		if (cold)
+			std::snprintf(coldText, sizeof(coldText), "%.2fms", (double)coldMicroseconds / 1000.0);
+		std::printf("    %-24s cold %10s  warm %7.2fms  %8.1f MB/s warm\n", modes[m].m_pName, coldText, (double)warmMicroseconds / 1000.0,
+			warmMicroseconds ? (double)numBytes / MEGABYTE / ((double)warmMicroseconds / 1000000.0) : 0.0);
+	}
+
+	std::remove(ZIPTEST_ASSETS_ARCHIVE);
+}
+
+static void BenchColdAndWarmLoads()
+{
+	BenchArchive(ZipWriter_Deflated);
+	BenchArchive(ZipWriter_Stored);
+}
+
+int main()
+{
+	RUN_TEST(TestBackendsMatchTheAssets);
+	RUN_TEST(TestStreamedReads);
+	RUN_TEST(TestChunkedReads);
+	RUN_TEST(TestCorruptChunkOffsets);
+	RUN_TEST(BenchColdAndWarmLoads);
+
+	return TestExitCode();
+}
@@ -0,0 +1,225 @@
+/*
+	ZipWriter.cpp
+*/
+
+#include "ZipWriter.h"
+
+#include "ZipFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <zlib.h>
+
+// zip record signatures
+const unsigned int ZIPWRITER_LOCAL_HEADER_SIG = 0x04034b50;
+const unsigned int ZIPWRITER_DIR_FILE_HEADER_SIG = 0x02014b50;
+const unsigned int ZIPWRITER_DIR_HEADER_SIG = 0x06054b50;
+
+// version 2.0 is the first with deflate
+const unsigned short ZIPWRITER_VERSION = 20;
+
+/// Append a little endian number
+static void Put16(std::vector<char>& out, unsigned int value)
+{
+	out.push_back((char)(value & 0xff));
+	out.push_back((char)((value >> 8) & 0xff));
+}
+
+static void Put32(std::vector<char>& out, unsigned int value)
+{
+	Put16(out, value & 0xffff);
+	Put16(out, value >> 16);
+}
+
+bool ZipWriter::AddFile(const std::string& name, const char* pData, unsigned int size, ZipWriterMethod method, unsigned int chunkSize)
+{
+	Entry entry;
+	entry.m_Name = name;
+	entry.m_Compression = (method == ZipWriter_Deflated) ? Z_DEFLATED : 0;
+	entry.m_Crc = (unsigned int)crc32(crc32(0, Z_NULL, 0), (const Bytef*)pData, size);
+	entry.m_Size = size;
+	entry.m_HeaderOffset = (unsigned int)m_Data.size();
+
+	std::vector<char> compressed;
+	if (method == ZipWriter_Deflated && chunkSize > 0 && size > chunkSize)
+	{
+		std::vector<unsigned int> offsets;
+		if (!DeflateChunks(pData, size, chunkSize, compressed, offsets))
+			return false;
+
+		// the chunk size followed by where each chunk after the first starts
+		Put16(entry.m_Extra, ZIPFILE_CHUNK_TABLE_ID);
+		Put16(entry.m_Extra, (unsigned int)(4 * (offsets.size() + 1)));
+		Put32(entry.m_Extra, chunkSize);
+		for (auto it = offsets.begin(); it != offsets.end(); ++it)
+			Put32(entry.m_Extra, *it);
+	}
+	else if (method == ZipWriter_Deflated && !Deflate(pData, size, compressed))
+		return false;
+	entry.m_CompressedSize = (method == ZipWriter_Deflated) ? (unsigned int)compressed.size() : size;
+
+	Put32(m_Data, ZIPWRITER_LOCAL_HEADER_SIG);
+	Put16(m_Data, ZIPWRITER_VERSION);
+	Put16(m_Data, 0);						// flags
+	Put16(m_Data, entry.m_Compression);
+	Put16(m_Data, 0);						// time
+	Put16(m_Data, 0);						// date
+	Put32(m_Data, entry.m_Crc);
+	Put32(m_Data, entry.m_CompressedSize);
+	Put32(m_Data, entry.m_Size);
+	Put16(m_Data, (unsigned int)name.size());
+	Put16(m_Data, 0);						// extra field length
+	m_Data.insert(m_Data.end(), name.begin(), name.end());
+
+	if (method == ZipWriter_Deflated)
+		m_Data.insert(m_Data.end(), compressed.begin(), compressed.end());
+	else
+		m_Data.insert(m_Data.end(), pData, pData + size);
+
+	m_Entries.push_back(entry);
+	return true;
+}
+
+bool ZipWriter::AddDirectory(const std::string& directory, ZipWriterMethod method)
+{
+	std::error_code error;
+	std::filesystem::recursive_directory_iterator it(directory, error);
+	if (error)
+		return false;
+
+	for (; it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+	{
+		if (error)
+			return false;
+		if (!it->is_regular_file())
+			continue;
+
+		std::ifstream file(it->path(), std::ios::binary);
+		std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (!file.good() && !file.eof())
+			return false;
+
+		// a file that is already compressed, ex. an ogg, is stored so it can be used in place
+		ZipWriterMethod fileMethod = method;
+		std::vector<char> compressed;
+		if (method == ZipWriter_Deflated)
+		{
+			if (!Deflate(data.data(), (unsigned int)data.size(), compressed))
+				return false;
+			if (compressed.size() >= data.size())
+				fileMethod = ZipWriter_Stored;
+		}
+
+		std::string name = std::filesystem::relative(it->path(), directory).generic_string();
+		if (!AddFile(name, data.data(), (unsigned int)data.size(), fileMethod))
+			return false;
+	}
+
+	return true;
+}
+
+bool ZipWriter::Save(const std::string& fileName) const
+{
+	std::vector<char> dir;
+	for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+	{
+		Put32(dir, ZIPWRITER_DIR_FILE_HEADER_SIG);
+		Put16(dir, ZIPWRITER_VERSION);			// made by
+		Put16(dir, ZIPWRITER_VERSION);			// needed
+		Put16(dir, 0);							// flags
+		Put16(dir, it->m_Compression);
+		Put16(dir, 0);							// time
+		Put16(dir, 0);							// date
+		Put32(dir, it->m_Crc);
+		Put32(dir, it->m_CompressedSize);
+		Put32(dir, it->m_Size);
+		Put16(dir, (unsigned int)it->m_Name.size());
+		Put16(dir, (unsigned int)it->m_Extra.size());
+		Put16(dir, 0);							// comment length
+		Put16(dir, 0);							// disk
+		Put16(dir, 0);							// internal attributes
+		Put32(dir, 0);							// external attributes
+		Put32(dir, it->m_HeaderOffset);
+		dir.insert(dir.end(), it->m_Name.begin(), it->m_Name.end());
+		dir.insert(dir.end(), it->m_Extra.begin(), it->m_Extra.end());
+	}
+
+	unsigned int dirSize = (unsigned int)dir.size();
+	Put32(dir, ZIPWRITER_DIR_HEADER_SIG);
+	Put16(dir, 0);								// disk
+	Put16(dir, 0);								// directory's disk
+	Put16(dir, (unsigned int)m_Entries.size());
+	Put16(dir, (unsigned int)m_Entries.size());
+	Put32(dir, dirSize);
+	Put32(dir, (unsigned int)m_Data.size());
+	Put16(dir, 0);								// comment length
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	file.write(m_Data.data(), m_Data.size());
+	file.write(dir.data(), dir.size());
+	return file.good();
+}
+
+bool ZipWriter::Deflate(const char* pData, unsigned int size, std::vector<char>& compressed)
+{
+	z_stream stream = {};
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	compressed.resize(deflateBound(&stream, size));
+	stream.next_in = (Bytef*)pData;
+	stream.avail_in = size;
+	stream.next_out = (Bytef*)compressed.data();
+	stream.avail_out = (uInt)compressed.size();
+
+	int err = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	return err == Z_STREAM_END;
+}
+
+bool ZipWriter::DeflateChunks(const char* pData, unsigned int size, unsigned int chunkSize, std::vector<char>& compressed, std::vector<unsigned int>& offsets)
+{
+	z_stream stream = {};
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	// every full flush adds a few bytes on top of the bound, the buffer grows if it runs out
+	compressed.resize(deflateBound(&stream, size));
+	offsets.clear();
+
+	bool success = true;
+	for (unsigned int start = 0; start < size && success; start += chunkSize)
+	{
+		// a full flush ends the chunk on a byte boundary and drops the dictionary, so the next chunk inflates on its own
+		bool last = size - start <= chunkSize;
+		if (start > 0)
+			offsets.push_back((unsigned int)stream.total_out);
+
+		stream.next_in = (Bytef*)(pData + start);
+		stream.avail_in = last ? size - start : chunkSize;
+		int flush = last ? Z_FINISH : Z_FULL_FLUSH;
+		for (;;)
+		{
+			if (compressed.size() - stream.total_out < 64)
+				compressed.resize(compressed.size() * 2);
+			stream.next_out = (Bytef*)compressed.data() + stream.total_out;
+			stream.avail_out = (uInt)(compressed.size() - stream.total_out);
+
+			int err = deflate(&stream, flush);
+			if (err == Z_STREAM_ERROR)
+			{
+				success = false;
+				break;
+			}
+
+			// the flush is only complete once deflate returns with output space left over
+			if (last ? (err == Z_STREAM_END) : (stream.avail_in == 0 && stream.avail_out > 0))
+				break;
+		}
+	}
+
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	return success;
+}
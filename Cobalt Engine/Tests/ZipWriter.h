@@ -0,0 +1,72 @@
+/*
+	ZipWriter.h
+
+	Writes zip archives for the zip reader tests and benchmarks, so they
+	don't depend on a zip tool or a checked in archive. Files are stored
+	or deflated with zlib, the layout ZipFile.h describes, and a deflated
+	file can be split into chunks that inflate on their own with the
+	chunk table in its directory entry's extra field.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/// How a file is written to the archive
+enum ZipWriterMethod
+{
+	ZipWriter_Stored,
+	ZipWriter_Deflated
+};
+
+/**
+	Builds a zip archive in memory and writes it out in one go. Names are given with forward
+	slashes like any zip tool writes them.
+
+	Usage:
+	ZipWriter writer;
+	writer.AddFile("gameobjects/light.xml", pData, size, ZipWriter_Deflated);
+	writer.Save("Test.zip");
+*/
+class ZipWriter
+{
+public:
+	/// Add a file -- returns false if zlib fails to compress it. A deflated file longer than the chunk size is split into chunks of that many bytes
+	bool AddFile(const std::string& name, const char* pData, unsigned int size, ZipWriterMethod method, unsigned int chunkSize = 0);
+
+	/// Add every file under a directory with its path relative to the directory. Deflating stores the files that don't shrink
+	bool AddDirectory(const std::string& directory, ZipWriterMethod method);
+
+	/// Write the archive to disk
+	bool Save(const std::string& fileName) const;
+
+	/// Return the number of files added
+	unsigned int GetNumFiles() const { return (unsigned int)m_Entries.size(); }
+
+private:
+	/// What the directory needs to know about a file
+	struct Entry
+	{
+		std::string m_Name;
+		unsigned short m_Compression;
+		unsigned int m_Crc;
+		unsigned int m_CompressedSize;
+		unsigned int m_Size;
+		unsigned int m_HeaderOffset;
+		std::vector<char> m_Extra;	// extra field for the directory entry
+	};
+
+	/// Raw deflate a buffer -- returns false if zlib fails
+	static bool Deflate(const char* pData, unsigned int size, std::vector<char>& compressed);
+
+	/// Raw deflate a buffer with a full flush after every chunk and fill in the offset of each chunk after the first -- returns false if zlib fails
+	static bool DeflateChunks(const char* pData, unsigned int size, unsigned int chunkSize, std::vector<char>& compressed, std::vector<unsigned int>& offsets);
+
+private:
+	/// Local headers and file data
+	std::vector<char> m_Data;
+
+	/// One entry per file for the directory
+	std::vector<Entry> m_Entries;
+};